@@ -36,6 +36,10 @@
 /* Enable BMP decoder for loading BMP images from filesystem */
 #define LV_USE_BMP 1
 
+/* Enable the split-JPEG decoder; its TJpgDec core is also used by the
+   upload converter (asset_transcode.cpp) to turn JPEGs into .bin assets */
+#define LV_USE_SJPG 1
+
 /* Use PSRAM for LVGL memory allocation - custom functions to force PSRAM usage */
 #define LV_MEM_CUSTOM 1
 #define LV_MEM_CUSTOM_INCLUDE <esp_heap_caps.h>
@@ -46,7 +46,10 @@ typedef enum {
 	GRAPH_TIME_1M = 2,         // 1 minute
 	GRAPH_TIME_5M = 3,         // 5 minutes
 	GRAPH_TIME_10M = 4,        // 10 minutes
-	GRAPH_TIME_30M = 5         // 30 minutes
+	GRAPH_TIME_30M = 5,        // 30 minutes
+	GRAPH_TIME_6H = 6,         // 6 hours (from the SD time-series store)
+	GRAPH_TIME_24H = 7,        // 24 hours (from the SD time-series store)
+	GRAPH_TIME_7D = 8          // 7 days (from the SD time-series store)
 } GraphTimeRange;
 
 // Graph chart type
@@ -56,6 +59,18 @@ typedef enum {
 	GRAPH_CHART_SCATTER = 2    // Scatter plot
 } GraphChartType;
 
+// Value widgets on a screen, used to index the per-widget redraw settings.
+// The number slots follow the layout of whichever display type is active.
+typedef enum {
+	WIDGET_SLOT_GAUGE_TOP = 0,     // top needle (GAUGE, GAUGE_NUMBER)
+	WIDGET_SLOT_GAUGE_BOTTOM = 1,  // bottom needle (GAUGE)
+	WIDGET_SLOT_NUMBER_1 = 2,      // number / dual top / quad top-left / gauge+number center
+	WIDGET_SLOT_NUMBER_2 = 3,      // dual bottom / quad top-right
+	WIDGET_SLOT_NUMBER_3 = 4,      // quad bottom-left
+	WIDGET_SLOT_NUMBER_4 = 5,      // quad bottom-right
+	WIDGET_SLOT_COUNT = 6
+} WidgetSlot;
+
 typedef struct {
 	GaugeCalibrationPoint cal[2][5]; // 2 gauges, 5 points each
 	char icon_paths[2][128];         // 2 icons (top/bottom)
@@ -101,6 +116,11 @@ typedef struct {
 	uint8_t graph_time_range;         // GraphTimeRange for graph time window
 	char graph_path_2[128];           // Signal K path for second graph series
 	char graph_color_2[8];            // Hex color for second graph series
+	// Redraw filtering per WidgetSlot (0 = off). Needles work in degrees of
+	// sweep, numbers in displayed units (after unit conversion).
+	float redraw_deadband[WIDGET_SLOT_COUNT];      // ignore changes smaller than this
+	uint16_t redraw_min_ms[WIDGET_SLOT_COUNT];     // minimum time between redraws
+	float redraw_resolution[WIDGET_SLOT_COUNT];    // round the shown value to this step
 	// Add more fields as needed
 } __attribute__((packed)) ScreenConfig;
 
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+# Gzip the web app in web/ into data/www/ for the SPIFFS image.
+#
+# Runs as a PlatformIO pre-script (extra_scripts in platformio.ini) before
+# every build, so `pio run -t uploadfs` always ships the current sources.
+# Also works standalone: python scripts/build_web.py
+#
+# index.html is served with no-cache and revalidated by ETag; it refers to
+# app.js/app.css as ?v=<hash of their contents> so the browser may cache
+# those for a year and still picks up a new upload.
+import gzip
+import hashlib
+import os
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    project_dir = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    project_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+src_dir = os.path.join(project_dir, 'web')
+out_dir = os.path.join(project_dir, 'data', 'www')
+assets = ['app.js', 'app.css']
+
+
+def read(name):
+    with open(os.path.join(src_dir, name), 'rb') as f:
+        return f.read()
+
+
+def write_gz(name, data):
+    path = os.path.join(out_dir, name + '.gz')
+    # mtime=0 keeps the output (and so the device's ETag) stable across builds
+    packed = gzip.compress(data, compresslevel=9, mtime=0)
+    old = None
+    if os.path.exists(path):
+        with open(path, 'rb') as f:
+            old = f.read()
+    if old != packed:
+        with open(path, 'wb') as f:
+            f.write(packed)
+        print('[build_web] %s: %d -> %d bytes' % (name, len(data), len(packed)))
+
+
+if os.path.isdir(src_dir):
+    os.makedirs(out_dir, exist_ok=True)
+    digest = hashlib.sha1()
+    for name in assets:
+        data = read(name)
+        digest.update(data)
+        write_gz(name, data)
+    index = read('index.html').replace(b'%APP_VERSION%', digest.hexdigest()[:8].encode())
+    write_gz('index.html', index)
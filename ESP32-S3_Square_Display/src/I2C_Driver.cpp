@@ -1,34 +1,235 @@
-#include "I2C_Driver.h"                    
+#include "I2C_Driver.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+
+#define I2C_SYNC_SLOTS 4                  // concurrent synchronous callers
+
+typedef struct {
+  I2C_Txn txn;
+  uint8_t tx_buf[I2C_TX_INLINE];          // used when txn.tx is NULL
+  I2C_Done_Cb done;
+  void *arg;
+  uint32_t queued_us;
+} I2C_Item;
+
+typedef struct {
+  SemaphoreHandle_t sem;
+  bool ok;
+} I2C_Sync;
+
+typedef struct {
+  uint8_t addr;
+  uint32_t count;
+  uint32_t errors;
+  uint64_t bus_us_total;
+  uint32_t bus_us_max;
+  uint32_t wait_us_max;
+} I2C_Stats_Entry;
+
+static const uint8_t i2c_queue_depth[I2C_PRIO_COUNT] = {4, 8, 8, 4};
+static QueueHandle_t i2c_queues[I2C_PRIO_COUNT] = {NULL};
+static QueueHandle_t i2c_sync_pool = NULL;   // free binary semaphores for I2C_Transfer
+static TaskHandle_t i2c_task_handle = NULL;
+
+static I2C_Stats_Entry i2c_stats[I2C_MAX_DEVICES];
+static uint8_t i2c_stats_count = 0;
+static portMUX_TYPE i2c_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void I2C_Record(uint8_t addr, bool ok, uint32_t bus_us, uint32_t wait_us) {
+  portENTER_CRITICAL(&i2c_stats_mux);
+  I2C_Stats_Entry *e = NULL;
+  for (uint8_t i = 0; i < i2c_stats_count; i++) {
+    if (i2c_stats[i].addr == addr) { e = &i2c_stats[i]; break; }
+  }
+  if (!e && i2c_stats_count < I2C_MAX_DEVICES) {
+    e = &i2c_stats[i2c_stats_count++];
+    memset(e, 0, sizeof(*e));
+    e->addr = addr;
+  }
+  if (e) {
+    e->count++;
+    if (!ok) e->errors++;
+    e->bus_us_total += bus_us;
+    if (bus_us > e->bus_us_max) e->bus_us_max = bus_us;
+    if (wait_us > e->wait_us_max) e->wait_us_max = wait_us;
+  }
+  portEXIT_CRITICAL(&i2c_stats_mux);
+}
+
+// Runs one transaction on the wire; only ever called by the bus owner
+static bool I2C_Execute(const I2C_Item *item) {
+  const I2C_Txn *t = &item->txn;
+  const uint8_t *tx = t->tx ? t->tx : item->tx_buf;
+  if (t->reg_len || t->tx_len || !t->rx_len) {
+    Wire.beginTransmission(t->addr);
+    if (t->reg_len == 2) Wire.write((uint8_t)(t->reg >> 8));
+    if (t->reg_len) Wire.write((uint8_t)t->reg);
+    if (t->tx_len) Wire.write(tx, t->tx_len);
+    if (Wire.endTransmission(true)) return false;
+  }
+  if (t->rx_len) {
+    size_t got = Wire.requestFrom((uint16_t)t->addr, (size_t)t->rx_len, true);
+    for (uint16_t i = 0; i < t->rx_len; i++) {
+      t->rx[i] = (i < got) ? (uint8_t)Wire.read() : 0;
+    }
+    if (got != t->rx_len) return false;
+  }
+  return true;
+}
+
+static bool I2C_Run(const I2C_Item *item) {
+  uint32_t start = micros();
+  bool ok = I2C_Execute(item);
+  uint32_t end = micros();
+  I2C_Record(item->txn.addr, ok, end - start, item->queued_us ? start - item->queued_us : 0);
+  if (item->done) item->done(ok, item->arg);
+  return ok;
+}
+
+static bool I2C_Next(I2C_Item *item) {
+  for (int p = 0; p < I2C_PRIO_COUNT; p++) {
+    if (xQueueReceive(i2c_queues[p], item, 0) == pdTRUE) return true;
+  }
+  return false;
+}
+
+static void I2C_Task(void *arg) {
+  I2C_Item item;
+  uint32_t stats_last = millis();
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    // Re-check from the top after every transaction so higher priorities win
+    while (I2C_Next(&item)) {
+      I2C_Run(&item);
+    }
+    if (millis() - stats_last >= I2C_STATS_PERIOD_MS) {
+      stats_last = millis();
+      I2C_Log_Stats();
+    }
+  }
+}
 
 void I2C_Init(void) {
   Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+  if (i2c_task_handle) return;
+
+  for (int p = 0; p < I2C_PRIO_COUNT; p++) {
+    i2c_queues[p] = xQueueCreate(i2c_queue_depth[p], sizeof(I2C_Item));
+  }
+  i2c_sync_pool = xQueueCreate(I2C_SYNC_SLOTS, sizeof(SemaphoreHandle_t));
+  for (int i = 0; i < I2C_SYNC_SLOTS; i++) {
+    SemaphoreHandle_t sem = xSemaphoreCreateBinary();
+    xQueueSend(i2c_sync_pool, &sem, 0);
+  }
+  // Above the touch task so a waiting touch read is served as soon as it is queued
+  xTaskCreatePinnedToCore(I2C_Task, "i2c_bus", 3072, NULL, 5, &i2c_task_handle, 1);
+}
+
+static bool I2C_Enqueue(const I2C_Txn *txn, I2C_Priority prio, I2C_Done_Cb done, void *arg, bool copy_tx, TickType_t wait) {
+  if (prio >= I2C_PRIO_COUNT) prio = I2C_PRIO_LOW;
+  I2C_Item item;
+  item.txn = *txn;
+  item.done = done;
+  item.arg = arg;
+  item.queued_us = micros();
+  if (copy_tx && txn->tx_len) {
+    if (txn->tx_len > I2C_TX_INLINE) return false;
+    memcpy(item.tx_buf, txn->tx, txn->tx_len);
+    item.txn.tx = NULL;
+  }
+  if (xQueueSend(i2c_queues[prio], &item, wait) != pdTRUE) return false;
+  xTaskNotifyGive(i2c_task_handle);
+  return true;
 }
+
+bool I2C_Submit(const I2C_Txn *txn, I2C_Priority prio, I2C_Done_Cb done, void *arg) {
+  if (!i2c_task_handle || xTaskGetCurrentTaskHandle() == i2c_task_handle) {
+    bool ok = I2C_Transfer(txn, prio);
+    if (done) done(ok, arg);
+    return true;
+  }
+  if (!I2C_Enqueue(txn, prio, done, arg, true, pdMS_TO_TICKS(20))) {
+    I2C_Record(txn->addr, false, 0, 0);
+    printf("[I2C] Queue full, dropped transaction to 0x%02X\r\n", txn->addr);
+    return false;
+  }
+  return true;
+}
+
+static void I2C_Sync_Done(bool ok, void *arg) {
+  I2C_Sync *sync = (I2C_Sync *)arg;
+  sync->ok = ok;
+  xSemaphoreGive(sync->sem);
+}
+
+bool I2C_Transfer(const I2C_Txn *txn, I2C_Priority prio) {
+  if (!i2c_task_handle || xTaskGetCurrentTaskHandle() == i2c_task_handle) {
+    I2C_Item item;
+    item.txn = *txn;
+    item.done = NULL;
+    item.arg = NULL;
+    item.queued_us = 0;
+    return I2C_Run(&item);
+  }
+
+  I2C_Sync sync;
+  xQueueReceive(i2c_sync_pool, &sync.sem, portMAX_DELAY);
+  sync.ok = false;
+  bool ok = false;
+  // The caller waits, so the payload can stay in its own buffer
+  if (I2C_Enqueue(txn, prio, I2C_Sync_Done, &sync, false, portMAX_DELAY)) {
+    xSemaphoreTake(sync.sem, portMAX_DELAY);
+    ok = sync.ok;
+  }
+  xQueueSend(i2c_sync_pool, &sync.sem, 0);
+  return ok;
+}
+
+uint8_t I2C_Get_Stats(I2C_Device_Stats *out, uint8_t max) {
+  uint8_t n = 0;
+  portENTER_CRITICAL(&i2c_stats_mux);
+  for (; n < i2c_stats_count && n < max; n++) {
+    const I2C_Stats_Entry *e = &i2c_stats[n];
+    out[n].addr = e->addr;
+    out[n].count = e->count;
+    out[n].errors = e->errors;
+    out[n].bus_us_avg = e->count ? (uint32_t)(e->bus_us_total / e->count) : 0;
+    out[n].bus_us_max = e->bus_us_max;
+    out[n].wait_us_max = e->wait_us_max;
+  }
+  portEXIT_CRITICAL(&i2c_stats_mux);
+  return n;
+}
+
+void I2C_Log_Stats(void) {
+  I2C_Device_Stats stats[I2C_MAX_DEVICES];
+  uint8_t n = I2C_Get_Stats(stats, I2C_MAX_DEVICES);
+  for (uint8_t i = 0; i < n; i++) {
+    Serial.printf("[I2C] 0x%02X: %lu txns, %lu errors, bus avg %lu us max %lu us, queue wait max %lu us\n",
+                  stats[i].addr, (unsigned long)stats[i].count, (unsigned long)stats[i].errors,
+                  (unsigned long)stats[i].bus_us_avg, (unsigned long)stats[i].bus_us_max,
+                  (unsigned long)stats[i].wait_us_max);
+  }
+}
+
 // 寄存器地址为 8 位的
-bool I2C_Read(uint8_t Driver_addr, uint8_t Reg_addr, uint8_t *Reg_data, uint32_t Length)
+bool I2C_Read(uint8_t Driver_addr, uint8_t Reg_addr, uint8_t *Reg_data, uint32_t Length, I2C_Priority prio)
 {
-  Wire.beginTransmission(Driver_addr);
-  Wire.write(Reg_addr); 
-  if ( Wire.endTransmission(true)){
+  I2C_Txn txn = {Driver_addr, 1, Reg_addr, NULL, 0, Reg_data, (uint16_t)Length};
+  if (!I2C_Transfer(&txn, prio)) {
     printf("The I2C transmission fails. - I2C Read\r\n");
     return -1;
   }
-  Wire.requestFrom(Driver_addr, Length);
-  for (int i = 0; i < Length; i++) {
-    *Reg_data++ = Wire.read();
-  }
   return 0;
 }
-bool I2C_Write(uint8_t Driver_addr, uint8_t Reg_addr, const uint8_t *Reg_data, uint32_t Length)
+bool I2C_Write(uint8_t Driver_addr, uint8_t Reg_addr, const uint8_t *Reg_data, uint32_t Length, I2C_Priority prio)
 {
-  Wire.beginTransmission(Driver_addr);
-  Wire.write(Reg_addr);       
-  for (int i = 0; i < Length; i++) {
-    Wire.write(*Reg_data++);
-  }
-  if ( Wire.endTransmission(true))
-  {
+  I2C_Txn txn = {Driver_addr, 1, Reg_addr, Reg_data, (uint16_t)Length, NULL, 0};
+  if (!I2C_Transfer(&txn, prio)) {
     printf("The I2C transmission fails. - I2C Write\r\n");
     return -1;
   }
   return 0;
-}
\ No newline at end of file
+}
@@ -4,7 +4,55 @@
 #define I2C_SCL_PIN       7
 #define I2C_SDA_PIN       15
 
+// The bus is owned by a single manager task. Every transaction is queued to it
+// and the queues are served strictly by priority, so a touch read never waits
+// behind more than the one transaction already on the wire.
+typedef enum {
+  I2C_PRIO_TOUCH = 0,             // GT911 reads (latency sensitive)
+  I2C_PRIO_HIGH,                  // TCA9554 outputs: backlight, buzzer, SD CS, panel reset
+  I2C_PRIO_NORMAL,                // RTC, IMU
+  I2C_PRIO_LOW,                   // background / diagnostic traffic
+  I2C_PRIO_COUNT
+} I2C_Priority;
+
+#define I2C_TX_INLINE         16  // payload bytes copied with an asynchronous write
+#define I2C_MAX_DEVICES       8   // devices tracked in the statistics table
+#define I2C_STATS_PERIOD_MS   60000
+
+// Completion callback, runs on the bus task: keep it short and do not block
+typedef void (*I2C_Done_Cb)(bool ok, void *arg);
+
+typedef struct {
+  uint8_t addr;
+  uint8_t reg_len;                // register address bytes sent first: 0, 1 or 2 (MSB first)
+  uint16_t reg;
+  const uint8_t *tx;              // payload written after the register address
+  uint16_t tx_len;
+  uint8_t *rx;                    // read after the register address (repeated transaction)
+  uint16_t rx_len;
+} I2C_Txn;
+
+typedef struct {
+  uint8_t addr;
+  uint32_t count;
+  uint32_t errors;
+  uint32_t bus_us_avg;            // time on the wire
+  uint32_t bus_us_max;
+  uint32_t wait_us_max;           // time spent queued before reaching the wire
+} I2C_Device_Stats;
 
 void I2C_Init(void);
-bool I2C_Read(uint8_t Driver_addr, uint8_t Reg_addr, uint8_t *Reg_data, uint32_t Length);
-bool I2C_Write(uint8_t Driver_addr, uint8_t Reg_addr, const uint8_t *Reg_data, uint32_t Length);
\ No newline at end of file
+
+// Queue a transaction and return immediately. A write payload up to I2C_TX_INLINE
+// bytes is copied; `rx` must stay valid until `done` has been called.
+bool I2C_Submit(const I2C_Txn *txn, I2C_Priority prio, I2C_Done_Cb done, void *arg);
+// Queue a transaction and wait for it. Runs inline before the bus task exists
+// and when called from a completion callback. Returns true on success.
+bool I2C_Transfer(const I2C_Txn *txn, I2C_Priority prio);
+
+uint8_t I2C_Get_Stats(I2C_Device_Stats *out, uint8_t max);
+void I2C_Log_Stats(void);
+
+// 8-bit register helpers; return 0 on success like the esp_err_t callers expect
+bool I2C_Read(uint8_t Driver_addr, uint8_t Reg_addr, uint8_t *Reg_data, uint32_t Length, I2C_Priority prio = I2C_PRIO_NORMAL);
+bool I2C_Write(uint8_t Driver_addr, uint8_t Reg_addr, const uint8_t *Reg_data, uint32_t Length, I2C_Priority prio = I2C_PRIO_NORMAL);
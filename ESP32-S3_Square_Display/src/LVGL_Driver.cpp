@@ -216,6 +216,18 @@ void Lvgl_Display_LCD( lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_
 /*Read the touchpad*/
 void Lvgl_Touchpad_Read( lv_indev_drv_t * indev_drv, lv_indev_data_t * data )
 {
+#if GT911_USE_IRQ
+  // The touch task keeps the latest state; no I2C traffic from the LVGL poll
+  uint16_t x = 0, y = 0;
+  uint8_t points = 0;
+  if (Touch_Get_Latest(&x, &y, &points)) {
+    data->point.x = x;
+    data->point.y = y;
+    data->state = LV_INDEV_STATE_PR;
+  } else {
+    data->state = LV_INDEV_STATE_REL;
+  }
+#else
   uint16_t touchpad_x[GT911_LCD_TOUCH_MAX_POINTS] = {0};
   uint16_t touchpad_y[GT911_LCD_TOUCH_MAX_POINTS] = {0};
   uint16_t strength[GT911_LCD_TOUCH_MAX_POINTS]   = {0};
@@ -230,6 +242,7 @@ void Lvgl_Touchpad_Read( lv_indev_drv_t * indev_drv, lv_indev_data_t * data )
   } else {
     data->state = LV_INDEV_STATE_REL;
   }
+#endif
 }
 void example_increase_lvgl_tick(void *arg)
 {
@@ -1,93 +1,147 @@
 #include "TCA9554PWR.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Shadow copies of the output and configuration registers. The expander only
+// changes them when we write, so pin updates never need a read first and a
+// write is skipped when the register would not change.
+static uint8_t exio_output_shadow = 0xFF;                    // power-on defaults
+static uint8_t exio_config_shadow = 0xFF;
+static uint8_t exio_input_cache = 0x00;
+static volatile bool exio_input_stale = true;                // set by the expander INT line
+static SemaphoreHandle_t exio_mutex = NULL;
+
+static void EXIO_Lock(void)   { if (exio_mutex) xSemaphoreTake(exio_mutex, portMAX_DELAY); }
+static void EXIO_Unlock(void) { if (exio_mutex) xSemaphoreGive(exio_mutex); }
+
+#if TCA9554_INT_PIN >= 0
+static void IRAM_ATTR EXIO_Interrupt(void) {
+  exio_input_stale = true;
+}
+#endif
 
 /*****************************************************  Operation register REG   ****************************************************/   
 uint8_t I2C_Read_EXIO(uint8_t REG)                             // Read the value of the TCA9554PWR register REG
 {
-  Wire.beginTransmission(TCA9554_ADDRESS);                
-  Wire.write(REG);                                        
-  uint8_t result = Wire.endTransmission();               
-  if (result != 0) {                                     
+  uint8_t bitsStatus = 0;
+  if (I2C_Read(TCA9554_ADDRESS, REG, &bitsStatus, 1, I2C_PRIO_HIGH)) {
     printf("Data Transfer Failure !!!\r\n");
   }
-  Wire.requestFrom(TCA9554_ADDRESS, 1);                   
-  uint8_t bitsStatus = Wire.read();                        
   return bitsStatus;                                     
 }
 uint8_t I2C_Write_EXIO(uint8_t REG,uint8_t Data)              // Write Data to the REG register of the TCA9554PWR
 {
-  Wire.beginTransmission(TCA9554_ADDRESS);                
-  Wire.write(REG);                                        
-  Wire.write(Data);                                       
-  uint8_t result = Wire.endTransmission();                  
-  if (result != 0) {    
+  if (I2C_Write(TCA9554_ADDRESS, REG, &Data, 1, I2C_PRIO_HIGH)) {
     printf("Data write failure!!!\r\n");
     return -1;
   }
   return 0;                                             
 }
+// Write a register through its shadow; no bus traffic when nothing changes. Caller holds the lock.
+static uint8_t EXIO_Update(uint8_t REG, uint8_t *shadow, uint8_t Data)
+{
+  if (Data == *shadow) return 0;
+  uint8_t result = I2C_Write_EXIO(REG, Data);
+  if (result == 0) *shadow = Data;
+  return result;
+}
 /********************************************************** Set EXIO mode **********************************************************/       
 void Mode_EXIO(uint8_t Pin,uint8_t State)                 // Set the mode of the TCA9554PWR Pin. The default is Output mode (output mode or input mode). State: 0= Output mode 1= input mode   
 {
-  uint8_t bitsStatus = I2C_Read_EXIO(TCA9554_CONFIG_REG);      
-  uint8_t Data = (0x01 << (Pin-1)) | bitsStatus;   
-  uint8_t result = I2C_Write_EXIO(TCA9554_CONFIG_REG,Data); 
+  if (Pin < 1 || Pin > 8) return;
+  EXIO_Lock();
+  uint8_t Data = State ? (exio_config_shadow | (0x01 << (Pin-1))) : (exio_config_shadow & ~(0x01 << (Pin-1)));
+  uint8_t result = EXIO_Update(TCA9554_CONFIG_REG, &exio_config_shadow, Data);
+  EXIO_Unlock();
   if (result != 0) { 
     printf("I/O Configuration Failure !!!\r\n");
   }
 }
 void Mode_EXIOS(uint8_t PinState)                         // Set the mode of the 7 pins from the TCA9554PWR with PinState   
 {
-  uint8_t result = I2C_Write_EXIO(TCA9554_CONFIG_REG,PinState);  
+  EXIO_Lock();
+  uint8_t result = EXIO_Update(TCA9554_CONFIG_REG, &exio_config_shadow, PinState);
+  EXIO_Unlock();
   if (result != 0) {   
     printf("I/O Configuration Failure !!!\r\n");
   }
 }
 /********************************************************** Read EXIO status **********************************************************/       
+void EXIO_Refresh_Inputs(void)                            // Re-read the input register from the expander
+{
+  EXIO_Lock();
+  exio_input_stale = false;
+  exio_input_cache = I2C_Read_EXIO(TCA9554_INPUT_REG);
+  EXIO_Unlock();
+}
 uint8_t Read_EXIO(uint8_t Pin)                            // Read the level of the TCA9554PWR Pin
 {
-  uint8_t inputBits = I2C_Read_EXIO(TCA9554_INPUT_REG);          
+  uint8_t inputBits = Read_EXIOS(TCA9554_INPUT_REG);          
   uint8_t bitStatus = (inputBits >> (Pin-1)) & 0x01; 
   return bitStatus;                                  
 }
 uint8_t Read_EXIOS(uint8_t REG = TCA9554_INPUT_REG)       // Read the level of all pins of TCA9554PWR, the default read input level state, want to get the current IO output state, pass the parameter TCA9554_OUTPUT_REG, such as Read_EXIOS(TCA9554_OUTPUT_REG);
 {
-  uint8_t inputBits = I2C_Read_EXIO(REG);                     
-  return inputBits;     
+  if (REG == TCA9554_OUTPUT_REG) return exio_output_shadow;
+  if (REG == TCA9554_CONFIG_REG) return exio_config_shadow;
+  if (REG != TCA9554_INPUT_REG) return I2C_Read_EXIO(REG);
+  // Output pins read back what we drive; only pins configured as inputs need the bus
+  uint8_t inputs = exio_config_shadow;
+  if (inputs == 0) return exio_output_shadow;
+#if TCA9554_INT_PIN >= 0
+  if (exio_input_stale) EXIO_Refresh_Inputs();
+#else
+  EXIO_Refresh_Inputs();
+#endif
+  return (exio_input_cache & inputs) | (exio_output_shadow & ~inputs);
 }
 
 /********************************************************** Set the EXIO output status **********************************************************/  
 void Set_EXIO(uint8_t Pin,uint8_t State)                  // Sets the level state of the Pin without affecting the other pins
 {
-  uint8_t Data;
   if(State < 2 && Pin < 9 && Pin > 0){  
-    uint8_t bitsStatus = Read_EXIOS(TCA9554_OUTPUT_REG);
-    if(State == 1)                                     
-      Data = (0x01 << (Pin-1)) | bitsStatus; 
-    else if(State == 0)                  
-      Data = (~(0x01 << (Pin-1))) & bitsStatus;      
-    uint8_t result = I2C_Write_EXIO(TCA9554_OUTPUT_REG,Data);  
-    if (result != 0) {                         
-      printf("Failed to set GPIO!!!\r\n");
-    }
+    Set_EXIO_Mask(0x01 << (Pin-1), State ? 0xFF : 0x00);
   }
   else                                           
     printf("Parameter error, please enter the correct parameter!\r\n");
 }
-void Set_EXIOS(uint8_t PinState)                          // Set 7 pins to the PinState state such as :PinState=0x23, 0010 0011 state (the highest bit is not used)
+void Set_EXIO_Mask(uint8_t Mask,uint8_t Levels)           // Set every pin in Mask to the matching bit of Levels in one write
 {
-  uint8_t result = I2C_Write_EXIO(TCA9554_OUTPUT_REG,PinState); 
-  if (result != 0) {                  
+  EXIO_Lock();
+  uint8_t Data = (exio_output_shadow & ~Mask) | (Levels & Mask);
+  uint8_t result = EXIO_Update(TCA9554_OUTPUT_REG, &exio_output_shadow, Data);
+  EXIO_Unlock();
+  if (result != 0) {                         
     printf("Failed to set GPIO!!!\r\n");
   }
 }
+void Set_EXIOS(uint8_t PinState)                          // Set 7 pins to the PinState state such as :PinState=0x23, 0010 0011 state (the highest bit is not used)
+{
+  Set_EXIO_Mask(0xFF, PinState);
+}
 /********************************************************** Flip EXIO state **********************************************************/  
 void Set_Toggle(uint8_t Pin)                              // Flip the level of the TCA9554PWR Pin
 {
-    uint8_t bitsStatus = Read_EXIO(Pin);                 
-    Set_EXIO(Pin,(bool)!bitsStatus); 
+  if (Pin < 1 || Pin > 8) return;
+  EXIO_Lock();
+  uint8_t Data = exio_output_shadow ^ (0x01 << (Pin-1));
+  uint8_t result = EXIO_Update(TCA9554_OUTPUT_REG, &exio_output_shadow, Data);
+  EXIO_Unlock();
+  if (result != 0) {
+    printf("Failed to set GPIO!!!\r\n");
+  }
 }
 /********************************************************* TCA9554PWR Initializes the device ***********************************************************/  
 void TCA9554PWR_Init(uint8_t PinState)                  // Set the seven pins to PinState state, for example :PinState=0x23, 0010 0011 State  (Output mode or input mode) 0= Output mode 1= Input mode. The default value is output mode
 {                  
+  if (!exio_mutex) exio_mutex = xSemaphoreCreateMutex();
+  // Seed the shadows from the device once; after this only changes are written
+  exio_output_shadow = I2C_Read_EXIO(TCA9554_OUTPUT_REG);
+  exio_config_shadow = I2C_Read_EXIO(TCA9554_CONFIG_REG);
   Mode_EXIOS(PinState);      
+#if TCA9554_INT_PIN >= 0
+  pinMode(TCA9554_INT_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(TCA9554_INT_PIN), EXIO_Interrupt, FALLING);
+#endif
+  EXIO_Refresh_Inputs();
 }
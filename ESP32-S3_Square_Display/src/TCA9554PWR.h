@@ -20,6 +20,10 @@
 #define TCA9554_Polarity_REG    0x02                      // The Polarity Inversion register (register 2) allows polarity inversion of pins defined as inputs by the Configuration register.  
 #define TCA9554_CONFIG_REG      0x03                      // Configuration register, mode configuration
 
+#ifndef TCA9554_INT_PIN
+#define TCA9554_INT_PIN         -1                        // MCU pin wired to the expander INT output, -1 when not connected (inputs are then read on demand)
+#endif
+
 
 #define Low   0
 #define High  1
@@ -34,15 +38,17 @@
 
 /*****************************************************  Operation register REG   ****************************************************/   
 uint8_t I2C_Read_EXIO(uint8_t REG);                              // Read the value of the TCA9554PWR register REG
-uint8_t I2C_Read_EXIO(uint8_t REG,uint8_t Data);                // Write Data to the REG register of the TCA9554PWR
+uint8_t I2C_Write_EXIO(uint8_t REG,uint8_t Data);               // Write Data to the REG register of the TCA9554PWR
 /********************************************************** Set EXIO mode **********************************************************/       
 void Mode_EXIO(uint8_t Pin,uint8_t State);                  // Set the mode of the TCA9554PWR Pin. The default is Output mode (output mode or input mode). State: 0= Output mode 1= input mode   
 void Mode_EXIOS(uint8_t PinState);                          // Set the mode of the 7 pins from the TCA9554PWR with PinState  
 /********************************************************** Read EXIO status **********************************************************/       
 uint8_t Read_EXIO(uint8_t Pin);                             // Read the level of the TCA9554PWR Pin
+void EXIO_Refresh_Inputs(void);                            // Re-read the input register (otherwise only refreshed on demand or after an INT edge)
 uint8_t Read_EXIOS(uint8_t REG);                            // Read the level of all pins of TCA9554PWR, the default read input level state, want to get the current IO output state, pass the parameter TCA9554_OUTPUT_REG, such as Read_EXIOS(TCA9554_OUTPUT_REG);
 /********************************************************** Set the EXIO output status **********************************************************/  
 void Set_EXIO(uint8_t Pin,uint8_t State);                   // Sets the level state of the Pin without affecting the other pins
+void Set_EXIO_Mask(uint8_t Mask,uint8_t Levels);          // Set every pin in Mask to the matching bit of Levels with a single write
 void Set_EXIOS(uint8_t PinState);                           // Set 7 pins to the PinState state such as :PinState=0x23, 0010 0011 state (the highest bit is not used)
 /********************************************************** Flip EXIO state **********************************************************/  
 void Set_Toggle(uint8_t Pin);                               // Flip the level of the TCA9554PWR Pin
@@ -1,43 +1,102 @@
 #include "Touch_GT911.h"
+#include "buzzer.h"
+#include "frame_governor.h"
 struct GT911_Touch touch_data = {0};
 
+// I2C bus transactions issued to the GT911 (a register read is two: address write + read)
+static volatile uint32_t touch_i2c_transactions = 0;
+
+// Latest state packed into one word so it can be published and read without a
+// lock: bits 0-11 x, 12-23 y, 24-27 number of points
+static uint32_t touch_latest = 0;
+static TaskHandle_t touch_task_handle = NULL;
+
 
 bool I2C_Read_Touch(uint8_t Driver_addr, uint16_t Reg_addr, uint8_t *Reg_data, uint32_t Length)
 {
-  Wire.beginTransmission(Driver_addr);
-  Wire.write((uint8_t)(Reg_addr >> 8)); 
-  Wire.write((uint8_t)Reg_addr);         
-  if ( Wire.endTransmission(true)){
+  touch_i2c_transactions += 2;
+  I2C_Txn txn = {Driver_addr, 2, Reg_addr, NULL, 0, Reg_data, (uint16_t)Length};
+  if (!I2C_Transfer(&txn, I2C_PRIO_TOUCH)) {
     printf("The I2C transmission fails. - I2C Read\r\n");
     return false;
   }
-  Wire.requestFrom(Driver_addr, Length);
-  for (int i = 0; i < Length; i++) {
-    *Reg_data++ = Wire.read();
-  }
   return true;
 }
 bool I2C_Write_Touch(uint8_t Driver_addr, uint16_t Reg_addr, const uint8_t *Reg_data, uint32_t Length)
 {
-  Wire.beginTransmission(Driver_addr);
-  Wire.write((uint8_t)(Reg_addr >> 8));
-  Wire.write((uint8_t)Reg_addr);        
-  for (int i = 0; i < Length; i++) {
-    Wire.write(*Reg_data++);
-  }
-  if ( Wire.endTransmission(true))
-  {
+  touch_i2c_transactions += 1;
+  I2C_Txn txn = {Driver_addr, 2, Reg_addr, Reg_data, (uint16_t)Length, NULL, 0};
+  if (!I2C_Transfer(&txn, I2C_PRIO_TOUCH)) {
     printf("The I2C transmission fails. - I2C Write\r\n");
     return false;
   }
   return true;
 }
 
+static void Touch_Publish(uint16_t x, uint16_t y, uint8_t points) {
+  uint32_t packed = ((uint32_t)(points & 0x0F) << 24) | ((uint32_t)(y & 0x0FFF) << 12) | (x & 0x0FFF);
+  __atomic_store_n(&touch_latest, packed, __ATOMIC_RELEASE);
+}
+
+bool Touch_Get_Latest(uint16_t *x, uint16_t *y, uint8_t *points) {
+  uint32_t packed = __atomic_load_n(&touch_latest, __ATOMIC_ACQUIRE);
+  if (x) *x = packed & 0x0FFF;
+  if (y) *y = (packed >> 12) & 0x0FFF;
+  if (points) *points = (packed >> 24) & 0x0F;
+  return ((packed >> 24) & 0x0F) > 0;
+}
+
+uint32_t Touch_Get_I2C_Count(void) {
+  return touch_i2c_transactions;
+}
+
+// Sleeps until the GT911 raises INT, then reads the report once. While a
+// finger is down the GT911 reports continuously, so a quiet period means the
+// release report was missed and one extra read settles the state.
+static void Touch_Task(void *arg) {
+  uint16_t x[GT911_LCD_TOUCH_MAX_POINTS];
+  uint16_t y[GT911_LCD_TOUCH_MAX_POINTS];
+  uint8_t cnt = 0;
+  unsigned long stats_start = millis();
+  uint32_t stats_base = touch_i2c_transactions;
+  for (;;) {
+    bool pressed = Touch_Get_Latest(NULL, NULL, NULL);
+    TickType_t wait = pdMS_TO_TICKS(pressed ? GT911_RELEASE_POLL_MS : GT911_STATS_PERIOD_MS);
+    bool irq = ulTaskNotifyTake(pdTRUE, wait) > 0;
+    if (irq || pressed) {
+      Touch_interrupts = false;
+      if (Touch_Read_Data()) {
+        Touch_Get_XY(x, y, NULL, &cnt, GT911_LCD_TOUCH_MAX_POINTS);
+        // A new press silences a sounding alarm
+        if (!pressed && cnt > 0 && buzzer_is_active()) buzzer_acknowledge();
+        // Bring the UI back to full rate before LVGL polls this touch
+        if (cnt > 0) frame_governor_kick();
+        Touch_Publish(x[0], y[0], cnt);
+      } else if (!irq) {
+        Touch_Publish(0, 0, 0);
+      }
+    }
+    unsigned long now = millis();
+    if (now - stats_start >= GT911_STATS_PERIOD_MS) {
+      uint32_t total = touch_i2c_transactions;
+      Serial.printf("[TOUCH] GT911 I2C transactions/s: %.1f\n",
+                    (float)(total - stats_base) * 1000.0f / (float)(now - stats_start));
+      stats_base = total;
+      stats_start = now;
+    }
+  }
+}
+
 uint8_t Touch_Init(void) {
 
   GT911_Touch_Reset();
   GT911_Read_cfg();
 
+#if GT911_USE_IRQ
+  if (touch_task_handle == NULL) {
+    xTaskCreatePinnedToCore(Touch_Task, "gt911", 3072, NULL, 4, &touch_task_handle, 1);
+  }
+#endif
   attachInterrupt(GT911_INT_PIN, Touch_GT911_ISR, interrupt); 
 
   return true;
@@ -74,9 +133,10 @@ uint8_t Touch_Read_Data(void) {
   uint8_t clear = 0;
   uint8_t Over = 0xAB;
   size_t i = 0,num=0;
-  I2C_Read_Touch(GT911_ADDR, ESP_LCD_TOUCH_GT911_READ_XY_REG, buf, 1);
+  if (!I2C_Read_Touch(GT911_ADDR, ESP_LCD_TOUCH_GT911_READ_XY_REG, buf, 1)) return false;
   if ((buf[0] & 0x80) == 0x00) {                                              
     I2C_Write_Touch(GT911_ADDR, ESP_LCD_TOUCH_GT911_READ_XY_REG, &clear, 1);  // No touch data
+    return false;
   } else {
     /* Count of touched points */
     touch_cnt = buf[0] & 0x0F;
@@ -158,4 +218,9 @@ void example_touchpad_read(void){
 uint8_t Touch_interrupts;
 void IRAM_ATTR Touch_GT911_ISR(void) {
   Touch_interrupts = true;
+  if (touch_task_handle) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(touch_task_handle, &woken);
+    if (woken) portYIELD_FROM_ISR();
+  }
 }
@@ -7,6 +7,16 @@
 #define GT911_ADDR          0x5D
 #define GT911_INT_PIN       16
 
+// IRQ-driven touch: the GT911 INT line wakes a small task that reads the point
+// buffer once per report and publishes it to a lock-free slot, so the LVGL
+// read callback never touches the I2C bus. Set to 0 to poll from the LVGL
+// read callback instead (boards without the INT line wired).
+#ifndef GT911_USE_IRQ
+#define GT911_USE_IRQ       1
+#endif
+#define GT911_RELEASE_POLL_MS   100     // while pressed, re-read if no report arrives (missed release)
+#define GT911_STATS_PERIOD_MS   60000   // how often the task logs I2C transactions/s
+
 
 #define GT911_LCD_TOUCH_MAX_POINTS             (5)      
 /* GT911 registers */
@@ -41,7 +51,12 @@ uint8_t Touch_Init();
 void Touch_Loop(void);
 uint8_t GT911_Touch_Reset(void);
 void GT911_Read_cfg(void);
-uint8_t Touch_Read_Data(void);
+uint8_t Touch_Read_Data(void);          // true when a fresh report was consumed
 uint8_t Touch_Get_XY(uint16_t *x, uint16_t *y, uint16_t *strength, uint8_t *point_num, uint8_t max_point_num);
 void example_touchpad_read(void);
 void IRAM_ATTR Touch_GT911_ISR(void);
+
+// Latest touch state published by the touch task (lock-free, any context)
+bool Touch_Get_Latest(uint16_t *x, uint16_t *y, uint8_t *points);
+// Total GT911 I2C bus transactions since boot
+uint32_t Touch_Get_I2C_Count(void);
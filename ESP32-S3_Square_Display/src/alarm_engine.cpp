@@ -0,0 +1,182 @@
+#include "alarm_engine.h"
+#include "alarm_zones.h"
+#include <Arduino.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "screen_config_c_api.h"
+#include "signalk_config.h"
+#include "ui.h"
+#include "ui_helpers.h"
+#include "ui_Settings.h"
+
+#define ALARM_SLOTS (NUM_SCREENS * 2)
+
+typedef struct {
+    uint8_t zone;                       // committed zone, 0 until first evaluation
+    uint8_t candidate;
+    uint32_t candidate_since;
+} AlarmSlot;
+
+static AlarmTable tables[ALARM_SLOTS];
+static AlarmSlot slots[ALARM_SLOTS];
+static bool tables_built = false;
+
+// Written by the ingest task, drained by the UI loop
+static float slot_values[ALARM_SLOTS];
+static uint32_t dirty_mask = 0;
+static portMUX_TYPE feed_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t debounce_mask = 0;      // slots with a candidate waiting out the debounce
+static uint32_t buzzing_mask = 0;       // slots whose committed zone sounds the buzzer
+static uint32_t entered_mask = 0;       // slots that entered a buzzer zone since the last service
+extern unsigned long last_buzzer_time;
+
+static void alarm_compile(int slot) {
+    const ScreenConfig& cfg = screen_configs[slot / 2];
+    int g = slot % 2;
+    alarm_zones_compile(&tables[slot], cfg.min[g], cfg.max[g], cfg.buzzer[g]);
+}
+
+static uint8_t alarm_classify(int slot, float v) {
+    return alarm_zones_classify(&tables[slot], slots[slot].zone, v);
+}
+
+static lv_obj_t* alarm_icon(int slot) {
+    bool top = (slot % 2) == 0;
+    switch (slot / 2) {
+        case 0: return top ? ui_TopIcon1 : ui_BottomIcon1;
+        case 1: return top ? ui_TopIcon2 : ui_BottomIcon2;
+        case 2: return top ? ui_TopIcon3 : ui_BottomIcon3;
+        case 3: return top ? ui_TopIcon4 : ui_BottomIcon4;
+        case 4: return top ? ui_TopIcon5 : ui_BottomIcon5;
+        default: return NULL;
+    }
+}
+
+static uint32_t alarm_screen_mask(int screen_idx) {
+    return 3u << (screen_idx * 2);
+}
+
+static void alarm_commit(int slot, uint8_t zone, float value) {
+    uint8_t prev = slots[slot].zone;
+    slots[slot].zone = zone;
+    if (prev != 0) {
+        Serial.printf("[ALARM] screen=%d gauge=%d zone %d -> %d val=%.2f\n",
+                      slot / 2 + 1, slot % 2, prev, zone, value);
+    }
+
+    uint8_t type = screen_configs[slot / 2].display_type;
+    lv_obj_t* icon = alarm_icon(slot);
+    if (icon && (type == DISPLAY_TYPE_GAUGE || type == DISPLAY_TYPE_GAUGE_NUMBER)) {
+        lv_obj_clear_flag(icon, LV_OBJ_FLAG_HIDDEN);
+        _ui_apply_icon_style(icon, slot / 2, slot % 2);
+    }
+
+    bool buzz = (tables[slot].buzzer_zones & (1u << zone)) != 0;
+    if (buzz) {
+        // Entering a buzzer zone sounds at once rather than waiting out the cooldown
+        if (!(buzzing_mask & (1u << slot))) entered_mask |= (1u << slot);
+        buzzing_mask |= (1u << slot);
+    } else {
+        buzzing_mask &= ~(1u << slot);
+    }
+}
+
+void alarm_engine_rebuild(void) {
+    // A zone that is still configured stays committed, so saving unrelated
+    // settings neither re-logs it nor counts as entering it again (no beep).
+    // The buzzer keeps sounding for it if its zone still has the buzzer on.
+    buzzing_mask = 0;
+    for (int s = 0; s < ALARM_SLOTS; ++s) {
+        alarm_compile(s);
+        if (!alarm_zones_exists(&tables[s], slots[s].zone)) slots[s].zone = 0;
+        slots[s].candidate = 0;
+        if (slots[s].zone && (tables[s].buzzer_zones & (1u << slots[s].zone))) buzzing_mask |= (1u << s);
+    }
+    tables_built = true;
+    debounce_mask = 0;
+    entered_mask = 0;
+    // get_sensor_value() takes the sensor mutex, so read before the spinlock
+    float values[ALARM_SLOTS];
+    for (int s = 0; s < ALARM_SLOTS; ++s) values[s] = get_sensor_value(s);
+    portENTER_CRITICAL(&feed_mux);
+    memcpy(slot_values, values, sizeof(slot_values));
+    dirty_mask = (1u << ALARM_SLOTS) - 1;
+    portEXIT_CRITICAL(&feed_mux);
+}
+
+void alarm_engine_feed(int slot, float value) {
+    if (slot < 0 || slot >= ALARM_SLOTS) return;
+    portENTER_CRITICAL(&feed_mux);
+    slot_values[slot] = value;
+    dirty_mask |= (1u << slot);
+    portEXIT_CRITICAL(&feed_mux);
+}
+
+void alarm_engine_service(int current_screen) {
+    if (!tables_built) alarm_engine_rebuild();
+
+    uint32_t dirty;
+    float values[ALARM_SLOTS];
+    portENTER_CRITICAL(&feed_mux);
+    dirty = dirty_mask;
+    dirty_mask = 0;
+    if (dirty | debounce_mask) memcpy(values, slot_values, sizeof(values));
+    portEXIT_CRITICAL(&feed_mux);
+
+    uint32_t work = dirty | debounce_mask;
+    unsigned long now = millis();
+    for (int s = 0; work && s < ALARM_SLOTS; ++s) {
+        uint32_t bit = 1u << s;
+        if (!(work & bit)) continue;
+        work &= ~bit;
+        uint8_t z = alarm_classify(s, values[s]);
+        AlarmSlot& st = slots[s];
+        if (st.zone == 0) {
+            alarm_commit(s, z, values[s]);              // first classification is immediate
+        } else if (z == st.zone) {
+            debounce_mask &= ~bit;
+        } else if (!(debounce_mask & bit) || z != st.candidate) {
+            st.candidate = z;
+            st.candidate_since = now;
+            debounce_mask |= bit;
+        } else if (now - st.candidate_since >= ALARM_DEBOUNCE_MS) {
+            debounce_mask &= ~bit;
+            alarm_commit(s, z, values[s]);
+        }
+    }
+
+    // Buzzer schedule: global mode watches every slot, per-screen mode only the
+    // visible screen. Nothing to do while no committed zone sounds the buzzer.
+    uint32_t entered = entered_mask;
+    entered_mask = 0;
+    if (buzzer_mode == 0 || buzzing_mask == 0) return;
+    int screen_idx = current_screen - 1;
+    if (screen_idx < 0) screen_idx = 0;
+    uint32_t scope = (buzzer_mode == 1) ? buzzing_mask : (buzzing_mask & alarm_screen_mask(screen_idx));
+    if (scope == 0) return;
+
+    unsigned long cooldown = (unsigned long)buzzer_cooldown_sec * 1000UL;
+    if (cooldown < ALARM_MIN_REPEAT_MS) cooldown = ALARM_MIN_REPEAT_MS;
+    if (first_run_buzzer || (entered & scope) || now - last_buzzer_time > cooldown) {
+        int s = __builtin_ctz(scope);
+        printf("[ALERT] screen=%d gauge=%d zone=%d mode=%d first_run=%d\n",
+               s / 2, s % 2, slots[s].zone, buzzer_mode, (int)first_run_buzzer);
+        trigger_buzzer_alert();
+        last_buzzer_time = now;
+        first_run_buzzer = false;
+    }
+}
+
+int alarm_engine_committed_zone(int screen, int gauge) {
+    if (screen < 0 || screen >= NUM_SCREENS || gauge < 0 || gauge > 1) return 0;
+    return slots[screen * 2 + gauge].zone;
+}
+
+int alarm_engine_zone(int screen, int gauge) {
+    if (screen < 0 || screen >= NUM_SCREENS || gauge < 0 || gauge > 1) return 1;
+    if (!tables_built) alarm_engine_rebuild();
+    int slot = screen * 2 + gauge;
+    if (slots[slot].zone != 0) return slots[slot].zone;
+    return alarm_classify(slot, get_sensor_value(slot));
+}
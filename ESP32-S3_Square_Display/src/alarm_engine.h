@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Central alarm engine for gauge zones.
+//
+// Each gauge's four configured zones are compiled into a sorted table of
+// disjoint segments (alarm_zones.h; the narrowest zone wins where zones
+// overlap), so a value is classified with one binary search. Values are fed
+// from the Signal K ingest path; only slots whose value changed are
+// re-evaluated. A zone change must get past a small hysteresis band at the
+// edge it crosses and persist for the debounce time before it is committed.
+// Committed changes restyle the icon, drive the buzzer and are logged.
+
+#define ALARM_DEBOUNCE_MS       1000
+#define ALARM_MIN_REPEAT_MS     500     // floor for the repeat interval when cooldown is 0
+
+// Recompile the zone tables from screen_configs; call after config changes.
+// Committed zones that are still configured are kept.
+void alarm_engine_rebuild(void);
+
+// New value for a sensor slot (screen * 2 + gauge); safe from any task
+void alarm_engine_feed(int slot, float value);
+
+// Commit debounced zone changes and run the buzzer schedule. Call from the
+// UI loop; returns immediately when nothing changed and no alarm is active.
+void alarm_engine_service(int current_screen);
+
+// Committed zone (1..4) for a gauge, evaluating immediately if it has not been
+// classified yet. Used by the icon styling so every caller agrees.
+int alarm_engine_zone(int screen, int gauge);
+
+// Committed zone without evaluating (0 = not classified yet). Read-only, so
+// it can be polled from tasks other than the UI loop.
+int alarm_engine_committed_zone(int screen, int gauge);
+
+#ifdef __cplusplus
+}
+#endif
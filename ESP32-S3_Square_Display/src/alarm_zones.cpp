@@ -0,0 +1,112 @@
+#include "alarm_zones.h"
+#include <math.h>
+#include <string.h>
+
+void alarm_zones_compile(AlarmTable *t, const float *min, const float *max, const int *buzzer) {
+    memset(t, 0, sizeof(*t));
+    float points[ALARM_MAX_SEGMENTS + 1];
+    int npoints = 0;
+    float span_lo = INFINITY, span_hi = -INFINITY;
+    for (int z = 1; z <= ALARM_ZONES; ++z) {
+        float mn = min[z];
+        float mx = max[z];
+        t->zone_lo[z] = mn;
+        t->zone_hi[z] = mx;
+        if (buzzer[z]) t->buzzer_zones |= (1u << z);
+        if (mn == mx) continue;                         // unconfigured
+        if (t->nan_zone == 0) t->nan_zone = z;
+        points[npoints++] = mn;
+        points[npoints++] = mx;
+        if (mn < span_lo) span_lo = mn;
+        if (mx > span_hi) span_hi = mx;
+    }
+    if (t->nan_zone == 0) t->nan_zone = 1;
+    if (npoints == 0) return;
+    t->hysteresis = (span_hi - span_lo) * ALARM_HYSTERESIS_FRAC;
+
+    // Sorted unique breakpoints; each gap between two becomes a segment owned
+    // by the narrowest zone covering it
+    for (int i = 1; i < npoints; ++i) {
+        float v = points[i];
+        int j = i - 1;
+        while (j >= 0 && points[j] > v) { points[j + 1] = points[j]; --j; }
+        points[j + 1] = v;
+    }
+    int unique = 0;
+    for (int i = 0; i < npoints; ++i) {
+        if (unique == 0 || points[i] != points[unique - 1]) points[unique++] = points[i];
+    }
+    for (int i = 0; i + 1 < unique; ++i) {
+        float lo = points[i], hi = points[i + 1];
+        float mid = lo + (hi - lo) * 0.5f;
+        uint8_t best = 0;
+        float best_range = INFINITY;
+        for (int z = 1; z <= ALARM_ZONES; ++z) {
+            float mn = t->zone_lo[z], mx = t->zone_hi[z];
+            if (mn == mx || mid < mn || mid > mx) continue;
+            if (mx - mn < best_range) { best_range = mx - mn; best = z; }
+        }
+        if (best == 0) continue;                        // gap between zones
+        if (t->seg_count > 0 && t->seg[t->seg_count - 1].zone == best && t->seg[t->seg_count - 1].hi == lo) {
+            t->seg[t->seg_count - 1].hi = hi;           // merge with the previous segment
+        } else {
+            t->seg[t->seg_count++] = {lo, hi, best};
+        }
+    }
+}
+
+// Index of the last segment starting at or below `v` (-1 when none)
+static int segment_at(const AlarmTable *t, float v) {
+    int lo = 0, hi = (int)t->seg_count - 1, found = -1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (t->seg[mid].lo <= v) { found = mid; lo = mid + 1; }
+        else hi = mid - 1;
+    }
+    return found;
+}
+
+uint8_t alarm_zones_lookup(const AlarmTable *t, float v) {
+    int found = segment_at(t, v);
+    if (found >= 0 && v <= t->seg[found].hi) return t->seg[found].zone;
+    // Closed upper edge of the previous segment
+    if (found > 0 && v == t->seg[found - 1].hi) return t->seg[found - 1].zone;
+    return 0;
+}
+
+static uint8_t zone_or_default(const AlarmTable *t, float v) {
+    uint8_t z = alarm_zones_lookup(t, v);
+    return z ? z : 1;
+}
+
+uint8_t alarm_zones_classify(const AlarmTable *t, uint8_t cur, float v) {
+    if (isnan(v)) return t->nan_zone;
+    uint8_t z = zone_or_default(t, v);
+    if (cur == 0 || z == cur || t->hysteresis <= 0.0f) return z;
+    // Width of the segment (or gap) holding `v`; the band is capped at a
+    // quarter of it so a zone narrower than the band can still be entered
+    int i = segment_at(t, v);
+    float lo, hi;
+    if (i >= 0 && v <= t->seg[i].hi) {
+        lo = t->seg[i].lo;
+        hi = t->seg[i].hi;
+    } else {
+        lo = i >= 0 ? t->seg[i].hi : -INFINITY;
+        hi = i + 1 < (int)t->seg_count ? t->seg[i + 1].lo : INFINITY;
+    }
+    float h = fminf(t->hysteresis, (hi - lo) * 0.25f);
+    // Stay in the committed zone only while it is within the band, i.e. the
+    // value has just crossed the edge between the two zones. Deeper inside
+    // `z` (e.g. a narrow alarm zone nested in a wide one) the zone changes.
+    // Values outside every zone only count as zone 1 when zone 1 is the
+    // implicit fallback rather than a configured range.
+    uint8_t outside = t->zone_lo[1] == t->zone_hi[1] ? 1 : 0;
+    uint8_t below = alarm_zones_lookup(t, v - h), above = alarm_zones_lookup(t, v + h);
+    if ((below ? below : outside) == cur || (above ? above : outside) == cur) return cur;
+    return z;
+}
+
+bool alarm_zones_exists(const AlarmTable *t, uint8_t z) {
+    if (z < 1 || z > ALARM_ZONES) return false;
+    return z == 1 || t->zone_lo[z] != t->zone_hi[z];
+}
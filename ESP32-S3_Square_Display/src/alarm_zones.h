@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Zone tables for the alarm engine, kept free of Arduino/LVGL so they can be
+// tested on the host (test/test_alarm_zones).
+//
+// A gauge's four zones (1..4) are compiled into a sorted table of disjoint
+// segments; where zones overlap the narrowest one owns the overlap, so a
+// narrow alarm band inside a wider zone is found by one binary search.
+
+#define ALARM_ZONES             4
+#define ALARM_MAX_SEGMENTS      (ALARM_ZONES * 2)
+#define ALARM_HYSTERESIS_FRAC   0.01f   // of the span covered by the configured zones
+
+typedef struct {
+    float lo;
+    float hi;
+    uint8_t zone;
+} AlarmSegment;
+
+typedef struct {
+    AlarmSegment seg[ALARM_MAX_SEGMENTS];
+    uint8_t seg_count;
+    uint8_t nan_zone;                   // zone shown while the value is unknown
+    float zone_lo[ALARM_ZONES + 1];
+    float zone_hi[ALARM_ZONES + 1];
+    float hysteresis;
+    uint8_t buzzer_zones;               // bit z set when zone z sounds the buzzer
+} AlarmTable;
+
+// Build the table from one gauge's zone settings (index 1..4 used, as in
+// ScreenConfig.min/max/buzzer; a zone with min == max is unconfigured)
+void alarm_zones_compile(AlarmTable *t, const float *min, const float *max, const int *buzzer);
+
+// Zone containing `v` without hysteresis: 0 when no configured zone matches
+uint8_t alarm_zones_lookup(const AlarmTable *t, float v);
+
+// Zone for `v` given the committed zone `cur` (0 = none yet). Values outside
+// every zone count as zone 1. A change is held back only while `v` is within
+// the hysteresis band of the edge where the committed zone meets the new one.
+uint8_t alarm_zones_classify(const AlarmTable *t, uint8_t cur, float v);
+
+// True when zone `z` is configured (zone 1 always is: it is the fallback)
+bool alarm_zones_exists(const AlarmTable *t, uint8_t z);
+
+#ifdef __cplusplus
+}
+#endif
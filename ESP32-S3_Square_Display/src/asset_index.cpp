@@ -0,0 +1,396 @@
+#include "asset_index.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "SD_Card.h"
+#include "rgb565_decoder.h"
+#include "web_task.h"
+#include <lvgl.h>
+
+#define ASSET_INDEX_FILE        "/sdcard/config/assets.idx"
+#define ASSET_INDEX_FILE_TMP    "/sdcard/config/assets.tmp"
+#define ASSET_INDEX_MAGIC       0x31584941UL    // "AIX1"
+#define ASSET_READ_CHUNK        4096
+
+typedef struct {
+    uint32_t magic;
+    uint16_t count;
+    uint16_t record_size;
+} AssetIndexHeader;
+
+static AssetEntry *asset_entries = NULL;   // sorted by name, PSRAM
+static int asset_count = 0;
+static int asset_capacity = 0;
+static int asset_dropped = 0;
+static SemaphoreHandle_t asset_mutex = NULL;
+
+AssetType asset_type_from_name(const char *name) {
+    const char *dot = strrchr(name, '.');
+    if (!dot) return ASSET_TYPE_OTHER;
+    if (!strcasecmp(dot, ".png")) return ASSET_TYPE_PNG;
+    if (!strcasecmp(dot, ".jpg") || !strcasecmp(dot, ".jpeg")) return ASSET_TYPE_JPEG;
+    if (!strcasecmp(dot, ".bmp")) return ASSET_TYPE_BMP;
+    if (!strcasecmp(dot, ".gif")) return ASSET_TYPE_GIF;
+    if (!strcasecmp(dot, ".bin")) return ASSET_TYPE_RGB565;
+    return ASSET_TYPE_OTHER;
+}
+
+const char *asset_type_name(AssetType type) {
+    static const char *const names[ASSET_TYPE_COUNT] = {"other", "png", "jpeg", "bmp", "gif", "rgb565", "rgb565a"};
+    return type < ASSET_TYPE_COUNT ? names[type] : "other";
+}
+
+static uint16_t be16(const uint8_t *p) { return (uint16_t)(p[0] << 8 | p[1]); }
+static uint16_t le16(const uint8_t *p) { return (uint16_t)(p[1] << 8 | p[0]); }
+static uint32_t be32(const uint8_t *p) { return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]; }
+static int32_t le32(const uint8_t *p) { return (int32_t)((uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0]); }
+
+// Walk the JPEG markers up to the first start-of-frame
+static bool jpeg_dimensions(FILE *f, uint16_t *w, uint16_t *h) {
+    uint8_t m[9];
+    long pos = 2;
+    for (int guard = 0; guard < 64; guard++) {
+        if (fseek(f, pos, SEEK_SET) != 0 || fread(m, 1, 4, f) != 4 || m[0] != 0xFF) return false;
+        uint8_t marker = m[1];
+        uint16_t len = be16(&m[2]);
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (fread(m, 1, 5, f) != 5) return false;
+            *h = be16(&m[1]);
+            *w = be16(&m[3]);
+            return true;
+        }
+        if (len < 2) return false;
+        pos += 2 + len;
+    }
+    return false;
+}
+
+static void probe_dimensions(const char *path, AssetEntry *e) {
+    e->width = e->height = 0;
+    if (e->type == ASSET_TYPE_OTHER) return;
+    FILE *f = fopen(path, "rb");
+    if (!f) return;
+    uint8_t hdr[26];
+    size_t n = fread(hdr, 1, sizeof(hdr), f);
+    switch (e->type) {
+        case ASSET_TYPE_RGB565:
+            if (n >= sizeof(rgb565_file_header_t) && !memcmp(hdr, RGB565_FILE_MAGIC, 4)) {
+                const rgb565_file_header_t *h = (const rgb565_file_header_t *)hdr;
+                e->width = h->w;
+                e->height = h->h;
+                if (h->cf == RGB565_CF_ALPHA) e->type = ASSET_TYPE_RGB565A;
+            } else {
+                // Same rule as the RGB565 decoder: square, 2 bytes per pixel
+                uint32_t side = 1;
+                while (side * side < e->size / 2) side++;
+                e->width = e->height = (uint16_t)side;
+            }
+            break;
+        case ASSET_TYPE_PNG:
+            if (n >= 24 && !memcmp(&hdr[12], "IHDR", 4)) {
+                e->width = (uint16_t)be32(&hdr[16]);
+                e->height = (uint16_t)be32(&hdr[20]);
+            }
+            break;
+        case ASSET_TYPE_JPEG:
+            if (n >= 2 && hdr[0] == 0xFF && hdr[1] == 0xD8) jpeg_dimensions(f, &e->width, &e->height);
+            break;
+        case ASSET_TYPE_BMP:
+            if (n >= 26 && hdr[0] == 'B' && hdr[1] == 'M') {
+                e->width = (uint16_t)abs(le32(&hdr[18]));
+                e->height = (uint16_t)abs(le32(&hdr[22]));   // negative = top-down rows
+            }
+            break;
+        case ASSET_TYPE_GIF:
+            if (n >= 10 && !memcmp(hdr, "GIF", 3)) {
+                e->width = le16(&hdr[6]);
+                e->height = le16(&hdr[8]);
+            }
+            break;
+        default:
+            break;
+    }
+    fclose(f);
+}
+
+static bool file_crc32(const char *path, uint32_t *crc, uint32_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t *buf = (uint8_t *)heap_caps_malloc(ASSET_READ_CHUNK, MALLOC_CAP_SPIRAM);
+    if (!buf) { fclose(f); return false; }
+    uint32_t c = 0, total = 0;
+    size_t n;
+    while ((n = fread(buf, 1, ASSET_READ_CHUNK, f)) > 0) {
+        c = esp_rom_crc32_le(c, buf, n);
+        total += n;
+    }
+    heap_caps_free(buf);
+    fclose(f);
+    *crc = c;
+    *size = total;
+    return true;
+}
+
+// Make room for `need` entries in a PSRAM table, doubling its capacity
+static bool grow_table(AssetEntry **table, int *capacity, int need) {
+    if (need <= *capacity) return true;
+    if (need > ASSET_INDEX_LIMIT) return false;
+    int cap = *capacity ? *capacity : ASSET_INDEX_INITIAL;
+    while (cap < need) cap *= 2;
+    if (cap > ASSET_INDEX_LIMIT) cap = ASSET_INDEX_LIMIT;
+    AssetEntry *t = (AssetEntry *)heap_caps_realloc(*table, cap * sizeof(AssetEntry), MALLOC_CAP_SPIRAM);
+    if (!t) return false;
+    *table = t;
+    *capacity = cap;
+    return true;
+}
+
+// ---- Table (asset_mutex held) ----------------------------------------------
+
+static int find_locked(const char *name, bool *found) {
+    int lo = 0, hi = asset_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        int c = strcmp(asset_entries[mid].name, name);
+        if (c == 0) { *found = true; return mid; }
+        if (c < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    *found = false;
+    return lo;
+}
+
+static bool insert_locked(const AssetEntry *e) {
+    bool found;
+    int at = find_locked(e->name, &found);
+    if (!found) {
+        if (!grow_table(&asset_entries, &asset_capacity, asset_count + 1)) {
+            asset_dropped++;
+            return false;
+        }
+        memmove(&asset_entries[at + 1], &asset_entries[at], (asset_count - at) * sizeof(AssetEntry));
+        asset_count++;
+    }
+    asset_entries[at] = *e;
+    return true;
+}
+
+static void save_locked(void) {
+    if (!SD_IsMounted()) return;
+    mkdir("/sdcard/config", 0755);
+    FILE *f = fopen(ASSET_INDEX_FILE_TMP, "wb");
+    if (!f) {
+        Serial.println("[ASSETS] Failed to write " ASSET_INDEX_FILE_TMP);
+        return;
+    }
+    AssetIndexHeader hdr = {ASSET_INDEX_MAGIC, (uint16_t)asset_count, (uint16_t)sizeof(AssetEntry)};
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    if (asset_count) ok = ok && fwrite(asset_entries, sizeof(AssetEntry), asset_count, f) == (size_t)asset_count;
+    fclose(f);
+    if (!ok) {
+        remove(ASSET_INDEX_FILE_TMP);
+        return;
+    }
+    remove(ASSET_INDEX_FILE);
+    rename(ASSET_INDEX_FILE_TMP, ASSET_INDEX_FILE);
+}
+
+static bool load_locked(void) {
+    FILE *f = fopen(ASSET_INDEX_FILE, "rb");
+    if (!f) return false;
+    AssetIndexHeader hdr;
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 && hdr.magic == ASSET_INDEX_MAGIC &&
+              hdr.record_size == sizeof(AssetEntry) && grow_table(&asset_entries, &asset_capacity, hdr.count) &&
+              fread(asset_entries, sizeof(AssetEntry), hdr.count, f) == hdr.count;
+    fclose(f);
+    if (!ok) {
+        Serial.println("[ASSETS] Ignoring incompatible " ASSET_INDEX_FILE);
+        asset_count = 0;
+        return false;
+    }
+    asset_count = hdr.count;
+    for (int i = 0; i < asset_count; i++) asset_entries[i].name[ASSET_NAME_LEN - 1] = '\0';
+    return true;
+}
+
+// ---- Replacing files ---------------------------------------------------------
+
+// "<dir>/.<name>.bak" for "<dir>/<name>"
+static void backup_path(const char *dest, char *out, size_t len) {
+    const char *slash = strrchr(dest, '/');
+    int dir_len = slash ? (int)(slash - dest) : 0;
+    snprintf(out, len, "%.*s/.%s.bak", dir_len, dest, slash ? slash + 1 : dest);
+}
+
+bool asset_replace_file(const char *tmp, const char *dest) {
+    char bak[ASSET_NAME_LEN + sizeof(ASSET_DIR) + 8];
+    backup_path(dest, bak, sizeof(bak));
+    struct stat st;
+    bool had_old = stat(dest, &st) == 0;
+    if (had_old) {
+        remove(bak);
+        if (rename(dest, bak) != 0) return false;
+    }
+    if (rename(tmp, dest) != 0) {
+        if (had_old) rename(bak, dest);
+        return false;
+    }
+    if (had_old) remove(bak);
+    return true;
+}
+
+// Finish replacements cut short by a reset: a backup whose file is missing
+// is the last good copy, otherwise the new file made it and the backup goes
+static void recover_backups(void) {
+    DIR *d = opendir(ASSET_DIR);
+    if (!d) return;
+    char bak[ASSET_NAME_LEN + sizeof(ASSET_DIR) + 8];
+    char dest[ASSET_NAME_LEN + sizeof(ASSET_DIR) + 1];
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (entry->d_name[0] != '.' || len < 6 || len - 5 >= ASSET_NAME_LEN) continue;
+        if (strcmp(entry->d_name + len - 4, ".bak") != 0) continue;
+        snprintf(bak, sizeof(bak), ASSET_DIR "/%s", entry->d_name);
+        snprintf(dest, sizeof(dest), ASSET_DIR "/%.*s", (int)(len - 5), entry->d_name + 1);
+        struct stat st;
+        if (stat(dest, &st) == 0) {
+            remove(bak);
+        } else if (rename(bak, dest) == 0) {
+            Serial.printf("[ASSETS] Restored %s from an interrupted replace\n", dest);
+        }
+    }
+    closedir(d);
+}
+
+// ---- Public API --------------------------------------------------------------
+
+void asset_index_init(void) {
+    if (asset_entries) return;
+    if (!grow_table(&asset_entries, &asset_capacity, ASSET_INDEX_INITIAL)) {
+        Serial.println("[ASSETS] Index allocation failed");
+        return;
+    }
+    asset_mutex = xSemaphoreCreateMutex();
+    if (!SD_IsMounted()) return;
+    recover_backups();
+    xSemaphoreTake(asset_mutex, portMAX_DELAY);
+    bool loaded = load_locked();
+    xSemaphoreGive(asset_mutex);
+    if (loaded) Serial.printf("[ASSETS] Index loaded: %d file(s)\n", asset_count);
+    else asset_index_rescan();
+}
+
+int asset_index_rescan(void) {
+    if (!asset_entries || !SD_IsMounted()) return 0;
+    uint32_t t0 = millis();
+    mkdir(ASSET_DIR, 0755);
+    DIR *d = opendir(ASSET_DIR);
+    if (!d) return 0;
+    // Build into a scratch table so readers keep the old one during the scan
+    AssetEntry *scan = NULL;
+    int scan_capacity = 0;
+    int n = 0, dropped = 0;
+    struct dirent *entry;
+    char path[ASSET_NAME_LEN + sizeof(ASSET_DIR) + 1];
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_type == DT_DIR || entry->d_name[0] == '.') continue;
+        if (strlen(entry->d_name) >= ASSET_NAME_LEN) continue;
+        if (!grow_table(&scan, &scan_capacity, n + 1)) {
+            dropped++;
+            continue;
+        }
+        AssetEntry *e = &scan[n];
+        memset(e, 0, sizeof(*e));
+        strcpy(e->name, entry->d_name);
+        snprintf(path, sizeof(path), ASSET_DIR "/%s", e->name);
+        if (!file_crc32(path, &e->crc32, &e->size)) continue;
+        e->type = asset_type_from_name(e->name);
+        probe_dimensions(path, e);
+        n++;
+        // Give LVGL a turn at the card between files
+        vTaskDelay(1);
+    }
+    closedir(d);
+
+    xSemaphoreTake(asset_mutex, portMAX_DELAY);
+    asset_count = 0;
+    asset_dropped = dropped;
+    for (int i = 0; i < n; i++) insert_locked(&scan[i]);
+    save_locked();
+    int count = asset_count;
+    dropped = asset_dropped;
+    xSemaphoreGive(asset_mutex);
+    if (scan) heap_caps_free(scan);
+    Serial.printf("[ASSETS] Indexed %d file(s) in %lu ms\n", count, (unsigned long)(millis() - t0));
+    if (dropped) Serial.printf("[ASSETS] Index full: %d file(s) not listed\n", dropped);
+    return count;
+}
+
+AssetEntry *asset_index_snapshot(int *count) {
+    *count = 0;
+    if (!asset_entries) return NULL;
+    xSemaphoreTake(asset_mutex, portMAX_DELAY);
+    AssetEntry *out = NULL;
+    if (asset_count) out = (AssetEntry *)heap_caps_malloc(asset_count * sizeof(AssetEntry), MALLOC_CAP_SPIRAM);
+    if (out) {
+        memcpy(out, asset_entries, asset_count * sizeof(AssetEntry));
+        *count = asset_count;
+    }
+    xSemaphoreGive(asset_mutex);
+    return out;
+}
+
+int asset_index_dropped(void) {
+    return asset_dropped;
+}
+
+// LVGL may still hold the old pixels of a replaced or deleted file in its
+// image cache; drop them between frames
+static void invalidate_image_cache(void) {
+    ui_lock();
+    lv_img_cache_invalidate_src(NULL);
+    ui_unlock();
+}
+
+bool asset_index_put(const char *name, uint32_t size, uint32_t crc32) {
+    if (!asset_entries || !name[0] || strlen(name) >= ASSET_NAME_LEN) return false;
+    AssetEntry e;
+    memset(&e, 0, sizeof(e));
+    strcpy(e.name, name);
+    e.size = size;
+    e.crc32 = crc32;
+    e.type = asset_type_from_name(name);
+    char path[ASSET_NAME_LEN + sizeof(ASSET_DIR) + 1];
+    snprintf(path, sizeof(path), ASSET_DIR "/%s", name);
+    probe_dimensions(path, &e);
+
+    xSemaphoreTake(asset_mutex, portMAX_DELAY);
+    bool replaced;
+    find_locked(name, &replaced);
+    bool ok = insert_locked(&e);
+    if (ok) save_locked();
+    xSemaphoreGive(asset_mutex);
+    if (!ok) Serial.printf("[ASSETS] Index full, %s not listed\n", name);
+    if (replaced) invalidate_image_cache();
+    return ok;
+}
+
+void asset_index_remove(const char *name) {
+    if (!asset_entries) return;
+    xSemaphoreTake(asset_mutex, portMAX_DELAY);
+    bool found;
+    int at = find_locked(name, &found);
+    if (found) {
+        memmove(&asset_entries[at], &asset_entries[at + 1], (asset_count - at - 1) * sizeof(AssetEntry));
+        asset_count--;
+        save_locked();
+    }
+    xSemaphoreGive(asset_mutex);
+    if (found) invalidate_image_cache();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// In-memory index of the files in /assets on the SD card.
+//
+// Pages and the JSON API list assets from here instead of walking the
+// directory on every request, which is slow with many files and competes
+// with LVGL reading backgrounds from the same card. The index is saved to
+// /config/assets.idx and loaded at boot; the card is only scanned when there
+// is no saved index or a rescan is requested (files copied onto the card
+// from a computer are not seen until then). Uploads and deletes from the
+// web UI update single entries.
+//
+// Dimensions come from the file header (PNG IHDR, JPEG SOFn, BMP, GIF, the
+// converter's .bin header); headerless .bin backgrounds are square, so their
+// side follows from the size.
+//
+// The table lives in PSRAM and doubles as files are added, up to
+// ASSET_INDEX_LIMIT entries. Files that still do not fit are counted and
+// reported on the assets page instead of silently missing.
+
+#define ASSET_INDEX_INITIAL 64
+#define ASSET_INDEX_LIMIT   4096
+#define ASSET_NAME_LEN      64
+#define ASSET_DIR           "/sdcard/assets"
+
+typedef enum {
+    ASSET_TYPE_OTHER = 0,
+    ASSET_TYPE_PNG,
+    ASSET_TYPE_JPEG,
+    ASSET_TYPE_BMP,
+    ASSET_TYPE_GIF,
+    ASSET_TYPE_RGB565,      // .bin, opaque (backgrounds)
+    ASSET_TYPE_RGB565A,     // .bin with alpha (icons from the converter)
+    ASSET_TYPE_COUNT
+} AssetType;
+
+typedef struct {
+    char name[ASSET_NAME_LEN];  // file name inside /assets
+    uint32_t size;
+    uint32_t crc32;
+    uint16_t width;             // 0 when unknown
+    uint16_t height;
+    uint8_t type;               // AssetType
+} AssetEntry;
+
+// Load the saved index, or scan the card when there is none. Call once the
+// SD card is mounted.
+void asset_index_init(void);
+
+// Rebuild from the card (reads every file for its checksum); returns the count
+int asset_index_rescan(void);
+
+// Copy of the whole index, sorted by name, in PSRAM (free() it). Sets *count;
+// returns NULL when the index is empty or out of memory.
+AssetEntry *asset_index_snapshot(int *count);
+
+// Files on the card left out of the index because it was full, counted
+// since the last rescan
+int asset_index_dropped(void);
+
+// Add or replace one file after it was written. Size and checksum are taken
+// from the caller (computed while the upload streamed in); the header is read
+// for the dimensions. Replacing or removing a file clears LVGL's image cache
+// under the UI lock, so neither may be called with that lock held.
+bool asset_index_put(const char *name, uint32_t size, uint32_t crc32);
+
+// Drop one file from the index
+void asset_index_remove(const char *name);
+
+// Move a finished temporary file over `dest` (both full paths in ASSET_DIR).
+// An existing file is first renamed to a hidden ".<name>.bak", which is
+// deleted once the new file is in place, so a reset at any step leaves
+// either the old or the new file; asset_index_init() puts back a backup
+// whose file is missing. Returns false (with `dest` unchanged) on failure.
+bool asset_replace_file(const char *tmp, const char *dest);
+
+// Type from the file extension, and its short name ("png", "rgb565", ...)
+AssetType asset_type_from_name(const char *name);
+const char *asset_type_name(AssetType type);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,494 @@
+#include "asset_transcode.h"
+#include <Arduino.h>
+#include <lvgl.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_crc.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include "rgb565_decoder.h"
+
+#define LODEPNG_NO_COMPILE_CPP
+extern "C" {
+#include "src/extra/libs/png/lodepng.h"
+}
+#include "src/extra/libs/sjpg/tjpgd.h"
+
+#define TRANSCODE_TASK_STACK    8192
+#define TRANSCODE_TASK_PRIORITY 1       // same as the web task, below Signal K
+#define TRANSCODE_TASK_CORE     0
+#define TRANSCODE_JPEG_POOL     4096    // TJpgDec work area, as lv_sjpg uses
+#define TRANSCODE_READ_CHUNK    4096
+#define TRANSCODE_DECODE_SHARE  60      // progress percent given to decoding
+
+typedef struct {
+    uint8_t *px;        // RGBA8888 rows, lv_mem (PSRAM)
+    uint16_t w;
+    uint16_t h;
+} Image;
+
+// Source window and output size
+typedef struct {
+    int x0, y0, ww, wh;
+    int tw, th;
+} Plan;
+
+typedef struct {
+    FILE *f;
+    Image *img;
+    int job;
+} JpegCtx;
+
+static AssetJob jobs[ASSET_JOBS];
+static uint32_t next_job_id = 1;
+static SemaphoreHandle_t job_mutex = NULL;
+static QueueHandle_t job_queue = NULL;
+
+const char *asset_slot_name(AssetSlot slot) {
+    switch (slot) {
+        case ASSET_SLOT_ICON: return "icon";
+        case ASSET_SLOT_BACKGROUND: return "background";
+        default: return "auto";
+    }
+}
+
+const char *asset_job_state_name(AssetJobState state) {
+    switch (state) {
+        case ASSET_JOB_QUEUED: return "queued";
+        case ASSET_JOB_RUNNING: return "running";
+        case ASSET_JOB_DONE: return "done";
+        default: return "failed";
+    }
+}
+
+bool asset_transcode_supported(const char *name) {
+    AssetType t = asset_type_from_name(name);
+    return t == ASSET_TYPE_PNG || t == ASSET_TYPE_JPEG;
+}
+
+static void set_progress(int job, int pct) {
+    if (pct > 99) pct = 99;     // 100 only once the file is in place
+    xSemaphoreTake(job_mutex, portMAX_DELAY);
+    jobs[job].progress = (uint8_t)pct;
+    xSemaphoreGive(job_mutex);
+}
+
+static void resolve_slot(AssetSlot *slot, int w, int h) {
+    if (*slot == ASSET_SLOT_AUTO) {
+        *slot = (w >= ASSET_BG_SIDE && h >= ASSET_BG_SIDE) ? ASSET_SLOT_BACKGROUND : ASSET_SLOT_ICON;
+    }
+}
+
+static void plan_output(AssetSlot slot, int w, int h, Plan *p) {
+    p->x0 = p->y0 = 0;
+    p->ww = w;
+    p->wh = h;
+    if (slot == ASSET_SLOT_BACKGROUND) {
+        // Cover the square screen, cropping the longer side around the centre
+        p->tw = p->th = ASSET_BG_SIDE;
+        if (w > h) {
+            p->ww = h;
+            p->x0 = (w - h) / 2;
+        } else {
+            p->wh = w;
+            p->y0 = (h - w) / 2;
+        }
+        return;
+    }
+    // Icons keep their aspect and are never enlarged
+    int side = w > h ? w : h;
+    if (side <= ASSET_ICON_MAX_SIDE) {
+        p->tw = w;
+        p->th = h;
+        return;
+    }
+    p->tw = (w * ASSET_ICON_MAX_SIDE + side / 2) / side;
+    p->th = (h * ASSET_ICON_MAX_SIDE + side / 2) / side;
+    if (p->tw < 1) p->tw = 1;
+    if (p->th < 1) p->th = 1;
+}
+
+// ---- PNG: the whole file is inflated at once ----
+
+static bool decode_png(int job, const char *path, Image *img, char *err) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Cannot open file");
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    // Refuse before inflating anything too big for PSRAM
+    uint8_t hdr[24];
+    if (size < (long)sizeof(hdr) || fread(hdr, 1, sizeof(hdr), f) != sizeof(hdr) || memcmp(&hdr[12], "IHDR", 4)) {
+        fclose(f);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Not a PNG file");
+        return false;
+    }
+    uint32_t w = (uint32_t)hdr[16] << 24 | (uint32_t)hdr[17] << 16 | (uint32_t)hdr[18] << 8 | hdr[19];
+    uint32_t h = (uint32_t)hdr[20] << 24 | (uint32_t)hdr[21] << 16 | (uint32_t)hdr[22] << 8 | hdr[23];
+    if (!w || !h || (uint64_t)w * h > ASSET_MAX_PIXELS) {
+        fclose(f);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Image too large (%lux%lu)", (unsigned long)w, (unsigned long)h);
+        return false;
+    }
+
+    uint8_t *buf = (uint8_t *)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (!buf) {
+        fclose(f);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Out of memory reading file");
+        return false;
+    }
+    fseek(f, 0, SEEK_SET);
+    long got = 0;
+    while (got < size) {
+        size_t n = fread(buf + got, 1, (size - got) > TRANSCODE_READ_CHUNK ? TRANSCODE_READ_CHUNK : (size - got), f);
+        if (n == 0) break;
+        got += n;
+        set_progress(job, (int)(got * 20 / size));
+    }
+    fclose(f);
+    if (got != size) {
+        heap_caps_free(buf);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Read error");
+        return false;
+    }
+
+    unsigned char *out = NULL;
+    unsigned ow = 0, oh = 0;
+    unsigned e = lodepng_decode32(&out, &ow, &oh, buf, size);
+    heap_caps_free(buf);
+    if (e) {
+        if (out) lv_mem_free(out);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "PNG: %s", lodepng_error_text(e));
+        return false;
+    }
+    img->px = out;
+    img->w = (uint16_t)ow;
+    img->h = (uint16_t)oh;
+    set_progress(job, TRANSCODE_DECODE_SHARE);
+    return true;
+}
+
+// ---- JPEG: streamed from the card one MCU strip at a time ----
+
+static size_t jpeg_in(JDEC *jd, uint8_t *buf, size_t n) {
+    JpegCtx *c = (JpegCtx *)jd->device;
+    if (buf) return fread(buf, 1, n, c->f);
+    return fseek(c->f, n, SEEK_CUR) == 0 ? n : 0;
+}
+
+static int jpeg_out(JDEC *jd, void *bitmap, JRECT *r) {
+    JpegCtx *c = (JpegCtx *)jd->device;
+    Image *img = c->img;
+    const uint8_t *s = (const uint8_t *)bitmap;
+    int rw = r->right - r->left + 1;
+    for (int y = r->top; y <= r->bottom; ++y, s += rw * 3) {
+        if (y >= img->h) continue;
+        uint8_t *d = img->px + ((size_t)y * img->w + r->left) * 4;
+        for (int x = 0; x < rw && r->left + x < img->w; ++x, d += 4) {
+            d[0] = s[x * 3];
+            d[1] = s[x * 3 + 1];
+            d[2] = s[x * 3 + 2];
+            d[3] = 255;
+        }
+    }
+    // Blocks arrive left to right, so a strip is done at the right edge
+    if (r->right + 1 >= img->w) set_progress(c->job, (r->bottom + 1) * TRANSCODE_DECODE_SHARE / img->h);
+    return 1;
+}
+
+static bool decode_jpeg(int job, const char *path, AssetSlot *slot, Image *img, char *err) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Cannot open file");
+        return false;
+    }
+    void *pool = malloc(TRANSCODE_JPEG_POOL);
+    if (!pool) {
+        fclose(f);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Out of memory");
+        return false;
+    }
+
+    JpegCtx ctx = {f, img, job};
+    JDEC jd;
+    JRESULT res = jd_prepare(&jd, jpeg_in, pool, TRANSCODE_JPEG_POOL, &ctx);
+    if (res != JDR_OK) {
+        free(pool);
+        fclose(f);
+        // TJpgDec only reads baseline files
+        snprintf(err, ASSET_JOB_ERROR_LEN, res == JDR_FMT3 ? "JPEG: progressive or unsupported format"
+                                                             : "JPEG: bad header (%d)", (int)res);
+        return false;
+    }
+
+    // Let the decoder drop resolution by up to 8x while staying at or above
+    // the target size; the box filter does the rest
+    resolve_slot(slot, jd.width, jd.height);
+    Plan p;
+    plan_output(*slot, jd.width, jd.height, &p);
+    uint8_t scale = 0;
+    while (scale < 3 && (jd.width >> (scale + 1)) >= p.tw && (jd.height >> (scale + 1)) >= p.th) scale++;
+
+    img->w = jd.width >> scale;
+    img->h = jd.height >> scale;
+    if (!img->w || !img->h || (uint32_t)img->w * img->h > ASSET_MAX_PIXELS) {
+        free(pool);
+        fclose(f);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Image too large (%ux%u)", jd.width, jd.height);
+        return false;
+    }
+    img->px = (uint8_t *)lv_mem_alloc((size_t)img->w * img->h * 4);
+    if (!img->px) {
+        free(pool);
+        fclose(f);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Out of memory (%ux%u)", img->w, img->h);
+        return false;
+    }
+    res = jd_decomp(&jd, jpeg_out, scale);
+    free(pool);
+    fclose(f);
+    if (res != JDR_OK) {
+        lv_mem_free(img->px);
+        img->px = NULL;
+        snprintf(err, ASSET_JOB_ERROR_LEN, "JPEG: decode error (%d)", (int)res);
+        return false;
+    }
+    return true;
+}
+
+// ---- Resize and write ----
+
+// Box filter over premultiplied alpha, so transparent pixels do not bleed
+// their (often black) colour into the edges. Opaque output is composited
+// onto black.
+static void sample(const Image *img, int sx0, int sx1, int sy0, int sy1, bool alpha, uint8_t out[4]) {
+    uint32_t r = 0, g = 0, b = 0, a = 0, n = 0;
+    for (int y = sy0; y < sy1; ++y) {
+        const uint8_t *p = img->px + ((size_t)y * img->w + sx0) * 4;
+        for (int x = sx0; x < sx1; ++x, p += 4) {
+            r += p[0] * p[3];
+            g += p[1] * p[3];
+            b += p[2] * p[3];
+            a += p[3];
+            n++;
+        }
+    }
+    uint32_t div = alpha ? a : n * 255;
+    out[3] = (uint8_t)(a / n);
+    if (!div) {
+        out[0] = out[1] = out[2] = 0;
+        return;
+    }
+    out[0] = (uint8_t)(r / div);
+    out[1] = (uint8_t)(g / div);
+    out[2] = (uint8_t)(b / div);
+}
+
+static bool write_output(int job, const Image *img, const Plan *p, bool alpha, const char *path, uint32_t *size,
+                         uint32_t *crc, char *err) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Cannot create output");
+        return false;
+    }
+    rgb565_file_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, RGB565_FILE_MAGIC, 4);
+    hdr.w = (uint16_t)p->tw;
+    hdr.h = (uint16_t)p->th;
+    hdr.cf = alpha ? RGB565_CF_ALPHA : RGB565_CF_OPAQUE;
+    bool ok = fwrite(&hdr, 1, sizeof(hdr), f) == sizeof(hdr);
+    *crc = esp_rom_crc32_le(0, (const uint8_t *)&hdr, sizeof(hdr));
+    *size = sizeof(hdr);
+
+    int bpp = alpha ? 3 : 2;
+    size_t row_bytes = (size_t)p->tw * bpp;
+    uint8_t *row = (uint8_t *)malloc(row_bytes);
+    if (!row) ok = false;
+
+    for (int oy = 0; ok && oy < p->th; ++oy) {
+        int sy0 = p->y0 + oy * p->wh / p->th;
+        int sy1 = p->y0 + (oy + 1) * p->wh / p->th;
+        if (sy1 <= sy0) sy1 = sy0 + 1;
+        uint8_t *d = row;
+        for (int ox = 0; ox < p->tw; ++ox, d += bpp) {
+            int sx0 = p->x0 + ox * p->ww / p->tw;
+            int sx1 = p->x0 + (ox + 1) * p->ww / p->tw;
+            if (sx1 <= sx0) sx1 = sx0 + 1;
+            uint8_t px[4];
+            sample(img, sx0, sx1, sy0, sy1, alpha, px);
+            uint16_t c = (uint16_t)((px[0] & 0xF8) << 8 | (px[1] & 0xFC) << 3 | px[2] >> 3);
+            d[0] = c & 0xFF;
+            d[1] = c >> 8;
+            if (alpha) d[2] = px[3];
+        }
+        if (fwrite(row, 1, row_bytes, f) != row_bytes) ok = false;
+        *crc = esp_rom_crc32_le(*crc, row, row_bytes);
+        *size += row_bytes;
+        set_progress(job, TRANSCODE_DECODE_SHARE + (oy + 1) * (100 - TRANSCODE_DECODE_SHARE) / p->th);
+    }
+    free(row);
+    if (fclose(f) != 0) ok = false;
+    if (!ok) {
+        remove(path);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Write failed (card full?)");
+    }
+    return ok;
+}
+
+static bool transcode(int job, const char *source, AssetSlot *slot, char *output, uint16_t *ow, uint16_t *oh,
+                      char *err) {
+    char path[96], tmp[96], dest[96];
+    snprintf(path, sizeof(path), ASSET_DIR "/%s", source);
+
+    // foo.png -> foo.bin
+    const char *dot = strrchr(source, '.');
+    int base = dot ? (int)(dot - source) : (int)strlen(source);
+    if (base + 4 >= ASSET_NAME_LEN) {
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Name too long");
+        return false;
+    }
+    snprintf(output, ASSET_NAME_LEN, "%.*s.bin", base, source);
+    // Hidden from the index until it is complete
+    snprintf(tmp, sizeof(tmp), ASSET_DIR "/.%s.tmp", output);
+    snprintf(dest, sizeof(dest), ASSET_DIR "/%s", output);
+
+    Image img = {NULL, 0, 0};
+    bool ok;
+    if (asset_type_from_name(source) == ASSET_TYPE_PNG) {
+        ok = decode_png(job, path, &img, err);
+        if (ok) resolve_slot(slot, img.w, img.h);
+    } else {
+        ok = decode_jpeg(job, path, slot, &img, err);
+    }
+    if (!ok) return false;
+
+    Plan p;
+    plan_output(*slot, img.w, img.h, &p);
+    uint32_t size = 0, crc = 0;
+    ok = write_output(job, &img, &p, *slot == ASSET_SLOT_ICON, tmp, &size, &crc, err);
+    lv_mem_free(img.px);
+    if (!ok) return false;
+
+    if (!asset_replace_file(tmp, dest)) {
+        remove(tmp);
+        snprintf(err, ASSET_JOB_ERROR_LEN, "Rename failed");
+        return false;
+    }
+    asset_index_put(output, size, crc);
+    // The .bin replaces the upload
+    if (remove(path) == 0) asset_index_remove(source);
+    *ow = (uint16_t)p.tw;
+    *oh = (uint16_t)p.th;
+    return true;
+}
+
+static void run_job(int job) {
+    char source[ASSET_NAME_LEN];
+    xSemaphoreTake(job_mutex, portMAX_DELAY);
+    AssetSlot slot = (AssetSlot)jobs[job].slot;
+    snprintf(source, sizeof(source), "%s", jobs[job].source);
+    jobs[job].state = ASSET_JOB_RUNNING;
+    xSemaphoreGive(job_mutex);
+
+    char output[ASSET_NAME_LEN] = "";
+    char err[ASSET_JOB_ERROR_LEN] = "";
+    uint16_t w = 0, h = 0;
+    uint32_t t0 = millis();
+    bool ok = transcode(job, source, &slot, output, &w, &h, err);
+    uint32_t ms = millis() - t0;
+
+    xSemaphoreTake(job_mutex, portMAX_DELAY);
+    AssetJob *j = &jobs[job];
+    j->state = ok ? ASSET_JOB_DONE : ASSET_JOB_FAILED;
+    j->slot = slot;
+    j->elapsed_ms = ms;
+    if (ok) {
+        j->progress = 100;
+        j->width = w;
+        j->height = h;
+        snprintf(j->output, sizeof(j->output), "%s", output);
+    }
+    snprintf(j->error, sizeof(j->error), "%s", err);
+    xSemaphoreGive(job_mutex);
+
+    if (ok) {
+        Serial.printf("[ASSETS] Converted %s -> %s (%s %ux%u) in %lu ms\n", source, output,
+                      asset_slot_name(slot), w, h, (unsigned long)ms);
+    } else {
+        Serial.printf("[ASSETS] Converting %s failed: %s\n", source, err);
+    }
+}
+
+static void transcode_task(void *parameter) {
+    (void)parameter;
+    int job;
+    for (;;) {
+        if (xQueueReceive(job_queue, &job, portMAX_DELAY) == pdTRUE) run_job(job);
+    }
+}
+
+void asset_transcode_init(void) {
+    if (job_queue) return;
+    job_mutex = xSemaphoreCreateMutex();
+    job_queue = xQueueCreate(ASSET_JOBS, sizeof(int));
+    memset(jobs, 0, sizeof(jobs));
+    xTaskCreatePinnedToCore(transcode_task, "transcode", TRANSCODE_TASK_STACK, NULL, TRANSCODE_TASK_PRIORITY, NULL,
+                            TRANSCODE_TASK_CORE);
+}
+
+uint32_t asset_transcode_queue(const char *source, AssetSlot slot) {
+    if (!job_queue || !asset_transcode_supported(source) || strlen(source) >= ASSET_NAME_LEN) return 0;
+
+    // Reuse an empty slot, else the oldest finished job
+    xSemaphoreTake(job_mutex, portMAX_DELAY);
+    int pick = -1;
+    for (int i = 0; i < ASSET_JOBS; ++i) {
+        AssetJob *j = &jobs[i];
+        if (j->id && (j->state == ASSET_JOB_QUEUED || j->state == ASSET_JOB_RUNNING)) continue;
+        if (pick < 0 || j->id < jobs[pick].id) pick = i;
+    }
+    uint32_t id = 0;
+    if (pick >= 0) {
+        AssetJob *j = &jobs[pick];
+        memset(j, 0, sizeof(*j));
+        id = j->id = next_job_id++;
+        snprintf(j->source, sizeof(j->source), "%s", source);
+        j->slot = slot;
+        j->state = ASSET_JOB_QUEUED;
+    }
+    xSemaphoreGive(job_mutex);
+    if (!id) return 0;
+
+    xQueueSend(job_queue, &pick, 0);
+    return id;
+}
+
+int asset_transcode_jobs(AssetJob *out, int max) {
+    if (!job_mutex) return 0;
+    AssetJob all[ASSET_JOBS];
+    int n = 0;
+    xSemaphoreTake(job_mutex, portMAX_DELAY);
+    for (int i = 0; i < ASSET_JOBS; ++i) {
+        if (jobs[i].id) all[n++] = jobs[i];
+    }
+    xSemaphoreGive(job_mutex);
+    // Newest first
+    for (int i = 1; i < n; ++i) {
+        AssetJob t = all[i];
+        int k = i - 1;
+        while (k >= 0 && all[k].id < t.id) {
+            all[k + 1] = all[k];
+            k--;
+        }
+        all[k + 1] = t;
+    }
+    if (n > max) n = max;
+    memcpy(out, all, n * sizeof(AssetJob));
+    return n;
+}
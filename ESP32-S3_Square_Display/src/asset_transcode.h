@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "asset_index.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Converts uploaded PNG and JPEG files into the display's native .bin
+// format on a background task, so pages never decode PNG at runtime.
+//
+//   icon        fit within ASSET_ICON_MAX_SIDE (never enlarged), RGB565 + alpha
+//   background  scaled to cover ASSET_BG_SIDE square and centre-cropped, RGB565
+//   auto        background when the image is at least ASSET_BG_SIDE on both
+//               sides, otherwise icon
+//
+// JPEGs are decoded in MCU strips straight from the card, using the decoder's
+// 1/2..1/8 scaling when the image is much larger than the target. PNGs are
+// inflated whole into PSRAM (up to ASSET_MAX_PIXELS). Both are box-filtered to
+// the target size and written row by row to a temporary file, which replaces
+// /assets/<name>.bin once complete; the source file is then removed. Each
+// job reports its progress for the upload page to poll.
+
+#define ASSET_ICON_MAX_SIDE     120
+#define ASSET_BG_SIDE           480
+#define ASSET_MAX_PIXELS        (1024 * 1024)
+#define ASSET_JOBS              4
+#define ASSET_JOB_ERROR_LEN     48
+
+typedef enum {
+    ASSET_SLOT_AUTO = 0,
+    ASSET_SLOT_ICON,
+    ASSET_SLOT_BACKGROUND,
+} AssetSlot;
+
+typedef enum {
+    ASSET_JOB_QUEUED = 0,
+    ASSET_JOB_RUNNING,
+    ASSET_JOB_DONE,
+    ASSET_JOB_FAILED,
+} AssetJobState;
+
+typedef struct {
+    uint32_t id;                // 0 = unused
+    char source[ASSET_NAME_LEN];
+    char output[ASSET_NAME_LEN];
+    uint8_t slot;               // AssetSlot, resolved once the size is known
+    uint8_t state;              // AssetJobState
+    uint8_t progress;           // percent
+    uint16_t width;             // output size
+    uint16_t height;
+    uint32_t elapsed_ms;
+    char error[ASSET_JOB_ERROR_LEN];
+} AssetJob;
+
+// Start the conversion task
+void asset_transcode_init(void);
+
+// True for the file types the converter accepts (PNG, JPEG)
+bool asset_transcode_supported(const char *name);
+
+// Queue /assets/<source> for conversion; returns the job id, or 0 when the
+// type is not supported or ASSET_JOBS conversions are already pending
+uint32_t asset_transcode_queue(const char *source, AssetSlot slot);
+
+// Recent jobs, newest first; returns how many were copied
+int asset_transcode_jobs(AssetJob *out, int max);
+
+const char *asset_slot_name(AssetSlot slot);
+const char *asset_job_state_name(AssetJobState state);
+
+#ifdef __cplusplus
+}
+#endif
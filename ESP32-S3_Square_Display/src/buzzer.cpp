@@ -0,0 +1,189 @@
+#include "buzzer.h"
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "TCA9554PWR.h"
+
+#define BUZZER_PIN          EXIO_PIN6
+#define BUZZER_MAX_PENDING  4
+#define BUZZER_ESCALATE_MIN_GAP_MS 150
+
+typedef struct {
+    const uint16_t* steps;      // alternating on/off durations in ms, starting with on
+    uint8_t count;
+    bool repeat;
+    bool escalate;              // shorten the final gap on every repetition
+} BuzzerPatternDef;
+
+static const uint16_t pat_double[] = {100, 100, 100, 100};
+static const uint16_t pat_continuous[] = {500, 500};
+static const uint16_t pat_sos[] = {100, 100, 100, 100, 100, 300,
+                                   300, 100, 300, 100, 300, 300,
+                                   100, 100, 100, 100, 100, 1500};
+static const uint16_t pat_escalating[] = {150, 1350};
+
+static const BuzzerPatternDef patterns[BUZZER_PATTERN_COUNT] = {
+    {pat_double, sizeof(pat_double) / sizeof(pat_double[0]), false, false},
+    {pat_continuous, sizeof(pat_continuous) / sizeof(pat_continuous[0]), true, false},
+    {pat_sos, sizeof(pat_sos) / sizeof(pat_sos[0]), true, false},
+    {pat_escalating, sizeof(pat_escalating) / sizeof(pat_escalating[0]), true, true},
+};
+
+typedef enum { BUZZER_CMD_PLAY, BUZZER_CMD_ACK } BuzzerCmdType;
+
+typedef struct {
+    BuzzerCmdType type;
+    BuzzerPattern pattern;
+    BuzzerPriority prio;
+} BuzzerCmd;
+
+typedef struct {
+    BuzzerPattern pattern;
+    BuzzerPriority prio;
+} BuzzerRequest;
+
+static QueueHandle_t buzzer_queue = NULL;
+static volatile bool buzzer_active = false;
+
+// Sequencer state, only touched by the task
+static bool playing = false;
+static BuzzerRequest current;
+static uint8_t step = 0;
+static uint16_t cycle = 0;
+static uint32_t step_deadline = 0;
+static BuzzerRequest pending[BUZZER_MAX_PENDING];
+static uint8_t pending_count = 0;
+
+static void buzzer_output(bool on) {
+    Set_EXIO(BUZZER_PIN, on ? High : Low);
+}
+
+static uint16_t buzzer_step_ms(void) {
+    const BuzzerPatternDef& def = patterns[current.pattern];
+    uint16_t ms = def.steps[step];
+    if (def.escalate && step == def.count - 1) {
+        uint32_t shrink = (uint32_t)cycle * 200;
+        ms = (shrink + BUZZER_ESCALATE_MIN_GAP_MS >= ms) ? BUZZER_ESCALATE_MIN_GAP_MS : (uint16_t)(ms - shrink);
+    }
+    return ms;
+}
+
+static void buzzer_start(const BuzzerRequest& req) {
+    current = req;
+    playing = true;
+    step = 0;
+    cycle = 0;
+    buzzer_output(true);
+    step_deadline = millis() + buzzer_step_ms();
+}
+
+static void buzzer_start_next(void) {
+    playing = false;
+    buzzer_output(false);
+    if (pending_count == 0) return;
+    // Highest priority first, oldest first within a priority
+    uint8_t best = 0;
+    for (uint8_t i = 1; i < pending_count; i++) {
+        if (pending[i].prio > pending[best].prio) best = i;
+    }
+    BuzzerRequest next = pending[best];
+    for (uint8_t i = best; i + 1 < pending_count; i++) pending[i] = pending[i + 1];
+    pending_count--;
+    buzzer_start(next);
+}
+
+static void buzzer_enqueue(const BuzzerRequest& req) {
+    if (playing && current.pattern == req.pattern) {
+        if (req.prio > current.prio) current.prio = req.prio;
+        return;
+    }
+    for (uint8_t i = 0; i < pending_count; i++) {
+        if (pending[i].pattern == req.pattern) {
+            if (req.prio > pending[i].prio) pending[i].prio = req.prio;
+            return;
+        }
+    }
+    if (!playing) {
+        buzzer_start(req);
+        return;
+    }
+    if (req.prio > current.prio) {
+        // Pre-empt; a repeating pattern resumes later, a one-shot is dropped
+        BuzzerRequest preempted = current;
+        buzzer_start(req);
+        if (patterns[preempted.pattern].repeat && pending_count < BUZZER_MAX_PENDING) {
+            pending[pending_count++] = preempted;
+        }
+        return;
+    }
+    if (pending_count < BUZZER_MAX_PENDING) pending[pending_count++] = req;
+}
+
+static void buzzer_advance(void) {
+    const BuzzerPatternDef& def = patterns[current.pattern];
+    step++;
+    if (step >= def.count) {
+        if (!def.repeat) {
+            buzzer_start_next();
+            return;
+        }
+        step = 0;
+        if (cycle < 0xFFFF) cycle++;
+    }
+    buzzer_output((step & 1) == 0);
+    step_deadline += buzzer_step_ms();
+    // Do not try to catch up if the task was held off for a long time
+    if ((int32_t)(step_deadline - millis()) < 0) step_deadline = millis() + buzzer_step_ms();
+}
+
+static void buzzer_task(void* arg) {
+    BuzzerCmd cmd;
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+        if (playing) {
+            int32_t left = (int32_t)(step_deadline - millis());
+            wait = left > 0 ? pdMS_TO_TICKS(left) : 0;
+        }
+        if (xQueueReceive(buzzer_queue, &cmd, wait) == pdTRUE) {
+            if (cmd.type == BUZZER_CMD_ACK) {
+                pending_count = 0;
+                if (playing) Serial.printf("[BUZZER] Acknowledged pattern %d\n", (int)current.pattern);
+                playing = false;
+                buzzer_output(false);
+            } else {
+                BuzzerRequest req = {cmd.pattern, cmd.prio};
+                buzzer_enqueue(req);
+            }
+        } else if (playing) {
+            buzzer_advance();
+        }
+        buzzer_active = playing || pending_count > 0;
+    }
+}
+
+void buzzer_init(void) {
+    if (buzzer_queue) return;
+    buzzer_queue = xQueueCreate(8, sizeof(BuzzerCmd));
+    buzzer_output(false);
+    xTaskCreatePinnedToCore(buzzer_task, "buzzer", 2560, NULL, 2, NULL, 0);
+}
+
+bool buzzer_play(BuzzerPattern pattern, BuzzerPriority prio) {
+    if (!buzzer_queue || pattern >= BUZZER_PATTERN_COUNT) return false;
+    BuzzerCmd cmd = {BUZZER_CMD_PLAY, pattern, prio};
+    if (xQueueSend(buzzer_queue, &cmd, 0) != pdTRUE) return false;
+    buzzer_active = true;
+    return true;
+}
+
+void buzzer_acknowledge(void) {
+    if (!buzzer_queue) return;
+    BuzzerCmd cmd = {BUZZER_CMD_ACK, BUZZER_DOUBLE_BEEP, BUZZER_PRIO_INFO};
+    // Queued behind earlier play requests so those are dropped too
+    xQueueSend(buzzer_queue, &cmd, pdMS_TO_TICKS(20));
+}
+
+bool buzzer_is_active(void) {
+    return buzzer_active;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Non-blocking buzzer sequencer.
+//
+// Patterns are queued to a small task that owns EXIO_PIN6 and steps through
+// on/off durations with timed waits, so callers (the UI loop, alarm checks)
+// never sleep. A higher-priority request pre-empts the one playing; repeating
+// patterns keep sounding until they are acknowledged or stopped.
+
+typedef enum {
+    BUZZER_DOUBLE_BEEP = 0,     // two short beeps, plays once
+    BUZZER_CONTINUOUS,          // steady on/off until acknowledged
+    BUZZER_SOS,                 // ... --- ... until acknowledged
+    BUZZER_ESCALATING,          // beeps getting closer together until acknowledged
+    BUZZER_PATTERN_COUNT
+} BuzzerPattern;
+
+typedef enum {
+    BUZZER_PRIO_INFO = 0,
+    BUZZER_PRIO_WARNING = 1,
+    BUZZER_PRIO_ALARM = 2
+} BuzzerPriority;
+
+// Start the sequencer task. Call after TCA9554PWR_Init().
+void buzzer_init(void);
+
+// Queue a pattern; returns false if the queue is full. Requesting a pattern
+// that is already playing or queued is a no-op.
+bool buzzer_play(BuzzerPattern pattern, BuzzerPriority prio);
+
+// Silence the current pattern and drop everything queued (e.g. on touch).
+void buzzer_acknowledge(void);
+
+// True while a pattern is sounding or queued
+bool buzzer_is_active(void);
+
+#ifdef __cplusplus
+}
+#endif
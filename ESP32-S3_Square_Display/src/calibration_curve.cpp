@@ -0,0 +1,155 @@
+#include "calibration_curve.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Fractions of a degree (1/65536) this close to an integer, on top of the input
+// quantisation step, are resolved in float
+#define CAL_CURVE_EXACT_EPS 128
+
+int16_t cal_curve_eval_reference(const GaugeCalibrationPoint* pts, int count, float value) {
+    for (int i = 0; i + 1 < count; i++) {
+        float val1 = pts[i].value;
+        float val2 = pts[i + 1].value;
+        int16_t angle1 = pts[i].angle;
+        int16_t angle2 = pts[i + 1].angle;
+        if ((val1 <= val2 && value >= val1 && value <= val2) ||
+            (val1 > val2 && value >= val2 && value <= val1)) {
+            float value_range = val2 - val1;
+            if (fabs(value_range) < 0.001) return angle1;
+            float normalized = (value - val1) / value_range;
+            int16_t result;
+            if (angle2 < angle1) {
+                result = angle1 - (int16_t)(normalized * abs(angle2 - angle1));
+            } else {
+                result = angle1 + (int16_t)(normalized * abs(angle2 - angle1));
+            }
+            return result;
+        }
+    }
+    if (value < pts[0].value) return pts[0].angle;
+    return pts[count - 1].angle;
+}
+
+// Fritsch-Carlson tangents, then cubic Hermite coefficients per segment
+static void cal_curve_build_cubic(CalCurve* c) {
+    int n = c->count;
+    float d[CAL_CURVE_MAX_POINTS];          // secant slopes
+    float m[CAL_CURVE_MAX_POINTS];          // tangents
+    for (int i = 0; i + 1 < n; i++) {
+        d[i] = (float)(c->angle[i + 1] - c->angle[i]) / (c->x[i + 1] - c->x[i]);
+    }
+    m[0] = d[0];
+    m[n - 1] = d[n - 2];
+    for (int i = 1; i + 1 < n; i++) {
+        m[i] = (d[i - 1] * d[i] <= 0.0f) ? 0.0f : (d[i - 1] + d[i]) * 0.5f;
+    }
+    for (int i = 0; i + 1 < n; i++) {
+        if (d[i] == 0.0f) { m[i] = m[i + 1] = 0.0f; continue; }
+        float a = m[i] / d[i];
+        float b = m[i + 1] / d[i];
+        float s = a * a + b * b;
+        if (s > 9.0f) {
+            float t = 3.0f / sqrtf(s);
+            m[i] = t * a * d[i];
+            m[i + 1] = t * b * d[i];
+        }
+    }
+    for (int i = 0; i + 1 < n; i++) {
+        float h = c->x[i + 1] - c->x[i];
+        c->cubic_c[i][0] = m[i];
+        c->cubic_c[i][1] = (3.0f * d[i] - 2.0f * m[i] - m[i + 1]) / h;
+        c->cubic_c[i][2] = (m[i] + m[i + 1] - 2.0f * d[i]) / (h * h);
+    }
+}
+
+void cal_curve_compile(CalCurve* c, const GaugeCalibrationPoint* pts, int count, bool cubic) {
+    memset(c, 0, sizeof(*c));
+    if (count > CAL_CURVE_MAX_POINTS) count = CAL_CURVE_MAX_POINTS;
+    if (count < 1) return;
+    c->count = (uint8_t)count;
+    memcpy(c->src, pts, sizeof(GaugeCalibrationPoint) * count);
+    c->angle_low = pts[0].angle;
+    c->angle_high = pts[count - 1].angle;
+    if (count < 2) return;
+
+    // Only strictly monotone value axes can be searched; anything else keeps
+    // the reference scan so odd user input behaves exactly as before
+    bool ascending = pts[1].value > pts[0].value;
+    for (int i = 0; i + 1 < count; i++) {
+        float dv = pts[i + 1].value - pts[i].value;
+        if (!(ascending ? dv >= 0.001f : dv <= -0.001f)) return;
+    }
+    c->reversed = !ascending;
+    for (int i = 0; i < count; i++) {
+        const GaugeCalibrationPoint& p = pts[ascending ? i : count - 1 - i];
+        c->x[i] = p.value;
+        c->angle[i] = (int16_t)p.angle;
+    }
+    c->x_min = c->x[0];
+    c->x_scale = (float)(1 << CAL_CURVE_Q_BITS) / (c->x[count - 1] - c->x[0]);
+    for (int i = 0; i < count; i++) {
+        // Same float ops as the lookup so a value equal to a point lands on it
+        c->qx[i] = (int32_t)((c->x[i] - c->x_min) * c->x_scale);
+    }
+    for (int i = 0; i + 1 < count; i++) {
+        int64_t span = c->qx[i + 1] - c->qx[i];
+        int64_t dy = (int64_t)abs(c->angle[i + 1] - c->angle[i]) << 8;
+        c->slope[i] = span > 0 ? (dy << 32) / span : 0;
+        // One Q24 step of input quantisation, in 1/65536 degree, plus float slack
+        int64_t step = c->slope[i] >> 24;
+        c->exact_eps[i] = (uint32_t)(step > 0x7FFF ? 0x7FFF : step) + CAL_CURVE_EXACT_EPS;
+    }
+    c->cubic = cubic && count >= 3;
+    if (c->cubic) cal_curve_build_cubic(c);
+    c->compiled = true;
+}
+
+int16_t cal_curve_eval(const CalCurve* c, float value) {
+    if (!c->compiled) {
+        if (c->count == 0) return 0;
+        return cal_curve_eval_reference(c->src, c->count, value);
+    }
+    int n = c->count;
+    if (!(value >= c->x[0])) return isnan(value) ? c->angle_high : c->angle_low;
+    if (value > c->x[n - 1]) return c->angle_high;
+
+    int32_t q = (int32_t)((value - c->x_min) * c->x_scale);
+    // Segment i with qx[i] <= q; the top breakpoint belongs to the last segment
+    int lo = 0, hi = n - 2;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (c->qx[mid] <= q) lo = mid; else hi = mid - 1;
+    }
+    int i = lo;
+
+    // The reference walks points in stored order, so a reversed curve measures
+    // the fraction from the segment's upper end
+    int a = c->reversed ? i + 1 : i;
+    int b = c->reversed ? i : i + 1;
+    int16_t angle1 = c->angle[a];
+    int16_t angle2 = c->angle[b];
+
+    if (c->cubic) {
+        // The top breakpoint sits at u == h, where round-off in the Hermite
+        // sum can land just short of the point's angle
+        if (value == c->x[i + 1]) return c->angle[i + 1];
+        float u = value - c->x[i];
+        float y = c->angle[i] + ((c->cubic_c[i][2] * u + c->cubic_c[i][1]) * u + c->cubic_c[i][0]) * u;
+        float off = y - angle1;
+        return (int16_t)(angle1 + (int16_t)off);
+    }
+
+    int64_t dq = c->reversed ? (int64_t)(c->qx[i + 1] - q) : (int64_t)(q - c->qx[i]);
+    if (dq < 0) dq = 0;
+    int64_t prod = dq * c->slope[i];                       // degrees in Q40
+    int32_t mag = (int32_t)(prod >> 40);
+    uint32_t frac = (uint32_t)(prod >> 24) & 0xFFFF;
+    if (frac < c->exact_eps[i] || frac > 0xFFFFu - c->exact_eps[i]) {
+        // Within rounding distance of a whole degree: settle the truncation the
+        // way the float reference does so both paths always agree
+        float normalized = (value - c->x[a]) / (c->x[b] - c->x[a]);
+        mag = (int16_t)(normalized * abs(angle2 - angle1));
+    }
+    return angle2 < angle1 ? angle1 - mag : angle1 + mag;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "calibration_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Calibration curve compiled once from a list of (value, angle) points so the
+// per-frame value -> angle conversion is a binary search plus a multiply.
+//
+// The value axis is normalised to Q24 over the curve's span and every segment
+// stores its slope as Q32 (Q8 angle per Q24 step), so linear lookups need no
+// float division. Output follows the original scan exactly: the fraction of a
+// segment is truncated toward the segment's first angle, values below the
+// lowest point map to the first angle and values above the highest point (or
+// NaN) map to the last angle.
+//
+// Optionally the curve is a monotone cubic (Fritsch-Carlson) through the same
+// points, for dials whose scale is not linear between calibration marks.
+// Curves whose values are not strictly monotone cannot be compiled and fall
+// back to the reference scan.
+//
+// test/test_calibration_curve checks the compiled lookup against the scan and
+// times both (pio test -e native).
+
+#define CAL_CURVE_MAX_POINTS 16
+#define CAL_CURVE_Q_BITS     24
+
+typedef struct {
+    uint8_t count;
+    bool compiled;                          // false: use cal_curve_eval_reference
+    bool cubic;
+    bool reversed;                          // points were stored with decreasing values
+    float x_min;
+    float x_scale;                          // (1 << CAL_CURVE_Q_BITS) / (x_max - x_min)
+    int32_t qx[CAL_CURVE_MAX_POINTS];       // breakpoints, ascending, Q24
+    int16_t angle[CAL_CURVE_MAX_POINTS];    // angle at each breakpoint (ascending order)
+    int64_t slope[CAL_CURVE_MAX_POINTS];    // |d angle| per Q24 step, Q8.32
+    uint16_t exact_eps[CAL_CURVE_MAX_POINTS]; // near-integer band settled in float
+    float cubic_c[CAL_CURVE_MAX_POINTS][3]; // Hermite coefficients on (value - x_i)
+    float x[CAL_CURVE_MAX_POINTS];
+    int16_t angle_low;                      // result below the lowest point
+    int16_t angle_high;                     // result above the highest point / NaN
+    GaugeCalibrationPoint src[CAL_CURVE_MAX_POINTS];
+} CalCurve;
+
+// Compile `count` points (in calibration order) into `curve`
+void cal_curve_compile(CalCurve* curve, const GaugeCalibrationPoint* pts, int count, bool cubic);
+
+int16_t cal_curve_eval(const CalCurve* curve, float value);
+
+// Original segment scan over raw points; used for curves that cannot be compiled
+int16_t cal_curve_eval_reference(const GaugeCalibrationPoint* pts, int count, float value);
+
+#ifdef __cplusplus
+}
+#endif
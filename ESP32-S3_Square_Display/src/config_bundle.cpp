@@ -0,0 +1,610 @@
+#include "config_bundle.h"
+#include <esp_heap_caps.h>
+#include <math.h>
+#include <stdarg.h>
+#include <string.h>
+#include "sensESP_setup.h"
+#include "signalk_config.h"
+#include "gauge_config.h"
+#include "screen_config_c_api.h"
+#include "needle_style.h"
+#include "needle_motion.h"
+#include "signal_filter.h"
+#include "derived_values.h"
+#include "asset_index.h"
+#include "web_task.h"
+#include "web_config.h"
+
+extern String saved_ssid;
+extern String saved_password;
+extern String saved_signalk_ip;
+extern uint16_t saved_signalk_port;
+extern String saved_hostname;
+extern String signalk_paths[NUM_SCREENS * 2];
+extern int buzzer_mode;
+extern uint16_t buzzer_cooldown_sec;
+extern bool first_run_buzzer;
+extern uint8_t LCD_Backlight;
+extern void Set_Backlight(uint8_t Light);
+extern void save_preferences();
+extern bool apply_all_screen_visuals();
+
+#define BUNDLE_PATH_LEN     128
+#define BUNDLE_ASSETS_MAX   (NUM_SCREENS * 3)   // two icons and a background per screen
+
+typedef struct __attribute__((packed)) {
+    char ssid[33];
+    char password[65];
+    char signalk_ip[64];
+    uint16_t signalk_port;
+    char hostname[64];
+    uint8_t buzzer_mode;
+    uint16_t buzzer_cooldown;
+    uint8_t brightness;
+    uint16_t auto_scroll;
+} BundleDevice;
+
+enum { NEEDLE_ROUNDED = 0x01, NEEDLE_GRADIENT = 0x02, NEEDLE_FOREGROUND = 0x04 };
+
+typedef struct __attribute__((packed)) {
+    char color[8];
+    uint16_t width;
+    int16_t inner;
+    int16_t outer;
+    uint16_t cx;
+    uint16_t cy;
+    uint8_t flags;          // NEEDLE_ROUNDED | NEEDLE_GRADIENT | NEEDLE_FOREGROUND
+    uint16_t damping_ms;
+    uint16_t max_rate;
+} BundleNeedle;
+
+typedef struct __attribute__((packed)) {
+    char name[ASSET_NAME_LEN];
+    uint32_t size;          // 0 = referenced but not on the exporting unit
+    uint32_t crc32;
+} BundleAsset;
+
+// A parsed and validated bundle, ready to commit
+typedef struct {
+    uint8_t flags;
+    uint16_t have;          // 1 << tag of each section present
+    BundleDevice device;
+    char paths[NUM_SCREENS * 2][BUNDLE_PATH_LEN];
+    int path_count;
+    ScreenConfig screens[NUM_SCREENS];
+    int screen_count;
+    uint16_t cubic_mask;
+    BundleNeedle needles[NUM_SCREENS * 2];
+    int needle_count;
+    SignalFilterConfig filters[SIGNAL_FILTER_MAX_PATHS];
+    int filter_count;
+    DerivedConfig derived[DERIVED_MAX];
+    int derived_count;
+    BundleAsset assets[BUNDLE_ASSETS_MAX];
+    int asset_count;
+    char err[BUNDLE_ERR_LEN];
+} BundleImage;
+
+static HttpServer *bundle_server = NULL;
+
+// Upload in flight (web task only)
+static uint8_t *bundle_buf = NULL;
+static size_t bundle_len = 0;
+static bool bundle_overflow = false;
+static bool bundle_uploaded = false;
+
+static void *bundle_alloc(size_t n) {
+    void *p = heap_caps_malloc(n, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    return p ? p : malloc(n);
+}
+
+// ---- Export -------------------------------------------------------------------
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    bool overflow;
+} BundleWriter;
+
+static void put(BundleWriter *w, const void *p, size_t n) {
+    if (w->len + n > w->cap) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, p, n);
+    w->len += n;
+}
+
+static void put_section(BundleWriter *w, uint8_t tag, int count, size_t rec_size) {
+    BundleSection sec = {tag, (uint8_t)count, (uint16_t)rec_size};
+    put(w, &sec, sizeof(sec));
+}
+
+static void copy_str(char *dst, size_t cap, const char *src) {
+    snprintf(dst, cap, "%s", src);
+}
+
+// File name inside /assets for an image path ("S://assets/x.bin"), or NULL
+static const char *asset_name_of(const char *path) {
+    if (!strstr(path, "/assets/")) return NULL;
+    const char *name = strrchr(path, '/') + 1;
+    return name[0] ? name : NULL;
+}
+
+static const AssetEntry *find_asset(const AssetEntry *list, int n, const char *name) {
+    for (int i = 0; i < n; ++i) if (strcmp(list[i].name, name) == 0) return &list[i];
+    return NULL;
+}
+
+// Distinct assets the screens reference, with their size and CRC from the index
+static int referenced_assets(BundleAsset *out) {
+    int n_list = 0;
+    AssetEntry *list = asset_index_snapshot(&n_list);
+    int n = 0;
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        const char *paths[3] = {screen_configs[s].icon_paths[0], screen_configs[s].icon_paths[1],
+                                screen_configs[s].background_path};
+        for (int k = 0; k < 3; ++k) {
+            const char *name = asset_name_of(paths[k]);
+            if (!name || n >= BUNDLE_ASSETS_MAX) continue;
+            bool seen = false;
+            for (int i = 0; i < n && !seen; ++i) seen = strcmp(out[i].name, name) == 0;
+            if (seen) continue;
+            BundleAsset &a = out[n++];
+            memset(&a, 0, sizeof(a));
+            copy_str(a.name, sizeof(a.name), name);
+            const AssetEntry *e = find_asset(list, n_list, name);
+            if (e) {
+                a.size = e->size;
+                a.crc32 = e->crc32;
+            }
+        }
+    }
+    free(list);
+    return n;
+}
+
+// The running device and network settings
+static void live_device(BundleDevice *dev, bool with_password) {
+    memset(dev, 0, sizeof(*dev));
+    copy_str(dev->ssid, sizeof(dev->ssid), saved_ssid.c_str());
+    if (with_password) copy_str(dev->password, sizeof(dev->password), saved_password.c_str());
+    copy_str(dev->signalk_ip, sizeof(dev->signalk_ip), saved_signalk_ip.c_str());
+    dev->signalk_port = saved_signalk_port;
+    copy_str(dev->hostname, sizeof(dev->hostname), saved_hostname.c_str());
+    dev->buzzer_mode = (uint8_t)buzzer_mode;
+    dev->buzzer_cooldown = buzzer_cooldown_sec;
+    dev->brightness = LCD_Backlight;
+    dev->auto_scroll = auto_scroll_sec;
+}
+
+uint8_t *config_bundle_export(bool with_password, size_t *len) {
+    BundleWriter w = {(uint8_t *)bundle_alloc(CONFIG_BUNDLE_MAX_SIZE), 0, CONFIG_BUNDLE_MAX_SIZE, false};
+    if (!w.buf) return NULL;
+
+    BundleDevice dev;
+    live_device(&dev, with_password);
+    put_section(&w, SEC_DEVICE, 1, sizeof(dev));
+    put(&w, &dev, sizeof(dev));
+
+    put_section(&w, SEC_PATHS, NUM_SCREENS * 2, BUNDLE_PATH_LEN);
+    for (int i = 0; i < NUM_SCREENS * 2; ++i) {
+        char path[BUNDLE_PATH_LEN];
+        memset(path, 0, sizeof(path));
+        copy_str(path, sizeof(path), signalk_paths[i].c_str());
+        put(&w, path, sizeof(path));
+    }
+
+    // The live calibration is in gauge_cal; screen_configs[].cal is only
+    // brought up to date when a screen is saved
+    put_section(&w, SEC_SCREENS, NUM_SCREENS, sizeof(ScreenConfig));
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        size_t at = w.len;
+        put(&w, &screen_configs[s], sizeof(ScreenConfig));
+        if (!w.overflow) memcpy(((ScreenConfig *)(w.buf + at))->cal, gauge_cal[s], sizeof(gauge_cal[s]));
+    }
+    put_section(&w, SEC_CAL_CUBIC, 1, sizeof(gauge_cal_cubic_mask));
+    put(&w, &gauge_cal_cubic_mask, sizeof(gauge_cal_cubic_mask));
+
+    put_section(&w, SEC_NEEDLES, NUM_SCREENS * 2, sizeof(BundleNeedle));
+    for (int i = 0; i < NUM_SCREENS * 2; ++i) {
+        NeedleStyle ns = get_needle_style(i / 2, i % 2);
+        BundleNeedle bn;
+        memset(&bn, 0, sizeof(bn));
+        copy_str(bn.color, sizeof(bn.color), ns.color.c_str());
+        bn.width = ns.width;
+        bn.inner = ns.inner;
+        bn.outer = ns.outer;
+        bn.cx = ns.cx;
+        bn.cy = ns.cy;
+        bn.flags = (ns.rounded ? NEEDLE_ROUNDED : 0) | (ns.gradient ? NEEDLE_GRADIENT : 0) |
+                   (ns.foreground ? NEEDLE_FOREGROUND : 0);
+        bn.damping_ms = ns.damping_ms;
+        bn.max_rate = ns.max_rate;
+        put(&w, &bn, sizeof(bn));
+    }
+
+    SignalFilterConfig filters[SIGNAL_FILTER_MAX_PATHS];
+    int nf = signal_filter_get_config(filters, SIGNAL_FILTER_MAX_PATHS);
+    put_section(&w, SEC_FILTERS, nf, sizeof(SignalFilterConfig));
+    put(&w, filters, sizeof(SignalFilterConfig) * nf);
+
+    DerivedConfig *derived = (DerivedConfig *)bundle_alloc(sizeof(DerivedConfig) * DERIVED_MAX);
+    int nd = derived ? derived_values_get_config(derived, DERIVED_MAX) : 0;
+    put_section(&w, SEC_DERIVED, nd, sizeof(DerivedConfig));
+    put(&w, derived, sizeof(DerivedConfig) * nd);
+    free(derived);
+
+    BundleAsset assets[BUNDLE_ASSETS_MAX];
+    int na = referenced_assets(assets);
+    put_section(&w, SEC_ASSETS, na, sizeof(BundleAsset));
+    put(&w, assets, sizeof(BundleAsset) * na);
+
+    uint8_t *out = w.overflow ? NULL : (uint8_t *)bundle_alloc(sizeof(BundleHeader) + w.len * 2);
+    if (!out) {
+        free(w.buf);
+        return NULL;
+    }
+    *len = bundle_seal(w.buf, w.len, with_password ? BUNDLE_HAS_PASSWORD : 0, out);
+    free(w.buf);
+    return out;
+}
+
+// ---- Import -------------------------------------------------------------------
+
+static bool bundle_fail(BundleImage *img, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(img->err, sizeof(img->err), fmt, ap);
+    va_end(ap);
+    return false;
+}
+
+// Copy up to `max` records into `dst` (records of dst_size bytes, already
+// holding the values fields missing from older bundles should keep)
+static int read_records(const BundleSection *sec, const uint8_t *body, void *dst, size_t dst_size, int max) {
+    int n = sec->count < max ? sec->count : max;
+    size_t copy = sec->rec_size < dst_size ? sec->rec_size : dst_size;
+    for (int i = 0; i < n; ++i) memcpy((uint8_t *)dst + i * dst_size, body + i * sec->rec_size, copy);
+    return n;
+}
+
+#define TERMINATE(field) ((field)[sizeof(field) - 1] = '\0')
+
+static bool finite_non_negative(float v) {
+    return isfinite(v) && v >= 0.0f;
+}
+
+static bool check_screen(BundleImage *img, int s) {
+    ScreenConfig &sc = img->screens[s];
+    for (int i = 0; i < 2; ++i) TERMINATE(sc.icon_paths[i]);
+    TERMINATE(sc.background_path);
+    for (int g = 0; g < 2; ++g) for (int z = 0; z < 5; ++z) TERMINATE(sc.color[g][z]);
+    TERMINATE(sc.number_bg_color);
+    TERMINATE(sc.number_font_color);
+    TERMINATE(sc.number_path);
+    TERMINATE(sc.dual_top_path);
+    TERMINATE(sc.dual_top_font_color);
+    TERMINATE(sc.dual_bottom_path);
+    TERMINATE(sc.dual_bottom_font_color);
+    TERMINATE(sc.quad_tl_path);
+    TERMINATE(sc.quad_tl_font_color);
+    TERMINATE(sc.quad_tr_path);
+    TERMINATE(sc.quad_tr_font_color);
+    TERMINATE(sc.quad_bl_path);
+    TERMINATE(sc.quad_bl_font_color);
+    TERMINATE(sc.quad_br_path);
+    TERMINATE(sc.quad_br_font_color);
+    TERMINATE(sc.gauge_num_center_path);
+    TERMINATE(sc.gauge_num_center_font_color);
+    TERMINATE(sc.graph_path_2);
+    TERMINATE(sc.graph_color_2);
+
+    if (sc.display_type > DISPLAY_TYPE_GRAPH) return bundle_fail(img, "screen %d: unknown display type", s + 1);
+    const uint8_t fonts[] = {sc.number_font_size, sc.dual_top_font_size, sc.dual_bottom_font_size, sc.quad_tl_font_size,
+                             sc.quad_tr_font_size, sc.quad_bl_font_size, sc.quad_br_font_size, sc.gauge_num_center_font_size};
+    for (uint8_t f : fonts) if (f > NUMBER_FONT_XXLARGE) return bundle_fail(img, "screen %d: unknown font size", s + 1);
+    if (sc.graph_chart_type > GRAPH_CHART_SCATTER || sc.graph_time_range > GRAPH_TIME_7D)
+        return bundle_fail(img, "screen %d: unknown graph setting", s + 1);
+    if (sc.icon_pos[0] > 3 || sc.icon_pos[1] > 3) return bundle_fail(img, "screen %d: unknown icon position", s + 1);
+    for (int g = 0; g < 2; ++g) for (int p = 0; p < 5; ++p)
+        if (!isfinite(sc.cal[g][p].value)) return bundle_fail(img, "screen %d: calibration value is not a number", s + 1);
+    for (int g = 0; g < 2; ++g) for (int z = 0; z < 5; ++z)
+        if (!isfinite(sc.min[g][z]) || !isfinite(sc.max[g][z]))
+            return bundle_fail(img, "screen %d: zone limit is not a number", s + 1);
+    for (int w = 0; w < WIDGET_SLOT_COUNT; ++w)
+        if (!finite_non_negative(sc.redraw_deadband[w]) || !finite_non_negative(sc.redraw_resolution[w]))
+            return bundle_fail(img, "screen %d: bad redraw setting", s + 1);
+    return true;
+}
+
+static bool check_image(BundleImage *img) {
+    BundleDevice &d = img->device;
+    TERMINATE(d.ssid);
+    TERMINATE(d.password);
+    TERMINATE(d.signalk_ip);
+    TERMINATE(d.hostname);
+    if ((img->have & (1 << SEC_DEVICE)) &&
+        (d.buzzer_mode > 2 || d.buzzer_cooldown > 3600 || d.auto_scroll > 3600 || d.brightness > 100))
+        return bundle_fail(img, "device: setting out of range");
+    for (int i = 0; i < img->path_count; ++i) TERMINATE(img->paths[i]);
+    for (int s = 0; s < img->screen_count; ++s) if (!check_screen(img, s)) return false;
+    for (int i = 0; i < img->needle_count; ++i) {
+        BundleNeedle &n = img->needles[i];
+        TERMINATE(n.color);
+        if (n.width < 1 || n.width > 64 || n.damping_ms > NEEDLE_MAX_DAMPING_MS || n.max_rate > NEEDLE_MAX_RATE_DPS)
+            return bundle_fail(img, "needle %d/%d: setting out of range", i / 2 + 1, i % 2);
+    }
+    for (int i = 0; i < img->filter_count; ++i) {
+        SignalFilterConfig &f = img->filters[i];
+        TERMINATE(f.path);
+        if (f.median_len > SIGNAL_FILTER_MEDIAN_MAX || !finite_non_negative(f.rate_limit) ||
+            !finite_non_negative(f.ema_tau_s) || !finite_non_negative(f.kalman_q) || !finite_non_negative(f.kalman_r) ||
+            f.circular > SIGNAL_FILTER_CIRCULAR_PI)
+            return bundle_fail(img, "filter %d: setting out of range", i + 1);
+    }
+    for (int i = 0; i < img->derived_count; ++i) {
+        TERMINATE(img->derived[i].name);
+        TERMINATE(img->derived[i].formula);
+    }
+    for (int i = 0; i < img->asset_count; ++i) TERMINATE(img->assets[i].name);
+    return true;
+}
+
+// Copy one section's records into the image
+static void read_section(void *ctx, const BundleSection *sec, const uint8_t *body) {
+    BundleImage *img = (BundleImage *)ctx;
+    switch (sec->tag) {
+        case SEC_DEVICE:
+            read_records(sec, body, &img->device, sizeof(BundleDevice), 1);
+            break;
+        case SEC_PATHS:
+            img->path_count = read_records(sec, body, img->paths, BUNDLE_PATH_LEN, NUM_SCREENS * 2);
+            break;
+        case SEC_SCREENS:
+            img->screen_count = read_records(sec, body, img->screens, sizeof(ScreenConfig), NUM_SCREENS);
+            break;
+        case SEC_CAL_CUBIC:
+            read_records(sec, body, &img->cubic_mask, sizeof(img->cubic_mask), 1);
+            break;
+        case SEC_NEEDLES:
+            img->needle_count = read_records(sec, body, img->needles, sizeof(BundleNeedle), NUM_SCREENS * 2);
+            break;
+        case SEC_FILTERS:
+            img->filter_count = read_records(sec, body, img->filters, sizeof(SignalFilterConfig), SIGNAL_FILTER_MAX_PATHS);
+            break;
+        case SEC_DERIVED:
+            img->derived_count = read_records(sec, body, img->derived, sizeof(DerivedConfig), DERIVED_MAX);
+            break;
+        case SEC_ASSETS:
+            img->asset_count = read_records(sec, body, img->assets, sizeof(BundleAsset), BUNDLE_ASSETS_MAX);
+            break;
+    }
+}
+
+// Check and decode a received bundle into `img`; nothing live is touched
+static bool bundle_parse(const uint8_t *data, size_t len, BundleImage *img) {
+    BundleHeader hdr;
+    if (!bundle_open(data, len, &hdr, img->err, sizeof(img->err))) return false;
+    img->flags = hdr.flags;
+
+    uint8_t *raw = (uint8_t *)bundle_alloc(hdr.raw_len ? hdr.raw_len : 1);
+    if (!raw) return bundle_fail(img, "Out of memory");
+    if (!bundle_unpack(data + sizeof(hdr), hdr.packed_len, raw, hdr.raw_len)) {
+        free(raw);
+        return bundle_fail(img, "Bundle data is corrupt");
+    }
+
+    // Start from the running configuration so shorter records keep it
+    live_device(&img->device, true);
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        memcpy(&img->screens[s], &screen_configs[s], sizeof(ScreenConfig));
+        memcpy(img->screens[s].cal, gauge_cal[s], sizeof(gauge_cal[s]));
+    }
+    memset(img->paths, 0, sizeof(img->paths));
+    memset(img->needles, 0, sizeof(img->needles));
+    memset(img->filters, 0, sizeof(img->filters));
+    memset(img->derived, 0, sizeof(img->derived));
+    memset(img->assets, 0, sizeof(img->assets));
+    img->cubic_mask = gauge_cal_cubic_mask;
+
+    bool ok = bundle_sections(raw, hdr.raw_len, read_section, img, &img->have, img->err, sizeof(img->err));
+    free(raw);
+    return ok && check_image(img);
+}
+
+// Replace the running configuration with the bundle's and re-apply the UI
+// in one pass. Runs under the UI lock. Returns true when network settings
+// changed (they are used from the next restart).
+static bool bundle_apply(const BundleImage *img, bool network) {
+    bool network_changed = false;
+    if (img->have & (1 << SEC_DEVICE)) {
+        const BundleDevice &d = img->device;
+        if (network) {
+            network_changed = saved_ssid != d.ssid || saved_signalk_ip != d.signalk_ip ||
+                              saved_signalk_port != d.signalk_port || saved_hostname != d.hostname;
+            saved_ssid = d.ssid;
+            if (img->flags & BUNDLE_HAS_PASSWORD) {
+                network_changed |= saved_password != d.password;
+                saved_password = d.password;
+            }
+            saved_signalk_ip = d.signalk_ip;
+            saved_signalk_port = d.signalk_port;
+            saved_hostname = d.hostname;
+        }
+        // Re-arm the first alarm beep only for a new mode, so importing the
+        // same settings does not sound the buzzer again
+        if (buzzer_mode != d.buzzer_mode) {
+            buzzer_mode = d.buzzer_mode;
+            first_run_buzzer = true;
+        }
+        buzzer_cooldown_sec = d.buzzer_cooldown;
+        LCD_Backlight = d.brightness;
+        Set_Backlight(LCD_Backlight);
+        auto_scroll_sec = d.auto_scroll;
+        set_auto_scroll_interval(auto_scroll_sec);
+    }
+    for (int i = 0; i < img->path_count; ++i) signalk_paths[i] = String(img->paths[i]);
+    for (int s = 0; s < img->screen_count; ++s) {
+        memcpy(&screen_configs[s], &img->screens[s], sizeof(ScreenConfig));
+        memcpy(gauge_cal[s], img->screens[s].cal, sizeof(gauge_cal[s]));
+    }
+    if (img->have & (1 << SEC_CAL_CUBIC)) gauge_cal_cubic_mask = img->cubic_mask;
+    gauge_cal_changed();
+    apply_all_screen_visuals();     // rebuilds alarms and resets redraw filters too
+    return network_changed;
+}
+
+// Store what bundle_apply() installed, without the UI lock: only the web
+// task writes the config, so it can read it back unlocked. Needle styles are
+// read from flash when applied, so they are applied once saved.
+static void bundle_store(const BundleImage *img) {
+    // Settings, paths and every screen in one pass
+    save_preferences();
+
+    for (int i = 0; i < img->needle_count; ++i) {
+        const BundleNeedle &n = img->needles[i];
+        save_needle_style_from_args(i / 2, i % 2, String(n.color), n.width, n.inner, n.outer, n.cx, n.cy,
+                                    n.flags & NEEDLE_ROUNDED, n.flags & NEEDLE_GRADIENT, n.flags & NEEDLE_FOREGROUND,
+                                    n.damping_ms, n.max_rate);
+    }
+    // Both keep their own lock
+    if (img->have & (1 << SEC_FILTERS)) signal_filter_set_config(img->filters, img->filter_count);
+    if (img->have & (1 << SEC_DERIVED)) derived_values_set_config(img->derived, img->derived_count);
+
+    refresh_signalk_subscriptions();
+    fetch_all_metadata();
+    if (img->needle_count) {
+        ui_lock();
+        apply_all_needle_styles();
+        ui_unlock();
+    }
+}
+
+// ---- Handlers -----------------------------------------------------------------
+
+static void bundle_free(void) {
+    free(bundle_buf);
+    bundle_buf = NULL;
+    bundle_len = 0;
+}
+
+static void bundle_upload(void) {
+    HttpUpload &upload = bundle_server->upload();
+    if (upload.status == UPLOAD_FILE_START) {
+        bundle_free();
+        bundle_overflow = false;
+        bundle_uploaded = true;
+        bundle_buf = (uint8_t *)bundle_alloc(CONFIG_BUNDLE_MAX_SIZE);
+    } else if (upload.status == UPLOAD_FILE_WRITE) {
+        if (!bundle_buf || bundle_overflow) return;
+        if (bundle_len + upload.currentSize > CONFIG_BUNDLE_MAX_SIZE) {
+            bundle_overflow = true;
+            return;
+        }
+        memcpy(bundle_buf + bundle_len, upload.buf, upload.currentSize);
+        bundle_len += upload.currentSize;
+    } else if (upload.status == UPLOAD_FILE_ABORTED) {
+        bundle_free();
+        bundle_uploaded = false;
+    }
+}
+
+static void handle_bundle_get(void) {
+    uint32_t t0 = millis();
+    size_t len = 0;
+    uint8_t *data = config_bundle_export(bundle_server->arg("password") != "0", &len);
+    if (!data) {
+        web_json_error(500, "Out of memory");
+        return;
+    }
+    String name = saved_hostname.length() ? saved_hostname : String("display");
+    bundle_server->sendHeader("Content-Disposition", "attachment; filename=\"" + name + ".mdcb\"");
+    bundle_server->send(200, "application/octet-stream", (const char *)data, len);
+    free(data);
+    Serial.printf("[BUNDLE] Exported %u bytes in %lu ms\n", (unsigned)len, (unsigned long)(millis() - t0));
+}
+
+static void handle_bundle_post(void) {
+    bool uploaded = bundle_uploaded;
+    bundle_uploaded = false;
+    if (!uploaded) {
+        web_json_error(400, "No bundle file in the request");
+        return;
+    }
+    if (!bundle_buf || bundle_overflow) {
+        bundle_free();
+        web_json_error(bundle_buf ? 413 : 500, bundle_buf ? "Bundle is too large" : "Out of memory");
+        return;
+    }
+    uint32_t t0 = millis();
+    BundleImage *img = (BundleImage *)bundle_alloc(sizeof(BundleImage));
+    if (!img) {
+        bundle_free();
+        web_json_error(500, "Out of memory");
+        return;
+    }
+    memset(img, 0, sizeof(*img));
+    size_t len = bundle_len;
+    bool ok = bundle_parse(bundle_buf, len, img);
+    bundle_free();
+    if (!ok) {
+        Serial.printf("[BUNDLE] Import rejected: %s\n", img->err);
+        web_json_error(400, img->err);
+        free(img);
+        return;
+    }
+
+    bool network = bundle_server->arg("network") != "0";
+    ui_lock();
+    uint32_t t_lock = millis();
+    bool network_changed = bundle_apply(img, network);
+    ui_unlock();
+    uint32_t t_applied = millis();
+    bundle_store(img);
+    uint32_t t_done = millis();
+
+    String json = "{\"ok\":true,\"bytes\":" + String((unsigned)len) + ",\"sections\":[";
+    bool first = true;
+    for (int t = 1; t < SEC_COUNT; ++t) {
+        if (!(img->have & (1 << t))) continue;
+        if (!first) json += ',';
+        json += "\"" + String(BUNDLE_SECTION_NAMES[t]) + "\"";
+        first = false;
+    }
+    json += "],\"screens\":" + String(img->screen_count);
+    json += ",\"password\":" + String(img->flags & BUNDLE_HAS_PASSWORD ? "true" : "false");
+    json += ",\"restart_required\":" + String(network_changed ? "true" : "false");
+    // Referenced assets against this unit's index
+    int n_list = 0;
+    AssetEntry *list = asset_index_snapshot(&n_list);
+    int missing = 0;
+    json += ",\"assets\":[";
+    for (int i = 0; i < img->asset_count; ++i) {
+        const BundleAsset &a = img->assets[i];
+        const AssetEntry *e = find_asset(list, n_list, a.name);
+        const char *state = !e ? "missing" : (a.size && (e->size != a.size || e->crc32 != a.crc32)) ? "differs" : "ok";
+        if (!e) ++missing;
+        if (i) json += ',';
+        json += "{\"name\":";
+        web_json_str(json, a.name);
+        json += ",\"state\":\"" + String(state) + "\"}";
+    }
+    free(list);
+    json += "],\"ms\":" + String(t_done - t0) + ",\"apply_ms\":" + String(t_applied - t_lock);
+    json += ",\"store_ms\":" + String(t_done - t_applied) + "}";
+    bundle_server->send(200, "application/json", json);
+    Serial.printf("[BUNDLE] Imported %u bytes (%d screens, %d assets missing): parse %lu ms, apply %lu ms, store %lu ms\n",
+                  (unsigned)len, img->screen_count, missing, (unsigned long)(t_lock - t0),
+                  (unsigned long)(t_applied - t_lock), (unsigned long)(t_done - t_applied));
+    free(img);
+}
+
+void config_bundle_register(HttpServer &server) {
+    bundle_server = &server;
+    // Both run without the UI lock; the import takes it only to apply,
+    // after the upload has been received and checked, and stores after it
+    web_on(server, "/api/config/bundle", HTTP_GET, handle_bundle_get, 0);
+    web_on(server, "/api/config/bundle", HTTP_POST, handle_bundle_post, 0, CONFIG_BUNDLE_MAX_SIZE + 1024, bundle_upload);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+#include "http_server.h"
+#include "config_bundle_codec.h"
+
+// The whole display configuration as one binary file, for backups and for
+// cloning a unit onto another.
+//
+//   GET  /api/config/bundle[?password=0]   download display-config.mdcb
+//   POST /api/config/bundle[?network=0]    multipart upload of a bundle
+//
+// e.g. curl -o display.mdcb http://<display>/api/config/bundle
+//      curl -F bundle=@display.mdcb http://<other-display>/api/config/bundle
+//
+// A bundle holds every screen (with its calibration), the Signal K paths,
+// needle styles, device and network settings, signal filters, derived values
+// and the size and CRC-32 of each asset the screens reference. It is a
+// CONFIG_BUNDLE_MAGIC header followed by tagged sections; runs of zero bytes
+// (mostly unused string space) are packed, so a full bundle is a few KB. The
+// header carries the packed length and a CRC-32 over the packed data. The
+// format itself is in config_bundle_codec.h.
+//
+// Import checks the header, CRC and every section into a working copy
+// before anything changes. Then it replaces the running configuration and
+// re-applies the UI in one hot-update pass under the UI lock, and stores it
+// once after releasing the lock.
+// Sections the bundle lacks are left as they are. Screens written by older
+// firmware (a shorter ScreenConfig) keep the current values of the newer
+// fields. Assets are not copied; the response lists referenced files that
+// are missing or differ from the bundle. Network settings take effect on the
+// next restart; ?network=0 keeps this unit's own.
+
+// Build the bundle for the current configuration into a heap buffer (free()
+// it). Returns NULL when out of memory.
+uint8_t *config_bundle_export(bool with_password, size_t *len);
+
+// Register GET/POST /api/config/bundle
+void config_bundle_register(HttpServer &server);
@@ -0,0 +1,115 @@
+#include "config_bundle_codec.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+const char *const BUNDLE_SECTION_NAMES[SEC_COUNT] = {
+    "", "device", "paths", "screens", "cal_cubic", "needles", "filters", "derived", "assets",
+};
+
+static bool fail(char *err, size_t err_len, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(err, err_len, fmt, ap);
+    va_end(ap);
+    return false;
+}
+
+// ---- Zero-run packing ---------------------------------------------------------
+// Worst case (isolated zeros) doubles the size.
+
+size_t bundle_pack(const uint8_t *in, size_t len, uint8_t *out) {
+    size_t o = 0;
+    for (size_t i = 0; i < len;) {
+        if (in[i]) {
+            out[o++] = in[i++];
+            continue;
+        }
+        size_t run = 1;
+        while (i + run < len && run < 255 && in[i + run] == 0) ++run;
+        out[o++] = 0;
+        out[o++] = (uint8_t)run;
+        i += run;
+    }
+    return o;
+}
+
+bool bundle_unpack(const uint8_t *in, size_t len, uint8_t *out, size_t out_len) {
+    size_t o = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (in[i]) {
+            if (o >= out_len) return false;
+            out[o++] = in[i];
+            continue;
+        }
+        if (++i >= len || in[i] == 0 || o + in[i] > out_len) return false;
+        memset(out + o, 0, in[i]);
+        o += in[i];
+    }
+    return o == out_len;
+}
+
+// ---- Header -------------------------------------------------------------------
+
+// Reflected polynomial 0xEDB88320, four bits at a time
+uint32_t bundle_crc32(const uint8_t *data, size_t len) {
+    static const uint32_t nibble[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ nibble[crc & 0x0F];
+        crc = (crc >> 4) ^ nibble[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+size_t bundle_seal(const uint8_t *raw, size_t raw_len, uint8_t flags, uint8_t *out) {
+    BundleHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, CONFIG_BUNDLE_MAGIC, sizeof(hdr.magic));
+    hdr.version = CONFIG_BUNDLE_VERSION;
+    hdr.flags = flags;
+    hdr.raw_len = (uint32_t)raw_len;
+    hdr.packed_len = (uint32_t)bundle_pack(raw, raw_len, out + sizeof(hdr));
+    hdr.crc32 = bundle_crc32(out + sizeof(hdr), hdr.packed_len);
+    memcpy(out, &hdr, sizeof(hdr));
+    return sizeof(hdr) + hdr.packed_len;
+}
+
+bool bundle_open(const uint8_t *data, size_t len, BundleHeader *hdr, char *err, size_t err_len) {
+    if (len < sizeof(*hdr)) return fail(err, err_len, "Not a config bundle");
+    memcpy(hdr, data, sizeof(*hdr));
+    if (memcmp(hdr->magic, CONFIG_BUNDLE_MAGIC, sizeof(hdr->magic)) != 0) return fail(err, err_len, "Not a config bundle");
+    if (hdr->version != CONFIG_BUNDLE_VERSION)
+        return fail(err, err_len, "Bundle version %u is not supported (this firmware reads %u)", hdr->version,
+                    CONFIG_BUNDLE_VERSION);
+    if (hdr->packed_len != len - sizeof(*hdr)) return fail(err, err_len, "Bundle is truncated");
+    if (bundle_crc32(data + sizeof(*hdr), hdr->packed_len) != hdr->crc32) return fail(err, err_len, "Bundle CRC mismatch");
+    if (hdr->raw_len > CONFIG_BUNDLE_MAX_SIZE) return fail(err, err_len, "Bundle is too large");
+    return true;
+}
+
+// ---- Sections -----------------------------------------------------------------
+
+bool bundle_sections(const uint8_t *raw, size_t raw_len, BundleSectionFn fn, void *ctx, uint16_t *have, char *err,
+                     size_t err_len) {
+    size_t off = 0;
+    while (off < raw_len) {
+        BundleSection sec;
+        if (raw_len - off < sizeof(sec)) return fail(err, err_len, "Bundle data is corrupt");
+        memcpy(&sec, raw + off, sizeof(sec));
+        off += sizeof(sec);
+        size_t body_len = (size_t)sec.count * sec.rec_size;
+        if (raw_len - off < body_len) return fail(err, err_len, "Bundle data is corrupt");
+        const uint8_t *body = raw + off;
+        off += body_len;
+        if (sec.tag == 0 || sec.tag >= SEC_COUNT) continue;
+        if (*have & (1 << sec.tag)) return fail(err, err_len, "Duplicate %s section", BUNDLE_SECTION_NAMES[sec.tag]);
+        *have |= 1 << sec.tag;
+        fn(ctx, &sec, body);
+    }
+    return true;
+}
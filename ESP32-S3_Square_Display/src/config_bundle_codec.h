@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// File format of the configuration bundle (config_bundle.h), kept free of
+// Arduino/IDF so it can be tested on the host (test/test_config_bundle_codec).
+//
+// A BundleHeader followed by the packed section data. Unpacked, the data is
+// a run of sections, each a BundleSection followed by `count` records of
+// `rec_size` bytes. Packing replaces every run of zero bytes with a zero
+// and the run length (1..255); other bytes are stored as is.
+
+#define CONFIG_BUNDLE_MAGIC     "MDCB"
+#define CONFIG_BUNDLE_VERSION   1
+#define CONFIG_BUNDLE_MAX_SIZE  (64 * 1024)    // packed or unpacked
+#define BUNDLE_HAS_PASSWORD     0x01
+#define BUNDLE_ERR_LEN          80
+
+// Section tags; unknown tags are skipped on import
+enum {
+    SEC_DEVICE = 1,
+    SEC_PATHS,
+    SEC_SCREENS,
+    SEC_CAL_CUBIC,
+    SEC_NEEDLES,
+    SEC_FILTERS,
+    SEC_DERIVED,
+    SEC_ASSETS,
+    SEC_COUNT
+};
+
+extern const char *const BUNDLE_SECTION_NAMES[SEC_COUNT];
+
+typedef struct __attribute__((packed)) {
+    char magic[4];
+    uint8_t version;
+    uint8_t flags;          // BUNDLE_HAS_PASSWORD
+    uint16_t reserved;
+    uint32_t raw_len;       // section data once unpacked
+    uint32_t packed_len;    // bytes after the header
+    uint32_t crc32;         // of those bytes
+} BundleHeader;
+
+// Records grow by appending fields, so a reader copies the part both sides know
+typedef struct __attribute__((packed)) {
+    uint8_t tag;
+    uint8_t count;
+    uint16_t rec_size;
+} BundleSection;
+
+// Called for each known section with its `count * rec_size` bytes of records
+typedef void (*BundleSectionFn)(void *ctx, const BundleSection *sec, const uint8_t *body);
+
+// Pack `len` bytes into `out`, which must hold 2 * len; returns the packed size
+size_t bundle_pack(const uint8_t *in, size_t len, uint8_t *out);
+
+// False unless the packed data expands to exactly `out_len` bytes
+bool bundle_unpack(const uint8_t *in, size_t len, uint8_t *out, size_t out_len);
+
+// CRC-32 (IEEE), the same as esp_rom_crc32_le(0, data, len)
+uint32_t bundle_crc32(const uint8_t *data, size_t len);
+
+// Header plus packed `raw` into `out` (sizeof(BundleHeader) + 2 * raw_len
+// bytes); returns the bundle size
+size_t bundle_seal(const uint8_t *raw, size_t raw_len, uint8_t flags, uint8_t *out);
+
+// Check the magic, version, length and CRC of a received bundle and copy
+// out its header. On failure `err` holds the reason.
+bool bundle_open(const uint8_t *data, size_t len, BundleHeader *hdr, char *err, size_t err_len);
+
+// Walk unpacked section data, calling `fn` for every known tag and marking
+// it in `*have` (1 << tag). Fails on a section running past the end or a
+// tag seen twice.
+bool bundle_sections(const uint8_t *raw, size_t raw_len, BundleSectionFn fn, void *ctx, uint16_t *have, char *err,
+                     size_t err_len);
+
+#ifdef __cplusplus
+}
+#endif
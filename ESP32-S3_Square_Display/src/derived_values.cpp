@@ -0,0 +1,215 @@
+#include "derived_values.h"
+#include "signalk_config.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <math.h>
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+extern Preferences preferences;
+
+#define DERIVED_PREF_KEY "derived"
+#define DERIVED_INPUT_SLOTS (DERIVED_MAX * EXPR_INPUT_MAX)
+
+// One distinct input path shared by every formula that reads it
+typedef struct {
+    char path[EXPR_PATH_LEN];
+    uint32_t hash;
+    float value;
+    uint32_t gen;           // 0 = no value received yet
+} DerivedInput;
+
+typedef struct {
+    ExprProgram prog;
+    uint8_t slot[EXPR_INPUT_MAX];       // prog.inputs[i] -> DerivedInput index
+    uint32_t seen_gen[EXPR_INPUT_MAX];  // generations used by the last evaluation
+    DerivedStatus status;
+} DerivedEntry;
+
+typedef struct {
+    DerivedConfig cfg[DERIVED_MAX];
+    DerivedEntry entry[DERIVED_MAX];
+    DerivedInput input[DERIVED_INPUT_SLOTS];
+    int count;
+    int n_inputs;
+} DerivedTable;
+
+static DerivedTable *derived = NULL;     // in PSRAM
+static SemaphoreHandle_t derived_mutex = NULL;
+
+static uint32_t fnv1a(const char *s) {
+    uint32_t h = 2166136261UL;
+    while (*s) { h ^= (uint8_t)*s++; h *= 16777619UL; }
+    return h;
+}
+
+static int input_find(const char *path, uint32_t hash) {
+    for (int i = 0; i < derived->n_inputs; i++) {
+        if (derived->input[i].hash == hash && strcmp(derived->input[i].path, path) == 0) return i;
+    }
+    return -1;
+}
+
+// Compile every entry and rebuild the shared input table; caller holds the mutex
+static void derived_store(const DerivedConfig *cfg, int count) {
+    derived->count = 0;
+    derived->n_inputs = 0;
+    memset(derived->entry, 0, sizeof(derived->entry));
+    for (int i = 0; i < count && derived->count < DERIVED_MAX; i++) {
+        if (!cfg[i].name[0]) continue;
+        DerivedConfig *c = &derived->cfg[derived->count];
+        *c = cfg[i];
+        c->name[DERIVED_NAME_LEN - 1] = '\0';
+        c->formula[DERIVED_FORMULA_LEN - 1] = '\0';
+        DerivedEntry *e = &derived->entry[derived->count];
+        derived->count++;
+
+        e->status.value = NAN;
+        e->status.compiled = expr_compile(c->formula, &e->prog, e->status.error, sizeof(e->status.error));
+        e->status.code_len = e->prog.code_len;
+        if (!e->status.compiled) {
+            Serial.printf("[DERIVED] %s: %s\n", c->name, e->status.error);
+            continue;
+        }
+        for (int k = 0; k < e->prog.n_inputs; k++) {
+            const char *p = e->prog.inputs[k];
+            uint32_t h = fnv1a(p);
+            int slot = input_find(p, h);
+            if (slot < 0) {
+                slot = derived->n_inputs++;
+                DerivedInput *in = &derived->input[slot];
+                memcpy(in->path, p, EXPR_PATH_LEN);
+                in->hash = h;
+                in->value = NAN;
+                in->gen = 0;
+            }
+            e->slot[k] = (uint8_t)slot;
+        }
+    }
+}
+
+void derived_values_init(void) {
+    if (!derived_mutex) derived_mutex = xSemaphoreCreateMutex();
+    if (!derived) {
+        derived = (DerivedTable *)heap_caps_calloc(1, sizeof(DerivedTable), MALLOC_CAP_SPIRAM);
+        if (!derived) {
+            Serial.println("[DERIVED] Out of PSRAM; derived values disabled");
+            return;
+        }
+    }
+    DerivedConfig loaded[DERIVED_MAX];
+    memset(loaded, 0, sizeof(loaded));
+    size_t got = 0;
+    if (preferences.begin("settings", true)) {
+        got = preferences.getBytes(DERIVED_PREF_KEY, loaded, sizeof(loaded));
+        preferences.end();
+    }
+    xSemaphoreTake(derived_mutex, portMAX_DELAY);
+    derived_store(loaded, (int)(got / sizeof(DerivedConfig)));
+    int n = derived->count;
+    xSemaphoreGive(derived_mutex);
+    Serial.printf("[DERIVED] %d derived value(s)\n", n);
+}
+
+void derived_values_input(const char *path, float value) {
+    if (!derived || !path) return;
+    uint32_t h = fnv1a(path);
+    if (xSemaphoreTake(derived_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+    int i = input_find(path, h);
+    if (i >= 0) {
+        derived->input[i].value = value;
+        derived->input[i].gen++;
+    }
+    xSemaphoreGive(derived_mutex);
+}
+
+void derived_values_update(void) {
+    if (!derived) return;
+    int out_idx[DERIVED_MAX];
+    float out_val[DERIVED_MAX];
+    int n_out = 0;
+
+    if (xSemaphoreTake(derived_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+    for (int d = 0; d < derived->count; d++) {
+        DerivedEntry *e = &derived->entry[d];
+        if (!e->status.compiled) continue;
+        float args[EXPR_INPUT_MAX];
+        bool changed = false, ready = true;
+        for (int k = 0; k < e->prog.n_inputs; k++) {
+            const DerivedInput *in = &derived->input[e->slot[k]];
+            if (in->gen == 0) ready = false;
+            if (in->gen != e->seen_gen[k]) changed = true;
+            args[k] = in->value;
+        }
+        // Constant formulas are published once; others wait for every input
+        if (!ready || (!changed && e->status.evals > 0)) continue;
+        for (int k = 0; k < e->prog.n_inputs; k++) e->seen_gen[k] = derived->input[e->slot[k]].gen;
+        float v = expr_eval(&e->prog, args);
+        if (!isfinite(v)) v = NAN;   // e.g. range with zero fuel rate shows as no data
+        e->status.value = v;
+        e->status.evals++;
+        out_idx[n_out] = d;
+        out_val[n_out++] = v;
+    }
+    // Publish outside the lock; names are only rewritten by set_config
+    char names[DERIVED_MAX][DERIVED_NAME_LEN];
+    for (int i = 0; i < n_out; i++) memcpy(names[i], derived->cfg[out_idx[i]].name, DERIVED_NAME_LEN);
+    xSemaphoreGive(derived_mutex);
+
+    for (int i = 0; i < n_out; i++) publish_sensor_value_by_path(names[i], out_val[i]);
+}
+
+bool derived_values_is_output(const char *path) {
+    if (!derived || !path) return false;
+    bool found = false;
+    xSemaphoreTake(derived_mutex, portMAX_DELAY);
+    for (int d = 0; d < derived->count && !found; d++) found = strcmp(derived->cfg[d].name, path) == 0;
+    xSemaphoreGive(derived_mutex);
+    return found;
+}
+
+bool derived_values_input_path(int index, char *out, size_t len) {
+    if (!derived || !out || len == 0 || index < 0) return false;
+    xSemaphoreTake(derived_mutex, portMAX_DELAY);
+    bool ok = index < derived->n_inputs;
+    if (ok) snprintf(out, len, "%s", derived->input[index].path);
+    xSemaphoreGive(derived_mutex);
+    return ok;
+}
+
+int derived_values_get_config(DerivedConfig *out, int max) {
+    if (!derived || !out) return 0;
+    xSemaphoreTake(derived_mutex, portMAX_DELAY);
+    int n = derived->count < max ? derived->count : max;
+    memcpy(out, derived->cfg, n * sizeof(DerivedConfig));
+    xSemaphoreGive(derived_mutex);
+    return n;
+}
+
+void derived_values_get_status(int index, DerivedStatus *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    out->value = NAN;
+    if (!derived || index < 0) return;
+    xSemaphoreTake(derived_mutex, portMAX_DELAY);
+    if (index < derived->count) *out = derived->entry[index].status;
+    xSemaphoreGive(derived_mutex);
+}
+
+void derived_values_set_config(const DerivedConfig *cfg, int count) {
+    if (!derived) return;
+    xSemaphoreTake(derived_mutex, portMAX_DELAY);
+    derived_store(cfg, count);
+    DerivedConfig saved[DERIVED_MAX];
+    int n = derived->count;
+    memcpy(saved, derived->cfg, n * sizeof(DerivedConfig));
+    xSemaphoreGive(derived_mutex);
+
+    if (preferences.begin("settings", false)) {
+        if (n > 0) preferences.putBytes(DERIVED_PREF_KEY, saved, n * sizeof(DerivedConfig));
+        else preferences.remove(DERIVED_PREF_KEY);
+        preferences.end();
+    }
+    Serial.printf("[DERIVED] Saved %d derived value(s)\n", n);
+}
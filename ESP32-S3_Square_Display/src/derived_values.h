@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "expression.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// User formulas over Signal K paths, published as virtual paths.
+//
+// Each entry names an output path (e.g. "derived.trueWindSpeed") and a
+// formula (see expression.h). Formulas are compiled when the configuration
+// is loaded or saved. Every input path has a generation counter that is
+// bumped when a new value arrives; after each Signal K message, only the
+// formulas with a changed input are evaluated. The result is stored like
+// any Signal K value, so every widget, alarm and statistic can bind the
+// output path. Evaluation does not allocate.
+
+#define DERIVED_MAX           8
+#define DERIVED_NAME_LEN      64
+#define DERIVED_FORMULA_LEN   160
+
+typedef struct __attribute__((packed)) {
+    char name[DERIVED_NAME_LEN];        // output path; empty = unused entry
+    char formula[DERIVED_FORMULA_LEN];
+} DerivedConfig;
+
+typedef struct {
+    bool compiled;
+    char error[48];         // compile error when !compiled
+    float value;            // last published result (NaN before the first)
+    uint32_t evals;
+    uint8_t code_len;       // bytecode size in bytes
+} DerivedStatus;
+
+// Load and compile the configuration from preferences. Call once before Signal K starts.
+void derived_values_init(void);
+
+// Note a new value for a path; cheap no-op for paths no formula reads
+void derived_values_input(const char *path, float value);
+
+// Evaluate formulas whose inputs changed and publish their results
+void derived_values_update(void);
+
+// True if `path` is the output of a formula (not a Signal K server path)
+bool derived_values_is_output(const char *path);
+
+// Distinct input paths of all compiled formulas, by index; false past the end
+bool derived_values_input_path(int index, char *out, size_t len);
+
+// Copy out the configuration table; returns the number of used entries
+int derived_values_get_config(DerivedConfig *out, int max);
+void derived_values_get_status(int index, DerivedStatus *out);
+
+// Replace the whole configuration, recompile and persist it. Entries that
+// fail to compile are kept (so they can be fixed) but never evaluated.
+void derived_values_set_config(const DerivedConfig *cfg, int count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,301 @@
+#include "expression.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+// Opcodes; CONST, INPUT and the CALL ops take a one-byte operand
+enum {
+    OP_CONST = 0,
+    OP_INPUT,
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_POW,
+    OP_NEG,
+    OP_CALL1,
+    OP_CALL2
+};
+
+enum {
+    FN_ABS = 0, FN_SQRT, FN_SIN, FN_COS, FN_TAN, FN_ASIN, FN_ACOS, FN_ATAN,
+    FN_EXP, FN_LN, FN_LOG10, FN_DEG, FN_RAD,
+    FN_ATAN2, FN_HYPOT, FN_MIN, FN_MAX, FN_POW
+};
+
+typedef struct {
+    const char *name;
+    uint8_t id;
+    uint8_t args;
+} ExprFunc;
+
+static const ExprFunc expr_funcs[] = {
+    {"abs", FN_ABS, 1}, {"sqrt", FN_SQRT, 1}, {"sin", FN_SIN, 1}, {"cos", FN_COS, 1},
+    {"tan", FN_TAN, 1}, {"asin", FN_ASIN, 1}, {"acos", FN_ACOS, 1}, {"atan", FN_ATAN, 1},
+    {"exp", FN_EXP, 1}, {"ln", FN_LN, 1}, {"log10", FN_LOG10, 1}, {"deg", FN_DEG, 1},
+    {"rad", FN_RAD, 1}, {"atan2", FN_ATAN2, 2}, {"hypot", FN_HYPOT, 2}, {"min", FN_MIN, 2},
+    {"max", FN_MAX, 2}, {"pow", FN_POW, 2},
+};
+
+// ---- Compiler --------------------------------------------------------------
+
+typedef struct {
+    const char *src;
+    const char *p;
+    ExprProgram *prog;
+    int depth;              // stack depth after the code emitted so far
+    int nesting;            // parse_unary recursion depth
+    char *err;
+    size_t err_len;
+    bool failed;
+} ExprParser;
+
+static void expr_fail(ExprParser *ps, const char *msg) {
+    if (ps->failed) return;
+    ps->failed = true;
+    if (ps->err && ps->err_len) snprintf(ps->err, ps->err_len, "%s at position %d", msg, (int)(ps->p - ps->src) + 1);
+}
+
+static void skip_space(ExprParser *ps) {
+    while (isspace((unsigned char)*ps->p)) ps->p++;
+}
+
+static void emit(ExprParser *ps, uint8_t op, int stack_delta) {
+    if (ps->failed) return;
+    if (ps->prog->code_len >= EXPR_CODE_MAX) { expr_fail(ps, "Formula too long"); return; }
+    ps->prog->code[ps->prog->code_len++] = op;
+    ps->depth += stack_delta;
+    if (ps->depth > EXPR_STACK_MAX) { expr_fail(ps, "Formula nested too deeply"); return; }
+    if (ps->depth > ps->prog->max_stack) ps->prog->max_stack = (uint8_t)ps->depth;
+}
+
+static void emit_operand(ExprParser *ps, uint8_t op, uint8_t arg, int stack_delta) {
+    emit(ps, op, stack_delta);
+    if (ps->failed) return;
+    if (ps->prog->code_len >= EXPR_CODE_MAX) { expr_fail(ps, "Formula too long"); return; }
+    ps->prog->code[ps->prog->code_len++] = arg;
+}
+
+static void emit_const(ExprParser *ps, float v) {
+    ExprProgram *pr = ps->prog;
+    for (uint8_t i = 0; i < pr->n_consts; i++) {
+        if (pr->consts[i] == v) { emit_operand(ps, OP_CONST, i, 1); return; }
+    }
+    if (pr->n_consts >= EXPR_CONST_MAX) { expr_fail(ps, "Too many constants"); return; }
+    pr->consts[pr->n_consts] = v;
+    emit_operand(ps, OP_CONST, pr->n_consts++, 1);
+}
+
+static void emit_input(ExprParser *ps, const char *name, size_t len) {
+    ExprProgram *pr = ps->prog;
+    if (len >= EXPR_PATH_LEN) { expr_fail(ps, "Path too long"); return; }
+    for (uint8_t i = 0; i < pr->n_inputs; i++) {
+        if (strncmp(pr->inputs[i], name, len) == 0 && pr->inputs[i][len] == '\0') {
+            emit_operand(ps, OP_INPUT, i, 1);
+            return;
+        }
+    }
+    if (pr->n_inputs >= EXPR_INPUT_MAX) { expr_fail(ps, "Too many different paths"); return; }
+    memcpy(pr->inputs[pr->n_inputs], name, len);
+    pr->inputs[pr->n_inputs][len] = '\0';
+    emit_operand(ps, OP_INPUT, pr->n_inputs++, 1);
+}
+
+static void parse_expr(ExprParser *ps);
+static void parse_unary(ExprParser *ps);
+
+static void parse_call(ExprParser *ps, const char *name, size_t len) {
+    const ExprFunc *fn = NULL;
+    for (size_t i = 0; i < sizeof(expr_funcs) / sizeof(expr_funcs[0]); i++) {
+        if (strlen(expr_funcs[i].name) == len && strncmp(expr_funcs[i].name, name, len) == 0) fn = &expr_funcs[i];
+    }
+    if (!fn) { expr_fail(ps, "Unknown function"); return; }
+    ps->p++;  // '('
+    for (int a = 0; a < fn->args && !ps->failed; a++) {
+        if (a > 0) {
+            skip_space(ps);
+            if (*ps->p != ',') { expr_fail(ps, "Expected ','"); return; }
+            ps->p++;
+        }
+        parse_expr(ps);
+    }
+    skip_space(ps);
+    if (*ps->p != ')') { expr_fail(ps, "Expected ')'"); return; }
+    ps->p++;
+    if (fn->args == 1) emit_operand(ps, OP_CALL1, fn->id, 0);
+    else emit_operand(ps, OP_CALL2, fn->id, -1);
+}
+
+static void parse_primary(ExprParser *ps) {
+    skip_space(ps);
+    const char *start = ps->p;
+    if (*ps->p == '(') {
+        ps->p++;
+        parse_expr(ps);
+        skip_space(ps);
+        if (*ps->p != ')') { expr_fail(ps, "Expected ')'"); return; }
+        ps->p++;
+    } else if (isdigit((unsigned char)*ps->p) || (*ps->p == '.' && isdigit((unsigned char)ps->p[1]))) {
+        char *end;
+        float v = strtof(ps->p, &end);
+        ps->p = end;
+        emit_const(ps, v);
+    } else if (isalpha((unsigned char)*ps->p) || *ps->p == '_') {
+        while (isalnum((unsigned char)*ps->p) || *ps->p == '_' || *ps->p == '.') ps->p++;
+        size_t len = (size_t)(ps->p - start);
+        if (start[len - 1] == '.') { expr_fail(ps, "Path ends with '.'"); return; }
+        skip_space(ps);
+        if (*ps->p == '(') {
+            parse_call(ps, start, len);
+        } else if (len == 2 && strncmp(start, "pi", 2) == 0) {
+            emit_const(ps, (float)PI);
+        } else {
+            emit_input(ps, start, len);
+        }
+    } else {
+        expr_fail(ps, *ps->p ? "Unexpected character" : "Unexpected end of formula");
+    }
+}
+
+static void parse_power(ExprParser *ps) {
+    parse_primary(ps);
+    skip_space(ps);
+    if (!ps->failed && *ps->p == '^') {
+        ps->p++;
+        parse_unary(ps);     // right-associative, and 2^-1 is allowed
+        emit(ps, OP_POW, -1);
+    }
+}
+
+// Every nested construct (parentheses, call arguments, signs, exponents)
+// passes through here, so this bounds the recursion
+static void parse_unary(ExprParser *ps) {
+    if (ps->failed) return;
+    if (++ps->nesting > EXPR_MAX_NESTING) {
+        expr_fail(ps, "Formula nested too deeply");
+        ps->nesting--;
+        return;
+    }
+    skip_space(ps);
+    if (*ps->p == '-') {
+        ps->p++;
+        parse_unary(ps);
+        emit(ps, OP_NEG, 0);
+    } else if (*ps->p == '+') {
+        ps->p++;
+        parse_unary(ps);
+    } else {
+        parse_power(ps);
+    }
+    ps->nesting--;
+}
+
+static void parse_term(ExprParser *ps) {
+    parse_unary(ps);
+    for (;;) {
+        skip_space(ps);
+        char c = *ps->p;
+        if (ps->failed || (c != '*' && c != '/')) return;
+        ps->p++;
+        parse_unary(ps);
+        emit(ps, c == '*' ? OP_MUL : OP_DIV, -1);
+    }
+}
+
+static void parse_expr(ExprParser *ps) {
+    parse_term(ps);
+    for (;;) {
+        skip_space(ps);
+        char c = *ps->p;
+        if (ps->failed || (c != '+' && c != '-')) return;
+        ps->p++;
+        parse_term(ps);
+        emit(ps, c == '+' ? OP_ADD : OP_SUB, -1);
+    }
+}
+
+bool expr_compile(const char *src, ExprProgram *out, char *err, size_t err_len) {
+    if (!out) return false;
+    memset(out, 0, sizeof(*out));
+    if (err && err_len) err[0] = '\0';
+    ExprParser ps = {src ? src : "", src ? src : "", out, 0, 0, err, err_len, false};
+    skip_space(&ps);
+    if (!*ps.p) {
+        expr_fail(&ps, "Empty formula");
+        return false;
+    }
+    parse_expr(&ps);
+    skip_space(&ps);
+    if (!ps.failed && *ps.p) expr_fail(&ps, "Unexpected character");
+    if (ps.failed) {
+        out->code_len = 0;
+        return false;
+    }
+    return true;
+}
+
+// ---- Evaluator -------------------------------------------------------------
+
+static float call1(uint8_t fn, float a) {
+    switch (fn) {
+        case FN_ABS:   return fabsf(a);
+        case FN_SQRT:  return sqrtf(a);
+        case FN_SIN:   return sinf(a);
+        case FN_COS:   return cosf(a);
+        case FN_TAN:   return tanf(a);
+        case FN_ASIN:  return asinf(a);
+        case FN_ACOS:  return acosf(a);
+        case FN_ATAN:  return atanf(a);
+        case FN_EXP:   return expf(a);
+        case FN_LN:    return logf(a);
+        case FN_LOG10: return log10f(a);
+        case FN_DEG:   return a * (float)(180.0 / PI);
+        case FN_RAD:   return a * (float)(PI / 180.0);
+        default:       return NAN;
+    }
+}
+
+// fminf/fmaxf return the other argument for a NaN, and powf(1, NaN) and
+// hypotf(inf, NaN) are not NaN either; a missing input must not look valid
+static float call2(uint8_t fn, float a, float b) {
+    if (isnan(a) || isnan(b)) return NAN;
+    switch (fn) {
+        case FN_ATAN2: return atan2f(a, b);
+        case FN_HYPOT: return hypotf(a, b);
+        case FN_MIN:   return fminf(a, b);
+        case FN_MAX:   return fmaxf(a, b);
+        case FN_POW:   return powf(a, b);
+        default:       return NAN;
+    }
+}
+
+float expr_eval(const ExprProgram *p, const float *inputs) {
+    if (!p || p->code_len == 0) return NAN;
+    // Stack depth was bounded by the compiler, so no checks are needed here
+    float stack[EXPR_STACK_MAX];
+    int sp = 0;
+    const uint8_t *pc = p->code;
+    const uint8_t *end = p->code + p->code_len;
+    while (pc < end) {
+        switch (*pc++) {
+            case OP_CONST: stack[sp++] = p->consts[*pc++]; break;
+            case OP_INPUT: stack[sp++] = inputs[*pc++]; break;
+            case OP_ADD:   sp--; stack[sp - 1] += stack[sp]; break;
+            case OP_SUB:   sp--; stack[sp - 1] -= stack[sp]; break;
+            case OP_MUL:   sp--; stack[sp - 1] *= stack[sp]; break;
+            case OP_DIV:   sp--; stack[sp - 1] /= stack[sp]; break;
+            case OP_POW:   sp--; stack[sp - 1] = call2(FN_POW, stack[sp - 1], stack[sp]); break;
+            case OP_NEG:   stack[sp - 1] = -stack[sp - 1]; break;
+            case OP_CALL1: stack[sp - 1] = call1(*pc++, stack[sp - 1]); break;
+            case OP_CALL2: sp--; stack[sp - 1] = call2(*pc++, stack[sp - 1], stack[sp]); break;
+            default:       return NAN;
+        }
+    }
+    return sp == 1 ? stack[0] : NAN;
+}
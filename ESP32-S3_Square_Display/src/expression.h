@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Arithmetic formulas over Signal K paths, compiled once into a small stack
+// bytecode and evaluated without allocation.
+//
+// Grammar: numbers, Signal K paths (letters, digits, '_' and '.'), the
+// constant pi, + - * / ^ (right-associative power), unary minus,
+// parentheses and the functions
+//   abs sqrt sin cos tan asin acos atan exp ln log10 deg rad   (one argument)
+//   atan2 hypot min max pow                                    (two arguments)
+// for example: hypot(environment.wind.speedApparent * cos(environment.wind.angleApparent)
+//              - navigation.speedThroughWater, environment.wind.speedApparent
+//              * sin(environment.wind.angleApparent))
+// This module has no Arduino dependencies so it also builds on a host.
+
+#define EXPR_CODE_MAX    96
+#define EXPR_CONST_MAX   16
+#define EXPR_INPUT_MAX   6
+#define EXPR_STACK_MAX   16
+#define EXPR_PATH_LEN    96
+#define EXPR_MAX_NESTING 32     // parentheses, calls and unary signs
+
+typedef struct {
+    uint8_t code[EXPR_CODE_MAX];
+    uint8_t code_len;
+    uint8_t n_consts;
+    uint8_t n_inputs;
+    uint8_t max_stack;                          // deepest stack use, checked at compile time
+    float consts[EXPR_CONST_MAX];
+    char inputs[EXPR_INPUT_MAX][EXPR_PATH_LEN]; // paths in first-use order
+} ExprProgram;
+
+// Compile `src` into `out`. On failure returns false and writes a message
+// with the character position into `err`.
+bool expr_compile(const char *src, ExprProgram *out, char *err, size_t err_len);
+
+// Run a compiled program; inputs[i] is the current value of out->inputs[i].
+// NaN inputs propagate to a NaN result, including through min, max and pow.
+float expr_eval(const ExprProgram *p, const float *inputs);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,181 @@
+#include "frame_governor.h"
+#include <Arduino.h>
+#include <lvgl.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#if FRAME_GOV_USE_PM
+#include "esp_pm.h"
+#endif
+
+typedef struct {
+    uint16_t refr_ms;       // LVGL display refresh timer period
+    uint16_t indev_ms;      // LVGL touch read timer period
+    uint16_t loop_ms;       // longest sleep at the end of loop()
+} FrameGovRates;
+
+// ACTIVE matches lv_conf.h (LV_DISP_DEF_REFR_PERIOD / LV_INDEV_DEF_READ_PERIOD)
+static const FrameGovRates gov_rates[FRAME_GOV_MODE_COUNT] = {
+    { 16, 10, 1 },
+    { 50, 30, 5 },
+    { 200, 60, 20 },
+};
+static const char *gov_mode_names[FRAME_GOV_MODE_COUNT] = {"active", "idle", "deep idle"};
+
+static TaskHandle_t gov_loop_task = NULL;
+static FrameGovMode gov_mode = FRAME_GOV_ACTIVE;
+static unsigned long gov_last_activity = 0;
+static volatile bool gov_kicked = false;
+
+// Written by the LVGL monitor callback, which runs inside lv_timer_handler()
+// on the loop task, so no locking is needed
+static uint32_t gov_frames = 0;
+static uint32_t gov_render_ms_max = 0;
+static uint32_t gov_frames_seen = 0;
+
+static uint32_t gov_loops = 0;
+static unsigned long gov_stats_start = 0;
+static unsigned long gov_active_ms = 0;
+static unsigned long gov_mode_since = 0;
+static FrameGovStats gov_stats = {FRAME_GOV_ACTIVE, 0, 0, 0, 100};
+static portMUX_TYPE gov_stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+#if FRAME_GOV_USE_PM
+static esp_pm_lock_handle_t gov_pm_lock = NULL;
+#endif
+
+static void gov_monitor_cb(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px) {
+    (void)drv;
+    (void)px;
+    gov_frames++;
+    if (time_ms > gov_render_ms_max) gov_render_ms_max = time_ms;
+}
+
+static void gov_apply(FrameGovMode mode) {
+    const FrameGovRates *r = &gov_rates[mode];
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp && disp->refr_timer) {
+        lv_timer_set_period(disp->refr_timer, r->refr_ms);
+        if (mode == FRAME_GOV_ACTIVE) lv_timer_ready(disp->refr_timer);
+    }
+    for (lv_indev_t *indev = lv_indev_get_next(NULL); indev; indev = lv_indev_get_next(indev)) {
+        if (!indev->driver || !indev->driver->read_timer) continue;
+        lv_timer_set_period(indev->driver->read_timer, r->indev_ms);
+        // Read the touch that woke us on the very next handler pass
+        if (mode == FRAME_GOV_ACTIVE) lv_timer_ready(indev->driver->read_timer);
+    }
+#if FRAME_GOV_USE_PM
+    if (gov_pm_lock) {
+        if (mode == FRAME_GOV_ACTIVE) esp_pm_lock_acquire(gov_pm_lock);
+        else if (gov_mode == FRAME_GOV_ACTIVE) esp_pm_lock_release(gov_pm_lock);
+    }
+#endif
+}
+
+static void gov_set_mode(FrameGovMode mode, unsigned long now) {
+    if (mode == gov_mode) return;
+    if (gov_mode == FRAME_GOV_ACTIVE) gov_active_ms += now - gov_mode_since;
+    gov_apply(mode);
+    gov_mode = mode;
+    gov_mode_since = now;
+    Serial.printf("[GOV] %s (refresh %u ms, touch poll %u ms)\n", gov_mode_names[mode],
+                  gov_rates[mode].refr_ms, gov_rates[mode].indev_ms);
+}
+
+static void gov_roll_stats(unsigned long now) {
+    unsigned long span = now - gov_stats_start;
+    if (span < FRAME_GOV_STATS_PERIOD_MS) return;
+
+    unsigned long active = gov_active_ms;
+    if (gov_mode == FRAME_GOV_ACTIVE) active += now - gov_mode_since;
+
+    FrameGovStats s;
+    s.mode = gov_mode;
+    s.loops_per_sec = (float)gov_loops * 1000.0f / (float)span;
+    s.frames_per_sec = (float)gov_frames * 1000.0f / (float)span;
+    s.render_ms_max = gov_render_ms_max;
+    s.active_pct = (uint8_t)(active >= span ? 100 : active * 100 / span);
+    portENTER_CRITICAL(&gov_stats_mux);
+    gov_stats = s;
+    portEXIT_CRITICAL(&gov_stats_mux);
+
+    Serial.printf("[GOV] %.1f loops/s, %.1f fps, render max %lu ms, active %u%%, now %s\n",
+                  s.loops_per_sec, s.frames_per_sec, (unsigned long)s.render_ms_max,
+                  s.active_pct, gov_mode_names[s.mode]);
+
+    gov_loops = 0;
+    gov_frames = 0;
+    gov_frames_seen = 0;
+    gov_render_ms_max = 0;
+    gov_active_ms = 0;
+    gov_mode_since = now;
+    gov_stats_start = now;
+}
+
+void frame_governor_init(void) {
+    gov_loop_task = xTaskGetCurrentTaskHandle();
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp && disp->driver) disp->driver->monitor_cb = gov_monitor_cb;
+
+#if FRAME_GOV_USE_PM
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ui", &gov_pm_lock) == ESP_OK) {
+        esp_pm_lock_acquire(gov_pm_lock);
+    } else {
+        gov_pm_lock = NULL;
+        Serial.println("[GOV] Power management unavailable, CPU clock stays fixed");
+    }
+#endif
+
+    unsigned long now = millis();
+    gov_mode = FRAME_GOV_ACTIVE;
+    gov_last_activity = now;
+    gov_mode_since = now;
+    gov_stats_start = now;
+}
+
+void frame_governor_kick(void) {
+    gov_kicked = true;
+    if (gov_loop_task) xTaskNotifyGive(gov_loop_task);
+}
+
+void frame_governor_service(void) {
+    if (!gov_loop_task) return;
+    unsigned long now = millis();
+    gov_loops++;
+
+    // Anything that will (or just did) put pixels on the panel counts
+    lv_disp_t *disp = lv_disp_get_default();
+    bool busy = gov_kicked || gov_frames != gov_frames_seen || lv_anim_count_running() > 0 ||
+                (disp && disp->inv_p > 0) || lv_disp_get_inactive_time(NULL) < FRAME_GOV_IDLE_AFTER_MS;
+    gov_kicked = false;
+    gov_frames_seen = gov_frames;
+    if (busy) gov_last_activity = now;
+
+    unsigned long quiet = now - gov_last_activity;
+    FrameGovMode mode = FRAME_GOV_ACTIVE;
+    if (quiet >= FRAME_GOV_DEEP_AFTER_MS) mode = FRAME_GOV_DEEP_IDLE;
+    else if (quiet >= FRAME_GOV_IDLE_AFTER_MS) mode = FRAME_GOV_IDLE;
+    gov_set_mode(mode, now);
+
+    gov_roll_stats(now);
+}
+
+void frame_governor_wait(void) {
+    TickType_t ticks = pdMS_TO_TICKS(gov_rates[gov_mode].loop_ms);
+    if (ticks == 0) ticks = 1;
+    if (gov_loop_task) {
+        ulTaskNotifyTake(pdTRUE, ticks);
+    } else {
+        vTaskDelay(ticks);
+    }
+}
+
+FrameGovMode frame_governor_mode(void) {
+    return gov_mode;
+}
+
+void frame_governor_get_stats(FrameGovStats *out) {
+    if (!out) return;
+    portENTER_CRITICAL(&gov_stats_mux);
+    *out = gov_stats;
+    portEXIT_CRITICAL(&gov_stats_mux);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Adaptive frame-rate governor.
+//
+// While something is happening on screen (touch, running animations, areas
+// being redrawn, new sensor data) LVGL runs at its default 16 ms refresh and
+// 10 ms input poll. Once the display has been static for a while the refresh
+// and poll timers are stretched and loop() sleeps longer between passes, so
+// an idle display at anchor overnight does a fraction of the work. Any touch
+// or data change raises the rates again on the next loop pass.
+
+#ifndef FRAME_GOV_IDLE_AFTER_MS
+#define FRAME_GOV_IDLE_AFTER_MS     3000    // static this long -> IDLE
+#endif
+#ifndef FRAME_GOV_DEEP_AFTER_MS
+#define FRAME_GOV_DEEP_AFTER_MS     60000   // static this long -> DEEP_IDLE
+#endif
+#ifndef FRAME_GOV_STATS_PERIOD_MS
+#define FRAME_GOV_STATS_PERIOD_MS   60000
+#endif
+
+// Hold an esp_pm CPU_FREQ_MAX lock while ACTIVE so dynamic frequency scaling
+// can drop the clock when idle. Needs CONFIG_PM_ENABLE in the SDK config; if
+// power management is unavailable the lock is skipped with a log line.
+#ifndef FRAME_GOV_USE_PM
+#define FRAME_GOV_USE_PM 0
+#endif
+
+typedef enum {
+    FRAME_GOV_ACTIVE = 0,
+    FRAME_GOV_IDLE,
+    FRAME_GOV_DEEP_IDLE,
+    FRAME_GOV_MODE_COUNT
+} FrameGovMode;
+
+typedef struct {
+    FrameGovMode mode;
+    float loops_per_sec;        // loop() passes over the last stats period
+    float frames_per_sec;       // LVGL refreshes that redrew something
+    uint32_t render_ms_max;     // slowest refresh in the period
+    uint8_t active_pct;         // share of the period spent ACTIVE
+} FrameGovStats;
+
+// Call once after Lvgl_Init() from the task that runs loop()
+void frame_governor_init(void);
+
+// Note activity from any task (touch, new sensor data); wakes loop() early
+void frame_governor_kick(void);
+
+// Re-evaluate the mode; call once per loop() pass after Lvgl_Loop()
+void frame_governor_service(void);
+
+// Sleep until the next loop pass is due or frame_governor_kick() is called.
+// Replaces the fixed delay(1) at the end of loop().
+void frame_governor_wait(void);
+
+FrameGovMode frame_governor_mode(void);
+
+// Figures from the last completed stats period
+void frame_governor_get_stats(FrameGovStats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -2,34 +2,34 @@
 #include "sensESP_setup.h"
 #include <cmath>
 #include <cstdlib>
+#include "calibration_curve.h"
+
+// Compiled curves for gauge_cal, rebuilt lazily after gauge_cal_changed()
+static CalCurve gauge_curves[NUM_SCREENS][2];
+static uint32_t gauge_cal_generation = 1;
+static uint32_t gauge_curves_generation = 0;
+uint16_t gauge_cal_cubic_mask = 0;       // bit (screen * 2 + gauge): monotone cubic between points
+
+void gauge_cal_changed() {
+    gauge_cal_generation++;
+}
+
+static void gauge_curves_rebuild() {
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        for (int g = 0; g < 2; ++g) {
+            bool cubic = (gauge_cal_cubic_mask >> (s * 2 + g)) & 1;
+            cal_curve_compile(&gauge_curves[s][g], gauge_cal[s][g], 5, cubic);
+        }
+    }
+    gauge_curves_generation = gauge_cal_generation;
+}
 
 // Get angle for a value using per-screen, per-gauge calibration
 int16_t gauge_value_to_angle_screen(float value, int screen, int gauge) {
     if (screen < 0 || screen >= NUM_SCREENS) return 0;
     if (gauge < 0 || gauge > 1) return 0;
-    GaugeCalibrationPoint* cal = gauge_cal[screen][gauge];
-    // Find which segment the value falls into
-    for (int i = 0; i < 4; i++) {
-        float val1 = cal[i].value;
-        float val2 = cal[i + 1].value;
-        int16_t angle1 = cal[i].angle;
-        int16_t angle2 = cal[i + 1].angle;
-        if ((val1 <= val2 && value >= val1 && value <= val2) ||
-            (val1 > val2 && value >= val2 && value <= val1)) {
-            float value_range = val2 - val1;
-            if (fabs(value_range) < 0.001) return angle1;
-            float normalized = (value - val1) / value_range;
-            int16_t result;
-            if (angle2 < angle1) {
-                result = angle1 - (int16_t)(normalized * abs(angle2 - angle1));
-            } else {
-                result = angle1 + (int16_t)(normalized * abs(angle2 - angle1));
-            }
-            return result;
-        }
-    }
-    if (value < cal[0].value) return cal[0].angle;
-    return cal[4].angle;
+    if (gauge_curves_generation != gauge_cal_generation) gauge_curves_rebuild();
+    return cal_curve_eval(&gauge_curves[screen][gauge], value);
 }
 // Use the Preferences object from sensESP_setup.cpp for all calibration storage
 #include "gauge_config.h"
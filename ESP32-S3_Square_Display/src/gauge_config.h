@@ -78,3 +78,8 @@ int16_t gauge_get_preview_bottom_angle();
 
 // New function for per-screen, per-gauge calibration
 int16_t gauge_value_to_angle_screen(float value, int screen, int gauge);
+
+// Call after writing gauge_cal or gauge_cal_cubic_mask; curves are recompiled on next use
+void gauge_cal_changed();
+// Bit (screen * 2 + gauge) selects monotone cubic interpolation for that gauge
+extern uint16_t gauge_cal_cubic_mask;
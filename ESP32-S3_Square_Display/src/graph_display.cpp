@@ -1,12 +1,13 @@
 #include "graph_display.h"
 #include "ui.h"
 #include "screen_config_c_api.h"
+#include "timeseries_store.h"
+#include "sliding_minmax.h"
 #include <Arduino.h>
+#include "esp_heap_caps.h"
 
 // Storage for graph display objects (one per screen)
-static lv_obj_t* graph_charts[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};
-static lv_chart_series_t* graph_series[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};
-static lv_chart_series_t* graph_series_2[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};  // Second series
+static lv_obj_t* graph_panels[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};
 static lv_obj_t* unit_labels[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};
 static lv_obj_t* description_labels[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};
 static lv_obj_t* unit_labels_2[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};  // Second series labels
@@ -15,22 +16,67 @@ static lv_obj_t* bg_panels[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};
 static lv_obj_t* y_min_labels[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};
 static lv_obj_t* y_max_labels[NUM_SCREENS] = {NULL, NULL, NULL, NULL, NULL};
 
-// Auto-ranging tracking
-static float data_min[NUM_SCREENS] = {0, 0, 0, 0, 0};
-static float data_max[NUM_SCREENS] = {100, 100, 100, 100, 100};
-static int data_count[NUM_SCREENS] = {0, 0, 0, 0, 0};
-
-// Time-based sampling tracking
-static unsigned long last_sample_time[NUM_SCREENS] = {0, 0, 0, 0, 0};
-static unsigned long sample_intervals[6] = {
-    100,    // 10s: sample every 100ms (100 points)
-    100,    // 30s: sample every 100ms (300 points)
-    200,    // 1m: sample every 200ms (300 points)
-    1000,   // 5m: sample every 1s (300 points)
-    2000,   // 10m: sample every 2s (300 points)
-    6000    // 30m: sample every 6s (300 points)
+// Plot area geometry (inside the 440x360 panel with 10px padding)
+#define GRAPH_PANEL_W 440
+#define GRAPH_PANEL_H 360
+#define GRAPH_PAD 10
+#define GRAPH_PLOT_W (GRAPH_PANEL_W - 2 * GRAPH_PAD)
+#define GRAPH_PLOT_H (GRAPH_PANEL_H - 2 * GRAPH_PAD)
+#define GRAPH_GRID_HOR 5
+#define GRAPH_GRID_VER 10
+#define GRAPH_LINE_HALF 1  // line series are drawn 3px tall (1px either side)
+#define GRAPH_HOLD_MS 2000 // carry the last value across empty columns for this long
+#define GRAPH_HISTORY_CHUNK 256  // records fetched per time-series store query
+#define GRAPH_SHRINK_FILL 0.5f   // shrink the axis once the data needs less than half of it
+
+// Per-screen plot state. History is decimated to one min/max pair per pixel
+// column, so every sample in the time window stays visible no matter how long
+// the range is. The grid is drawn once into its own canvas and the plot canvas
+// on top of it is scrolled in place: new columns shift the existing pixels left
+// and only the newest column is drawn.
+typedef struct {
+    lv_obj_t* grid;              // cached grid layer (drawn once at create)
+    lv_obj_t* plot;              // chroma-keyed plot layer, scrolled in place
+    lv_color_t* grid_buf;
+    lv_color_t* plot_buf;
+    float* col_min[2];           // ring of per-column min/max/last, per series
+    float* col_max[2];
+    float* col_last[2];
+    uint16_t head;               // ring index of the newest (live) column
+    uint16_t count;              // number of valid columns in the ring
+    bool head_sampled[2];        // live column has received a real sample
+    unsigned long col_ms;        // time covered by one pixel column
+    unsigned long col_start;     // millis() at which the live column started
+    unsigned long last_sample;   // millis() of the most recent real sample
+    float y_lo, y_hi;            // current vertical range
+    uint8_t label_decimals;      // decimals needed for the snapped axis labels
+    SlidingMinMax window;        // exact min/max over the visible columns
+    uint32_t seq;                // sequence number of the live column
+    lv_color_t color[2];
+    uint8_t chart_type;
+    int8_t store_level;          // TsLevel backing a long range, -1 for live-only ranges
+} GraphPlot;
+
+static GraphPlot graph_plots[NUM_SCREENS];
+
+// Window length for each GraphTimeRange; divided across GRAPH_PLOT_W columns
+static const unsigned long range_ms[] = {
+    10000UL,     // 10s: ~24ms per column
+    30000UL,     // 30s: ~71ms per column
+    60000UL,     // 1m: ~143ms per column
+    300000UL,    // 5m: ~0.7s per column
+    600000UL,    // 10m: ~1.4s per column
+    1800000UL,   // 30m: ~4.3s per column
+    21600000UL,  // 6h: ~51s per column
+    86400000UL,  // 24h: ~3.4min per column
+    604800000UL  // 7d: 24min per column
+};
+#define GRAPH_RANGE_COUNT (sizeof(range_ms) / sizeof(range_ms[0]))
+
+// Rollup level used to fill each range from the SD store (-1 = live only)
+static const int8_t range_store_level[GRAPH_RANGE_COUNT] = {
+    -1, -1, -1, -1, -1, -1, TS_LEVEL_1M, TS_LEVEL_1M, TS_LEVEL_15M
 };
-static int point_counts[6] = {100, 300, 300, 300, 300, 300};
 
 // Helper to convert hex color string to lv_color_t
 static lv_color_t hex_to_lv_color(const char* hex) {
@@ -56,6 +102,283 @@ static lv_obj_t* get_screen_obj(int screen_num) {
     }
 }
 
+// The plot layer uses LV_COLOR_CHROMA_KEY as "transparent"; nudge a series
+// colour that happens to match it so the trace does not vanish.
+static lv_color_t graph_series_color(lv_color_t c) {
+    if (c.full == LV_COLOR_CHROMA_KEY.full) return lv_color_make(0x00, 0xF8, 0x00);
+    return c;
+}
+
+static void graph_set_label(lv_obj_t* label, const char* text) {
+    if (!label || !text) return;
+    if (strcmp(lv_label_get_text(label), text) == 0) return;  // avoid needless invalidation
+    lv_label_set_text(label, text);
+}
+
+static inline uint16_t graph_ring_index(const GraphPlot* p, uint16_t age) {
+    return (uint16_t)((p->head + GRAPH_PLOT_W - age) % GRAPH_PLOT_W);
+}
+
+static lv_coord_t graph_value_to_y(const GraphPlot* p, float v) {
+    float span = p->y_hi - p->y_lo;
+    if (span <= 0.0f) span = 1.0f;
+    float y = (float)(GRAPH_PLOT_H - 1) - (v - p->y_lo) * (float)(GRAPH_PLOT_H - 1) / span;
+    if (y < 0.0f) y = 0.0f;
+    if (y > (float)(GRAPH_PLOT_H - 1)) y = (float)(GRAPH_PLOT_H - 1);
+    return (lv_coord_t)(y + 0.5f);
+}
+
+static void graph_draw_span(GraphPlot* p, int x, int y0, int y1, lv_color_t c) {
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    if (y0 < 0) y0 = 0;
+    if (y1 > GRAPH_PLOT_H - 1) y1 = GRAPH_PLOT_H - 1;
+    lv_color_t* px = p->plot_buf + (size_t)y0 * GRAPH_PLOT_W + x;
+    for (int y = y0; y <= y1; ++y, px += GRAPH_PLOT_W) *px = c;
+}
+
+static void graph_clear_column(GraphPlot* p, int x) {
+    graph_draw_span(p, x, 0, GRAPH_PLOT_H - 1, LV_COLOR_CHROMA_KEY);
+}
+
+// Draw the column of age `age` (0 = live column) at canvas column x
+static void graph_draw_column(GraphPlot* p, int x, uint16_t age) {
+    uint16_t idx = graph_ring_index(p, age);
+    bool has_prev = (age + 1) < p->count;
+    uint16_t prev = has_prev ? graph_ring_index(p, age + 1) : idx;
+    for (int s = 0; s < 2; ++s) {
+        if (!p->col_min[s]) continue;
+        float mn = p->col_min[s][idx];
+        float mx = p->col_max[s][idx];
+        if (isnan(mn) || isnan(mx)) continue;
+        if (p->chart_type == 1) {  // Bar: fill from the baseline up to the column max
+            graph_draw_span(p, x, graph_value_to_y(p, mx), GRAPH_PLOT_H - 1, p->color[s]);
+        } else if (p->chart_type == 2) {  // Scatter: mark the extremes
+            lv_coord_t y_mn = graph_value_to_y(p, mn);
+            lv_coord_t y_mx = graph_value_to_y(p, mx);
+            graph_draw_span(p, x, y_mn - 1, y_mn + 1, p->color[s]);
+            if (y_mx != y_mn) graph_draw_span(p, x, y_mx - 1, y_mx + 1, p->color[s]);
+        } else {  // Line: vertical min..max span, joined to the previous column's last value
+            if (has_prev && !isnan(p->col_last[s][prev])) {
+                float pl = p->col_last[s][prev];
+                if (pl < mn) mn = pl;
+                if (pl > mx) mx = pl;
+            }
+            graph_draw_span(p, x, graph_value_to_y(p, mx) - GRAPH_LINE_HALF,
+                            graph_value_to_y(p, mn) + GRAPH_LINE_HALF, p->color[s]);
+        }
+    }
+}
+
+static void graph_redraw_all(GraphPlot* p) {
+    lv_color_t* px = p->plot_buf;
+    for (size_t i = 0; i < (size_t)GRAPH_PLOT_W * GRAPH_PLOT_H; ++i) px[i] = LV_COLOR_CHROMA_KEY;
+    for (uint16_t age = 0; age < p->count; ++age) {
+        graph_draw_column(p, GRAPH_PLOT_W - 1 - age, age);
+    }
+    lv_obj_invalidate(p->plot);
+}
+
+// Shift the existing pixels left by n columns and draw only the n newest
+static void graph_scroll(GraphPlot* p, uint16_t n) {
+    if (n >= GRAPH_PLOT_W) { graph_redraw_all(p); return; }
+    size_t keep = (size_t)(GRAPH_PLOT_W - n) * sizeof(lv_color_t);
+    for (int y = 0; y < GRAPH_PLOT_H; ++y) {
+        lv_color_t* row = p->plot_buf + (size_t)y * GRAPH_PLOT_W;
+        memmove(row, row + n, keep);
+    }
+    for (uint16_t age = 0; age < n; ++age) {
+        int x = GRAPH_PLOT_W - 1 - age;
+        graph_clear_column(p, x);
+        graph_draw_column(p, x, age);
+    }
+    lv_obj_invalidate(p->plot);
+}
+
+// Redraw just the live (rightmost) column and invalidate only that strip
+static void graph_refresh_live_column(GraphPlot* p) {
+    graph_clear_column(p, GRAPH_PLOT_W - 1);
+    graph_draw_column(p, GRAPH_PLOT_W - 1, 0);
+    lv_area_t area;
+    lv_obj_get_coords(p->plot, &area);
+    area.x1 = area.x2;
+    lv_obj_invalidate_area(p->plot, &area);
+}
+
+// Open new columns for the time that has elapsed; returns how many were opened
+static uint16_t graph_advance(GraphPlot* p, unsigned long now) {
+    if (now - p->col_start < p->col_ms) return 0;
+    unsigned long n = (now - p->col_start) / p->col_ms;
+    p->col_start += n * p->col_ms;
+    if (n > GRAPH_PLOT_W) n = GRAPH_PLOT_W;
+    // Short gaps between samples are held at the last value; longer ones (screen
+    // not visible, data lost) are left empty rather than drawn as a flat line.
+    bool hold = (now - p->last_sample) <= GRAPH_HOLD_MS;
+    for (unsigned long i = 0; i < n; ++i) {
+        uint16_t prev = p->head;
+        p->head = (uint16_t)((p->head + 1) % GRAPH_PLOT_W);
+        p->seq++;
+        if (p->count < GRAPH_PLOT_W) p->count++;
+        for (int s = 0; s < 2; ++s) {
+            if (!p->col_min[s]) continue;
+            float v = hold ? p->col_last[s][prev] : NAN;
+            p->col_min[s][p->head] = v;
+            p->col_max[s][p->head] = v;
+            p->col_last[s][p->head] = v;
+            sliding_minmax_push(&p->window, p->seq, v, v);
+        }
+    }
+    sliding_minmax_expire(&p->window, p->seq);
+    p->head_sampled[0] = p->head_sampled[1] = false;
+    return (uint16_t)n;
+}
+
+static void graph_add_sample(GraphPlot* p, int s, float v) {
+    if (!p->col_min[s] || isnan(v)) return;
+    uint16_t h = p->head;
+    if (!p->head_sampled[s]) {
+        p->col_min[s][h] = v;
+        p->col_max[s][h] = v;
+        p->head_sampled[s] = true;
+    } else {
+        if (v < p->col_min[s][h]) p->col_min[s][h] = v;
+        if (v > p->col_max[s][h]) p->col_max[s][h] = v;
+    }
+    p->col_last[s][h] = v;
+    sliding_minmax_push(&p->window, p->seq, v, v);
+}
+
+// Round a raw axis step up to 1, 2, 2.5 or 5 times a power of ten
+static float graph_nice_step(float raw) {
+    float mag = powf(10.0f, floorf(log10f(raw)));
+    float f = raw / mag;
+    float nice = f <= 1.0f ? 1.0f : f <= 2.0f ? 2.0f : f <= 2.5f ? 2.5f : f <= 5.0f ? 5.0f : 10.0f;
+    return nice * mag;
+}
+
+// Auto-range from the exact window min/max (10% headroom, bounds snapped to a
+// nice step). The axis grows as soon as data leaves it but only shrinks once
+// the data needs less than GRAPH_SHRINK_FILL of it, so it does not re-layout
+// on every sample. Returns true when the range changed and the plot must be
+// redrawn.
+static bool graph_update_range(GraphPlot* p) {
+    float lo, hi;
+    if (!sliding_minmax_get(&p->window, &lo, &hi)) return false;  // no data yet
+    float range = hi - lo;
+    if (range < 0.1f) range = 0.1f;
+    float margin = range * 0.1f;
+    float step = graph_nice_step((range + 2 * margin) / (GRAPH_GRID_HOR - 1));
+    float y_lo = floorf((lo - margin) / step) * step;
+    float y_hi = ceilf((hi + margin) / step) * step;
+    if (lo >= p->y_lo && hi <= p->y_hi && (y_hi - y_lo) > (p->y_hi - p->y_lo) * GRAPH_SHRINK_FILL) {
+        return false;
+    }
+    if (y_lo == p->y_lo && y_hi == p->y_hi) return false;
+    p->y_lo = y_lo;
+    p->y_hi = y_hi;
+    int decimals = step >= 1.0f ? 0 : (int)ceilf(-log10f(step) - 0.001f);
+    p->label_decimals = (uint8_t)(decimals > 3 ? 3 : decimals);
+    return true;
+}
+
+static void graph_set_range_labels(int screen_num, const GraphPlot* p) {
+    if (y_min_labels[screen_num]) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%.*f", p->label_decimals, p->y_lo);
+        lv_label_set_text(y_min_labels[screen_num], buf);
+    }
+    if (y_max_labels[screen_num]) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%.*f", p->label_decimals, p->y_hi);
+        lv_label_set_text(y_max_labels[screen_num], buf);
+    }
+}
+
+// Rebuild the column ring from the SD time-series rollups (long ranges only)
+static void graph_load_history(int screen_num, GraphPlot* p) {
+    if (p->store_level < 0) return;
+    const ScreenConfig& cfg = screen_configs[screen_num];
+    const char* paths[2] = { cfg.number_path, cfg.graph_path_2 };
+    TsLevel level = (TsLevel)p->store_level;
+    uint32_t now_t = ts_store_now();
+    uint32_t col_s = p->col_ms / 1000UL;
+    if (col_s == 0) col_s = 1;
+    uint32_t span_s = col_s * GRAPH_PLOT_W;
+    uint32_t t_from = now_t > span_s ? now_t - span_s : 0;
+    // Bridge columns that fall between two rollup buckets
+    int hold_cols = (int)(ts_store_level_seconds(level) / col_s) + 1;
+
+    TsRecord* recs = (TsRecord*)heap_caps_malloc(GRAPH_HISTORY_CHUNK * sizeof(TsRecord), MALLOC_CAP_SPIRAM);
+    if (!recs) return;
+
+    p->head = GRAPH_PLOT_W - 1;
+    p->count = GRAPH_PLOT_W;
+    p->col_start = millis();
+    for (int s = 0; s < 2; ++s) {
+        if (!p->col_min[s]) continue;
+        for (int i = 0; i < GRAPH_PLOT_W; ++i) {
+            p->col_min[s][i] = p->col_max[s][i] = p->col_last[s][i] = NAN;
+        }
+        uint32_t from = t_from;
+        for (;;) {
+            size_t n = ts_store_query(paths[s], level, from, now_t, recs, GRAPH_HISTORY_CHUNK);
+            for (size_t i = 0; i < n; ++i) {
+                uint32_t age = (now_t - recs[i].t) / col_s;
+                if (recs[i].t > now_t || age >= GRAPH_PLOT_W) continue;
+                uint16_t idx = graph_ring_index(p, (uint16_t)age);
+                if (isnan(p->col_min[s][idx]) || recs[i].min < p->col_min[s][idx]) p->col_min[s][idx] = recs[i].min;
+                if (isnan(p->col_max[s][idx]) || recs[i].max > p->col_max[s][idx]) p->col_max[s][idx] = recs[i].max;
+                p->col_last[s][idx] = recs[i].avg;
+            }
+            if (n < GRAPH_HISTORY_CHUNK) break;
+            from = recs[n - 1].t + 1;
+        }
+        int since = hold_cols + 1;
+        float held = NAN;
+        for (int age = GRAPH_PLOT_W - 1; age >= 0; --age) {
+            uint16_t idx = graph_ring_index(p, (uint16_t)age);
+            if (!isnan(p->col_last[s][idx])) {
+                held = p->col_last[s][idx];
+                since = 0;
+            } else if (++since <= hold_cols && !isnan(held)) {
+                p->col_min[s][idx] = p->col_max[s][idx] = p->col_last[s][idx] = held;
+            }
+        }
+        p->head_sampled[s] = !isnan(p->col_min[s][p->head]);
+    }
+    heap_caps_free(recs);
+
+    sliding_minmax_reset(&p->window);
+    for (int age = GRAPH_PLOT_W - 1; age >= 0; --age) {
+        uint16_t idx = graph_ring_index(p, (uint16_t)age);
+        for (int s = 0; s < 2; ++s) {
+            if (p->col_min[s]) sliding_minmax_push(&p->window, p->seq - age, p->col_min[s][idx], p->col_max[s][idx]);
+        }
+    }
+}
+
+static void graph_free_plot(GraphPlot* p) {
+    sliding_minmax_free(&p->window);
+    if (p->grid_buf) heap_caps_free(p->grid_buf);
+    if (p->plot_buf) heap_caps_free(p->plot_buf);
+    if (p->col_min[0]) heap_caps_free(p->col_min[0]);  // single allocation for all rings
+    memset(p, 0, sizeof(*p));
+}
+
+// Draw the grid once into the cached grid layer
+static void graph_draw_grid(GraphPlot* p, lv_color_t grid_color) {
+    lv_color_t* px = p->grid_buf;
+    for (size_t i = 0; i < (size_t)GRAPH_PLOT_W * GRAPH_PLOT_H; ++i) px[i] = LV_COLOR_CHROMA_KEY;
+    for (int i = 0; i < GRAPH_GRID_HOR; ++i) {
+        int y = i * (GRAPH_PLOT_H - 1) / (GRAPH_GRID_HOR - 1);
+        lv_color_t* row = px + (size_t)y * GRAPH_PLOT_W;
+        for (int x = 0; x < GRAPH_PLOT_W; ++x) row[x] = grid_color;
+    }
+    for (int i = 0; i < GRAPH_GRID_VER; ++i) {
+        int x = i * (GRAPH_PLOT_W - 1) / (GRAPH_GRID_VER - 1);
+        for (int y = 0; y < GRAPH_PLOT_H; ++y) px[(size_t)y * GRAPH_PLOT_W + x] = grid_color;
+    }
+}
+
 void graph_display_create(int screen_num) {
     if (screen_num < 0 || screen_num >= NUM_SCREENS) return;
     
@@ -116,80 +439,88 @@ void graph_display_create(int screen_num) {
     lv_obj_align(unit_labels[screen_num], LV_ALIGN_TOP_RIGHT, -10, 10);
     lv_obj_add_flag(unit_labels[screen_num], LV_OBJ_FLAG_IGNORE_LAYOUT);
     
-    // Create LVGL chart (centered, takes up most of the screen)
-    graph_charts[screen_num] = lv_chart_create(screen);
-    lv_obj_set_size(graph_charts[screen_num], 440, 360);  // Slightly smaller to make room for labels
-    lv_obj_align(graph_charts[screen_num], LV_ALIGN_CENTER, 0, 10);
-    
-    // Configure chart type based on configuration
-    lv_chart_type_t chart_type = LV_CHART_TYPE_LINE;  // Default
-    if (cfg.graph_chart_type == 1) {
-        chart_type = LV_CHART_TYPE_BAR;
-    } else if (cfg.graph_chart_type == 2) {
-        chart_type = LV_CHART_TYPE_SCATTER;
-    }
-    lv_chart_set_type(graph_charts[screen_num], chart_type);
-    
-    // Set point count based on time range selection
-    uint8_t time_range = cfg.graph_time_range;
-    if (time_range > 5) time_range = 0;  // Safety check
-    int points = point_counts[time_range];
-    lv_chart_set_point_count(graph_charts[screen_num], points);
-    
-    // Start with default range (will auto-adjust)
-    lv_chart_set_range(graph_charts[screen_num], LV_CHART_AXIS_PRIMARY_Y, 0, 100);
-    data_min[screen_num] = 0;
-    data_max[screen_num] = 100;
-    data_count[screen_num] = 0;
-    
-    // Style the chart
-    lv_obj_set_style_bg_color(graph_charts[screen_num], lv_color_black(), 0);
-    lv_obj_set_style_bg_opa(graph_charts[screen_num], LV_OPA_50, 0);
-    lv_obj_set_style_border_width(graph_charts[screen_num], 0, 0);  // No border
-    lv_obj_set_style_pad_all(graph_charts[screen_num], 10, 0);
+    // Create the graph panel (centered, takes up most of the screen)
+    graph_panels[screen_num] = lv_obj_create(screen);
+    lv_obj_t* panel = graph_panels[screen_num];
+    lv_obj_set_size(panel, GRAPH_PANEL_W, GRAPH_PANEL_H);  // Slightly smaller to make room for labels
+    lv_obj_align(panel, LV_ALIGN_CENTER, 0, 10);
+    lv_obj_set_style_bg_color(panel, lv_color_black(), 0);
+    lv_obj_set_style_bg_opa(panel, LV_OPA_50, 0);
+    lv_obj_set_style_border_width(panel, 0, 0);  // No border
+    lv_obj_set_style_pad_all(panel, GRAPH_PAD, 0);
+    lv_obj_clear_flag(panel, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_clear_flag(panel, LV_OBJ_FLAG_CLICKABLE);
     
     // Grid lines - half brightness of main color
     uint8_t r = (font_color.ch.red >> 1);    // Divide by 2 for half brightness
     uint8_t g = (font_color.ch.green >> 1);
     uint8_t b = (font_color.ch.blue >> 1);
-    lv_color_t grid_color = lv_color_make(r, g, b);
+    lv_color_t grid_color = graph_series_color(lv_color_make(r, g, b));
     
-    lv_obj_set_style_line_color(graph_charts[screen_num], grid_color, LV_PART_MAIN);
-    lv_obj_set_style_line_width(graph_charts[screen_num], 1, LV_PART_MAIN);
-    
-    lv_chart_set_div_line_count(graph_charts[screen_num], 5, 10);  // 5 horizontal, 10 vertical grid lines
-    
-    // Add first data series (line color matches font color)
-    graph_series[screen_num] = lv_chart_add_series(graph_charts[screen_num], font_color, LV_CHART_AXIS_PRIMARY_Y);
-    
-    // Add second series if path is configured
     bool has_series_2 = (strlen(cfg.graph_path_2) > 0);
+    
+    // Plot buffers live in PSRAM: two canvas layers plus the decimated history
+    GraphPlot* p = &graph_plots[screen_num];
+    size_t canvas_bytes = LV_CANVAS_BUF_SIZE_TRUE_COLOR_CHROMA_KEYED(GRAPH_PLOT_W, GRAPH_PLOT_H);
+    size_t ring_floats = (size_t)GRAPH_PLOT_W * 3 * (has_series_2 ? 2 : 1);
+    p->grid_buf = (lv_color_t*)heap_caps_malloc(canvas_bytes, MALLOC_CAP_SPIRAM);
+    p->plot_buf = (lv_color_t*)heap_caps_malloc(canvas_bytes, MALLOC_CAP_SPIRAM);
+    float* ring = (float*)heap_caps_malloc(ring_floats * sizeof(float), MALLOC_CAP_SPIRAM);
+    bool window_ok = sliding_minmax_init(&p->window, GRAPH_PLOT_W, GRAPH_PLOT_W + 2);
+    if (!p->grid_buf || !p->plot_buf || !ring || !window_ok) {
+        Serial.printf("[GRAPH_DISPLAY] Screen %d: failed to allocate plot buffers (free PSRAM %u)\n",
+                      screen_num, (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+        if (ring) heap_caps_free(ring);
+        graph_free_plot(p);
+        return;
+    }
+    for (size_t i = 0; i < ring_floats; ++i) ring[i] = NAN;
+    p->col_min[0] = ring;
+    p->col_max[0] = ring + GRAPH_PLOT_W;
+    p->col_last[0] = ring + 2 * GRAPH_PLOT_W;
     if (has_series_2) {
-        lv_color_t series_2_color = hex_to_lv_color(cfg.graph_color_2);
-        graph_series_2[screen_num] = lv_chart_add_series(graph_charts[screen_num], series_2_color, LV_CHART_AXIS_PRIMARY_Y);
+        p->col_min[1] = ring + 3 * GRAPH_PLOT_W;
+        p->col_max[1] = ring + 4 * GRAPH_PLOT_W;
+        p->col_last[1] = ring + 5 * GRAPH_PLOT_W;
     }
     
-    // Set series style based on chart type
-    if (cfg.graph_chart_type == 0) {  // Line chart
-        lv_obj_set_style_line_width(graph_charts[screen_num], 3, LV_PART_ITEMS);
-        lv_obj_set_style_size(graph_charts[screen_num], 0, LV_PART_INDICATOR);  // Hide point markers
-    } else if (cfg.graph_chart_type == 1) {  // Bar chart
-        lv_obj_set_style_size(graph_charts[screen_num], 0, LV_PART_INDICATOR);  // No point markers
-    } else if (cfg.graph_chart_type == 2) {  // Scatter plot
-        lv_obj_set_style_size(graph_charts[screen_num], 8, LV_PART_INDICATOR);  // Show point markers
-        lv_obj_set_style_line_width(graph_charts[screen_num], 0, LV_PART_ITEMS); // No connecting lines
-    }
+    // Series colors: series 1 matches font color, series 2 is configurable
+    p->color[0] = graph_series_color(font_color);
+    p->color[1] = graph_series_color(hex_to_lv_color(cfg.graph_color_2));
+    p->chart_type = cfg.graph_chart_type <= 2 ? cfg.graph_chart_type : 0;
     
-    // Initialize all points to 0
-    for(int i = 0; i < points; i++) {
-        lv_chart_set_next_value(graph_charts[screen_num], graph_series[screen_num], 0);
-        if (has_series_2) {
-            lv_chart_set_next_value(graph_charts[screen_num], graph_series_2[screen_num], 0);
-        }
+    // Column width in time is based on the time range selection
+    uint8_t time_range = cfg.graph_time_range;
+    if (time_range >= GRAPH_RANGE_COUNT) time_range = 0;  // Safety check
+    p->col_ms = range_ms[time_range] / GRAPH_PLOT_W;
+    if (p->col_ms == 0) p->col_ms = 1;
+    p->store_level = range_store_level[time_range];
+    p->col_start = millis();
+    p->last_sample = 0;
+    p->head = 0;
+    p->count = 1;  // the live column
+    p->seq = GRAPH_PLOT_W;  // leaves room for history loaded behind the live column
+    
+    // Start with default range (will auto-adjust)
+    p->y_lo = 0;
+    p->y_hi = 100;
+    
+    // Long ranges start from the stored rollups instead of an empty plot
+    if (p->store_level >= 0) {
+        graph_load_history(screen_num, p);
+        p->last_sample = millis();
+        graph_update_range(p);
     }
     
-    // Initialize sampling timer
-    last_sample_time[screen_num] = 0;
+    p->grid = lv_canvas_create(panel);
+    lv_canvas_set_buffer(p->grid, p->grid_buf, GRAPH_PLOT_W, GRAPH_PLOT_H, LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED);
+    lv_obj_align(p->grid, LV_ALIGN_TOP_LEFT, 0, 0);
+    graph_draw_grid(p, grid_color);
+    
+    p->plot = lv_canvas_create(panel);
+    lv_canvas_set_buffer(p->plot, p->plot_buf, GRAPH_PLOT_W, GRAPH_PLOT_H, LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED);
+    lv_obj_align(p->plot, LV_ALIGN_TOP_LEFT, 0, 0);
+    graph_redraw_all(p);
     
     // Create Y-axis labels (min and max values)
     y_min_labels[screen_num] = lv_label_create(screen);
@@ -203,6 +534,7 @@ void graph_display_create(int screen_num) {
     lv_obj_set_style_text_font(y_max_labels[screen_num], &inter_16, 0);
     lv_obj_set_style_text_color(y_max_labels[screen_num], font_color, 0);
     lv_obj_align(y_max_labels[screen_num], LV_ALIGN_LEFT_MID, 5, -160);  // Top left of chart
+    graph_set_range_labels(screen_num, p);
     
     // Create second series labels at bottom if configured
     if (has_series_2) {
@@ -226,113 +558,61 @@ void graph_display_create(int screen_num) {
         lv_obj_add_flag(unit_labels_2[screen_num], LV_OBJ_FLAG_IGNORE_LAYOUT);
     }
     
-    Serial.printf("[GRAPH_DISPLAY] Created for screen %d (type=%d, series2=%d)\n", 
-                  screen_num, cfg.graph_chart_type, has_series_2 ? 1 : 0);
+    Serial.printf("[GRAPH_DISPLAY] Created for screen %d (type=%d, series2=%d, %lums/column)\n", 
+                  screen_num, cfg.graph_chart_type, has_series_2 ? 1 : 0, p->col_ms);
 }
 
 void graph_display_update(int screen_num, float value, const char* unit, const char* description,
                           float value2, const char* unit2, const char* description2) {
     if (screen_num < 0 || screen_num >= NUM_SCREENS) return;
-    if (!graph_charts[screen_num] || !graph_series[screen_num]) return;
+    GraphPlot* p = &graph_plots[screen_num];
+    if (!graph_panels[screen_num] || !p->plot) return;
     
-    bool has_series_2 = (graph_series_2[screen_num] != NULL && !isnan(value2));
+    bool has_series_2 = (p->col_min[1] != NULL && !isnan(value2));
     
-    // Check if enough time has passed based on selected time range
-    uint8_t time_range = screen_configs[screen_num].graph_time_range;
-    if (time_range > 5) time_range = 0;
+    // Update labels (only touched when the text actually changes)
+    graph_set_label(description_labels[screen_num], description);
+    graph_set_label(unit_labels[screen_num], unit);
+    if (has_series_2) {
+        graph_set_label(description_labels_2[screen_num], description2);
+        graph_set_label(unit_labels_2[screen_num], unit2);
+    }
     
+    // Every update is folded into the live column's min/max, so short spikes
+    // survive however long the time range is.
     unsigned long now = millis();
-    unsigned long interval = sample_intervals[time_range];
-    
-    // Only add a new sample if enough time has elapsed
-    if (last_sample_time[screen_num] == 0 || (now - last_sample_time[screen_num]) >= interval) {
-        last_sample_time[screen_num] = now;
-        
-        // Update description label
-        if (description_labels[screen_num] && description) {
-            lv_label_set_text(description_labels[screen_num], description);
-        }
-        
-        // Update unit label
-        if (unit_labels[screen_num] && unit) {
-            lv_label_set_text(unit_labels[screen_num], unit);
-        }
-        
-        // Update second series labels if present
-        if (has_series_2) {
-            if (description_labels_2[screen_num] && description2) {
-                lv_label_set_text(description_labels_2[screen_num], description2);
-            }
-            if (unit_labels_2[screen_num] && unit2) {
-                lv_label_set_text(unit_labels_2[screen_num], unit2);
-            }
-        }
-        
-        // Add new values to chart first
-        int32_t scaled_value = (int32_t)value;
-        lv_chart_set_next_value(graph_charts[screen_num], graph_series[screen_num], scaled_value);
-        
-        if (has_series_2) {
-            int32_t scaled_value2 = (int32_t)value2;
-            lv_chart_set_next_value(graph_charts[screen_num], graph_series_2[screen_num], scaled_value2);
-        }
-        
-        // Recalculate min/max from actual chart data (so range can shrink when data decreases)
-        uint16_t point_count = lv_chart_get_point_count(graph_charts[screen_num]);
-        lv_coord_t* y_array = lv_chart_get_y_array(graph_charts[screen_num], graph_series[screen_num]);
-        
-        lv_coord_t actual_min = y_array[0];
-        lv_coord_t actual_max = y_array[0];
-        
-        // Find min/max from first series
-        for (uint16_t i = 1; i < point_count; i++) {
-            if (y_array[i] < actual_min) actual_min = y_array[i];
-            if (y_array[i] > actual_max) actual_max = y_array[i];
-        }
-        
-        // Include second series if present
-        if (has_series_2) {
-            lv_coord_t* y_array2 = lv_chart_get_y_array(graph_charts[screen_num], graph_series_2[screen_num]);
-            for (uint16_t i = 0; i < point_count; i++) {
-                if (y_array2[i] < actual_min) actual_min = y_array2[i];
-                if (y_array2[i] > actual_max) actual_max = y_array2[i];
-            }
-        }
-        
-        // Add 10% margin to range for better visualization
-        float range = (float)(actual_max - actual_min);
-        if (range < 0.1f) range = 0.1f;  // Minimum range to avoid division by zero
-        float margin = range * 0.1f;
-        int32_t y_min = (int32_t)((float)actual_min - margin);
-        int32_t y_max = (int32_t)((float)actual_max + margin);
-        
-        // Update Y-axis range
-        lv_chart_set_range(graph_charts[screen_num], LV_CHART_AXIS_PRIMARY_Y, y_min, y_max);
-        
-        // Update Y-axis labels
-        if (y_min_labels[screen_num]) {
-            char buf[16];
-            snprintf(buf, sizeof(buf), "%d", y_min);
-            lv_label_set_text(y_min_labels[screen_num], buf);
-        }
-        if (y_max_labels[screen_num]) {
-            char buf[16];
-            snprintf(buf, sizeof(buf), "%d", y_max);
-            lv_label_set_text(y_max_labels[screen_num], buf);
-        }
-        
-        lv_chart_refresh(graph_charts[screen_num]);
+    if (p->store_level >= 0 && now - p->last_sample > GRAPH_HOLD_MS) {
+        // Screen was not updated for a while: refill the gap from the store
+        graph_load_history(screen_num, p);
+        graph_update_range(p);
+        graph_set_range_labels(screen_num, p);
+        graph_redraw_all(p);
+        p->last_sample = now;
+    }
+    uint16_t opened = graph_advance(p, now);
+    graph_add_sample(p, 0, value);
+    if (has_series_2) graph_add_sample(p, 1, value2);
+    p->last_sample = now;
+    
+    if (graph_update_range(p)) {
+        // Range changed: the whole plot has to be re-projected
+        graph_redraw_all(p);
+        graph_set_range_labels(screen_num, p);
+    } else if (opened > 0) {
+        graph_scroll(p, opened);
+    } else {
+        graph_refresh_live_column(p);
     }
 }
 
 void graph_display_destroy(int screen_num) {
     if (screen_num < 0 || screen_num >= NUM_SCREENS) return;
     
-    if (graph_charts[screen_num]) {
-        lv_obj_del(graph_charts[screen_num]);
-        graph_charts[screen_num] = NULL;
-        graph_series[screen_num] = NULL;  // Series is deleted with chart
+    if (graph_panels[screen_num]) {
+        lv_obj_del(graph_panels[screen_num]);  // Canvas layers are deleted with the panel
+        graph_panels[screen_num] = NULL;
     }
+    graph_free_plot(&graph_plots[screen_num]);
     
     if (unit_labels[screen_num]) {
         lv_obj_del(unit_labels[screen_num]);
@@ -344,6 +624,16 @@ void graph_display_destroy(int screen_num) {
         description_labels[screen_num] = NULL;
     }
     
+    if (unit_labels_2[screen_num]) {
+        lv_obj_del(unit_labels_2[screen_num]);
+        unit_labels_2[screen_num] = NULL;
+    }
+    
+    if (description_labels_2[screen_num]) {
+        lv_obj_del(description_labels_2[screen_num]);
+        description_labels_2[screen_num] = NULL;
+    }
+    
     if (y_min_labels[screen_num]) {
         lv_obj_del(y_min_labels[screen_num]);
         y_min_labels[screen_num] = NULL;
@@ -358,9 +648,4 @@ void graph_display_destroy(int screen_num) {
         lv_obj_del(bg_panels[screen_num]);
         bg_panels[screen_num] = NULL;
     }
-    
-    // Reset auto-ranging data
-    data_min[screen_num] = 0;
-    data_max[screen_num] = 100;
-    data_count[screen_num] = 0;
 }
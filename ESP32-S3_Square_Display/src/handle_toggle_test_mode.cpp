@@ -1,7 +1,7 @@
 // Handler for toggling test mode from the web UI
 #include <Arduino.h>
-#include <WebServer.h>
-extern WebServer config_server;
+#include "http_server.h"
+extern HttpServer config_server;
 extern bool test_mode;
 void handle_toggle_test_mode() {
     if (config_server.method() == HTTP_POST) {
@@ -0,0 +1,92 @@
+#include "html_stream.h"
+#include <stdarg.h>
+#include "esp_heap_caps.h"
+
+HtmlStream::HtmlStream(HttpServer &server, const char *label)
+    : server_(server), label_(label), buf_(NULL), len_(0), total_(0), chunks_(0),
+      start_ms_(0), heap_start_(0), heap_min_(0), open_(false) {}
+
+HtmlStream::~HtmlStream() {
+    if (open_) end();
+    if (buf_) free(buf_);
+}
+
+void HtmlStream::sample_heap() {
+    size_t free_now = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    if (free_now < heap_min_) heap_min_ = free_now;
+}
+
+void HtmlStream::begin(int code, const char *content_type) {
+    start_ms_ = millis();
+    heap_start_ = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    heap_min_ = heap_start_;
+    // One allocation for the whole page; without it every append goes out
+    // as its own chunk, which is slow but still correct
+    if (!buf_) buf_ = (char *)malloc(HTML_STREAM_BUF);
+    server_.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server_.send(code, content_type, "");
+    open_ = true;
+    sample_heap();
+}
+
+void HtmlStream::flush() {
+    if (len_ == 0) return;
+    server_.sendContent(buf_, len_);
+    chunks_++;
+    len_ = 0;
+}
+
+void HtmlStream::write(const char *data, size_t len) {
+    if (!open_ || len == 0) return;
+    total_ += len;
+    if (!buf_) {
+        server_.sendContent(data, len);
+        chunks_++;
+        sample_heap();
+        return;
+    }
+    while (len > 0) {
+        size_t n = HTML_STREAM_BUF - len_;
+        if (n > len) n = len;
+        memcpy(buf_ + len_, data, n);
+        len_ += n;
+        data += n;
+        len -= n;
+        if (len_ == HTML_STREAM_BUF) {
+            sample_heap();
+            flush();
+        }
+    }
+}
+
+void HtmlStream::printf(const char *fmt, ...) {
+    char tmp[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if ((size_t)n < sizeof(tmp)) {
+        write(tmp, (size_t)n);
+        return;
+    }
+    // Longer than the scratch buffer (e.g. a long path): format once more on the heap
+    char *big = (char *)malloc((size_t)n + 1);
+    if (!big) return;
+    va_start(ap, fmt);
+    vsnprintf(big, (size_t)n + 1, fmt, ap);
+    va_end(ap);
+    write(big, (size_t)n);
+    free(big);
+}
+
+void HtmlStream::end() {
+    if (!open_) return;
+    sample_heap();
+    flush();
+    server_.sendContent("");  // zero-length chunk ends the response
+    open_ = false;
+    Serial.printf("[WEB] %s: %u bytes in %lu chunks, %lu ms, internal heap %u free at start, %u lowest (peak use %u)\n",
+                  label_, (unsigned)total_, (unsigned long)chunks_, (unsigned long)(millis() - start_ms_),
+                  (unsigned)heap_start_, (unsigned)heap_min_, (unsigned)(heap_start_ - heap_min_));
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+#include "http_server.h"
+
+// Streams an HTML response with chunked transfer encoding through one
+// fixed-size buffer, so a large page never exists as a single String.
+// Appends use the same `+=` syntax as String; `printf` fills a template
+// straight into the buffer. Free internal heap is sampled at every flush and
+// the low-water mark is logged when the page ends.
+
+#define HTML_STREAM_BUF 1436            // one TCP segment of payload after chunk framing
+
+class HtmlStream {
+public:
+    HtmlStream(HttpServer &server, const char *label);
+    ~HtmlStream();
+
+    // Send the status line and headers; body follows through the appends
+    void begin(int code = 200, const char *content_type = "text/html");
+    // Flush the buffer, send the terminating chunk and log the statistics
+    void end();
+
+    void write(const char *data, size_t len);
+    HtmlStream &operator+=(const char *s) { if (s) write(s, strlen(s)); return *this; }
+    HtmlStream &operator+=(const String &s) { write(s.c_str(), s.length()); return *this; }
+    HtmlStream &operator+=(char c) { write(&c, 1); return *this; }
+    void printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    size_t bytes() const { return total_; }
+
+private:
+    void flush();
+    void sample_heap();
+
+    HttpServer &server_;
+    const char *label_;
+    char *buf_;
+    size_t len_;
+    size_t total_;
+    uint32_t chunks_;
+    uint32_t start_ms_;
+    size_t heap_start_;
+    size_t heap_min_;
+    bool open_;
+};
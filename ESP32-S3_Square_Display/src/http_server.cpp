@@ -0,0 +1,383 @@
+#include "http_server.h"
+#include <string.h>
+#include "esp_heap_caps.h"
+
+static const char *status_text(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "";
+    }
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static String url_decode(const char *s, size_t len) {
+    String out;
+    out.reserve(len);
+    for (size_t i = 0; i < len; ++i) {
+        char c = s[i];
+        if (c == '+') {
+            c = ' ';
+        } else if (c == '%' && i + 2 < len && hex_digit(s[i + 1]) >= 0 && hex_digit(s[i + 2]) >= 0) {
+            c = (char)(hex_digit(s[i + 1]) << 4 | hex_digit(s[i + 2]));
+            i += 2;
+        }
+        out += c;
+    }
+    return out;
+}
+
+HttpServer::HttpServer(uint16_t port)
+    : port_(port), handle_(NULL), route_count_(0), req_(NULL), route_(NULL), method_(HTTP_GET),
+      body_(BODY_DONE), upload_(), uploading_(false), chunked_(false), started_(false), ended_(false), close_(false) {
+    status_[0] = '\0';
+}
+
+void HttpServer::on(const char *uri, HTTPMethod method, THandlerFunction fn, THandlerFunction upload) {
+    if (route_count_ >= HTTP_ROUTE_MAX) {
+        Serial.printf("[WEB] Too many routes, %s not served\n", uri);
+        return;
+    }
+    Route &r = routes_[route_count_++];
+    r.uri = uri;
+    r.method = method;
+    r.fn = fn;
+    r.upload = upload;
+}
+
+bool HttpServer::begin(unsigned priority, size_t stack, int core) {
+    httpd_config_t cfg = HTTPD_DEFAULT_CONFIG();
+    cfg.server_port = port_;
+    cfg.task_priority = priority;
+    cfg.stack_size = stack;
+    cfg.core_id = core;
+    cfg.max_open_sockets = HTTP_MAX_SOCKETS;
+    cfg.max_uri_handlers = 5;
+    cfg.lru_purge_enable = true;
+    cfg.recv_wait_timeout = 10;
+    cfg.send_wait_timeout = 10;
+    cfg.uri_match_fn = httpd_uri_match_wildcard;
+    esp_err_t err = httpd_start(&handle_, &cfg);
+    if (err != ESP_OK) {
+        Serial.printf("[WEB] Server start failed: %s\n", esp_err_to_name(err));
+        return false;
+    }
+    // Every path goes to dispatch(), which matches the routes itself
+    static const httpd_method_t methods[] = {HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE};
+    for (httpd_method_t m : methods) {
+        httpd_uri_t u = {};
+        u.uri = "/*";
+        u.method = m;
+        u.handler = handle_request;
+        u.user_ctx = this;
+        httpd_register_uri_handler(handle_, &u);
+    }
+    return true;
+}
+
+esp_err_t HttpServer::handle_request(httpd_req_t *req) {
+    return ((HttpServer *)req->user_ctx)->dispatch(req);
+}
+
+bool HttpServer::match(const char *pattern, const char *path, std::vector<String> *captures) {
+    while (*pattern) {
+        if (pattern[0] == '{' && pattern[1] == '}') {
+            size_t n = strcspn(path, "/");
+            if (n == 0) return false;
+            captures->push_back(String(path).substring(0, n));
+            path += n;
+            pattern += 2;
+        } else if (*pattern++ != *path++) {
+            return false;
+        }
+    }
+    return *path == '\0';
+}
+
+esp_err_t HttpServer::dispatch(httpd_req_t *req) {
+    req_ = req;
+    route_ = NULL;
+    method_ = (HTTPMethod)req->method;
+    args_.clear();
+    resp_headers_.clear();
+    body_ = req->content_len ? BODY_UNREAD : BODY_DONE;
+    upload_ = HttpUpload();
+    uploading_ = false;
+    status_[0] = '\0';
+    chunked_ = started_ = ended_ = close_ = false;
+
+    const char *query = strchr(req->uri, '?');
+    uri_ = req->uri;
+    if (query) {
+        uri_.remove(query - req->uri);
+        parse_query(query + 1, strlen(query + 1));
+    }
+    for (int i = 0; i < route_count_ && !route_; ++i) {
+        const Route &r = routes_[i];
+        if (r.method != HTTP_ANY && r.method != method_) continue;
+        path_args_.clear();
+        if (match(r.uri, uri_.c_str(), &path_args_)) route_ = &r;
+    }
+    if (route_) route_->fn();
+    else send(404, "text/plain", "Not found: " + uri_);
+
+    if (!started_) send(500, "text/plain", "No response");
+    else if (chunked_ && !ended_) sendContent("", 0);
+    req_ = NULL;
+    route_ = NULL;
+    // Failing the request makes the server close the socket, the only way
+    // past a body that was not read
+    return close_ ? ESP_FAIL : ESP_OK;
+}
+
+void HttpServer::parse_query(const char *s, size_t len) {
+    const char *end = s + len;
+    while (s < end) {
+        const char *amp = (const char *)memchr(s, '&', end - s);
+        if (!amp) amp = end;
+        const char *eq = (const char *)memchr(s, '=', amp - s);
+        if (amp > s) {
+            Arg a;
+            a.name = url_decode(s, (eq ? eq : amp) - s);
+            if (eq) a.value = url_decode(eq + 1, amp - eq - 1);
+            args_.push_back(a);
+        }
+        s = amp + 1;
+    }
+}
+
+int HttpServer::read_body(void *ctx, char *buf, size_t len) {
+    HttpServer *s = (HttpServer *)ctx;
+    for (int tries = 0; tries < HTTP_RECV_RETRIES; ++tries) {
+        int n = httpd_req_recv(s->req_, buf, len);
+        if (n != HTTPD_SOCK_ERR_TIMEOUT) return n;
+    }
+    return -1;
+}
+
+bool HttpServer::read_plain(bool form) {
+    size_t len = req_->content_len;
+    char *buf = (char *)heap_caps_malloc(len + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!buf) buf = (char *)malloc(len + 1);
+    if (!buf) return false;
+    size_t got = 0;
+    while (got < len) {
+        int n = read_body(this, buf + got, len - got);
+        if (n <= 0) break;
+        got += (size_t)n;
+    }
+    bool ok = got == len;
+    if (ok) {
+        buf[len] = '\0';
+        if (form) {
+            parse_query(buf, len);
+        } else {
+            Arg a;
+            a.name = "plain";
+            a.value = buf;
+            args_.push_back(a);
+        }
+    }
+    free(buf);
+    return ok;
+}
+
+void HttpServer::part_begin(void *ctx, const MultipartPart *part) {
+    HttpServer *s = (HttpServer *)ctx;
+    s->field_ = "";
+    if (!part->is_file) return;
+    s->upload_.status = UPLOAD_FILE_START;
+    s->upload_.filename = part->filename;
+    s->upload_.name = part->name;
+    s->upload_.type = part->content_type;
+    s->upload_.totalSize = 0;
+    s->upload_.currentSize = 0;
+    s->upload_.buf = NULL;
+    s->uploading_ = true;
+    if (s->route_->upload) s->route_->upload();
+}
+
+void HttpServer::part_data(void *ctx, const MultipartPart *part, const uint8_t *data, size_t len) {
+    HttpServer *s = (HttpServer *)ctx;
+    if (!part->is_file) {
+        for (size_t i = 0; i < len && s->field_.length() < HTTP_FIELD_MAX; ++i) s->field_ += (char)data[i];
+        return;
+    }
+    s->upload_.status = UPLOAD_FILE_WRITE;
+    s->upload_.buf = data;
+    s->upload_.currentSize = len;
+    s->upload_.totalSize += len;
+    if (s->route_->upload) s->route_->upload();
+}
+
+void HttpServer::part_end(void *ctx, const MultipartPart *part) {
+    HttpServer *s = (HttpServer *)ctx;
+    if (!part->is_file) {
+        Arg a;
+        a.name = part->name;
+        a.value = s->field_;
+        s->args_.push_back(a);
+        s->field_ = "";
+        return;
+    }
+    s->upload_.status = UPLOAD_FILE_END;
+    s->upload_.buf = NULL;
+    s->upload_.currentSize = 0;
+    s->uploading_ = false;
+    if (s->route_->upload) s->route_->upload();
+}
+
+bool HttpServer::read_multipart(const char *content_type) {
+    char boundary[MULTIPART_BOUNDARY_MAX + 1];
+    if (!multipart_boundary(content_type, boundary, sizeof(boundary))) return false;
+    MultipartHandler h = {read_body, part_begin, part_data, part_end, this};
+    MultipartResult res = multipart_parse(boundary, &h);
+    if (res != MULTIPART_OK && uploading_) {
+        upload_.status = UPLOAD_FILE_ABORTED;
+        upload_.buf = NULL;
+        upload_.currentSize = 0;
+        uploading_ = false;
+        if (route_->upload) route_->upload();
+    }
+    if (res != MULTIPART_OK) Serial.printf("[WEB] %s: multipart body %s\n", uri_.c_str(),
+                                           res == MULTIPART_TRUNCATED ? "cut short" : "not readable");
+    return res == MULTIPART_OK;
+}
+
+bool HttpServer::readBody() {
+    // Also true while the body is being read, for args read from an upload callback
+    if (body_ != BODY_UNREAD) return body_ != BODY_FAILED;
+    if (!req_ || !route_) return false;
+    body_ = BODY_READING;
+    String type = header("Content-Type");
+    bool ok = type.startsWith("multipart/form-data") ? read_multipart(type.c_str())
+                                                     : read_plain(type.startsWith("application/x-www-form-urlencoded"));
+    body_ = ok ? BODY_DONE : BODY_FAILED;
+    if (!ok) close_ = true;
+    return ok;
+}
+
+int HttpServer::args() {
+    readBody();
+    return (int)args_.size();
+}
+
+String HttpServer::arg(const String &name) {
+    readBody();
+    for (const Arg &a : args_) if (a.name == name) return a.value;
+    return String();
+}
+
+String HttpServer::arg(int i) {
+    readBody();
+    return i >= 0 && i < (int)args_.size() ? args_[i].value : String();
+}
+
+String HttpServer::argName(int i) {
+    readBody();
+    return i >= 0 && i < (int)args_.size() ? args_[i].name : String();
+}
+
+bool HttpServer::hasArg(const String &name) {
+    readBody();
+    for (const Arg &a : args_) if (a.name == name) return true;
+    return false;
+}
+
+size_t HttpServer::clientContentLength() const {
+    return req_ ? req_->content_len : 0;
+}
+
+bool HttpServer::hasHeader(const char *name) const {
+    return req_ && httpd_req_get_hdr_value_len(req_, name) > 0;
+}
+
+String HttpServer::header(const char *name) const {
+    size_t len = req_ ? httpd_req_get_hdr_value_len(req_, name) : 0;
+    if (!len) return String();
+    char *buf = (char *)malloc(len + 1);
+    if (!buf) return String();
+    String v;
+    if (httpd_req_get_hdr_value_str(req_, name, buf, len + 1) == ESP_OK) v = buf;
+    free(buf);
+    return v;
+}
+
+void HttpServer::sendHeader(const String &name, const String &value, bool first) {
+    Arg h;
+    h.name = name;
+    h.value = value;
+    if (first) resp_headers_.insert(resp_headers_.begin(), h);
+    else resp_headers_.push_back(h);
+}
+
+// esp_http_server keeps pointers to the status, type and headers until the
+// first bytes go out, so they are held in members until the request ends
+void HttpServer::start_response(int code, const char *content_type) {
+    snprintf(status_, sizeof(status_), "%d %s", code, status_text(code));
+    content_type_ = content_type ? content_type : "text/html";
+    httpd_resp_set_status(req_, status_);
+    httpd_resp_set_type(req_, content_type_.c_str());
+    for (const Arg &h : resp_headers_) httpd_resp_set_hdr(req_, h.name.c_str(), h.value.c_str());
+    started_ = true;
+}
+
+void HttpServer::send(int code, const char *content_type, const String &content) {
+    send(code, content_type, content.c_str(), content.length());
+}
+
+void HttpServer::send(int code, const char *content_type, const char *content, size_t len) {
+    if (!req_ || started_) return;
+    start_response(code, content_type);
+    if (chunked_) {
+        if (len) sendContent(content, len);
+        return;
+    }
+    if (httpd_resp_send(req_, content, len) != ESP_OK) close_ = true;
+    ended_ = true;
+}
+
+void HttpServer::sendContent(const char *data, size_t len) {
+    if (!req_ || !chunked_ || ended_) return;
+    if (!started_) start_response(200, NULL);
+    // A zero-length chunk ends the response
+    if (httpd_resp_send_chunk(req_, len ? data : NULL, len) != ESP_OK) {
+        close_ = true;      // client gone; drop the rest
+        ended_ = true;
+        return;
+    }
+    if (!len) ended_ = true;
+}
+
+void HttpServer::streamFile(File &file, const String &content_type) {
+    String name = file.name();
+    if (name.endsWith(".gz") && content_type != "application/x-gzip" && content_type != "application/octet-stream") {
+        sendHeader("Content-Encoding", "gzip");
+    }
+    setContentLength(CONTENT_LENGTH_UNKNOWN);
+    send(200, content_type.c_str(), "");
+    char *buf = (char *)malloc(HTTP_FILE_CHUNK);
+    if (buf) {
+        size_t n;
+        while (!ended_ && (n = file.read((uint8_t *)buf, HTTP_FILE_CHUNK)) > 0) sendContent(buf, n);
+        free(buf);
+    }
+    sendContent("", 0);
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+#include <functional>
+#include <vector>
+#include <esp_http_server.h>
+#include "multipart_parser.h"
+
+// Config web server on ESP-IDF's esp_http_server, behind the part of the
+// Arduino WebServer interface the handlers use (arg(), send(), upload(), ...).
+//
+// esp_http_server runs one task that waits on every open socket with
+// select(). Connections stay open between requests (keep-alive), up to
+// HTTP_MAX_SOCKETS at once; when all are taken the least recently used one
+// is closed to make room. Requests are handled one at a time on that task,
+// so the state of the current request lives in the server object.
+//
+// The request body is read on demand: by readBody(), or on the first call
+// to one of the arg functions. Form fields become args, any other body is
+// the "plain" arg, and multipart file parts stream through the route's
+// upload callback in pieces of up to MULTIPART_WINDOW bytes.
+
+// Same definitions as Arduino's HTTP_Method.h
+typedef enum http_method HTTPMethod;
+#define HTTP_ANY (HTTPMethod)(255)
+
+#define CONTENT_LENGTH_UNKNOWN  ((size_t)-1)
+
+#define HTTP_MAX_SOCKETS        6       // LWIP has 16; the WebSocket and Signal K links need theirs
+#define HTTP_ROUTE_MAX          64
+#define HTTP_RECV_RETRIES       3       // receive timeouts tolerated in a row
+#define HTTP_FIELD_MAX          4096    // longest multipart form field kept
+#define HTTP_FILE_CHUNK         4096
+
+typedef enum {
+    UPLOAD_FILE_START,
+    UPLOAD_FILE_WRITE,
+    UPLOAD_FILE_END,
+    UPLOAD_FILE_ABORTED,
+} HttpUploadStatus;
+
+typedef struct {
+    HttpUploadStatus status;
+    String filename;
+    String name;
+    String type;
+    size_t totalSize;       // file bytes received so far
+    size_t currentSize;     // bytes at buf (UPLOAD_FILE_WRITE)
+    const uint8_t *buf;
+} HttpUpload;
+
+class HttpServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    explicit HttpServer(uint16_t port);
+
+    // Add a route; routes are tried in the order added. "{}" in the pattern
+    // matches one path segment, read back with pathArg().
+    void on(const char *uri, HTTPMethod method, THandlerFunction fn, THandlerFunction upload = nullptr);
+    // Start the server task
+    bool begin(unsigned priority, size_t stack, int core);
+
+    // ---- Current request (server task only) ---------------------------------
+    HTTPMethod method() const { return method_; }
+    const String &uri() const { return uri_; }
+    String pathArg(unsigned i) const { return i < path_args_.size() ? path_args_[i] : String(); }
+    size_t clientContentLength() const;
+    bool hasHeader(const char *name) const;
+    String header(const char *name) const;
+
+    // Read the body now (see above); false when the client went away or the
+    // multipart body was malformed
+    bool readBody();
+    int args();
+    String arg(const String &name);
+    String arg(int i);
+    String argName(int i);
+    bool hasArg(const String &name);
+    HttpUpload &upload() { return upload_; }
+
+    // ---- Response -------------------------------------------------------------
+    void sendHeader(const String &name, const String &value, bool first = false);
+    // With CONTENT_LENGTH_UNKNOWN the next send() starts a chunked response,
+    // continued by sendContent() and ended by sendContent("")
+    void setContentLength(size_t len) { chunked_ = len == CONTENT_LENGTH_UNKNOWN; }
+    void send(int code, const char *content_type = NULL, const String &content = String());
+    void send(int code, const char *content_type, const char *content, size_t len);
+    void sendContent(const char *data, size_t len);
+    void sendContent(const String &content) { sendContent(content.c_str(), content.length()); }
+    // Chunked, with Content-Encoding: gzip for a .gz file
+    void streamFile(File &file, const String &content_type);
+    // Close the connection after this response (e.g. a body left unread)
+    void closeConnection() { close_ = true; }
+
+private:
+    struct Route {
+        const char *uri;
+        HTTPMethod method;
+        THandlerFunction fn;
+        THandlerFunction upload;
+    };
+    struct Arg {
+        String name;
+        String value;
+    };
+    enum BodyState { BODY_UNREAD, BODY_READING, BODY_DONE, BODY_FAILED };
+
+    static esp_err_t handle_request(httpd_req_t *req);
+    static bool match(const char *pattern, const char *path, std::vector<String> *captures);
+    static int read_body(void *ctx, char *buf, size_t len);
+    static void part_begin(void *ctx, const MultipartPart *part);
+    static void part_data(void *ctx, const MultipartPart *part, const uint8_t *data, size_t len);
+    static void part_end(void *ctx, const MultipartPart *part);
+
+    esp_err_t dispatch(httpd_req_t *req);
+    void parse_query(const char *query, size_t len);
+    bool read_multipart(const char *content_type);
+    bool read_plain(bool form);
+    void start_response(int code, const char *content_type);
+
+    uint16_t port_;
+    httpd_handle_t handle_;
+    Route routes_[HTTP_ROUTE_MAX];
+    int route_count_;
+
+    // Current request
+    httpd_req_t *req_;
+    const Route *route_;
+    HTTPMethod method_;
+    String uri_;
+    std::vector<String> path_args_;
+    std::vector<Arg> args_;
+    BodyState body_;
+    HttpUpload upload_;
+    String field_;              // multipart field being received
+    bool uploading_;            // a file part has started and not ended
+    std::vector<Arg> resp_headers_;
+    String content_type_;
+    char status_[40];
+    bool chunked_;
+    bool started_;              // status and headers handed to the request
+    bool ended_;
+    bool close_;
+};
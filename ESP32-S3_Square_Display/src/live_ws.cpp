@@ -0,0 +1,156 @@
+#include "live_ws.h"
+#include <Arduino.h>
+#include <WebSocketsServer.h>
+#include <ArduinoJson.h>
+#include <math.h>
+#include <string.h>
+#include "signalk_config.h"
+#include "needle_motion.h"
+#include "alarm_engine.h"
+
+#define LIVE_WS_CLIENTS   WEBSOCKETS_SERVER_CLIENT_MAX
+#define LIVE_WS_POLL_MS   10
+#define LIVE_WS_SLOT_LEN  7     // f32 value + i16 angle + u8 zone
+
+typedef struct {
+    float value;
+    int16_t angle10;
+    uint8_t zone;
+} LiveSlot;
+
+typedef struct {
+    bool active;
+    bool want_key;
+    uint8_t seq;
+    uint8_t rate;
+    uint32_t next_ms;
+    uint32_t last_key_ms;
+    LiveSlot sent[LIVE_WS_SLOTS];
+} LiveClient;
+
+static WebSocketsServer live_server(LIVE_WS_PORT);
+static LiveClient live_clients[LIVE_WS_CLIENTS];
+static volatile int live_client_count = 0;
+static TaskHandle_t live_task_handle = NULL;
+
+static void live_snapshot(LiveSlot *out) {
+    for (int i = 0; i < LIVE_WS_SLOTS; ++i) {
+        out[i].value = get_sensor_value(i);
+        float a = needle_motion_angle(i / 2, i % 2);
+        out[i].angle10 = isfinite(a) ? (int16_t)lroundf(constrain(a, -3276.0f, 3276.0f) * 10.0f) : 0;
+        out[i].zone = (uint8_t)alarm_engine_committed_zone(i / 2, i % 2);
+    }
+}
+
+// Bitwise compare, so a slot that stays NaN counts as unchanged
+static bool slot_changed(const LiveSlot *a, const LiveSlot *b) {
+    return memcmp(&a->value, &b->value, sizeof(float)) != 0 || a->angle10 != b->angle10 || a->zone != b->zone;
+}
+
+static void live_send(uint8_t num, LiveClient *c, const LiveSlot *snap, uint32_t now) {
+    bool key = c->want_key || now - c->last_key_ms >= LIVE_WS_KEYFRAME_MS;
+    uint16_t mask = 0;
+    for (int i = 0; i < LIVE_WS_SLOTS; ++i) {
+        if (key || slot_changed(&snap[i], &c->sent[i])) mask |= (uint16_t)(1u << i);
+    }
+    if (!mask) return;
+
+    uint8_t frame[4 + LIVE_WS_SLOTS * LIVE_WS_SLOT_LEN];
+    size_t len = 0;
+    frame[len++] = key ? 'K' : 'D';
+    frame[len++] = c->seq++;
+    frame[len++] = mask & 0xFF;
+    frame[len++] = mask >> 8;
+    for (int i = 0; i < LIVE_WS_SLOTS; ++i) {
+        if (!(mask & (1u << i))) continue;
+        // Xtensa is little endian, which is the wire order
+        memcpy(&frame[len], &snap[i].value, 4);
+        memcpy(&frame[len + 4], &snap[i].angle10, 2);
+        frame[len + 6] = snap[i].zone;
+        len += LIVE_WS_SLOT_LEN;
+        c->sent[i] = snap[i];
+    }
+    if (key) {
+        c->want_key = false;
+        c->last_key_ms = now;
+    }
+    live_server.sendBIN(num, frame, len);
+}
+
+static void live_command(uint8_t num, LiveClient *c, const uint8_t *payload, size_t length) {
+    DynamicJsonDocument doc(128);
+    if (deserializeJson(doc, (const char *)payload, length)) return;
+    if (doc.containsKey("rate")) {
+        c->rate = (uint8_t)constrain(doc["rate"].as<int>(), 1, LIVE_WS_MAX_RATE);
+        c->next_ms = millis();
+        Serial.printf("[LIVE] Client %u rate %u Hz\n", num, c->rate);
+    }
+    if (doc["key"] | false) c->want_key = true;
+}
+
+static void live_event(uint8_t num, WStype_t type, uint8_t *payload, size_t length) {
+    if (num >= LIVE_WS_CLIENTS) return;
+    LiveClient *c = &live_clients[num];
+    switch (type) {
+        case WStype_CONNECTED: {
+            memset(c, 0, sizeof(*c));
+            c->active = true;
+            c->want_key = true;
+            c->rate = LIVE_WS_DEFAULT_RATE;
+            c->next_ms = millis();
+            live_client_count++;
+            char hello[80];
+            snprintf(hello, sizeof(hello), "{\"proto\":1,\"slots\":%d,\"rate\":%d,\"max_rate\":%d}",
+                     LIVE_WS_SLOTS, LIVE_WS_DEFAULT_RATE, LIVE_WS_MAX_RATE);
+            live_server.sendTXT(num, hello);
+            Serial.printf("[LIVE] Client %u connected from %s\n", num, live_server.remoteIP(num).toString().c_str());
+            break;
+        }
+        case WStype_DISCONNECTED:
+            if (c->active) live_client_count--;
+            c->active = false;
+            Serial.printf("[LIVE] Client %u disconnected\n", num);
+            break;
+        case WStype_TEXT:
+            if (c->active) live_command(num, c, payload, length);
+            break;
+        default:
+            break;
+    }
+}
+
+static void live_task(void *parameter) {
+    LiveSlot snap[LIVE_WS_SLOTS];
+    for (;;) {
+        live_server.loop();
+        uint32_t now = millis();
+        bool have_snap = false;
+        for (uint8_t i = 0; i < LIVE_WS_CLIENTS; ++i) {
+            LiveClient *c = &live_clients[i];
+            if (!c->active || (int32_t)(now - c->next_ms) < 0) continue;
+            // One snapshot per tick, shared by every client that is due
+            if (!have_snap) {
+                live_snapshot(snap);
+                have_snap = true;
+            }
+            live_send(i, c, snap, now);
+            c->next_ms += 1000 / c->rate;
+            if ((int32_t)(now - c->next_ms) > 0) c->next_ms = now;   // fell behind; don't burst
+        }
+        vTaskDelay(pdMS_TO_TICKS(LIVE_WS_POLL_MS));
+    }
+}
+
+void live_ws_init(void) {
+    if (live_task_handle) return;
+    live_server.begin();
+    live_server.onEvent(live_event);
+    // Drop browsers that vanish without closing (sleeping tablets)
+    live_server.enableHeartbeat(15000, 3000, 2);
+    xTaskCreatePinnedToCore(live_task, "live_ws", 4096, NULL, 1, &live_task_handle, 0);
+    Serial.printf("[LIVE] Live value WebSocket on port %d\n", LIVE_WS_PORT);
+}
+
+int live_ws_clients(void) {
+    return live_client_count;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Live values for browser dashboards and the calibration page, pushed over a
+// WebSocket on port LIVE_WS_PORT.
+//
+// On connect the device sends a text hello:
+//   {"proto":1,"slots":10,"rate":5,"max_rate":20}
+// and the client may answer with text commands at any time:
+//   {"rate":N}   frames per second, 1..LIVE_WS_MAX_RATE
+//   {"key":1}    send a keyframe now
+// Every frame after that is binary, little endian:
+//   u8  'K' keyframe (all slots) or 'D' delta (changed slots only)
+//   u8  sequence number, per client
+//   u16 slot mask, bit i = slot i (screen i / 2, gauge i % 2) follows
+//   per slot in mask: f32 value (raw Signal K units), i16 needle angle x10,
+//                     u8 committed alarm zone (0 = not classified yet)
+// A keyframe goes out every LIVE_WS_KEYFRAME_MS so a client that dropped a
+// frame resynchronises. Deltas with no changes are not sent at all.
+//
+// The server runs on its own low-priority task on core 0 and only reads
+// snapshots (sensor mutex, needle positions, committed zones), so a slow
+// browser can never stall rendering or Signal K ingest.
+
+#define LIVE_WS_PORT          81
+#define LIVE_WS_SLOTS         10
+#define LIVE_WS_DEFAULT_RATE  5
+#define LIVE_WS_MAX_RATE      20
+#define LIVE_WS_KEYFRAME_MS   5000
+
+// Start the server task; call once WiFi (station or AP) is up
+void live_ws_init(void);
+
+// Connected clients, for status pages
+int live_ws_clients(void);
+
+#ifdef __cplusplus
+}
+#endif
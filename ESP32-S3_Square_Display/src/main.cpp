@@ -15,11 +15,25 @@ bool test_mode = false;
 #include "sensESP_setup.h"
 #include "gauge_config.h"
 #include "needle_style.h"
+#include "needle_motion.h"
+#include "redraw_filter.h"
+#include "signal_filter.h"
+#include "stats_engine.h"
+#include "derived_values.h"
 #include "number_display.h"
 #include "dual_number_display.h"
 #include "quad_number_display.h"
 #include "gauge_number_display.h"
 #include "graph_display.h"
+#include "timeseries_store.h"
+#include "buzzer.h"
+#include "alarm_engine.h"
+#include "frame_governor.h"
+#include "live_ws.h"
+#include "web_task.h"
+#include "asset_index.h"
+#include "asset_transcode.h"
+#include "ota_update.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,10 +53,6 @@ bool apply_all_screen_visuals();
 
 // External UI elements (per-screen icons are declared in ui_ScreenN.h via ui.h)
 
-// Animation state tracking
-static int16_t current_needle_angle = 0;
-static int16_t current_lower_needle_angle = 0;
-
 // Global needle angle tracking for all screens (1-based: Screen1..Screen5)
 int16_t last_top_angle[6] = {0, 0, 0, 0, 0, 0};     // [screen] - all start at 0°
 int16_t last_bottom_angle[6] = {0, 180, 180, 180, 180, 180};  // [screen] - all start at 180°
@@ -54,53 +64,6 @@ int16_t last_bottom_angle[6] = {0, 180, 180, 180, 180, 180};  // [screen] - all
 unsigned long last_buzzer_time = 0;
 bool first_run_buzzer = true;
 
-// Animation callback for upper needle
-static void needle_anim_cb(void * var, int32_t v) {
-    lv_obj_t* needle = (lv_obj_t*)var;
-    if (needle != NULL) {
-        // Determine which screen/gauge this needle object corresponds to
-        int screen = 0;
-        int gauge = 0; // 0 = top
-        if (needle == ui_Needle) { screen = 0; gauge = 0; }
-        else if (needle == ui_Needle2) { screen = 1; gauge = 0; }
-        else if (needle == ui_Needle3) { screen = 2; gauge = 0; }
-        else if (needle == ui_Needle4) { screen = 3; gauge = 0; }
-        else if (needle == ui_Needle5) { screen = 4; gauge = 0; }
-
-        NeedleStyle s = get_needle_style(screen, gauge);
-        float rad = (v - 90) * PI / 180.0f;
-        static lv_point_t points[2];
-        points[0].x = s.cx + (int16_t)(s.inner * cos(rad));
-        points[0].y = s.cy + (int16_t)(s.inner * sin(rad));
-        points[1].x = s.cx + (int16_t)(s.outer * cos(rad));
-        points[1].y = s.cy + (int16_t)(s.outer * sin(rad));
-        lv_line_set_points(needle, points, 2);
-    }
-}
-
-// Animation callback for lower needle
-static void lower_needle_anim_cb(void * var, int32_t v) {
-    lv_obj_t* needle = (lv_obj_t*)var;
-    if (needle != NULL) {
-        int screen = 0;
-        int gauge = 1; // bottom
-        if (needle == ui_Lower_Needle) { screen = 0; gauge = 1; }
-        else if (needle == ui_Lower_Needle2) { screen = 1; gauge = 1; }
-        else if (needle == ui_Lower_Needle3) { screen = 2; gauge = 1; }
-        else if (needle == ui_Lower_Needle4) { screen = 3; gauge = 1; }
-        else if (needle == ui_Lower_Needle5) { screen = 4; gauge = 1; }
-
-        NeedleStyle s = get_needle_style(screen, gauge);
-        float rad = (v - 90) * PI / 180.0f;
-        static lv_point_t points[2];
-        points[0].x = s.cx + (int16_t)(s.inner * cos(rad));
-        points[0].y = s.cy + (int16_t)(s.inner * sin(rad));
-        points[1].x = s.cx + (int16_t)(s.outer * cos(rad));
-        points[1].y = s.cy + (int16_t)(s.outer * sin(rad));
-        lv_line_set_points(needle, points, 2);
-    }
-}
-
 // Auto-scroll timer handle (null when disabled)
 static lv_timer_t *auto_scroll_timer = NULL;
 
@@ -121,33 +84,13 @@ void set_auto_scroll_interval(uint16_t sec) {
     }
 }
 
-// Smooth animated needle updates - now fast with line-based rendering!
+// Screen1 needles, driven directly in setup/demo mode
 void rotate_needle(int16_t angle) {
-    if (ui_Needle != NULL && angle != current_needle_angle) {
-        lv_anim_t a;
-        lv_anim_init(&a);
-        lv_anim_set_var(&a, ui_Needle);
-        lv_anim_set_exec_cb(&a, needle_anim_cb);
-        lv_anim_set_values(&a, current_needle_angle, angle);
-        lv_anim_set_time(&a, 500);  // 500ms smooth animation
-        lv_anim_set_path_cb(&a, lv_anim_path_linear);
-        lv_anim_start(&a);
-        current_needle_angle = angle;
-    }
+    needle_motion_set_target(0, 0, angle);
 }
 
 void rotate_lower_needle(int16_t angle) {
-    if (ui_Lower_Needle != NULL && angle != current_lower_needle_angle) {
-        lv_anim_t a;
-        lv_anim_init(&a);
-        lv_anim_set_var(&a, ui_Lower_Needle);
-        lv_anim_set_exec_cb(&a, lower_needle_anim_cb);
-        lv_anim_set_values(&a, current_lower_needle_angle, angle);
-        lv_anim_set_time(&a, 500);  // 500ms smooth animation
-        lv_anim_set_path_cb(&a, lv_anim_path_linear);
-        lv_anim_start(&a);
-        current_lower_needle_angle = angle;
-    }
+    needle_motion_set_target(0, 1, angle);
 }
 
 // Legacy unit-to-angle helpers removed; mapping now uses
@@ -161,45 +104,22 @@ int16_t value_to_angle_for_param(float value, int screen, int gauge) {
     return angle;
 }
 
-// Generic needle animation helper that caches the last angle per needle
-static void animate_generic_needle(lv_obj_t* needle, int16_t &last_angle, int16_t new_angle, bool is_lower) {
-    if (needle == NULL) {
-        return;
-    }
+// Retarget a needle's motion, caching the last target angle per needle
+static void animate_generic_needle(int screen_idx, int gauge, int16_t &last_angle, int16_t new_angle) {
     if (new_angle == last_angle) {
         return;
     }
-
-    lv_anim_t a;
-    lv_anim_init(&a);
-    lv_anim_set_var(&a, needle);
-    lv_anim_set_exec_cb(&a, is_lower ? lower_needle_anim_cb : needle_anim_cb);
-    lv_anim_set_values(&a, last_angle, new_angle);
-    lv_anim_set_time(&a, 500);
-    lv_anim_set_path_cb(&a, lv_anim_path_linear);
-    lv_anim_start(&a);
-
-    
-
+    needle_motion_set_target(screen_idx, gauge, new_angle);
     last_angle = new_angle;
 }
 
 // Initialize all needle positions to defaults: top needles at 0°, bottom needles at 180°
 void initialize_needle_positions() {
-    // Set all top needles to 0 degrees (pointing up)
-    // Initialize line-based needles by calling the same callbacks used by animations
-    if (ui_Needle) needle_anim_cb(ui_Needle, 0);
-    if (ui_Needle2) needle_anim_cb(ui_Needle2, 0);
-    if (ui_Needle3) needle_anim_cb(ui_Needle3, 0);
-    if (ui_Needle4) needle_anim_cb(ui_Needle4, 0);
-    if (ui_Needle5) needle_anim_cb(ui_Needle5, 0);
-
-    // Set all bottom needles to 180 degrees (pointing down)
-    if (ui_Lower_Needle) lower_needle_anim_cb(ui_Lower_Needle, 180);
-    if (ui_Lower_Needle2) lower_needle_anim_cb(ui_Lower_Needle2, 180);
-    if (ui_Lower_Needle3) lower_needle_anim_cb(ui_Lower_Needle3, 180);
-    if (ui_Lower_Needle4) lower_needle_anim_cb(ui_Lower_Needle4, 180);
-    if (ui_Lower_Needle5) lower_needle_anim_cb(ui_Lower_Needle5, 180);
+    needle_motion_init();
+    for (int screen = 0; screen < 5; screen++) {
+        needle_motion_jump(screen, 0, 0);     // top needles pointing up
+        needle_motion_jump(screen, 1, 180);   // bottom needles pointing down
+    }
 }
 
 // File-level tracking for number displays (moved out of function scope for external reset)
@@ -218,6 +138,7 @@ extern "C" void reset_number_display_tracking(int screen_num) {
     last_display_values[screen_idx] = NAN;
     last_display_units[screen_idx] = "";
     last_display_descriptions[screen_idx] = "";
+    redraw_filter_reset(screen_idx);
     
     Serial.printf("[MAIN] Reset number display tracking for screen %d\n", screen_idx);
 }
@@ -359,6 +280,9 @@ static void update_number_display_for_screen(int screen_num) {
         display_value = NAN;
         unit_str = "N/A";
     }
+
+    // Hold back insignificant changes (deadband / interval / resolution)
+    redraw_filter_pass(screen_idx, WIDGET_SLOT_NUMBER_1, &display_value);
     
     // Create number display if it doesn't exist (note: may also be created externally via ui_hotupdate)
     if (!number_displays_created[screen_idx]) {
@@ -466,6 +390,9 @@ static void update_dual_number_display_for_screen(int screen_num) {
     String bottom_unit = "";
     String bottom_description = "";
     get_path_data(bottom_path, bottom_value, bottom_unit, bottom_description);
+
+    redraw_filter_pass(screen_idx, WIDGET_SLOT_NUMBER_1, &top_value);
+    redraw_filter_pass(screen_idx, WIDGET_SLOT_NUMBER_2, &bottom_value);
     
     // Update both displays
     dual_number_display_update_top(screen_idx, 
@@ -546,6 +473,11 @@ static void update_quad_number_display_for_screen(int screen_num) {
     get_path_data(tr_path, tr_value, tr_unit, tr_description);
     get_path_data(bl_path, bl_value, bl_unit, bl_description);
     get_path_data(br_path, br_value, br_unit, br_description);
+
+    redraw_filter_pass(screen_idx, WIDGET_SLOT_NUMBER_1, &tl_value);
+    redraw_filter_pass(screen_idx, WIDGET_SLOT_NUMBER_2, &tr_value);
+    redraw_filter_pass(screen_idx, WIDGET_SLOT_NUMBER_3, &bl_value);
+    redraw_filter_pass(screen_idx, WIDGET_SLOT_NUMBER_4, &br_value);
     
     // Update all quadrants
     quad_number_display_update_tl(screen_idx, isnan(tl_value) ? 0.0f : tl_value, tl_unit.c_str(), tl_description.c_str());
@@ -615,6 +547,7 @@ static void update_gauge_number_display_for_screen(int screen_num) {
     String center_unit = "";
     String center_description = "";
     get_path_data(center_path, center_value, center_unit, center_description);
+    redraw_filter_pass(screen_idx, WIDGET_SLOT_NUMBER_1, &center_value);
     
     // Update center number display
     gauge_number_display_update_center(screen_idx, 
@@ -641,7 +574,8 @@ static void update_graph_display_for_screen(int screen_num) {
         }
         
         // Get data directly by path
-        value = get_sensor_value_by_path(path);
+        // Graphs plot the raw signal; smoothing filters only apply to readouts
+        value = get_sensor_raw_value_by_path(path);
         unit = get_sensor_unit_by_path(path);
         description = get_sensor_description_by_path(path);
         
@@ -819,42 +753,16 @@ extern "C" void update_needles_for_screen(int screen_num) {
     }
 
 
-    // Reduced debug output for production build
-
-    animate_generic_needle(top_needle, last_top_angle[screen_num], top_angle, false);
-    animate_generic_needle(bottom_needle, last_bottom_angle[screen_num], bottom_angle, true);
+    // Hold back needle moves below the configured deadband / interval
+    float top_filtered = top_angle;
+    float bottom_filtered = bottom_angle;
+    redraw_filter_pass(screen_num - 1, WIDGET_SLOT_GAUGE_TOP, &top_filtered);
+    redraw_filter_pass(screen_num - 1, WIDGET_SLOT_GAUGE_BOTTOM, &bottom_filtered);
+    top_angle = (int16_t)lroundf(top_filtered);
+    bottom_angle = (int16_t)lroundf(bottom_filtered);
 
-    // Update dynamic icon recoloring for this screen/gauges based on current values
-    lv_obj_t* top_icon = NULL;
-    lv_obj_t* bottom_icon = NULL;
-
-    switch (screen_num) {
-        case 1:
-            top_icon = ui_TopIcon1;
-            bottom_icon = ui_BottomIcon1;
-            break;
-        case 2:
-            top_icon = ui_TopIcon2;
-            bottom_icon = ui_BottomIcon2;
-            break;
-        case 3:
-            top_icon = ui_TopIcon3;
-            bottom_icon = ui_BottomIcon3;
-            break;
-        case 4:
-            top_icon = ui_TopIcon4;
-            bottom_icon = ui_BottomIcon4;
-            break;
-        case 5:
-            top_icon = ui_TopIcon5;
-            bottom_icon = ui_BottomIcon5;
-            break;
-        default:
-            break;
-    }
-
-    if (top_icon) _ui_apply_icon_style(top_icon, screen_num - 1, 0);
-    if (bottom_icon) _ui_apply_icon_style(bottom_icon, screen_num - 1, 1);
+    if (top_needle) animate_generic_needle(screen_num - 1, 0, last_top_angle[screen_num], top_angle);
+    if (bottom_needle) animate_generic_needle(screen_num - 1, 1, last_bottom_angle[screen_num], bottom_angle);
 }
 
 // Move the specified gauge (top/bottom) on a given screen to the specified angle for testing
@@ -873,14 +781,7 @@ void test_move_gauge(int screen, int gauge, int angle) {
     if (gauge == 0) {
         // Top gauge (line)
         if (top_needles[screen]) {
-            lv_anim_t a;
-            lv_anim_init(&a);
-            lv_anim_set_var(&a, top_needles[screen]);
-            lv_anim_set_exec_cb(&a, needle_anim_cb);
-            lv_anim_set_values(&a, last_top_angle[idx], angle);
-            lv_anim_set_time(&a, 500);
-            lv_anim_set_path_cb(&a, lv_anim_path_linear);
-            lv_anim_start(&a);
+            needle_motion_set_target(screen, 0, angle);
             last_top_angle[idx] = angle;
         } else {
             // Debug output disabled for performance
@@ -888,14 +789,7 @@ void test_move_gauge(int screen, int gauge, int angle) {
     } else if (gauge == 1) {
         // Bottom gauge (line)
         if (bottom_needles[screen]) {
-            lv_anim_t a;
-            lv_anim_init(&a);
-            lv_anim_set_var(&a, bottom_needles[screen]);
-            lv_anim_set_exec_cb(&a, lower_needle_anim_cb);
-            lv_anim_set_values(&a, last_bottom_angle[idx], angle);
-            lv_anim_set_time(&a, 500);
-            lv_anim_set_path_cb(&a, lv_anim_path_linear);
-            lv_anim_start(&a);
+            needle_motion_set_target(screen, 1, angle);
             last_bottom_angle[idx] = angle;
         } else {
             // Debug output disabled for performance
@@ -914,12 +808,15 @@ void setup() {
     
     Serial.println("\n\n=== ESP32 Round Display Starting ===");
     Serial.flush();
+    // After a network update: count this boot and arm the rollback timer
+    ota_update_init();
     
     // I2C and IO expander
     I2C_Init();
     delay(100);
     TCA9554PWR_Init(0x00);
     Set_EXIO(EXIO_PIN6, Low);    // Start with buzzer OFF (board uses EXIO_PIN6)
+    buzzer_init();
     Serial.println("I2C and IO expander initialized");
     Serial.flush();
     
@@ -992,8 +889,24 @@ void setup() {
     // are available during screen construction.
     load_preferences();
 
+    // Start the SD time-series store before graph screens are built so long
+    // time ranges can be filled from stored history
+    ts_store_init();
+    // Rolling statistics behind "<path>:<stat>" virtual paths; restores the
+    // saved hour/since-reset windows, so it follows the store's clock base
+    stats_engine_init();
+    // Asset list for the web pages; loads the saved index instead of scanning
+    asset_index_init();
+    // Background PNG/JPEG to .bin conversion for uploads
+    asset_transcode_init();
+
+    // Touch controller: reset, then read it only when the GT911 raises INT
+    Touch_Init();
+
     // LVGL
     Lvgl_Init();
+    // Stretches LVGL refresh/touch polling and loop() sleeps while the display is static
+    frame_governor_init();
 
     // Initialize RGB565 binary image decoder (fast loading, no PNG decode overhead)
     rgb565_decoder_init();
@@ -1035,6 +948,10 @@ void setup() {
     
     // Initialize sensor mutex for thread-safe access
     init_sensor_mutex();
+
+    // Per-path smoothing filters, applied as Signal K values arrive
+    signal_filter_init();
+    derived_values_init();
     
     // Enable WiFi with optimizations
     Serial.println("Starting WiFi setup...");
@@ -1042,6 +959,8 @@ void setup() {
     setup_sensESP();
     Serial.println("WiFi setup complete");
     Serial.flush();
+    // Live value socket for browser dashboards and the calibration page
+    live_ws_init();
     
     // Start Signal K only if server is actually configured
     Serial.println("Checking Signal K configuration...");
@@ -1072,7 +991,6 @@ void setup() {
 }
 
 void loop() {
-    config_server.handleClient();
     // Use Signal K data instead of demo animation
     static int16_t needle_angle = 0;
     static int16_t lower_needle_angle = 0;
@@ -1111,21 +1029,11 @@ void loop() {
             if (current_screen != last_seen_screen) {
                 extern int16_t last_top_angle[6];
                 extern int16_t last_bottom_angle[6];
-                lv_obj_t* top_needle = NULL;
-                lv_obj_t* bottom_needle = NULL;
-                switch (current_screen) {
-                    case 1: top_needle = ui_Needle; bottom_needle = ui_Lower_Needle; break;
-                    case 2: top_needle = ui_Needle2; bottom_needle = ui_Lower_Needle2; break;
-                    case 3: top_needle = ui_Needle3; bottom_needle = ui_Lower_Needle3; break;
-                    case 4: top_needle = ui_Needle4; bottom_needle = ui_Lower_Needle4; break;
-                    case 5: top_needle = ui_Needle5; bottom_needle = ui_Lower_Needle5; break;
-                    default: break;
+                // Jump straight to the stored angles rather than sweeping
+                if (current_screen >= 1 && current_screen <= 5) {
+                    needle_motion_jump(current_screen - 1, 0, last_top_angle[current_screen]);
+                    needle_motion_jump(current_screen - 1, 1, last_bottom_angle[current_screen]);
                 }
-                // Directly invoke the animation callbacks to set the line points
-                // immediately (no animation) so the visual state matches the
-                // stored angles.
-                if (top_needle) needle_anim_cb(top_needle, last_top_angle[current_screen]);
-                if (bottom_needle) lower_needle_anim_cb(bottom_needle, last_bottom_angle[current_screen]);
                 last_seen_screen = current_screen;
             }
 
@@ -1133,167 +1041,20 @@ void loop() {
             last_needle_update = now;
         }
         
-        // Update icon styles and optionally trigger buzzer alerts per configured zone
-        {
-            static int last_zone_state[2] = {-1, -1}; // last selected zone per gauge (top=0,bottom=1)
-            unsigned long ALERT_COOLDOWN_MS = 60000;
-            // Use user-configured buzzer cooldown (seconds) from settings. 0 => constant (no cooldown)
-            extern uint16_t buzzer_cooldown_sec;
-            if (buzzer_cooldown_sec == 0) ALERT_COOLDOWN_MS = 0;
-            else ALERT_COOLDOWN_MS = (unsigned long)buzzer_cooldown_sec * 1000UL;
-
-            int current_screen = ui_get_current_screen();
-            int screen_idx = current_screen - 1;
-            if (screen_idx < 0) screen_idx = 0;
-
-            // Map icons for convenience
-            lv_obj_t* icons[2] = { NULL, NULL };
-            switch (current_screen) {
-                case 1: icons[0] = ui_TopIcon1; icons[1] = ui_BottomIcon1; break;
-                case 2: icons[0] = ui_TopIcon2; icons[1] = ui_BottomIcon2; break;
-                case 3: icons[0] = ui_TopIcon3; icons[1] = ui_BottomIcon3; break;
-                case 4: icons[0] = ui_TopIcon4; icons[1] = ui_BottomIcon4; break;
-                case 5: icons[0] = ui_TopIcon5; icons[1] = ui_BottomIcon5; break;
-                default: break;
-            }
-
-            // Determine runtime values for top/bottom gauges for this screen
-            float runtime_val[2] = { NAN, NAN };
-            switch (current_screen) {
-                case 1:
-                    runtime_val[0] = get_sensor_value(SCREEN1_RPM);
-                    runtime_val[1] = get_sensor_value(SCREEN1_COOLANT_TEMP);
-                    break;
-                case 2:
-                    runtime_val[0] = get_sensor_value(SCREEN2_RPM);
-                    runtime_val[1] = get_sensor_value(SCREEN2_FUEL);
-                    break;
-                case 3:
-                    runtime_val[0] = get_sensor_value(SCREEN3_COOLANT_TEMP);
-                    runtime_val[1] = get_sensor_value(SCREEN3_EXHAUST_TEMP);
-                    break;
-                case 4:
-                    runtime_val[0] = get_sensor_value(SCREEN4_FUEL);
-                    runtime_val[1] = get_sensor_value(SCREEN4_COOLANT_TEMP);
-                    break;
-                case 5:
-                    runtime_val[0] = get_sensor_value(SCREEN5_OIL_PRESSURE);
-                    runtime_val[1] = get_sensor_value(SCREEN5_COOLANT_TEMP);
-                    break;
-                default:
-                    break;
-            }
-
-            // For each gauge, choose zone and optionally trigger buzzer if configured
-            for (int g = 0; g < 2; ++g) {
-                lv_obj_t* icon = icons[g];
-                if (icon == NULL) continue;
-
-                float val = runtime_val[g];
-                int chosen_zone = -1;
-                // Prefer the most specific matching zone (smallest range) so
-                // narrow alert zones win when ranges overlap.
-                float best_range = 1e30f;
-                for (int z = 1; z <= 4; ++z) {
-                    float mn = screen_configs[screen_idx].min[g][z];
-                    float mx = screen_configs[screen_idx].max[g][z];
-                    if (mn == mx) continue;
-                    if (!isnan(val) && val >= mn && val <= mx) {
-                        float range = mx - mn;
-                        if (range < best_range) { best_range = range; chosen_zone = z; }
-                    }
-                }
-                // If no numeric match but there is a configured zone and value is NaN,
-                // pick the first configured zone (fallback behavior).
-                if (chosen_zone == -1 && isnan(val)) {
-                    for (int z = 1; z <= 4; ++z) {
-                        float mn = screen_configs[screen_idx].min[g][z];
-                        float mx = screen_configs[screen_idx].max[g][z];
-                        if (mn != mx) { chosen_zone = z; break; }
-                    }
-                }
-                if (chosen_zone == -1) chosen_zone = 1;
-                int current_state = chosen_zone - 1;
-
-                // Make icon visible and apply style for the chosen zone when it changes
-                if (current_state != last_zone_state[g]) {
-                    lv_obj_clear_flag(icon, LV_OBJ_FLAG_HIDDEN);
-                    _ui_apply_icon_style(icon, screen_idx, g);
-                    last_zone_state[g] = current_state;
-                }
-
-                // Check buzzer for Per-screen mode every cycle (not only on zone-change)
-                bool buz_enabled = (screen_configs[screen_idx].buzzer[g][chosen_zone] != 0);
-                unsigned long now = millis();
-                bool cooldown_expired = (now - last_buzzer_time > ALERT_COOLDOWN_MS);
-                if (buzzer_mode == 2 && buz_enabled && (first_run_buzzer || cooldown_expired)) {
-                    // Debug: log buzzer decision
-                    printf("[ALERT] screen=%d gauge=%d chosen_zone=%d val=%.2f buz_enabled=%d first_run=%d cooldown_expired=%d\n",
-                           screen_idx, g, chosen_zone, val, (int)buz_enabled, (int)first_run_buzzer, (int)cooldown_expired);
-                    trigger_buzzer_alert();
-                    last_buzzer_time = now;
-                    first_run_buzzer = false;
-                }
-            }
-
-            // If Global buzzer mode is enabled, scan all screens for any configured buzzer zones
-            if (buzzer_mode == 1) {
-                unsigned long now = millis();
-                bool cooldown_expired = (now - last_buzzer_time > ALERT_COOLDOWN_MS);
-                if (first_run_buzzer || cooldown_expired) {
-                    bool fired = false;
-                    for (int s = 0; s < NUM_SCREENS && !fired; ++s) {
-                        // For each gauge on screen s
-                        for (int g = 0; g < 2 && !fired; ++g) {
-                            // Get runtime value for that screen/gauge
-                            float rval = NAN;
-                            switch (s+1) {
-                                case 1: rval = (g==0) ? get_sensor_value(SCREEN1_RPM) : get_sensor_value(SCREEN1_COOLANT_TEMP); break;
-                                case 2: rval = (g==0) ? get_sensor_value(SCREEN2_RPM) : get_sensor_value(SCREEN2_FUEL); break;
-                                case 3: rval = (g==0) ? get_sensor_value(SCREEN3_COOLANT_TEMP) : get_sensor_value(SCREEN3_EXHAUST_TEMP); break;
-                                case 4: rval = (g==0) ? get_sensor_value(SCREEN4_FUEL) : get_sensor_value(SCREEN4_COOLANT_TEMP); break;
-                                case 5: rval = (g==0) ? get_sensor_value(SCREEN5_OIL_PRESSURE) : get_sensor_value(SCREEN5_COOLANT_TEMP); break;
-                                default: rval = NAN; break;
-                            }
-                            int chosen_zone = -1;
-                            float best_range = 1e30f;
-                            for (int z = 1; z <= 4; ++z) {
-                                float mn = screen_configs[s].min[g][z];
-                                float mx = screen_configs[s].max[g][z];
-                                if (mn == mx) continue;
-                                if (!isnan(rval) && rval >= mn && rval <= mx) {
-                                    float range = mx - mn;
-                                    if (range < best_range) { best_range = range; chosen_zone = z; }
-                                }
-                            }
-                            if (chosen_zone == -1 && isnan(rval)) {
-                                for (int z = 1; z <= 4; ++z) {
-                                    float mn = screen_configs[s].min[g][z];
-                                    float mx = screen_configs[s].max[g][z];
-                                    if (mn != mx) { chosen_zone = z; break; }
-                                }
-                            }
-                            if (chosen_zone == -1) chosen_zone = 1;
-                            bool buz_enabled = (screen_configs[s].buzzer[g][chosen_zone] != 0);
-                            if (buz_enabled) {
-                                printf("[ALERT-GLOBAL] screen=%d gauge=%d chosen_zone=%d val=%.2f buz_enabled=%d\n",
-                                       s, g, chosen_zone, rval, (int)buz_enabled);
-                                trigger_buzzer_alert();
-                                last_buzzer_time = now;
-                                first_run_buzzer = false;
-                                fired = true;
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        // Zone changes (icons, buzzer, logs) are committed by the alarm engine;
+        // this is a no-op while values are steady and no alarm is sounding
+        alarm_engine_service(ui_get_current_screen());
     }
     
     Lvgl_Loop();
 
-    // Small delay to prevent excessive loop iterations
-    delay(1);
-    yield();
+    // Pick the refresh rate for the next pass, then sleep 1-20 ms depending on
+    // how busy the display is (a touch or new data wakes us early)
+    frame_governor_service();
+    // Confirms freshly updated firmware once the loop has run long enough
+    ota_update_service();
+    // Web handlers that touch the UI run while we sleep (see web_task.h)
+    ui_unlock();
+    frame_governor_wait();
+    ui_lock();
 }
@@ -0,0 +1,186 @@
+#include "multipart_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+// The part of the body currently buffered
+typedef struct {
+    const MultipartHandler *h;
+    char *buf;
+    size_t cap;
+    size_t have;
+    bool eof;
+} Window;
+
+static bool fill(Window *w) {
+    if (w->eof || w->have == w->cap) return false;
+    int n = w->h->read(w->h->ctx, w->buf + w->have, w->cap - w->have);
+    if (n <= 0) {
+        w->eof = true;
+        return false;
+    }
+    w->have += (size_t)n;
+    return true;
+}
+
+static void consume(Window *w, size_t n) {
+    memmove(w->buf, w->buf + n, w->have - n);
+    w->have -= n;
+}
+
+// Offset of `pat` in the window, or -1
+static long find(const Window *w, const char *pat, size_t len) {
+    if (w->have < len) return -1;
+    const char *p = w->buf, *end = w->buf + w->have - len + 1;
+    while (p < end) {
+        p = (const char *)memchr(p, pat[0], (size_t)(end - p));
+        if (!p) return -1;
+        if (memcmp(p, pat, len) == 0) return (long)(p - w->buf);
+        ++p;
+    }
+    return -1;
+}
+
+// Offset of the next CRLF, reading more as needed; -1 at the end of the
+// body or when the line does not fit the window
+static long line_end(Window *w) {
+    for (;;) {
+        long i = find(w, "\r\n", 2);
+        if (i >= 0) return i;
+        if (!fill(w)) return -1;
+    }
+}
+
+static bool key_is(const char *s, size_t len, const char *key) {
+    return len == strlen(key) && strncasecmp(s, key, len) == 0;
+}
+
+static void copy_value(char *dst, const char *s, size_t len) {
+    while (len && s[len - 1] == ' ') --len;
+    if (len >= 2 && s[0] == '"' && s[len - 1] == '"') {
+        ++s;
+        len -= 2;
+    }
+    if (len >= MULTIPART_PARAM_MAX) len = MULTIPART_PARAM_MAX - 1;
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+}
+
+static void parse_header(MultipartPart *part, const char *line, size_t len) {
+    const char *colon = (const char *)memchr(line, ':', len);
+    if (!colon) return;
+    const char *v = colon + 1, *end = line + len;
+    while (v < end && *v == ' ') ++v;
+    size_t klen = (size_t)(colon - line);
+    if (key_is(line, klen, "Content-Type")) {
+        copy_value(part->content_type, v, (size_t)(end - v));
+        return;
+    }
+    if (!key_is(line, klen, "Content-Disposition")) return;
+    // form-data; name="field"; filename="file.png"
+    while (v < end) {
+        const char *semi = v;
+        bool quoted = false;
+        while (semi < end && (quoted || *semi != ';')) {
+            if (*semi == '"') quoted = !quoted;
+            ++semi;
+        }
+        const char *eq = (const char *)memchr(v, '=', (size_t)(semi - v));
+        if (eq) {
+            size_t kl = (size_t)(eq - v);
+            while (kl && v[kl - 1] == ' ') --kl;
+            if (key_is(v, kl, "name")) {
+                copy_value(part->name, eq + 1, (size_t)(semi - eq - 1));
+            } else if (key_is(v, kl, "filename")) {
+                copy_value(part->filename, eq + 1, (size_t)(semi - eq - 1));
+                part->is_file = true;
+            }
+        }
+        v = semi + 1;
+        while (v < end && *v == ' ') ++v;
+    }
+}
+
+bool multipart_boundary(const char *content_type, char *out, size_t cap) {
+    if (!content_type) return false;
+    for (const char *p = content_type; *p; ++p) {
+        if (strncasecmp(p, "boundary=", 9) != 0) continue;
+        const char *v = p + 9;
+        size_t len = strcspn(v, ";");
+        while (len && v[len - 1] == ' ') --len;
+        if (len >= 2 && v[0] == '"' && v[len - 1] == '"') {
+            ++v;
+            len -= 2;
+        }
+        if (len == 0 || len > MULTIPART_BOUNDARY_MAX || len >= cap) return false;
+        memcpy(out, v, len);
+        out[len] = '\0';
+        return true;
+    }
+    return false;
+}
+
+MultipartResult multipart_parse(const char *boundary, const MultipartHandler *h) {
+    size_t blen = strlen(boundary);
+    if (blen == 0 || blen > MULTIPART_BOUNDARY_MAX) return MULTIPART_MALFORMED;
+    char delim[MULTIPART_BOUNDARY_MAX + 5];
+    size_t dlen = (size_t)snprintf(delim, sizeof(delim), "\r\n--%s", boundary);
+
+    Window w = {h, NULL, MULTIPART_WINDOW + dlen, 0, false};
+    w.buf = (char *)malloc(w.cap);
+    if (!w.buf) return MULTIPART_NO_MEMORY;
+    // The first boundary has no CRLF ahead of it; supplying one lets every
+    // boundary be found the same way, and skips any preamble
+    memcpy(w.buf, "\r\n", 2);
+    w.have = 2;
+
+    MultipartPart part;
+    memset(&part, 0, sizeof(part));
+    bool in_part = false;
+    MultipartResult res = MULTIPART_TRUNCATED;
+    for (;;) {
+        long i = find(&w, delim, dlen);
+        if (i < 0) {
+            // Anything that cannot be the start of a boundary goes out now
+            if (w.have >= dlen) {
+                size_t n = w.have - (dlen - 1);
+                if (in_part && h->part_data) h->part_data(h->ctx, &part, (const uint8_t *)w.buf, n);
+                consume(&w, n);
+            }
+            if (!fill(&w)) break;
+            continue;
+        }
+        if (in_part) {
+            if (i > 0 && h->part_data) h->part_data(h->ctx, &part, (const uint8_t *)w.buf, (size_t)i);
+            if (h->part_end) h->part_end(h->ctx, &part);
+            in_part = false;
+        }
+        consume(&w, (size_t)i + dlen);
+        while (w.have < 2 && fill(&w)) {}
+        if (w.have < 2) break;
+        if (w.buf[0] == '-' && w.buf[1] == '-') {
+            res = MULTIPART_OK;     // closing boundary; the epilogue is ignored
+            break;
+        }
+        // Rest of the boundary line, then the part headers up to a blank line
+        memset(&part, 0, sizeof(part));
+        long e = line_end(&w);
+        if (e >= 0) {
+            consume(&w, (size_t)e + 2);
+            while ((e = line_end(&w)) > 0) {
+                parse_header(&part, w.buf, (size_t)e);
+                consume(&w, (size_t)e + 2);
+            }
+        }
+        if (e < 0) {
+            res = w.eof ? MULTIPART_TRUNCATED : MULTIPART_MALFORMED;
+            break;
+        }
+        consume(&w, 2);
+        in_part = true;
+        if (h->part_begin) h->part_begin(h->ctx, &part);
+    }
+    free(w.buf);
+    return res;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming multipart/form-data parser for the web server's uploads, kept
+// free of Arduino/IDF so it can be tested on the host
+// (test/test_multipart_parser).
+//
+// The body is pulled through one MULTIPART_WINDOW buffer: part data is
+// handed out in pieces straight from the window as soon as it cannot be the
+// start of the next boundary, so a file of any size is parsed in constant
+// memory.
+
+#define MULTIPART_WINDOW        4096    // body bytes examined at a time
+#define MULTIPART_BOUNDARY_MAX  70      // RFC 2046 limit
+#define MULTIPART_PARAM_MAX     128     // name, filename and content type
+
+typedef struct {
+    char name[MULTIPART_PARAM_MAX];
+    char filename[MULTIPART_PARAM_MAX];
+    char content_type[MULTIPART_PARAM_MAX];
+    bool is_file;                       // had a filename parameter
+} MultipartPart;
+
+typedef struct {
+    // Read up to `len` body bytes into `buf`; 0 or less ends the body
+    int (*read)(void *ctx, char *buf, size_t len);
+    void (*part_begin)(void *ctx, const MultipartPart *part);
+    void (*part_data)(void *ctx, const MultipartPart *part, const uint8_t *data, size_t len);
+    void (*part_end)(void *ctx, const MultipartPart *part);
+    void *ctx;
+} MultipartHandler;
+
+typedef enum {
+    MULTIPART_OK = 0,
+    MULTIPART_TRUNCATED,    // body ended before the closing boundary
+    MULTIPART_MALFORMED,    // part headers missing or too long
+    MULTIPART_NO_MEMORY,
+} MultipartResult;
+
+// Copy the boundary parameter of a Content-Type header into `out`; false
+// when there is none or it does not fit
+bool multipart_boundary(const char *content_type, char *out, size_t cap);
+
+// Parse a whole body. A part that was begun but not ended when this
+// returns an error was cut short.
+MultipartResult multipart_parse(const char *boundary, const MultipartHandler *h);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,177 @@
+#include "needle_motion.h"
+#include "needle_style.h"
+#include "ui.h"
+#include <math.h>
+
+#define NEEDLE_COUNT (5 * 2)
+#define NEEDLE_STEP_PERIOD_MS LV_DISP_DEF_REFR_PERIOD
+#define NEEDLE_MAX_DT 0.1f              // cap after a paused timer or a slow frame
+#define NEEDLE_SETTLE_ANGLE 0.05f       // degrees
+#define NEEDLE_SETTLE_RATE 1.0f         // degrees per second
+// A critically damped spring is within ~1% of its target after 6.6 / omega,
+// so this maps the configured damping time onto omega
+#define NEEDLE_SETTLE_OMEGA_MS 6600.0f
+
+typedef struct {
+    float pos;              // degrees, as last drawn
+    float vel;              // degrees per second
+    float target;
+    float omega;            // spring stiffness; 0 = snap to target
+    float max_rate;         // degrees per second; 0 = unlimited
+    float cx, cy, inner, outer;
+    lv_point_t points[2];   // owned per needle; lv_line keeps a pointer to it
+    bool moving;
+    bool drawn;
+} NeedleMotion;
+
+static NeedleMotion needles[NEEDLE_COUNT];
+static lv_timer_t *needle_timer = NULL;
+static uint32_t needle_last_tick = 0;
+
+static lv_obj_t *needle_obj(int screen, int gauge) {
+    switch (screen) {
+        case 0: return gauge ? ui_Lower_Needle : ui_Needle;
+        case 1: return gauge ? ui_Lower_Needle2 : ui_Needle2;
+        case 2: return gauge ? ui_Lower_Needle3 : ui_Needle3;
+        case 3: return gauge ? ui_Lower_Needle4 : ui_Needle4;
+        case 4: return gauge ? ui_Lower_Needle5 : ui_Needle5;
+        default: return NULL;
+    }
+}
+
+static NeedleMotion *needle_at(int screen, int gauge) {
+    if (screen < 0 || screen >= NEEDLE_COUNT / 2 || gauge < 0 || gauge > 1) return NULL;
+    return &needles[screen * 2 + gauge];
+}
+
+static void needle_draw(int idx) {
+    NeedleMotion *n = &needles[idx];
+    lv_obj_t *obj = needle_obj(idx / 2, idx % 2);
+    if (!obj) return;
+
+    float rad = (n->pos - 90.0f) * (float)PI / 180.0f;
+    float c = cosf(rad), s = sinf(rad);
+    lv_point_t p0, p1;
+    p0.x = (lv_coord_t)(n->cx + (int16_t)(n->inner * c));
+    p0.y = (lv_coord_t)(n->cy + (int16_t)(n->inner * s));
+    p1.x = (lv_coord_t)(n->cx + (int16_t)(n->outer * c));
+    p1.y = (lv_coord_t)(n->cy + (int16_t)(n->outer * s));
+    // Sub-pixel motion does not change the line, so skip the invalidation
+    if (n->drawn && p0.x == n->points[0].x && p0.y == n->points[0].y &&
+        p1.x == n->points[1].x && p1.y == n->points[1].y) {
+        return;
+    }
+    // The points are updated in place, so mark the old position dirty first
+    if (n->drawn) lv_obj_invalidate(obj);
+    n->points[0] = p0;
+    n->points[1] = p1;
+    lv_line_set_points(obj, n->points, 2);
+    n->drawn = true;
+}
+
+static void needle_step(NeedleMotion *n, float dt) {
+    float prev = n->pos;
+    if (n->omega <= 0.0f) {
+        n->pos = n->target;
+        n->vel = 0.0f;
+    } else {
+        // Closed-form critically damped step: stable for any dt, and a new
+        // target keeps the current velocity instead of starting from rest
+        float w = n->omega;
+        float x = n->pos - n->target;
+        float decay = expf(-w * dt);
+        float t = (n->vel + w * x) * dt;
+        n->pos = n->target + (x + t) * decay;
+        n->vel = (n->vel - w * t) * decay;
+    }
+    if (n->max_rate > 0.0f) {
+        float limit = n->max_rate * dt;
+        float moved = n->pos - prev;
+        if (moved > limit) { n->pos = prev + limit; n->vel = n->max_rate; }
+        else if (moved < -limit) { n->pos = prev - limit; n->vel = -n->max_rate; }
+    }
+    if (fabsf(n->pos - n->target) < NEEDLE_SETTLE_ANGLE && fabsf(n->vel) < NEEDLE_SETTLE_RATE) {
+        n->pos = n->target;
+        n->vel = 0.0f;
+        n->moving = false;
+    }
+}
+
+static void needle_timer_cb(lv_timer_t *t) {
+    uint32_t now = lv_tick_get();
+    float dt = (float)(now - needle_last_tick) / 1000.0f;
+    needle_last_tick = now;
+    if (dt > NEEDLE_MAX_DT) dt = NEEDLE_MAX_DT;
+
+    bool any = false;
+    for (int i = 0; i < NEEDLE_COUNT; i++) {
+        NeedleMotion *n = &needles[i];
+        if (!n->moving) continue;
+        needle_step(n, dt);
+        needle_draw(i);
+        any |= n->moving;
+    }
+    if (!any) lv_timer_pause(t);
+}
+
+static void needle_wake() {
+    if (!needle_timer || !needle_timer->paused) return;
+    needle_last_tick = lv_tick_get();
+    lv_timer_resume(needle_timer);
+    lv_timer_ready(needle_timer);
+}
+
+void needle_motion_reload() {
+    for (int i = 0; i < NEEDLE_COUNT; i++) {
+        NeedleMotion *n = &needles[i];
+        NeedleStyle s = get_needle_style(i / 2, i % 2);
+        n->cx = s.cx;
+        n->cy = s.cy;
+        n->inner = s.inner;
+        n->outer = s.outer;
+        n->omega = s.damping_ms ? NEEDLE_SETTLE_OMEGA_MS / (float)s.damping_ms : 0.0f;
+        n->max_rate = (float)s.max_rate;
+        if (n->drawn) {
+            // Geometry may have changed; force a redraw at the current angle
+            n->drawn = false;
+            lv_obj_t *obj = needle_obj(i / 2, i % 2);
+            if (obj) lv_obj_invalidate(obj);
+            needle_draw(i);
+        }
+    }
+}
+
+void needle_motion_init() {
+    needle_motion_reload();
+    if (!needle_timer) {
+        needle_timer = lv_timer_create(needle_timer_cb, NEEDLE_STEP_PERIOD_MS, NULL);
+        lv_timer_pause(needle_timer);
+    }
+}
+
+void needle_motion_set_target(int screen, int gauge, float angle) {
+    NeedleMotion *n = needle_at(screen, gauge);
+    if (!n || (angle == n->target && (n->moving || n->pos == angle))) return;
+    n->target = angle;
+    n->moving = true;
+    needle_wake();
+}
+
+void needle_motion_jump(int screen, int gauge, float angle) {
+    NeedleMotion *n = needle_at(screen, gauge);
+    if (!n) return;
+    n->pos = angle;
+    n->target = angle;
+    n->vel = 0.0f;
+    n->moving = false;
+    needle_draw(screen * 2 + gauge);
+}
+
+float needle_motion_angle(int screen, int gauge) {
+    NeedleMotion *n = needle_at(screen, gauge);
+    return n ? n->pos : NAN;
+}
+
+bool needle_motion_is_moving() {
+    return needle_timer && !needle_timer->paused;
+}
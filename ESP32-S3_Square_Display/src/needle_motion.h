@@ -0,0 +1,35 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// Needle motion model shared by every gauge needle.
+//
+// Each needle keeps a current angle and angular velocity and is eased toward
+// its latest target by a critically damped spring, optionally capped at a
+// maximum slew rate. One LVGL timer steps all moving needles per frame and
+// pauses itself once they have settled, so a new target simply retargets the
+// motion in flight instead of restarting an animation.
+//
+// Screen is 0-based (Screen1 = 0), gauge 0 = top, 1 = bottom.
+
+#define NEEDLE_DEFAULT_DAMPING_MS 500   // roughly the old 500 ms sweep
+#define NEEDLE_MAX_DAMPING_MS     5000
+#define NEEDLE_MAX_RATE_DPS       3600
+
+// Load geometry/damping and create the step timer. Call after ui_init().
+void needle_motion_init();
+
+// Re-read needle geometry and damping after the needle settings change
+void needle_motion_reload();
+
+// Ease the needle toward angle (degrees)
+void needle_motion_set_target(int screen, int gauge, float angle);
+
+// Place the needle at angle immediately, cancelling any motion
+void needle_motion_jump(int screen, int gauge, float angle);
+
+// Angle the needle was last stepped to (degrees); safe to read from any task
+float needle_motion_angle(int screen, int gauge);
+
+// True while any needle is still moving
+bool needle_motion_is_moving();
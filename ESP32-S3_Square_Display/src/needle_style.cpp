@@ -1,6 +1,7 @@
 #include "needle_style.h"
 #include "sensESP_setup.h"
 #include "ui.h"
+#include "needle_motion.h"
 #include <Preferences.h>
 
 extern Preferences preferences;
@@ -30,6 +31,8 @@ static String pref_key_cy(int s) { char b[32]; snprintf(b,sizeof(b),"n_s%d_cy",
 static String pref_key_rounded(int s, int g) { char b[32]; snprintf(b,sizeof(b),"n_s%d_g%d_rounded", s, g); return String(b); }
 static String pref_key_gradient(int s, int g) { char b[32]; snprintf(b,sizeof(b),"n_s%d_g%d_gradient", s, g); return String(b); }
 static String pref_key_fg(int s, int g) { char b[32]; snprintf(b,sizeof(b),"n_s%d_g%d_fg", s, g); return String(b); }
+static String pref_key_damping(int s, int g) { char b[32]; snprintf(b,sizeof(b),"n_s%d_g%d_damp", s, g); return String(b); }
+static String pref_key_rate(int s, int g) { char b[32]; snprintf(b,sizeof(b),"n_s%d_g%d_rate", s, g); return String(b); }
 
 NeedleStyle get_needle_style(int screen, int gauge) {
     NeedleStyle s;
@@ -50,6 +53,8 @@ NeedleStyle get_needle_style(int screen, int gauge) {
     s.rounded = false;
     s.gradient = false;
     s.foreground = true; // default foreground
+    s.damping_ms = NEEDLE_DEFAULT_DAMPING_MS;
+    s.max_rate = 0;
 
     if (preferences.begin("settings", true)) {
         s.color = preferences.getString(pref_key_color(screen,gauge).c_str(), s.color);
@@ -61,6 +66,8 @@ NeedleStyle get_needle_style(int screen, int gauge) {
         s.rounded = preferences.getUShort(pref_key_rounded(screen,gauge).c_str(), s.rounded ? 1 : 0) != 0;
         s.gradient = preferences.getUShort(pref_key_gradient(screen,gauge).c_str(), s.gradient ? 1 : 0) != 0;
         s.foreground = preferences.getUShort(pref_key_fg(screen,gauge).c_str(), s.foreground ? 1 : 0) != 0;
+        s.damping_ms = preferences.getUShort(pref_key_damping(screen,gauge).c_str(), s.damping_ms);
+        s.max_rate = preferences.getUShort(pref_key_rate(screen,gauge).c_str(), s.max_rate);
         preferences.end();
     }
     return s;
@@ -77,21 +84,29 @@ void apply_needle_style_to_obj(lv_obj_t* obj, int screen, int gauge) {
     if (s.foreground) lv_obj_move_foreground(obj); else lv_obj_move_background(obj);
 }
 
+// Needle line objects: ui_Needle (screen 0), ui_Needle2 (screen 1)...
+static lv_obj_t* needle_obj(int screen, int gauge) {
+    lv_obj_t* top[] = {ui_Needle, ui_Needle2, ui_Needle3, ui_Needle4, ui_Needle5};
+    lv_obj_t* bottom[] = {ui_Lower_Needle, ui_Lower_Needle2, ui_Lower_Needle3, ui_Lower_Needle4, ui_Lower_Needle5};
+    if (screen < 0 || screen >= 5) return NULL;
+    return gauge == 0 ? top[screen] : bottom[screen];
+}
+
+void apply_needle_style(int screen, int gauge) {
+    apply_needle_style_to_obj(needle_obj(screen, gauge), screen, gauge);
+    needle_motion_reload();
+}
+
 void apply_all_needle_styles() {
-    // Top needles: ui_Needle (screen 0), ui_Needle2 (screen1)...
-    apply_needle_style_to_obj(ui_Needle, 0, 0);
-    apply_needle_style_to_obj(ui_Lower_Needle, 0, 1);
-    apply_needle_style_to_obj(ui_Needle2, 1, 0);
-    apply_needle_style_to_obj(ui_Lower_Needle2, 1, 1);
-    apply_needle_style_to_obj(ui_Needle3, 2, 0);
-    apply_needle_style_to_obj(ui_Lower_Needle3, 2, 1);
-    apply_needle_style_to_obj(ui_Needle4, 3, 0);
-    apply_needle_style_to_obj(ui_Lower_Needle4, 3, 1);
-    apply_needle_style_to_obj(ui_Needle5, 4, 0);
-    apply_needle_style_to_obj(ui_Lower_Needle5, 4, 1);
+    for (int s = 0; s < 5; ++s) {
+        apply_needle_style_to_obj(needle_obj(s, 0), s, 0);
+        apply_needle_style_to_obj(needle_obj(s, 1), s, 1);
+    }
+    // Pick up new geometry and damping in the motion model
+    needle_motion_reload();
 }
 
-void save_needle_style_from_args(int screen, int gauge, const String& color, uint16_t width, int16_t inner, int16_t outer, uint16_t cx, uint16_t cy, bool rounded, bool gradient, bool fg) {
+void save_needle_style_from_args(int screen, int gauge, const String& color, uint16_t width, int16_t inner, int16_t outer, uint16_t cx, uint16_t cy, bool rounded, bool gradient, bool fg, uint16_t damping_ms, uint16_t max_rate) {
     if (!preferences.begin("settings", false)) return;
     preferences.putString(pref_key_color(screen,gauge).c_str(), color);
     preferences.putUShort(pref_key_width(screen,gauge).c_str(), width);
@@ -102,6 +117,8 @@ void save_needle_style_from_args(int screen, int gauge, const String& color, uin
     preferences.putUShort(pref_key_rounded(screen,gauge).c_str(), rounded ? 1 : 0);
     preferences.putUShort(pref_key_gradient(screen,gauge).c_str(), gradient ? 1 : 0);
     preferences.putUShort(pref_key_fg(screen,gauge).c_str(), fg ? 1 : 0);
+    preferences.putUShort(pref_key_damping(screen,gauge).c_str(), damping_ms);
+    preferences.putUShort(pref_key_rate(screen,gauge).c_str(), max_rate);
     preferences.end();
 }
 
@@ -13,6 +13,8 @@ struct NeedleStyle {
     bool rounded;      // rounded end caps
     bool gradient;     // pseudo-gradient enabled (not implemented fully)
     bool foreground;   // true -> move to foreground
+    uint16_t damping_ms; // needle settle time (ms), 0 = jump straight to the value
+    uint16_t max_rate; // max needle speed (deg/s), 0 = unlimited
 };
 
 // Initialize defaults (called internally)
@@ -24,8 +26,11 @@ NeedleStyle get_needle_style(int screen, int gauge);
 // Apply style to a specific lv line object
 void apply_needle_style_to_obj(lv_obj_t* obj, int screen, int gauge);
 
+// Apply the style of one needle after only its settings changed
+void apply_needle_style(int screen, int gauge);
+
 // Apply styles to all needle objects (ui_Needle, ui_Needle2, ...)
 void apply_all_needle_styles();
 
 // Persist settings via Preferences (namespace "settings") - helpers used by WebUI
-void save_needle_style_from_args(int screen, int gauge, const String& color, uint16_t width, int16_t inner, int16_t outer, uint16_t cx, uint16_t cy, bool rounded, bool gradient, bool fg);
+void save_needle_style_from_args(int screen, int gauge, const String& color, uint16_t width, int16_t inner, int16_t outer, uint16_t cx, uint16_t cy, bool rounded, bool gradient, bool fg, uint16_t damping_ms, uint16_t max_rate);
@@ -0,0 +1,369 @@
+#include "ota_update.h"
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp_heap_caps.h>
+#include <mbedtls/sha256.h>
+#include <string.h>
+#include "web_task.h"
+#include "web_config.h"
+#include "timeseries_store.h"
+#include "stats_engine.h"
+
+#define OTA_NAMESPACE       "ota"
+#define OTA_TASK_STACK      3072
+#define OTA_TASK_PRIORITY   1
+#define OTA_TASK_CORE       0
+#define OTA_RESTART_DELAY_MS 1000   // let the response reach the client
+
+typedef enum {
+    OTA_RESULT_NONE = 0,
+    OTA_RESULT_RECEIVING,
+    OTA_RESULT_DONE,
+    OTA_RESULT_FAILED,
+} OtaResult;
+
+static HttpServer *ota_server = NULL;
+
+// Update in flight (web task only)
+static esp_ota_handle_t ota_handle = 0;
+static const esp_partition_t *ota_target = NULL;
+static bool ota_active = false;
+static bool ota_uploaded = false;   // this request carried a file part
+static uint8_t *ota_buf = NULL;
+static size_t ota_fill = 0;
+static mbedtls_sha256_context ota_sha;
+static String ota_expected;
+// Outcome of the last update, for the response and GET /api/ota
+static OtaResult ota_result = OTA_RESULT_NONE;
+static String ota_error;
+static int ota_error_code = 0;
+static uint32_t ota_bytes = 0;
+static uint32_t ota_t0 = 0;
+static uint32_t ota_ms = 0;
+static char ota_sha_hex[65] = "";
+
+// Trial of freshly installed firmware
+static bool ota_trial = false;
+static volatile bool ota_confirmed = false;
+static uint8_t ota_boots = 0;
+
+// Arduino confirms a pending image at startup unless this returns true;
+// the confirmation happens in ota_update_service() instead
+extern "C" bool verifyRollbackLater() {
+    return true;
+}
+
+static const char *state_name(esp_ota_img_states_t st) {
+    switch (st) {
+        case ESP_OTA_IMG_NEW: return "new";
+        case ESP_OTA_IMG_PENDING_VERIFY: return "pending_verify";
+        case ESP_OTA_IMG_VALID: return "valid";
+        case ESP_OTA_IMG_INVALID: return "invalid";
+        case ESP_OTA_IMG_ABORTED: return "aborted";
+        default: return "undefined";
+    }
+}
+
+static bool running_pending_verify(void) {
+    esp_ota_img_states_t st;
+    return esp_ota_get_state_partition(esp_ota_get_running_partition(), &st) == ESP_OK &&
+           st == ESP_OTA_IMG_PENDING_VERIFY;
+}
+
+static void ota_rollback(const char *reason) {
+    Serial.printf("[OTA] Rolling back: %s\n", reason);
+    Serial.flush();
+    // With bootloader rollback support the image is pending verification
+    // and the bootloader restores the previous one
+    if (running_pending_verify()) esp_ota_mark_app_invalid_rollback_and_reboot();
+
+    // Otherwise point the boot partition back by hand
+    Preferences p;
+    p.begin(OTA_NAMESPACE, true);
+    String prev = p.getString("prev", "");
+    p.end();
+    const esp_partition_t *part = prev.length()
+        ? esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, prev.c_str()) : NULL;
+    if (!part || esp_ota_set_boot_partition(part) != ESP_OK) {
+        Serial.println("[OTA] No previous firmware to return to; staying on this one");
+        return;
+    }
+    esp_restart();
+}
+
+static void ota_watchdog_task(void *parameter) {
+    (void)parameter;
+    vTaskDelay(pdMS_TO_TICKS(OTA_CONFIRM_TIMEOUT_S * 1000UL));
+    if (!ota_confirmed) ota_rollback("not confirmed in time");
+    vTaskDelete(NULL);
+}
+
+void ota_update_init(void) {
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    Preferences p;
+    p.begin(OTA_NAMESPACE, false);
+    bool trial = p.getUChar("trial", 0) != 0;
+    String prev = p.getString("prev", "");
+    if (trial && prev == running->label) {
+        // The update never confirmed and we are back on the old firmware
+        Serial.printf("[OTA] Update was rolled back, running %s\n", running->label);
+        p.putUChar("trial", 0);
+        trial = false;
+    }
+    if (trial || running_pending_verify()) {
+        ota_boots = p.getUChar("boots", 0) + 1;
+        p.putUChar("boots", ota_boots);
+        p.end();
+        Serial.printf("[OTA] New firmware on %s, trial boot %u of %u\n", running->label, ota_boots, OTA_TRIAL_BOOTS);
+        if (ota_boots > OTA_TRIAL_BOOTS) ota_rollback("restarted without confirming");
+        ota_trial = true;
+        xTaskCreatePinnedToCore(ota_watchdog_task, "ota_wdt", OTA_TASK_STACK, NULL, OTA_TASK_PRIORITY, NULL, OTA_TASK_CORE);
+        return;
+    }
+    p.end();
+}
+
+void ota_update_service(void) {
+    if (!ota_trial || ota_confirmed) return;
+    if (millis() < OTA_CONFIRM_AFTER_S * 1000UL) return;
+    ota_confirmed = true;
+    esp_ota_mark_app_valid_cancel_rollback();
+    Preferences p;
+    p.begin(OTA_NAMESPACE, false);
+    p.putUChar("trial", 0);
+    p.putUChar("boots", 0);
+    p.end();
+    Serial.printf("[OTA] Firmware on %s confirmed\n", esp_ota_get_running_partition()->label);
+}
+
+// ---- Receiving ----
+
+static void ota_fail(int code, const String &msg) {
+    if (ota_result != OTA_RESULT_FAILED) {
+        ota_result = OTA_RESULT_FAILED;
+        ota_error = msg;
+        ota_error_code = code;
+        Serial.printf("[OTA] Update failed: %s\n", msg.c_str());
+    }
+    if (ota_active) {
+        esp_ota_abort(ota_handle);
+        mbedtls_sha256_free(&ota_sha);
+        ota_active = false;
+    }
+}
+
+static void ota_free_buffer(void) {
+    if (ota_buf) heap_caps_free(ota_buf);
+    ota_buf = NULL;
+    ota_fill = 0;
+}
+
+static void ota_flush(void) {
+    if (!ota_active || !ota_fill) return;
+    esp_err_t err = esp_ota_write(ota_handle, ota_buf, ota_fill);
+    ota_fill = 0;
+    if (err != ESP_OK) ota_fail(err == ESP_ERR_OTA_VALIDATE_FAILED ? 400 : 500,
+                                String("Flash write failed: ") + esp_err_to_name(err));
+}
+
+static void ota_begin(HttpUpload &upload) {
+    if (ota_active) ota_fail(500, "Superseded by a new upload");
+    ota_free_buffer();
+    ota_uploaded = true;
+    ota_result = OTA_RESULT_RECEIVING;
+    ota_error = "";
+    ota_error_code = 0;
+    ota_bytes = 0;
+    ota_ms = 0;
+    ota_t0 = millis();
+    ota_sha_hex[0] = 0;
+
+    if (ota_trial && !ota_confirmed) {
+        ota_fail(409, "The running firmware has not been confirmed yet");
+        return;
+    }
+    ota_expected = ota_server->arg("sha256");
+    ota_expected.toLowerCase();
+    if (ota_expected.length() && ota_expected.length() != 64) {
+        ota_fail(400, "sha256 must be 64 hex digits");
+        return;
+    }
+    ota_target = esp_ota_get_next_update_partition(NULL);
+    if (!ota_target) {
+        ota_fail(500, "No OTA partition to update");
+        return;
+    }
+    // The multipart body is a little larger than the image itself
+    if (ota_server->clientContentLength() > ota_target->size + 4096) {
+        ota_fail(413, "Image larger than the " + String(ota_target->size / 1024) + " KB app slot");
+        return;
+    }
+    // Flash is programmed from internal RAM; a PSRAM block is copied through
+    // the driver's bounce buffer
+    ota_buf = (uint8_t *)heap_caps_malloc(OTA_BLOCK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!ota_buf) ota_buf = (uint8_t *)heap_caps_malloc(OTA_BLOCK_SIZE, MALLOC_CAP_SPIRAM);
+    if (!ota_buf) {
+        ota_fail(500, "Out of memory");
+        return;
+    }
+    // Sequential mode erases each sector as it is reached instead of the
+    // whole slot up front, which would stall flash access for seconds
+    esp_err_t err = esp_ota_begin(ota_target, OTA_WITH_SEQUENTIAL_WRITES, &ota_handle);
+    if (err != ESP_OK) {
+        ota_free_buffer();
+        ota_fail(500, String("OTA begin failed: ") + esp_err_to_name(err));
+        return;
+    }
+    mbedtls_sha256_init(&ota_sha);
+    mbedtls_sha256_starts_ret(&ota_sha, 0);
+    ota_active = true;
+    Serial.printf("[OTA] Receiving %s into %s\n", upload.filename.c_str(), ota_target->label);
+}
+
+static void ota_finish(void) {
+    ota_flush();
+    ota_ms = millis() - ota_t0;
+    ota_free_buffer();
+    if (!ota_active) return;
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish_ret(&ota_sha, digest);
+    for (int i = 0; i < 32; ++i) snprintf(&ota_sha_hex[i * 2], 3, "%02x", digest[i]);
+    if (ota_expected.length() && ota_expected != ota_sha_hex) {
+        ota_fail(400, String("SHA-256 mismatch, received ") + ota_sha_hex);
+        return;
+    }
+    mbedtls_sha256_free(&ota_sha);
+    ota_active = false;
+
+    // Checks the image header, segments and its own appended digest
+    esp_err_t err = esp_ota_end(ota_handle);
+    if (err != ESP_OK) {
+        ota_fail(err == ESP_ERR_OTA_VALIDATE_FAILED ? 400 : 500,
+                 err == ESP_ERR_OTA_VALIDATE_FAILED ? String("Not a valid firmware image")
+                                                    : String("OTA end failed: ") + esp_err_to_name(err));
+        return;
+    }
+    err = esp_ota_set_boot_partition(ota_target);
+    if (err != ESP_OK) {
+        ota_fail(500, String("Could not select the new firmware: ") + esp_err_to_name(err));
+        return;
+    }
+    // Remember where to return to if the new firmware does not confirm
+    Preferences p;
+    p.begin(OTA_NAMESPACE, false);
+    p.putString("prev", esp_ota_get_running_partition()->label);
+    p.putUChar("trial", 1);
+    p.putUChar("boots", 0);
+    p.end();
+    ota_result = OTA_RESULT_DONE;
+    Serial.printf("[OTA] %lu bytes written to %s in %lu ms, sha256 %s\n", (unsigned long)ota_bytes,
+                  ota_target->label, (unsigned long)ota_ms, ota_sha_hex);
+}
+
+static void ota_upload(void) {
+    HttpUpload &upload = ota_server->upload();
+    if (upload.status == UPLOAD_FILE_START) {
+        ota_begin(upload);
+    } else if (upload.status == UPLOAD_FILE_WRITE) {
+        if (!ota_active) return;
+        mbedtls_sha256_update_ret(&ota_sha, upload.buf, upload.currentSize);
+        ota_bytes += upload.currentSize;
+        const uint8_t *p = upload.buf;
+        size_t left = upload.currentSize;
+        while (left && ota_active) {
+            size_t n = OTA_BLOCK_SIZE - ota_fill;
+            if (n > left) n = left;
+            memcpy(ota_buf + ota_fill, p, n);
+            ota_fill += n;
+            p += n;
+            left -= n;
+            if (ota_fill == OTA_BLOCK_SIZE) ota_flush();
+        }
+    } else if (upload.status == UPLOAD_FILE_END) {
+        ota_finish();
+    } else if (upload.status == UPLOAD_FILE_ABORTED) {
+        ota_free_buffer();
+        ota_fail(400, "Upload aborted");
+    }
+}
+
+static void ota_restart_task(void *parameter) {
+    (void)parameter;
+    vTaskDelay(pdMS_TO_TICKS(OTA_RESTART_DELAY_MS));
+    // Keep the history and statistics gathered so far
+    ts_store_flush();
+    stats_engine_save();
+    Serial.println("[OTA] Restarting into the new firmware");
+    Serial.flush();
+    esp_restart();
+}
+
+static uint32_t ota_kbps(void) {
+    return (uint32_t)((uint64_t)ota_bytes * 1000 / (ota_ms ? ota_ms : 1) / 1024);
+}
+
+static void handle_ota_post(void) {
+    bool uploaded = ota_uploaded;
+    ota_uploaded = false;
+    if (!uploaded) {
+        web_json_error(400, "No firmware file in the request");
+        return;
+    }
+    if (ota_result == OTA_RESULT_RECEIVING) ota_fail(400, "Upload incomplete");
+    if (ota_result != OTA_RESULT_DONE) {
+        web_json_error(ota_error_code ? ota_error_code : 500, ota_error.c_str());
+        return;
+    }
+    String json = "{\"ok\":true,\"partition\":\"" + String(ota_target->label) + "\"";
+    json += ",\"bytes\":" + String(ota_bytes) + ",\"ms\":" + String(ota_ms) + ",\"kbps\":" + String(ota_kbps());
+    json += ",\"sha256\":\"" + String(ota_sha_hex) + "\",\"verified\":" + String(ota_expected.length() ? "true" : "false");
+    json += ",\"restarting\":true}";
+    ota_server->send(200, "application/json", json);
+    xTaskCreatePinnedToCore(ota_restart_task, "ota_restart", OTA_TASK_STACK, NULL, OTA_TASK_PRIORITY, NULL, OTA_TASK_CORE);
+}
+
+static void handle_ota_get(void) {
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *boot = esp_ota_get_boot_partition();
+    const esp_partition_t *next = esp_ota_get_next_update_partition(NULL);
+    const esp_app_desc_t *app = esp_ota_get_app_description();
+    esp_ota_img_states_t st = ESP_OTA_IMG_UNDEFINED;
+    esp_ota_get_state_partition(running, &st);
+
+    String json = "{\"running\":\"" + String(running->label) + "\"";
+    json += ",\"boot\":\"" + String(boot ? boot->label : "") + "\"";
+    json += ",\"next\":\"" + String(next ? next->label : "") + "\"";
+    json += ",\"slot_size\":" + String(next ? next->size : 0);
+    json += ",\"version\":";
+    web_json_str(json, app->version);
+    json += ",\"built\":";
+    web_json_str(json, (String(app->date) + " " + app->time).c_str());
+    json += ",\"idf\":";
+    web_json_str(json, app->idf_ver);
+    json += ",\"state\":\"" + String(state_name(st)) + "\"";
+    json += ",\"trial\":" + String(ota_trial && !ota_confirmed ? "true" : "false");
+    if (ota_trial && !ota_confirmed) {
+        uint32_t up = millis() / 1000;
+        json += ",\"trial_boot\":" + String(ota_boots);
+        json += ",\"confirm_in_s\":" + String(up < OTA_CONFIRM_AFTER_S ? OTA_CONFIRM_AFTER_S - up : 0);
+    }
+    static const char *const results[] = {"none", "receiving", "done", "failed"};
+    json += ",\"last\":{\"result\":\"" + String(results[ota_result]) + "\"";
+    if (ota_result != OTA_RESULT_NONE) {
+        json += ",\"bytes\":" + String(ota_bytes) + ",\"ms\":" + String(ota_ms) + ",\"kbps\":" + String(ota_kbps());
+        json += ",\"sha256\":\"" + String(ota_sha_hex) + "\",\"error\":";
+        web_json_str(json, ota_error.c_str());
+    }
+    json += "}}";
+    ota_server->send(200, "application/json", json);
+}
+
+void ota_update_register(HttpServer &server) {
+    ota_server = &server;
+    // No body limit here; the image is checked against the slot size.
+    // Neither route touches the UI, so the display keeps rendering.
+    web_on(server, "/api/ota", HTTP_POST, handle_ota_post, 0, 0, ota_upload);
+    web_on(server, "/api/ota", HTTP_GET, handle_ota_get, 0);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+#include "http_server.h"
+
+// Firmware update over the network into the inactive app slot (app0/app1
+// in partitions.csv).
+//
+//   POST /api/ota[?sha256=<hex>]   multipart upload of firmware.bin
+//   GET  /api/ota                  running slot, version and trial state
+//
+// e.g. curl -F firmware=@firmware.bin "http://<display>/api/ota?sha256=$(sha256sum firmware.bin | cut -c1-64)"
+//
+// The image is written while it streams in, in OTA_BLOCK_SIZE blocks so the
+// flash is erased and programmed a few sectors at a time, and hashed as it
+// goes. The request runs on the web task without the UI lock, so the display
+// keeps rendering apart from the short stalls flash writes cause. When the
+// image validates and its SHA-256 matches (if one was given), the other slot
+// becomes the boot partition and the display restarts.
+//
+// The new firmware then runs on trial: it is confirmed once the UI loop has
+// run for OTA_CONFIRM_AFTER_S. If it has not confirmed within
+// OTA_CONFIRM_TIMEOUT_S, or it restarts OTA_TRIAL_BOOTS times without
+// confirming (crash loop), the previous slot is booted again.
+
+#define OTA_BLOCK_SIZE          (32 * 1024)
+#define OTA_CONFIRM_AFTER_S     20
+#define OTA_CONFIRM_TIMEOUT_S   90
+#define OTA_TRIAL_BOOTS         3
+
+// Check the trial state of the running firmware; call early in setup(),
+// after Serial is up
+void ota_update_init(void);
+
+// Called once per loop() pass; confirms the firmware once it is healthy
+void ota_update_service(void);
+
+// Register POST/GET /api/ota
+void ota_update_register(HttpServer &server);
@@ -0,0 +1,73 @@
+#include "redraw_filter.h"
+#include <Arduino.h>
+#include <math.h>
+
+typedef struct {
+    float shown;            // last value let through (after rounding)
+    uint32_t shown_ms;
+    bool valid;             // false until something has been shown
+    RedrawCounts counts;
+} RedrawState;
+
+static RedrawState redraw_state[NUM_SCREENS][WIDGET_SLOT_COUNT];
+
+static bool redraw_index_ok(int screen, int slot) {
+    return screen >= 0 && screen < NUM_SCREENS && slot >= 0 && slot < WIDGET_SLOT_COUNT;
+}
+
+bool redraw_filter_pass(int screen, int slot, float *value) {
+    if (!value || !redraw_index_ok(screen, slot)) return true;
+    const ScreenConfig *cfg = &screen_configs[screen];
+    RedrawState *st = &redraw_state[screen][slot];
+
+    float v = *value;
+    float res = cfg->redraw_resolution[slot];
+    if (res > 0.0f && isfinite(res) && !isnan(v)) {
+        v = roundf(v / res) * res;
+        *value = v;
+    }
+
+    bool pass;
+    if (!st->valid || isnan(v) != isnan(st->shown)) {
+        pass = true;
+    } else if (isnan(v) || v == st->shown) {
+        return false;   // unchanged, not counted as suppressed
+    } else {
+        float deadband = cfg->redraw_deadband[slot];
+        uint16_t min_ms = cfg->redraw_min_ms[slot];
+        pass = !(deadband > 0.0f && fabsf(v - st->shown) < deadband) &&
+               !(min_ms > 0 && millis() - st->shown_ms < min_ms);
+    }
+
+    if (pass) {
+        st->shown = v;
+        st->shown_ms = millis();
+        st->valid = true;
+        st->counts.redraws++;
+    } else {
+        // Keep showing the previous value; the widget's own text compare
+        // then turns the update into a no-op
+        *value = st->shown;
+        st->counts.suppressed++;
+    }
+    return pass;
+}
+
+void redraw_filter_reset(int screen) {
+    if (screen < 0 || screen >= NUM_SCREENS) return;
+    for (int w = 0; w < WIDGET_SLOT_COUNT; w++) redraw_state[screen][w].valid = false;
+}
+
+void redraw_filter_reset_all(void) {
+    for (int s = 0; s < NUM_SCREENS; s++) redraw_filter_reset(s);
+}
+
+void redraw_filter_get_counts(int screen, int slot, RedrawCounts *out) {
+    if (!out) return;
+    if (!redraw_index_ok(screen, slot)) {
+        out->redraws = 0;
+        out->suppressed = 0;
+        return;
+    }
+    *out = redraw_state[screen][slot].counts;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "screen_config_c_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Significant-change filter between live values and the widgets that show
+// them. Each widget (screen x WidgetSlot) remembers the last value it let
+// through; a new value only reaches LVGL when it has moved by more than the
+// widget's deadband and the minimum redraw interval has passed. Values are
+// rounded to the configured resolution first, so jitter below one display
+// step never redraws. Settings come from ScreenConfig.redraw_*.
+
+typedef struct {
+    uint32_t redraws;       // updates passed on to the widget
+    uint32_t suppressed;    // changed values held back by deadband/interval/resolution
+} RedrawCounts;
+
+// Filter a new value for a widget in place: *value becomes the value the
+// widget should show (rounded to its resolution, or the previously shown
+// value if the change is not significant). Returns true if that differs from
+// what is on screen. NaN always differs from a number.
+bool redraw_filter_pass(int screen, int slot, float *value);
+
+// Forget the last shown values so the next update always passes (call when
+// widgets are recreated and show placeholders again)
+void redraw_filter_reset(int screen);
+void redraw_filter_reset_all(void);
+
+void redraw_filter_get_counts(int screen, int slot, RedrawCounts *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,10 +4,20 @@
 
 /**
  * Custom decoder for raw RGB565 binary files
- * File format: Variable size, 2 bytes per pixel (RGB565), little-endian
- * No header, just raw pixel data
+ * File format: optional rgb565_file_header_t, then 2 bytes per pixel
+ * (RGB565, little-endian) or 3 with alpha. Without the header the file is
+ * square and its side follows from the size.
  */
 
+// Read the converter header; false for a legacy headerless file
+static bool read_header(lv_fs_file_t * f, rgb565_file_header_t * hdr)
+{
+    uint32_t n = 0;
+    lv_fs_seek(f, 0, LV_FS_SEEK_SET);
+    if(lv_fs_read(f, hdr, sizeof(*hdr), &n) != LV_FS_RES_OK || n != sizeof(*hdr)) return false;
+    return memcmp(hdr->magic, RGB565_FILE_MAGIC, 4) == 0;
+}
+
 static lv_res_t decoder_info(lv_img_decoder_t * decoder, const void * src, lv_img_header_t * header)
 {
     (void) decoder;
@@ -23,6 +33,15 @@ static lv_res_t decoder_info(lv_img_decoder_t * decoder, const void * src, lv_im
                 return LV_RES_INV;
             }
             
+            rgb565_file_header_t hdr;
+            if(read_header(&f, &hdr)) {
+                lv_fs_close(&f);
+                header->cf = hdr.cf == RGB565_CF_ALPHA ? LV_IMG_CF_TRUE_COLOR_ALPHA : LV_IMG_CF_TRUE_COLOR;
+                header->w = hdr.w;
+                header->h = hdr.h;
+                return LV_RES_OK;
+            }
+
             // Get file size
             uint32_t file_size;
             lv_fs_seek(&f, 0, LV_FS_SEEK_END);
@@ -65,7 +84,12 @@ static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t *
             uint32_t file_size;
             lv_fs_seek(&f, 0, LV_FS_SEEK_END);
             lv_fs_tell(&f, &file_size);
-            lv_fs_seek(&f, 0, LV_FS_SEEK_SET);  // Reset to beginning
+
+            // Pixel data starts after the header, if there is one
+            rgb565_file_header_t hdr;
+            uint32_t offset = read_header(&f, &hdr) ? sizeof(hdr) : 0;
+            file_size -= offset;
+            lv_fs_seek(&f, offset, LV_FS_SEEK_SET);
             
             // Allocate buffer in PSRAM
             dsc->img_data = (const uint8_t*)lv_mem_alloc(file_size);
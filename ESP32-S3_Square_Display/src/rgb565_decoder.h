@@ -2,6 +2,24 @@
 #define RGB565_DECODER_H
 
 #include "lvgl.h"
+#include <stdint.h>
+
+/**
+ * Header of the .bin assets written by the on-device converter
+ * (asset_transcode). Files without it are the older headerless, square
+ * RGB565 backgrounds and are still accepted.
+ */
+#define RGB565_FILE_MAGIC   "R565"
+#define RGB565_CF_OPAQUE    0   /* 2 bytes per pixel, RGB565 little-endian */
+#define RGB565_CF_ALPHA     1   /* 3 bytes per pixel, RGB565 then 8-bit alpha */
+
+typedef struct __attribute__((packed)) {
+    char magic[4];          /* RGB565_FILE_MAGIC */
+    uint16_t w;
+    uint16_t h;
+    uint8_t cf;             /* RGB565_CF_* */
+    uint8_t reserved[3];
+} rgb565_file_header_t;
 
 // Initialize RGB565 binary decoder for LVGL
 void rgb565_decoder_init(void);
@@ -3,7 +3,6 @@
 #include "gauge_config.h"
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
 #include <ESPmDNS.h>
 #include <Preferences.h>
 #include <vector>
@@ -51,7 +50,6 @@ extern "C" void show_fallback_error_screen_if_needed() {
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
 #include <ESPmDNS.h>
 #include <Preferences.h>
 #include "sensESP_setup.h"
@@ -67,6 +65,24 @@ extern "C" void show_fallback_error_screen_if_needed() {
 #include <esp_err.h>
 #include "esp_log.h"
 #include "needle_style.h"
+#include "needle_motion.h"
+#include "redraw_filter.h"
+#include "signal_filter.h"
+#include "stats_engine.h"
+#include "derived_values.h"
+#include "html_stream.h"
+#include "web_config.h"
+#include "live_ws.h"
+#include "web_task.h"
+#include "asset_index.h"
+#include "asset_transcode.h"
+#include "ota_update.h"
+#include "config_bundle.h"
+#include <esp_rom_crc.h>
+#include <esp_heap_caps.h>
+#include "frame_governor.h"
+#include "I2C_Driver.h"
+#include "LVGL_Driver.h"
 
 static const char *TAG_SETUP = "sensESP_setup";
 
@@ -142,6 +158,7 @@ input[type=number]{width:120px;padding:6px;border:1px solid #dfe9fb;border-radiu
 void handle_toggle_test_mode();
 void handle_test_gauge();
 void handle_nvs_test();
+void handle_perf();
 void handle_set_screen();
 // Device settings handlers
 void handle_device_page();
@@ -149,15 +166,27 @@ void handle_save_device();
 // Needle style handlers (WebUI only)
 void handle_needles_page();
 void handle_save_needles();
+// Signal filter handlers
+void handle_filters_page();
+void handle_save_filters();
+// Derived value (formula) handlers
+void handle_derived_page();
+void handle_save_derived();
+// Rolling statistics handlers
+void handle_stats_api();
+void handle_stats_reset();
 // Asset manager handlers
 void handle_assets_page();
 void handle_assets_upload();
 void handle_assets_upload_post();
 void handle_assets_delete();
+void handle_assets_rescan();
+void handle_assets_api();
+void handle_assets_jobs();
 // Hot-update helper (apply backgrounds/icons at runtime)
 extern bool apply_all_screen_visuals();
 
-WebServer config_server(80);
+HttpServer config_server(80);
 Preferences preferences;
 
 String saved_ssid = "";
@@ -190,6 +219,79 @@ extern uint8_t LCD_Backlight;
 extern "C" int ui_get_current_screen(void);
 extern "C" void ui_set_screen(int screen_num);
 
+// Write one screen blob to an open NVS handle, retrying once after erasing
+// the key and falling back to 128-byte parts if the blob is still rejected.
+// `blob_err` gets the result of the single-blob write; returns true if the
+// screen was stored either way.
+static bool nvs_store_screen(nvs_handle_t nvs_handle, int s, esp_err_t *blob_err) {
+    const size_t CHUNK_SIZE = 128;
+    // copy runtime calibration into screen_configs
+    for (int g = 0; g < 2; ++g) for (int p = 0; p < 5; ++p) screen_configs[s].cal[g][p] = gauge_cal[s][g][p];
+    char key[32];
+    snprintf(key, sizeof(key), "screen%d", s);
+    esp_err_t err = nvs_set_blob(nvs_handle, key, &screen_configs[s], sizeof(ScreenConfig));
+    Serial.printf("[NVS SAVE] nvs_set_blob('%s', size=%u) -> %d\n", key, (unsigned)sizeof(ScreenConfig), err);
+    if (err != ESP_OK) {
+        esp_err_t erase_err = nvs_erase_key(nvs_handle, key);
+        Serial.printf("[NVS SAVE] nvs_erase_key('%s') -> %d\n", key, erase_err);
+        if (erase_err == ESP_OK) {
+            err = nvs_set_blob(nvs_handle, key, &screen_configs[s], sizeof(ScreenConfig));
+            Serial.printf("[NVS SAVE] Retry nvs_set_blob('%s') -> %d\n", key, err);
+        }
+    }
+    *blob_err = err;
+    if (err == ESP_OK) return true;
+    // chunked fallback
+    size_t total = sizeof(ScreenConfig);
+    int parts = (total + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    for (int part = 0; part < parts; ++part) {
+        snprintf(key, sizeof(key), "screen%d.part%d", s, part);
+        size_t part_sz = ((part + 1) * CHUNK_SIZE > total) ? (total - part * CHUNK_SIZE) : CHUNK_SIZE;
+        esp_err_t perr = nvs_set_blob(nvs_handle, key, ((uint8_t *)&screen_configs[s]) + part * CHUNK_SIZE, part_sz);
+        Serial.printf("[NVS SAVE] nvs_set_blob('%s', size=%u) -> %d\n", key, (unsigned)part_sz, perr);
+        if (perr != ESP_OK) return false;
+    }
+    Serial.printf("[NVS SAVE] Chunked write succeeded for screen%d (%d parts)\n", s, parts);
+    return true;
+}
+
+// Persist a single screen: its config blob, its two gauge paths and the
+// cubic-curve mask. Used by the REST API so one edit does not rewrite every
+// screen; falls back to /config/screen<N>.bin on SD like save_preferences().
+bool save_screen_config(int s) {
+    if (s < 0 || s >= NUM_SCREENS) return false;
+    uint32_t t0 = millis();
+    preferences.end();
+    if (preferences.begin(SETTINGS_NAMESPACE, false)) {
+        for (int g = 0; g < 2; ++g) {
+            String key = String("skpath_") + (s * 2 + g);
+            preferences.putString(key.c_str(), signalk_paths[s * 2 + g]);
+        }
+        preferences.putUShort("cal_cubic", gauge_cal_cubic_mask);
+        preferences.end();
+    }
+    bool ok = false;
+    nvs_handle_t nvs_handle;
+    if (nvs_open(PREF_NAMESPACE, NVS_READWRITE, &nvs_handle) == ESP_OK) {
+        esp_err_t blob_err;
+        ok = nvs_store_screen(nvs_handle, s, &blob_err);
+        nvs_commit(nvs_handle);
+        nvs_close(nvs_handle);
+    }
+    if (!ok) {
+        if (!SD_MMC.exists("/config")) SD_MMC.mkdir("/config");
+        char sdpath[64];
+        snprintf(sdpath, sizeof(sdpath), "/config/screen%d.bin", s);
+        File f = SD_MMC.open(sdpath, FILE_WRITE);
+        if (f) {
+            ok = f.write((const uint8_t *)&screen_configs[s], sizeof(ScreenConfig)) == sizeof(ScreenConfig);
+            f.close();
+        }
+    }
+    Serial.printf("[SAVE] screen%d %s in %lu ms\n", s, ok ? "saved" : "FAILED", (unsigned long)(millis() - t0));
+    return ok;
+}
+
 void save_preferences() {
     Serial.println("[DEBUG] Saving preferences...");
     preferences.end();
@@ -207,6 +309,7 @@ void save_preferences() {
         preferences.putUShort("brightness", (uint16_t)LCD_Backlight);
         // Save auto-scroll setting
         preferences.putUShort("auto_scroll", auto_scroll_sec);
+        preferences.putUShort("cal_cubic", gauge_cal_cubic_mask);
         for (int i = 0; i < NUM_SCREENS * 2; ++i) {
             String key = String("skpath_") + i;
             preferences.putString(key.c_str(), signalk_paths[i]);
@@ -219,45 +322,11 @@ void save_preferences() {
     esp_err_t nvs_err = nvs_open(PREF_NAMESPACE, NVS_READWRITE, &nvs_handle);
     bool any_nvs_ok = false;
     bool nvs_invalid_length_detected = false;
-    const size_t CHUNK_SIZE = 128;
     if (nvs_err == ESP_OK) {
         for (int s = 0; s < NUM_SCREENS; ++s) {
-            // copy runtime calibration into screen_configs
-            for (int g = 0; g < 2; ++g) for (int p = 0; p < 5; ++p) screen_configs[s].cal[g][p] = gauge_cal[s][g][p];
-            char key[32];
-            snprintf(key, sizeof(key), "screen%d", s);
-            esp_err_t err = nvs_set_blob(nvs_handle, key, &screen_configs[s], sizeof(ScreenConfig));
-            Serial.printf("[NVS SAVE] nvs_set_blob('%s', size=%u) -> %d\n", key, (unsigned)sizeof(ScreenConfig), err);
-            if (err != ESP_OK) {
-                esp_err_t erase_err = nvs_erase_key(nvs_handle, key);
-                Serial.printf("[NVS SAVE] nvs_erase_key('%s') -> %d\n", key, erase_err);
-                if (erase_err == ESP_OK) {
-                    err = nvs_set_blob(nvs_handle, key, &screen_configs[s], sizeof(ScreenConfig));
-                    Serial.printf("[NVS SAVE] Retry nvs_set_blob('%s') -> %d\n", key, err);
-                }
-            }
-            if (err == ESP_OK) {
-                any_nvs_ok = true;
-                continue;
-            }
-            if (err == ESP_ERR_NVS_INVALID_LENGTH) {
-                nvs_invalid_length_detected = true;
-            }
-            // chunked fallback
-            size_t total = sizeof(ScreenConfig);
-            int parts = (total + CHUNK_SIZE - 1) / CHUNK_SIZE;
-            bool parts_ok = true;
-            for (int part = 0; part < parts; ++part) {
-                snprintf(key, sizeof(key), "screen%d.part%d", s, part);
-                size_t part_sz = ((part + 1) * CHUNK_SIZE > total) ? (total - part * CHUNK_SIZE) : CHUNK_SIZE;
-                esp_err_t perr = nvs_set_blob(nvs_handle, key, ((uint8_t *)&screen_configs[s]) + part * CHUNK_SIZE, part_sz);
-                Serial.printf("[NVS SAVE] nvs_set_blob('%s', size=%u) -> %d\n", key, (unsigned)part_sz, perr);
-                if (perr != ESP_OK) { parts_ok = false; break; }
-            }
-            if (parts_ok) {
-                any_nvs_ok = true;
-                Serial.printf("[NVS SAVE] Chunked write succeeded for screen%d (%d parts)\n", s, parts);
-            }
+            esp_err_t blob_err;
+            if (nvs_store_screen(nvs_handle, s, &blob_err)) any_nvs_ok = true;
+            if (blob_err == ESP_ERR_NVS_INVALID_LENGTH) nvs_invalid_length_detected = true;
         }
         nvs_commit(nvs_handle);
         nvs_close(nvs_handle);
@@ -411,6 +480,7 @@ void load_preferences() {
         saved_hostname = preferences.getString("hostname", "");
         // Load auto-scroll interval (seconds)
         auto_scroll_sec = preferences.getUShort("auto_scroll", 0);
+        gauge_cal_cubic_mask = preferences.getUShort("cal_cubic", 0);
         // Load device settings
         buzzer_mode = (int)preferences.getUShort("buzzer_mode", (uint16_t)buzzer_mode);
         buzzer_cooldown_sec = preferences.getUShort("buzzer_cooldown", buzzer_cooldown_sec);
@@ -503,8 +573,10 @@ void load_preferences() {
             ScreenConfig tmp;
             size_t required = sizeof(ScreenConfig);
             esp_err_t err = nvs_get_blob(nvs_handle, key, &tmp, &required);
-            if (err == ESP_OK && required == sizeof(ScreenConfig)) {
-                memcpy(&screen_configs[s], &tmp, sizeof(ScreenConfig));
+            // Blobs saved before fields were appended are shorter; the new
+            // tail keeps the defaults set above
+            if (err == ESP_OK && required <= sizeof(ScreenConfig)) {
+                memcpy(&screen_configs[s], &tmp, required);
                 continue;
             }
             // try chunked parts
@@ -594,64 +666,126 @@ void load_preferences() {
             }
         }
     }
+    gauge_cal_changed();
 
     // No automatic default icon set; keep blank unless user selects one via UI
 }
 
+// ---- /gauges page templates -------------------------------------------------
+// Per-screen sections are written straight into the response stream
+
+static const char *const DISPLAY_TYPE_LABELS[] = {"Gauge", "Number", "Dual", "Quad", "Gauge + Number", "Graph"};
+static const char *const FONT_SIZE_LABELS[] = {"Small (48pt)", "Medium (72pt)", "Large (96pt)", "X-Large (120pt)", "XX-Large (144pt)"};
+static const char *const CHART_TYPE_LABELS[] = {"Line Chart", "Bar Chart", "Scatter Plot"};
+static const char *const TIME_RANGE_LABELS[] = {"10 seconds", "30 seconds", "1 minute", "5 minutes", "10 minutes",
+                                                 "30 minutes", "6 hours", "24 hours", "7 days"};
+
+// What the /gauges page shows, copied under the UI lock
+struct GaugesPageView {
+    ScreenConfig screens[NUM_SCREENS];
+    GaugeCalibrationPoint cal[NUM_SCREENS][2][5];
+    uint16_t cubic_mask;
+};
+
+// Labelled <select name='<name>_<s>'> with options numbered from 0
+static void emit_select(HtmlStream &html, const char *label, const char *name, int s,
+                        const char *const *labels, int count, int selected) {
+    html.printf("<div style='margin-bottom:8px;'><label>%s: <select name='%s_%d'>", label, name, s);
+    for (int i = 0; i < count; ++i) {
+        html.printf("<option value='%d'%s>%s</option>", i, i == selected ? " selected" : "", labels[i]);
+    }
+    html += "</select></label></div>";
+}
+
+// Five calibration points with test buttons, plus the cubic-curve checkbox
+static void emit_calibration_table(HtmlStream &html, const GaugesPageView &v, int s, int g, bool test_mode) {
+    html += "<table class='table'><tr><th>Point</th><th>Angle</th><th>Value</th><th>Test</th></tr>";
+    for (int p = 0; p < 5; ++p) {
+        html.printf("<tr><td>%d</td>"
+                    "<td><input name='angle_%d_%d_%d' type='number' value='%d'></td>"
+                    "<td><input name='value_%d_%d_%d' type='number' step='any' value='%.2f'></td>",
+                    p + 1, s, g, p, v.cal[s][g][p].angle, s, g, p, v.cal[s][g][p].value);
+        html.printf("<td><button type='button' onclick='testGaugePoint(%d,%d,%d)' %sstyle='padding:4px 8px;font-size:0.9em;"
+                    "background-color:%s;color:#ffffff;border:1px solid #2d5a8f;border-radius:4px;cursor:%s;'>Test</button></td></tr>",
+                    s, g, p, test_mode ? "" : "disabled ", test_mode ? "#4a90e2" : "#cccccc", test_mode ? "pointer" : "not-allowed");
+    }
+    html += "</table>";
+    html.printf("<div id='live_%d_%d' style='margin:4px 0 8px;font-family:monospace;color:#555;'>Live: --</div>", s, g);
+    html.printf("<div style='margin-bottom:8px;'><label><input type='checkbox' name='cubic_%d_%d'%s> Smooth curve between points (monotone cubic)</label></div>",
+                s, g, ((v.cubic_mask >> (s * 2 + g)) & 1) ? " checked" : "");
+}
+
+static String normalize_asset_path(const String &path) {
+    String norm = path;
+    norm.toLowerCase();
+    norm.replace("S://", "S:/");
+    while (norm.indexOf("//") != -1) norm.replace("//", "/");
+    return norm;
+}
+
+// Opens the icon-section (closed by the caller after the zone row)
+static void emit_icon_controls(HtmlStream &html, const GaugesPageView &v, int s, int g, const std::vector<String> &iconFiles) {
+    String savedIcon = String(v.screens[s].icon_paths[g]);
+    String savedIconNorm = normalize_asset_path(savedIcon);
+    html.printf("<div class='icon-section'><div class='icon-row'>"
+                "<div style='margin-bottom:8px;'><label>Icon: <select name='icon_%d_%d'><option value=''%s>None</option>",
+                s, g, savedIcon.length() == 0 ? " selected='selected'" : "");
+    for (const auto &icon : iconFiles) {
+        bool sel = savedIcon.length() > 0 && normalize_asset_path(icon) == savedIconNorm;
+        html.printf("<option value='%s'%s>%s</option>", icon.c_str(), sel ? " selected='selected'" : "", icon.c_str());
+    }
+    html += "</select></label></div>";
+    static const char *const pos_names[] = {"Top", "Right", "Bottom", "Left"};
+    html.printf("<div style='margin-bottom:8px;'><label>Icon Position: <select name='iconpos_%d_%d'>", s, g);
+    for (int po = 0; po < 4; ++po) {
+        html.printf("<option value='%d'%s>%s</option>", po, v.screens[s].icon_pos[g] == po ? " selected='selected'" : "", pos_names[po]);
+    }
+    html += "</select></label></div>";
+    html += "</div>"; // close icon-row
+}
+
+// Zone min/max/color/transparent/buzzer controls for zones 1..4
+static void emit_zone_row(HtmlStream &html, const GaugesPageView &v, int s, int g) {
+    html += "<div class='zone-row'>";
+    for (int i = 1; i <= 4; ++i) {
+        const ScreenConfig &c = v.screens[s];
+        html.printf("<div class='zone-item'><label>Min %d: <input name='mnv%d%d%d' type='number' step='any' value='%.2f' style='width:100px'></label></div>"
+                    "<div class='zone-item'><label>Max %d: <input name='mxv%d%d%d' type='number' step='any' value='%.2f' style='width:100px'></label></div>",
+                    i, s, g, i, c.min[g][i], i, s, g, i, c.max[g][i]);
+        html.printf("<div class='zone-item'><label>Color: <input class='color-input' name='clr%d%d%d' type='color' value='%s'></label></div>"
+                    "<div class='zone-item small'><label>Transparent <input name='trn%d%d%d' type='checkbox'%s></label></div>"
+                    "<div class='zone-item small'><label>Buzzer <input name='bzr%d%d%d' type='checkbox'%s></label></div>",
+                    s, g, i, c.color[g][i], s, g, i, c.transparent[g][i] ? " checked" : "", s, g, i, c.buzzer[g][i] ? " checked" : "");
+    }
+    html += "</div>";
+}
+
 void handle_gauges_page() {
-    // --- Scan SD card for available asset files and split into background and icon lists ---
-    std::vector<String> iconFiles; // only .png files for icons
-    std::vector<String> bgFiles;   // only .bin files for large backgrounds
+    // Icons (.png) and backgrounds (.bin) from the asset index, in the same
+    // "S:/" + "/assets/name" form the directory scan used to produce
+    std::vector<String> iconFiles;
+    std::vector<String> bgFiles;
     {
-        File root = SD_MMC.open("/assets");
-        if (root && root.isDirectory()) {
-            File file = root.openNextFile();
-            while (file) {
-                String fname = file.name();
-                Serial.printf("[ASSET SCAN] Found file: %s\n", fname.c_str());
-                // Exclude macOS resource fork files (._ prefix)
-                if (fname.startsWith("._")) {
-                    file = root.openNextFile();
-                    continue;
-                }
-                String lname = fname;
-                lname.toLowerCase();
-                // sanitize filenames that start with underscore
-                if (lname.startsWith("_")) { file = root.openNextFile(); continue; }
-                // Always add /assets/ prefix if not present
-                String fullPath = fname;
-                if (!fname.startsWith("/assets/")) {
-                    fullPath = "/assets/" + fname;
-                }
-                if (lname.endsWith(".png")) {
-                    iconFiles.push_back(String("S:/") + fullPath);
-                } else if (lname.endsWith(".bin")) {
-                    bgFiles.push_back(String("S:/") + fullPath);
-                }
-                file = root.openNextFile();
-            }
-        } else {
-            // POSIX fallback: scan /sdcard/assets
-            DIR *d = opendir("/sdcard/assets");
-            if (d) {
-                struct dirent *entry;
-                while ((entry = readdir(d)) != NULL) {
-                    const char *fname = entry->d_name;
-                    if (!fname) continue;
-                    if (fname[0] == '.') continue;
-                    String sname = String(fname);
-                    String lname = sname;
-                    lname.toLowerCase();
-                    if (lname.startsWith("_")) continue;
-                    String fullPath = "/assets/" + sname;
-                    if (lname.endsWith(".png")) iconFiles.push_back(String("S:/") + fullPath);
-                    else if (lname.endsWith(".bin")) bgFiles.push_back(String("S:/") + fullPath);
-                }
-                closedir(d);
-            }
+        int na = 0;
+        AssetEntry *assets = asset_index_snapshot(&na);
+        for (int i = 0; i < na; ++i) {
+            if (assets[i].name[0] == '_') continue;
+            String fullPath = String("S:/") + "/assets/" + assets[i].name;
+            if (assets[i].type == ASSET_TYPE_PNG || assets[i].type == ASSET_TYPE_RGB565A) iconFiles.push_back(fullPath);
+            else if (assets[i].type == ASSET_TYPE_RGB565) bgFiles.push_back(fullPath);
         }
+        free(assets);
     }
-    // --- End SD scan ---
+    // The page streams to the browser without the UI lock; take what it
+    // shows under the lock first
+    GaugesPageView *view = (GaugesPageView *)heap_caps_malloc(sizeof(GaugesPageView), MALLOC_CAP_SPIRAM);
+    if (!view) {
+        config_server.send(500, "text/plain", "Out of memory");
+        return;
+    }
+    GaugesPageView &v = *view;
+    String paths[NUM_SCREENS * 2];
+    ui_lock();
     // Reload config from storage unless a save just occurred — in that case
     // prefer the in-memory `screen_configs` so the UI shows the recently-saved values.
     if (!skip_next_load_preferences) {
@@ -660,15 +794,22 @@ void handle_gauges_page() {
         // consume the skip flag and keep current in-memory configs
         skip_next_load_preferences = false;
     }
+    memcpy(v.screens, screen_configs, sizeof(v.screens));
+    memcpy(v.cal, gauge_cal, sizeof(v.cal));
+    v.cubic_mask = gauge_cal_cubic_mask;
+    for (int i = 0; i < NUM_SCREENS * 2; ++i) paths[i] = signalk_paths[i];
+    ui_unlock();
     Serial.println("[DEBUG] handle_gauges_page() - gauge_cal values sent to HTML:");
     for (int s = 0; s < NUM_SCREENS; ++s) {
         for (int g = 0; g < 2; ++g) {
             for (int p = 0; p < 5; ++p) {
-                Serial.printf("[DEBUG] gauge_cal[%d][%d][%d]: angle=%d value=%.2f\n", s, g, p, gauge_cal[s][g][p].angle, gauge_cal[s][g][p].value);
+                Serial.printf("[DEBUG] v.cal[%d][%d][%d]: angle=%d value=%.2f\n", s, g, p, v.cal[s][g][p].angle, v.cal[s][g][p].value);
             }
         }
     }
-    String html = "<!DOCTYPE html><html><head>";
+    HtmlStream html(config_server, "/gauges");
+    html.begin();
+    html += "<!DOCTYPE html><html><head>";
     html += "<meta charset='UTF-8'>";
     html += STYLE;
     html += "<title>Gauge Calibration</title></head><body><div class='container'>";
@@ -705,29 +846,14 @@ void handle_gauges_page() {
         html += "<h3>Screen " + String(s+1) + "</h3>";
         
         // Display Type dropdown (new)
-        html += "<div style='margin-bottom:16px;'><label>Display Type: <select name='displaytype_" + String(s) + "' id='displaytype_" + String(s) + "' onchange='toggleGaugeConfig(" + String(s) + ")'>";
-        html += "<option value='0'";
-        if (screen_configs[s].display_type == 0) html += " selected";
-        html += ">Gauge</option>";
-        html += "<option value='1'";
-        if (screen_configs[s].display_type == 1) html += " selected";
-        html += ">Number</option>";
-        html += "<option value='2'";
-        if (screen_configs[s].display_type == 2) html += " selected";
-        html += ">Dual</option>";
-        html += "<option value='3'";
-        if (screen_configs[s].display_type == 3) html += " selected";
-        html += ">Quad</option>";
-        html += "<option value='4'";
-        if (screen_configs[s].display_type == 4) html += " selected";
-        html += ">Gauge + Number</option>";
-        html += "<option value='5'";
-        if (screen_configs[s].display_type == 5) html += " selected";
-        html += ">Graph</option>";
+        html.printf("<div style='margin-bottom:16px;'><label>Display Type: <select name='displaytype_%d' id='displaytype_%d' onchange='toggleGaugeConfig(%d)'>", s, s, s);
+        for (int t = 0; t < (int)(sizeof(DISPLAY_TYPE_LABELS) / sizeof(DISPLAY_TYPE_LABELS[0])); ++t) {
+            html.printf("<option value='%d'%s>%s</option>", t, v.screens[s].display_type == t ? " selected" : "", DISPLAY_TYPE_LABELS[t]);
+        }
         html += "</select></label></div>";
         
         // Background selection (per-screen)
-        String savedBg = String(screen_configs[s].background_path);
+        String savedBg = String(v.screens[s].background_path);
         String savedBgNorm = savedBg;
         savedBgNorm.toLowerCase();
         savedBgNorm.replace("S://", "S:/");
@@ -752,101 +878,53 @@ void handle_gauges_page() {
         html += "</select></label></div>";
         
         // Number display configuration container (shown when display_type is Number)
-        html += "<div id='numberconfig_" + String(s) + "' style='display:" + String(screen_configs[s].display_type == 1 ? "block" : "none") + ";'>";
+        html += "<div id='numberconfig_" + String(s) + "' style='display:" + String(v.screens[s].display_type == 1 ? "block" : "none") + ";'>";
         html += "<h4>Number Display Settings</h4>";
         
         // SignalK Path for number display
-        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='number_path_" + String(s) + "' type='text' value='" + String(screen_configs[s].number_path) + "' style='width:80%'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='number_path_" + String(s) + "' type='text' value='" + String(v.screens[s].number_path) + "' style='width:80%'></label></div>";
         
         // Background color (shown when Custom Color is selected in bg_image dropdown)
-        bool isCustomColor = (String(screen_configs[s].background_path) == "Custom Color");
+        bool isCustomColor = (String(v.screens[s].background_path) == "Custom Color");
         html += "<div id='number_bg_color_div_" + String(s) + "' style='margin-bottom:8px;display:" + String(isCustomColor ? "block" : "none") + ";'>";
-        html += "<label>Background Color: <input name='number_bg_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].number_bg_color[0] ? screen_configs[s].number_bg_color : "#000000") + "'></label></div>";
+        html += "<label>Background Color: <input name='number_bg_color_" + String(s) + "' type='color' value='" + String(v.screens[s].number_bg_color[0] ? v.screens[s].number_bg_color : "#000000") + "'></label></div>";
         
         // Font size
-        html += "<div style='margin-bottom:8px;'><label>Font Size: <select name='number_font_size_" + String(s) + "'>";
-        html += "<option value='0'";
-        if (screen_configs[s].number_font_size == 0) html += " selected";
-        html += ">Small (48pt)</option>";
-        html += "<option value='1'";
-        if (screen_configs[s].number_font_size == 1) html += " selected";
-        html += ">Medium (72pt)</option>";
-        html += "<option value='2'";
-        if (screen_configs[s].number_font_size == 2) html += " selected";
-        html += ">Large (96pt)</option>";
-        html += "<option value='3'";
-        if (screen_configs[s].number_font_size == 3) html += " selected";
-        html += ">X-Large (120pt)</option>";
-        html += "<option value='4'";
-        if (screen_configs[s].number_font_size == 4) html += " selected";
-        html += ">XX-Large (144pt)</option>";
-        html += "</select></label></div>";
+        emit_select(html, "Font Size", "number_font_size", s, FONT_SIZE_LABELS, 5, v.screens[s].number_font_size);
         
         // Font color
-        html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='number_font_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].number_font_color[0] ? screen_configs[s].number_font_color : "#FFFFFF") + "'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='number_font_color_" + String(s) + "' type='color' value='" + String(v.screens[s].number_font_color[0] ? v.screens[s].number_font_color : "#FFFFFF") + "'></label></div>";
         
         html += "</div>"; // End number display config
         
         // Dual display configuration container (shown when display_type is Dual)
-        html += "<div id='dualconfig_" + String(s) + "' style='display:" + String(screen_configs[s].display_type == 2 ? "block" : "none") + ";'>";
+        html += "<div id='dualconfig_" + String(s) + "' style='display:" + String(v.screens[s].display_type == 2 ? "block" : "none") + ";'>";
         html += "<h4>Dual Display Settings</h4>";
         
         // Background color (shown when Custom Color is selected in bg_image dropdown)
         html += "<div id='dual_bg_color_div_" + String(s) + "' style='margin-bottom:8px;display:" + String(isCustomColor ? "block" : "none") + ";'>";
-        html += "<label>Background Color: <input name='dual_bg_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].number_bg_color[0] ? screen_configs[s].number_bg_color : "#000000") + "'></label></div>";
+        html += "<label>Background Color: <input name='dual_bg_color_" + String(s) + "' type='color' value='" + String(v.screens[s].number_bg_color[0] ? v.screens[s].number_bg_color : "#000000") + "'></label></div>";
         
         // Top display settings
         html += "<h5>Top Display</h5>";
-        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='dual_top_path_" + String(s) + "' type='text' value='" + String(screen_configs[s].dual_top_path) + "' style='width:80%'></label></div>";
-        html += "<div style='margin-bottom:8px;'><label>Font Size: <select name='dual_top_font_size_" + String(s) + "'>";
-        html += "<option value='0'";
-        if (screen_configs[s].dual_top_font_size == 0) html += " selected";
-        html += ">Small (48pt)</option>";
-        html += "<option value='1'";
-        if (screen_configs[s].dual_top_font_size == 1) html += " selected";
-        html += ">Medium (72pt)</option>";
-        html += "<option value='2'";
-        if (screen_configs[s].dual_top_font_size == 2) html += " selected";
-        html += ">Large (96pt)</option>";
-        html += "<option value='3'";
-        if (screen_configs[s].dual_top_font_size == 3) html += " selected";
-        html += ">X-Large (120pt)</option>";
-        html += "<option value='4'";
-        if (screen_configs[s].dual_top_font_size == 4) html += " selected";
-        html += ">XX-Large (144pt)</option>";
-        html += "</select></label></div>";
-        html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='dual_top_font_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].dual_top_font_color[0] ? screen_configs[s].dual_top_font_color : "#FFFFFF") + "'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='dual_top_path_" + String(s) + "' type='text' value='" + String(v.screens[s].dual_top_path) + "' style='width:80%'></label></div>";
+        emit_select(html, "Font Size", "dual_top_font_size", s, FONT_SIZE_LABELS, 5, v.screens[s].dual_top_font_size);
+        html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='dual_top_font_color_" + String(s) + "' type='color' value='" + String(v.screens[s].dual_top_font_color[0] ? v.screens[s].dual_top_font_color : "#FFFFFF") + "'></label></div>";
         
         // Bottom display settings
         html += "<h5>Bottom Display</h5>";
-        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='dual_bottom_path_" + String(s) + "' type='text' value='" + String(screen_configs[s].dual_bottom_path) + "' style='width:80%'></label></div>";
-        html += "<div style='margin-bottom:8px;'><label>Font Size: <select name='dual_bottom_font_size_" + String(s) + "'>";
-        html += "<option value='0'";
-        if (screen_configs[s].dual_bottom_font_size == 0) html += " selected";
-        html += ">Small (48pt)</option>";
-        html += "<option value='1'";
-        if (screen_configs[s].dual_bottom_font_size == 1) html += " selected";
-        html += ">Medium (72pt)</option>";
-        html += "<option value='2'";
-        if (screen_configs[s].dual_bottom_font_size == 2) html += " selected";
-        html += ">Large (96pt)</option>";
-        html += "<option value='3'";
-        if (screen_configs[s].dual_bottom_font_size == 3) html += " selected";
-        html += ">X-Large (120pt)</option>";
-        html += "<option value='4'";
-        if (screen_configs[s].dual_bottom_font_size == 4) html += " selected";
-        html += ">XX-Large (144pt)</option>";
-        html += "</select></label></div>";
-        html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='dual_bottom_font_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].dual_bottom_font_color[0] ? screen_configs[s].dual_bottom_font_color : "#FFFFFF") + "'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='dual_bottom_path_" + String(s) + "' type='text' value='" + String(v.screens[s].dual_bottom_path) + "' style='width:80%'></label></div>";
+        emit_select(html, "Font Size", "dual_bottom_font_size", s, FONT_SIZE_LABELS, 5, v.screens[s].dual_bottom_font_size);
+        html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='dual_bottom_font_color_" + String(s) + "' type='color' value='" + String(v.screens[s].dual_bottom_font_color[0] ? v.screens[s].dual_bottom_font_color : "#FFFFFF") + "'></label></div>";
         
         html += "</div>"; // End dual display config
         
         // Quad display configuration (hidden when display_type is not Quad)
-        html += "<div id='quadconfig_" + String(s) + "' style='display:" + String(screen_configs[s].display_type == 3 ? "block" : "none") + ";'>";
+        html += "<div id='quadconfig_" + String(s) + "' style='display:" + String(v.screens[s].display_type == 3 ? "block" : "none") + ";'>";
         html += "<h4>Quad Display Settings</h4>";
         
         // Background color
-        html += "<div style='margin-bottom:8px;'><label>Background Color: <input name='quad_bg_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].number_bg_color[0] ? screen_configs[s].number_bg_color : "#000000") + "'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>Background Color: <input name='quad_bg_color_" + String(s) + "' type='color' value='" + String(v.screens[s].number_bg_color[0] ? v.screens[s].number_bg_color : "#000000") + "'></label></div>";
         
         // Helper function for quad quadrant HTML (we'll define it inline)
         auto addQuadrantHTML = [&](const char* name, const char* label, char* path, uint8_t size, char* color) {
@@ -866,267 +944,106 @@ void handle_gauges_page() {
             html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='quad_" + String(name) + "_font_color_" + String(s) + "' type='color' value='" + String(color[0] ? color : "#FFFFFF") + "'></label></div>";
         };
         
-        addQuadrantHTML("tl", "Top-Left", screen_configs[s].quad_tl_path, screen_configs[s].quad_tl_font_size, screen_configs[s].quad_tl_font_color);
-        addQuadrantHTML("tr", "Top-Right", screen_configs[s].quad_tr_path, screen_configs[s].quad_tr_font_size, screen_configs[s].quad_tr_font_color);
-        addQuadrantHTML("bl", "Bottom-Left", screen_configs[s].quad_bl_path, screen_configs[s].quad_bl_font_size, screen_configs[s].quad_bl_font_color);
-        addQuadrantHTML("br", "Bottom-Right", screen_configs[s].quad_br_path, screen_configs[s].quad_br_font_size, screen_configs[s].quad_br_font_color);
+        addQuadrantHTML("tl", "Top-Left", v.screens[s].quad_tl_path, v.screens[s].quad_tl_font_size, v.screens[s].quad_tl_font_color);
+        addQuadrantHTML("tr", "Top-Right", v.screens[s].quad_tr_path, v.screens[s].quad_tr_font_size, v.screens[s].quad_tr_font_color);
+        addQuadrantHTML("bl", "Bottom-Left", v.screens[s].quad_bl_path, v.screens[s].quad_bl_font_size, v.screens[s].quad_bl_font_color);
+        addQuadrantHTML("br", "Bottom-Right", v.screens[s].quad_br_path, v.screens[s].quad_br_font_size, v.screens[s].quad_br_font_color);
         
         html += "</div>"; // End quad display config
         
         // Gauge configuration container (hidden when display_type is Number)
-        html += "<div id='gaugeconfig_" + String(s) + "' style='display:" + String(screen_configs[s].display_type == 0 ? "block" : "none") + ";'>";
+        html += "<div id='gaugeconfig_" + String(s) + "' style='display:" + String(v.screens[s].display_type == 0 ? "block" : "none") + ";'>";
         
         for (int g = 0; g < 2; ++g) {
             // When rendering UI: allow user to hide bottom gauge per-screen
             if (g == 0) {
                 html += "<div style='margin-bottom:8px;'><label>Show Bottom Gauge: <input type='checkbox' name='showbottom_" + String(s) + "'";
-                if (screen_configs[s].show_bottom) html += " checked";
+                if (v.screens[s].show_bottom) html += " checked";
                 html += "></label></div>";
             }
             int idx = s * 2 + g;
             // If bottom gauge is disabled, skip rendering its configuration
-            if (g == 1 && !screen_configs[s].show_bottom) {
+            if (g == 1 && !v.screens[s].show_bottom) {
                 html += "<div style='margin-bottom:8px;'><em>Bottom gauge disabled for this screen.</em></div>";
                 continue;
             }
             html += "<b>" + String(g == 0 ? "Top Gauge" : "Bottom Gauge") + "</b>";
             // SignalK Path: show immediately above the icon options (per-gauge)
-            html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='skpath_" + String(s) + "_" + String(g) + "' type='text' value='" + signalk_paths[idx] + "' style='width:80%'></label></div>";
-
-            // Calibration points table (moved to be under SignalK Path)
-            html += "<table class='table'><tr><th>Point</th><th>Angle</th><th>Value</th><th>Test</th></tr>";
-            for (int p = 0; p < 5; ++p) {
-                html += "<tr><td>" + String(p+1) + "</td>";
-                html += "<td><input name='" + String("angle_") + s + "_" + g + "_" + p + "' type='number' value='" + String(gauge_cal[s][g][p].angle) + "'></td>";
-                html += "<td><input name='" + String("value_") + s + "_" + g + "_" + p + "' type='number' step='any' value='" + String(gauge_cal[s][g][p].value) + "'></td>";
-                html += "<td><button type='button' onclick='testGaugePoint(" + String(s) + "," + String(g) + "," + String(p) + ")' ";
-                html += (test_mode ? "" : "disabled ");
-                html += "style='padding:4px 8px;font-size:0.9em;background-color:";
-                html += (test_mode ? "#4a90e2" : "#cccccc");
-                html += ";color:#ffffff;border:1px solid #2d5a8f;border-radius:4px;cursor:";
-                html += (test_mode ? "pointer" : "not-allowed");
-                html += ";'>Test</button></td></tr>";
-            }
-            html += "</table>";
-
-            // Icon controls (grouped visually)
-            String savedIcon = String(screen_configs[s].icon_paths[g]);
-            String savedIconNorm = savedIcon;
-            savedIconNorm.toLowerCase();
-            savedIconNorm.replace("S://", "S:/");
-            while (savedIconNorm.indexOf("//") != -1) savedIconNorm.replace("//", "/");
-            html += "<div class='icon-section'><div class='icon-row'>";
-            html += "<div style='margin-bottom:8px;'><label>Icon: <select name='icon_" + String(s) + "_" + String(g) + "'>";
-            html += "<option value=''";
-            if (savedIcon.length() == 0) html += " selected='selected'";
-            html += ">None</option>";
-            for (const auto& icon : iconFiles) {
-                String iconNorm = icon;
-                iconNorm.toLowerCase();
-                iconNorm.replace("S://", "S:/");
-                while (iconNorm.indexOf("//") != -1) iconNorm.replace("//", "/");
-                html += "<option value='" + icon + "'";
-                if (iconNorm == savedIconNorm && savedIcon.length() > 0) html += " selected='selected'";
-                html += ">" + icon + "</option>";
-            }
-            html += "</select></label></div>";
-            // Icon position selector (per-gauge)
-            int curPos = screen_configs[s].icon_pos[g];
-            html += "<div style='margin-bottom:8px;'><label>Icon Position: <select name='iconpos_" + String(s) + "_" + String(g) + "'>";
-            struct { int v; const char *n; } posopts[] = { {0,"Top"}, {1,"Right"}, {2,"Bottom"}, {3,"Left"} };
-            for (int _po = 0; _po < 4; ++_po) {
-                html += "<option value='" + String(posopts[_po].v) + "'";
-                if (curPos == posopts[_po].v) html += " selected='selected'";
-                html += ">" + String(posopts[_po].n) + "</option>";
-            }
-            html += "</select></label></div>";
-            // close icon-row but keep icon-section open so min/max controls are grouped with icons
-            html += "</div>"; // close icon-row
-
-            // Zone min/max/color/transparent/buzzer controls — include inside icon-section
-            html += "<div class='zone-row'>";
-            for (int i = 1; i <= 4; ++i) {
-                float minVal = screen_configs[s].min[g][i];
-                float maxVal = screen_configs[s].max[g][i];
-                String colorVal = String(screen_configs[s].color[g][i]);
-                bool transVal = screen_configs[s].transparent[g][i] != 0;
-                bool bzrVal = screen_configs[s].buzzer[g][i] != 0;
-                html += "<div class='zone-item'><label>Min " + String(i) + ": <input name='mnv" + String(s) + String(g) + String(i) + "' type='number' step='any' value='" + String(minVal) + "' style='width:100px'></label></div>";
-                html += "<div class='zone-item'><label>Max " + String(i) + ": <input name='mxv" + String(s) + String(g) + String(i) + "' type='number' step='any' value='" + String(maxVal) + "' style='width:100px'></label></div>";
-                html += "<div class='zone-item'><label>Color: <input class='color-input' name='clr" + String(s) + String(g) + String(i) + "' type='color' value='" + colorVal + "'></label></div>";
-                html += "<div class='zone-item small'><label>Transparent <input name='trn" + String(s) + String(g) + String(i) + "' type='checkbox'";
-                if (transVal) html += " checked";
-                html += "></label></div>";
-                html += "<div class='zone-item small'><label>Buzzer <input name='bzr" + String(s) + String(g) + String(i) + "' type='checkbox'";
-                if (bzrVal) html += " checked";
-                html += "></label></div>";
-            }
-            html += "</div>";
+            html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='skpath_" + String(s) + "_" + String(g) + "' type='text' value='" + paths[idx] + "' style='width:80%'></label></div>";
 
+            emit_calibration_table(html, v, s, g, test_mode);
+            emit_icon_controls(html, v, s, g, iconFiles);
+            emit_zone_row(html, v, s, g);
             html += "</div>"; // close icon-section
         }
         html += "</div>"; // close gaugeconfig div
         
         // Gauge + Number configuration (display_type == 4)
-        html += "<div id='gaugenumconfig_" + String(s) + "' style='display:" + String(screen_configs[s].display_type == 4 ? "block" : "none") + ";'>";
+        html += "<div id='gaugenumconfig_" + String(s) + "' style='display:" + String(v.screens[s].display_type == 4 ? "block" : "none") + ";'>";
         html += "<h4>Gauge + Number Display Settings</h4>";
         
         // Top gauge configuration (g=0 only)
         html += "<b>Top Gauge</b>";
         int idx = s * 2 + 0; // Always use top gauge (g=0)
-        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='skpath_" + String(s) + "_0' type='text' value='" + signalk_paths[idx] + "' style='width:80%'></label></div>";
-        
-        // Calibration points table
-        html += "<table class='table'><tr><th>Point</th><th>Angle</th><th>Value</th><th>Test</th></tr>";
-        for (int p = 0; p < 5; ++p) {
-            html += "<tr><td>" + String(p+1) + "</td>";
-            html += "<td><input name='" + String("angle_") + s + "_0_" + p + "' type='number' value='" + String(gauge_cal[s][0][p].angle) + "'></td>";
-            html += "<td><input name='" + String("value_") + s + "_0_" + p + "' type='number' step='any' value='" + String(gauge_cal[s][0][p].value) + "'></td>";
-            html += "<td><button type='button' onclick='testGaugePoint(" + String(s) + ",0," + String(p) + ")' ";
-            html += (test_mode ? "" : "disabled ");
-            html += "style='padding:4px 8px;font-size:0.9em;background-color:";
-            html += (test_mode ? "#4a90e2" : "#cccccc");
-            html += ";color:#ffffff;border:1px solid #2d5a8f;border-radius:4px;cursor:";
-            html += (test_mode ? "pointer" : "not-allowed");
-            html += ";'>Test</button></td></tr>";
-        }
-        html += "</table>";
-        
-        // Icon controls for top gauge
-        String savedIcon = String(screen_configs[s].icon_paths[0]);
-        String savedIconNorm = savedIcon;
-        savedIconNorm.toLowerCase();
-        savedIconNorm.replace("S://", "S:/");
-        while (savedIconNorm.indexOf("//") != -1) savedIconNorm.replace("//", "/");
-        html += "<div class='icon-section'><div class='icon-row'>";
-        html += "<div style='margin-bottom:8px;'><label>Icon: <select name='icon_" + String(s) + "_0'>";
-        html += "<option value=''";
-        if (savedIcon.length() == 0) html += " selected='selected'";
-        html += ">None</option>";
-        for (const auto& icon : iconFiles) {
-            String iconNorm = icon;
-            iconNorm.toLowerCase();
-            iconNorm.replace("S://", "S:/");
-            while (iconNorm.indexOf("//") != -1) iconNorm.replace("//", "/");
-            html += "<option value='" + icon + "'";
-            if (iconNorm == savedIconNorm && savedIcon.length() > 0) html += " selected='selected'";
-            html += ">" + icon + "</option>";
-        }
-        html += "</select></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='skpath_" + String(s) + "_0' type='text' value='" + paths[idx] + "' style='width:80%'></label></div>";
         
-        // Icon position for top gauge
-        int curPos = screen_configs[s].icon_pos[0];
-        html += "<div style='margin-bottom:8px;'><label>Icon Position: <select name='iconpos_" + String(s) + "_0'>";
-        struct { int v; const char *n; } posopts[] = { {0,"Top"}, {1,"Right"}, {2,"Bottom"}, {3,"Left"} };
-        for (int _po = 0; _po < 4; ++_po) {
-            html += "<option value='" + String(posopts[_po].v) + "'";
-            if (curPos == posopts[_po].v) html += " selected='selected'";
-            html += ">" + String(posopts[_po].n) + "</option>";
-        }
-        html += "</select></label></div>";
-        html += "</div>"; // close icon-row
-        
-        // Zone controls for top gauge
-        html += "<div class='zone-row'>";
-        for (int i = 1; i <= 4; ++i) {
-            float minVal = screen_configs[s].min[0][i];
-            float maxVal = screen_configs[s].max[0][i];
-            String colorVal = String(screen_configs[s].color[0][i]);
-            bool transVal = screen_configs[s].transparent[0][i] != 0;
-            bool bzrVal = screen_configs[s].buzzer[0][i] != 0;
-            html += "<div class='zone-item'><label>Min " + String(i) + ": <input name='mnv" + String(s) + "0" + String(i) + "' type='number' step='any' value='" + String(minVal) + "' style='width:100px'></label></div>";
-            html += "<div class='zone-item'><label>Max " + String(i) + ": <input name='mxv" + String(s) + "0" + String(i) + "' type='number' step='any' value='" + String(maxVal) + "' style='width:100px'></label></div>";
-            html += "<div class='zone-item'><label>Color: <input class='color-input' name='clr" + String(s) + "0" + String(i) + "' type='color' value='" + colorVal + "'></label></div>";
-            html += "<div class='zone-item small'><label>Transparent <input name='trn" + String(s) + "0" + String(i) + "' type='checkbox'";
-            if (transVal) html += " checked";
-            html += "></label></div>";
-            html += "<div class='zone-item small'><label>Buzzer <input name='bzr" + String(s) + "0" + String(i) + "' type='checkbox'";
-            if (bzrVal) html += " checked";
-            html += "></label></div>";
-        }
-        html += "</div>";
+        emit_calibration_table(html, v, s, 0, test_mode);
+        emit_icon_controls(html, v, s, 0, iconFiles);
+        emit_zone_row(html, v, s, 0);
         html += "</div>"; // close icon-section
         
         // Center number display configuration
         html += "<h5 style='margin-top:16px;'>Center Number Display</h5>";
-        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='gauge_num_center_path_" + String(s) + "' type='text' value='" + String(screen_configs[s].gauge_num_center_path) + "' style='width:80%'></label></div>";
-        html += "<div style='margin-bottom:8px;'><label>Font Size: <select name='gauge_num_center_font_size_" + String(s) + "'>";
-        html += "<option value='0'";
-        if (screen_configs[s].gauge_num_center_font_size == 0) html += " selected";
-        html += ">Small (48pt)</option>";
-        html += "<option value='1'";
-        if (screen_configs[s].gauge_num_center_font_size == 1) html += " selected";
-        html += ">Medium (72pt)</option>";
-        html += "<option value='2'";
-        if (screen_configs[s].gauge_num_center_font_size == 2) html += " selected";
-        html += ">Large (96pt)</option>";
-        html += "<option value='3'";
-        if (screen_configs[s].gauge_num_center_font_size == 3) html += " selected";
-        html += ">X-Large (120pt)</option>";
-        html += "<option value='4'";
-        if (screen_configs[s].gauge_num_center_font_size == 4) html += " selected";
-        html += ">XX-Large (144pt)</option>";
-        html += "</select></label></div>";
-        html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='gauge_num_center_font_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].gauge_num_center_font_color[0] ? screen_configs[s].gauge_num_center_font_color : "#FFFFFF") + "'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='gauge_num_center_path_" + String(s) + "' type='text' value='" + String(v.screens[s].gauge_num_center_path) + "' style='width:80%'></label></div>";
+        emit_select(html, "Font Size", "gauge_num_center_font_size", s, FONT_SIZE_LABELS, 5, v.screens[s].gauge_num_center_font_size);
+        html += "<div style='margin-bottom:8px;'><label>Font Color: <input name='gauge_num_center_font_color_" + String(s) + "' type='color' value='" + String(v.screens[s].gauge_num_center_font_color[0] ? v.screens[s].gauge_num_center_font_color : "#FFFFFF") + "'></label></div>";
         
         html += "</div>"; // close gaugenumconfig div
         
         // Graph configuration (display_type == 5)
-        html += "<div id='graphconfig_" + String(s) + "' style='display:" + String(screen_configs[s].display_type == 5 ? "block" : "none") + ";'>";
+        html += "<div id='graphconfig_" + String(s) + "' style='display:" + String(v.screens[s].display_type == 5 ? "block" : "none") + ";'>";
         html += "<h4>Graph Display Settings</h4>";
         
         // SignalK Path for graph display (reuses number_path field)
-        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='number_path_" + String(s) + "' type='text' value='" + String(screen_configs[s].number_path) + "' style='width:80%'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>SignalK Path: <input name='number_path_" + String(s) + "' type='text' value='" + String(v.screens[s].number_path) + "' style='width:80%'></label></div>";
         
         // Chart Type selection
-        html += "<div style='margin-bottom:8px;'><label>Chart Type: <select name='graph_chart_type_" + String(s) + "'>";
-        html += "<option value='0'";
-        if (screen_configs[s].graph_chart_type == 0) html += " selected";
-        html += ">Line Chart</option>";
-        html += "<option value='1'";
-        if (screen_configs[s].graph_chart_type == 1) html += " selected";
-        html += ">Bar Chart</option>";
-        html += "<option value='2'";
-        if (screen_configs[s].graph_chart_type == 2) html += " selected";
-        html += ">Scatter Plot</option>";
-        html += "</select></label></div>";
+        emit_select(html, "Chart Type", "graph_chart_type", s, CHART_TYPE_LABELS, sizeof(CHART_TYPE_LABELS) / sizeof(CHART_TYPE_LABELS[0]), v.screens[s].graph_chart_type);
         
         // Time Range selection
-        html += "<div style='margin-bottom:8px;'><label>Time Range: <select name='graph_time_range_" + String(s) + "'>";
-        html += "<option value='0'";
-        if (screen_configs[s].graph_time_range == 0) html += " selected";
-        html += ">10 seconds</option>";
-        html += "<option value='1'";
-        if (screen_configs[s].graph_time_range == 1) html += " selected";
-        html += ">30 seconds</option>";
-        html += "<option value='2'";
-        if (screen_configs[s].graph_time_range == 2) html += " selected";
-        html += ">1 minute</option>";
-        html += "<option value='3'";
-        if (screen_configs[s].graph_time_range == 3) html += " selected";
-        html += ">5 minutes</option>";
-        html += "<option value='4'";
-        if (screen_configs[s].graph_time_range == 4) html += " selected";
-        html += ">10 minutes</option>";
-        html += "<option value='5'";
-        if (screen_configs[s].graph_time_range == 5) html += " selected";
-        html += ">30 minutes</option>";
-        html += "</select></label></div>";
+        emit_select(html, "Time Range", "graph_time_range", s, TIME_RANGE_LABELS, sizeof(TIME_RANGE_LABELS) / sizeof(TIME_RANGE_LABELS[0]), v.screens[s].graph_time_range);
         
         // Font color for graph (labels, axes, line color)
-        html += "<div style='margin-bottom:8px;'><label>Series 1 Color: <input name='number_font_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].number_font_color[0] ? screen_configs[s].number_font_color : "#00FF00") + "'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>Series 1 Color: <input name='number_font_color_" + String(s) + "' type='color' value='" + String(v.screens[s].number_font_color[0] ? v.screens[s].number_font_color : "#00FF00") + "'></label></div>";
         
         // Second series configuration
         html += "<h5 style='margin-top:16px;'>Second Data Series (Optional)</h5>";
-        html += "<div style='margin-bottom:8px;'><label>SignalK Path 2: <input name='graph_path_2_" + String(s) + "' type='text' value='" + String(screen_configs[s].graph_path_2) + "' style='width:80%'></label></div>";
-        html += "<div style='margin-bottom:8px;'><label>Series 2 Color: <input name='graph_color_2_" + String(s) + "' type='color' value='" + String(screen_configs[s].graph_color_2[0] ? screen_configs[s].graph_color_2 : "#FF0000") + "'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>SignalK Path 2: <input name='graph_path_2_" + String(s) + "' type='text' value='" + String(v.screens[s].graph_path_2) + "' style='width:80%'></label></div>";
+        html += "<div style='margin-bottom:8px;'><label>Series 2 Color: <input name='graph_color_2_" + String(s) + "' type='color' value='" + String(v.screens[s].graph_color_2[0] ? v.screens[s].graph_color_2 : "#FF0000") + "'></label></div>";
         
         // Background color (shown when Custom Color is selected in bg_image dropdown)
-        bool isCustomColorGraph = (String(screen_configs[s].background_path) == "Custom Color");
+        bool isCustomColorGraph = (String(v.screens[s].background_path) == "Custom Color");
         html += "<div id='graph_bg_color_div_" + String(s) + "' style='margin-bottom:8px;display:" + String(isCustomColorGraph ? "block" : "none") + ";'>";
-        html += "<label>Background Color: <input name='number_bg_color_" + String(s) + "' type='color' value='" + String(screen_configs[s].number_bg_color[0] ? screen_configs[s].number_bg_color : "#000000") + "'></label></div>";
+        html += "<label>Background Color: <input name='number_bg_color_" + String(s) + "' type='color' value='" + String(v.screens[s].number_bg_color[0] ? v.screens[s].number_bg_color : "#000000") + "'></label></div>";
         
         html += "</div>"; // close graphconfig div
+
+        // Redraw filtering: per-widget deadband, minimum interval and resolution
+        static const char *const widget_names[WIDGET_SLOT_COUNT] = {
+            "Top needle (&deg;)", "Bottom needle (&deg;)", "Number / top / top-left / center",
+            "Bottom / top-right", "Bottom-left", "Bottom-right"};
+        html += "<details style='margin-top:12px;'><summary>Redraw filtering</summary>";
+        html += "<p style='font-size:0.9em;'>Changes smaller than the deadband, or sooner than the minimum interval, are not redrawn. Resolution rounds the shown value (e.g. 0.5, 10). 0 = off.</p>";
+        html += "<table><tr><th>Widget</th><th>Deadband</th><th>Min interval (ms)</th><th>Resolution</th></tr>";
+        for (int w = 0; w < WIDGET_SLOT_COUNT; ++w) {
+            html.printf("<tr><td>%s</td>"
+                        "<td><input name='rd_db_%d_%d' type='number' step='any' min='0' style='width:80px' value='%.3f'></td>"
+                        "<td><input name='rd_ms_%d_%d' type='number' min='0' max='60000' style='width:80px' value='%u'></td>"
+                        "<td><input name='rd_res_%d_%d' type='number' step='any' min='0' style='width:80px' value='%.3f'></td></tr>",
+                        widget_names[w], s, w, v.screens[s].redraw_deadband[w], s, w,
+                        (unsigned)v.screens[s].redraw_min_ms[w], s, w, v.screens[s].redraw_resolution[w]);
+        }
+        html += "</table></details>";
         
         html += "</div>"; // close tab content
     }
@@ -1137,12 +1054,10 @@ void handle_gauges_page() {
     for (int s = 0; s < NUM_SCREENS; ++s) {
         for (int g = 0; g < 2; ++g) {
             for (int p = 0; p < 5; ++p) {
-                html += "<form style='display:none;' id='testform_" + String(s) + "_" + String(g) + "_" + String(p) + "' method='POST' action='/test-gauge'>";
-                html += "<input type='hidden' name='screen' value='" + String(s) + "'>";
-                html += "<input type='hidden' name='gauge' value='" + String(g) + "'>";
-                html += "<input type='hidden' name='point' value='" + String(p) + "'>";
-                html += "<input type='hidden' name='angle' id='testangle_" + String(s) + "_" + String(g) + "_" + String(p) + "' value=''>";
-                html += "</form>";
+                html.printf("<form style='display:none;' id='testform_%d_%d_%d' method='POST' action='/test-gauge'>"
+                            "<input type='hidden' name='screen' value='%d'><input type='hidden' name='gauge' value='%d'>"
+                            "<input type='hidden' name='point' value='%d'><input type='hidden' name='angle' id='testangle_%d_%d_%d' value=''></form>",
+                            s, g, p, s, g, p, s, g, p);
             }
         }
     }
@@ -1246,13 +1161,13 @@ void handle_gauges_page() {
     // Pass display types and show_bottom flags to JavaScript
     html += "  var displayTypes = [";
     for (int s = 0; s < NUM_SCREENS; s++) {
-        html += String(screen_configs[s].display_type);
+        html += String(v.screens[s].display_type);
         if (s < NUM_SCREENS - 1) html += ",";
     }
     html += "];\n";
     html += "  var showBottom = [";
     for (int s = 0; s < NUM_SCREENS; s++) {
-        html += String(screen_configs[s].show_bottom ? "true" : "false");
+        html += String(v.screens[s].show_bottom ? "true" : "false");
         if (s < NUM_SCREENS - 1) html += ",";
     }
     html += "];\n";
@@ -1296,9 +1211,32 @@ void handle_gauges_page() {
     html += "  var initial = 0; if(location.hash && location.hash.indexOf('#tab')===0){ initial = parseInt(location.hash.replace('#tab',''))||0; }\n";
     html += "  showScreenTab(initial);\n";
     html += "});</script>";
+    // Live readings under each calibration table, from the live value socket
+    // (see live_ws.h). Only slots that changed arrive after the first frame.
+    html += "<script>(function(){\n";
+    html += "  var ws;\n";
+    html += "  function open(){\n";
+    html += "    ws = new WebSocket('ws://'+location.hostname+':" + String(LIVE_WS_PORT) + "/');\n";
+    html += "    ws.binaryType = 'arraybuffer';\n";
+    html += "    ws.onopen = function(){ ws.send(JSON.stringify({rate:5})); };\n";
+    html += "    ws.onmessage = function(e){\n";
+    html += "      if(typeof e.data === 'string') return;\n";
+    html += "      var d = new DataView(e.data), mask = d.getUint16(2, true), o = 4;\n";
+    html += "      for(var i = 0; i < 16; i++){\n";
+    html += "        if(!(mask & (1 << i))) continue;\n";
+    html += "        var v = d.getFloat32(o, true), a = d.getInt16(o + 4, true) / 10, z = d.getUint8(o + 6); o += 7;\n";
+    html += "        var el = document.getElementById('live_' + (i >> 1) + '_' + (i & 1));\n";
+    html += "        if(el) el.textContent = 'Live: value ' + (isFinite(v) ? v.toFixed(2) : '--') + ' | needle ' + a.toFixed(1) + '\\u00b0 | ' + (z ? 'zone ' + z : 'zone -');\n";
+    html += "      }\n";
+    html += "    };\n";
+    html += "    ws.onclose = function(){ setTimeout(open, 3000); };\n";
+    html += "  }\n";
+    html += "  open();\n";
+    html += "})();</script>";
     html += "<p style='text-align:center;'><a href='/'>Back</a></p>";
     html += "</div></body></html>";
-    config_server.send(200, "text/html", html);
+    html.end();
+    free(view);
 }
 
 void handle_save_gauges() {
@@ -1332,6 +1270,10 @@ void handle_save_gauges() {
     Serial.println("[DEBUG] handle_save_gauges() called");
     if (config_server.method() == HTTP_POST) {
         bool reboot_needed = false;
+        // The UI lock covers updating the config and the hot-apply; saving
+        // and the metadata fetch run after it. Only the web task writes the
+        // config, so reading it back unlocked is safe.
+        ui_lock();
         for (int s = 0; s < NUM_SCREENS; ++s) {
             for (int g = 0; g < 2; ++g) {
                 int idx = s * 2 + g;
@@ -1525,6 +1467,18 @@ void handle_save_gauges() {
                         strncpy(screen_configs[s].graph_color_2, config_server.arg(graphColor2Key).c_str(), 7);
                         screen_configs[s].graph_color_2[7] = '\0';
                     }
+
+                    // Redraw filtering per widget
+                    for (int w = 0; w < WIDGET_SLOT_COUNT; ++w) {
+                        String suffix = String(s) + "_" + String(w);
+                        if (!config_server.hasArg("rd_db_" + suffix)) continue;
+                        float db = config_server.arg("rd_db_" + suffix).toFloat();
+                        long ms = config_server.arg("rd_ms_" + suffix).toInt();
+                        float res = config_server.arg("rd_res_" + suffix).toFloat();
+                        screen_configs[s].redraw_deadband[w] = (db > 0.0f && isfinite(db)) ? db : 0.0f;
+                        screen_configs[s].redraw_min_ms[w] = (uint16_t)constrain(ms, 0L, 60000L);
+                        screen_configs[s].redraw_resolution[w] = (res > 0.0f && isfinite(res)) ? res : 0.0f;
+                    }
                 }
                 // Only process zone settings if the first zone field is in the form
                 // (gauges hidden by display type won't submit their zone fields)
@@ -1559,6 +1513,11 @@ void handle_save_gauges() {
                         gauge_cal[s][g][p].angle = angleStr.toInt();
                         gauge_cal[s][g][p].value = valueStr.toFloat();
                     }
+                    String cubicKey = "cubic_" + String(s) + "_" + String(g);
+                    uint16_t bit = (uint16_t)(1u << (s * 2 + g));
+                    if (config_server.hasArg(cubicKey)) gauge_cal_cubic_mask |= bit;
+                    else gauge_cal_cubic_mask &= ~bit;
+                    gauge_cal_changed();
                 } else {
                     Serial.printf("[DEBUG] Skipping calibration for screen %d gauge %d (not in form)\n", s, g);
                 }
@@ -1573,6 +1532,18 @@ void handle_save_gauges() {
                 }
             }
         }
+        // Prefer hot-apply: try to apply visuals now. If successful, skip reloading
+        // stored preferences when rendering the gauges page so the user sees the
+        // updated state immediately.
+        bool applied_now = apply_all_screen_visuals();
+        if (!applied_now) {
+            Serial.println("[HOTAPPLY] apply_all_screen_visuals() returned false — UI objects may not be present yet");
+        }
+        // Either way the page reflects the in-memory state; we will not reboot
+        // unless an image changed and could not be applied
+        skip_next_load_preferences = true;
+        ui_unlock();
+
         // Attempt to write per-screen binary configs to SD immediately so toggles
         // (like show_bottom) persist even if NVS writes fail or are delayed.
         if (!SD_MMC.exists("/config")) SD_MMC.mkdir("/config");
@@ -1599,17 +1570,6 @@ void handle_save_gauges() {
         // Fetch metadata for any new or changed paths
         fetch_all_metadata();
 
-        // Prefer hot-apply: try to apply visuals now. If successful, skip reloading
-        // stored preferences when rendering the gauges page so the user sees the
-        // updated state immediately.
-        bool applied_now = apply_all_screen_visuals();
-        if (applied_now) {
-            skip_next_load_preferences = true;
-        } else {
-            Serial.println("[HOTAPPLY] apply_all_screen_visuals() returned false — UI objects may not be present yet");
-            // still set skip flag so the page reflects in-memory state; we will not reboot
-            skip_next_load_preferences = true;
-        }
         // Debug: print updated screen_configs including buzzer flags to verify checkboxes
         Serial.println("[DEBUG] Screen configs after save (including buzzer flags):");
         dump_screen_configs();
@@ -1634,13 +1594,10 @@ void handle_save_gauges() {
                 Serial.printf("[NVS ENUM] nvs_open failed: %d\n", nvs_enum_err);
             }
         }
-        // Try to apply visual changes at runtime (hot-update). If LVGL objects are not present
-        // or the update fails, fall back to reboot to ensure a clean load.
+        // Visual changes were hot-applied above. If LVGL objects were not present
+        // or the update failed, fall back to reboot to ensure a clean load.
         if (reboot_needed) {
-            bool applied = false;
-            // attempt hot-apply
-            applied = apply_all_screen_visuals();
-            if (applied) {
+            if (applied_now) {
                 // Immediately reload the Gauge Calibration page instead of showing an intermediate page
                 {
                     String redirectPath = "/gauges";
@@ -1665,8 +1622,6 @@ void handle_save_gauges() {
                 return;
             }
         } else {
-            // Attempt to apply visual changes at runtime (positions, recolor etc.) even when no reboot needed
-            bool applied_now = apply_all_screen_visuals();
             // Redirect back to the gauges page (no reboot), preserving active tab
             {
                 String redirectPath = "/gauges";
@@ -1716,6 +1671,8 @@ void handle_root() {
     html += "<button class='tab-btn' onclick=\"location.href='/network'\">Network Setup</button>";
     html += "<button class='tab-btn' onclick=\"location.href='/gauges'\">Gauge Calibration</button>";
     html += "<button class='tab-btn' onclick=\"location.href='/needles'\">Needles</button>";
+    html += "<button class='tab-btn' onclick=\"location.href='/filters'\">Filters</button>";
+    html += "<button class='tab-btn' onclick=\"location.href='/derived'\">Derived</button>";
     html += "<button class='tab-btn' onclick=\"location.href='/assets'\">Assets</button>";
     html += "<button class='tab-btn' onclick=\"location.href='/device'\">Device Settings</button>";
     html += "</div>"; // root-actions
@@ -1802,6 +1759,42 @@ void handle_device_page() {
     html += "</select></div>";
     html += "<div style='text-align:center;margin-top:12px;'><button class='tab-btn' type='submit' style='padding:10px 18px;'>Save</button></div>";
     html += "</form>";
+    // Firmware update: the browser streams the file to /api/ota and shows
+    // the upload progress (the server answers nothing else until it is in)
+    html += "<h3>Firmware</h3><p id='fwinfo'>-</p>";
+    html += "<div class='form-row'><input type='file' id='fw' accept='.bin'>";
+    html += "<button class='tab-btn' type='button' onclick='fwUpdate()'>Update firmware</button></div>";
+    html += "<p><progress id='fwbar' max='100' value='0'></progress> <span id='fwmsg'></span></p>";
+    html += "<script>";
+    html += "function fwInfo(){fetch('/api/ota').then(r=>r.json()).then(j=>{var t=j.version+' ('+j.built+') on '+j.running;";
+    html += "if(j.trial)t+=', on trial: confirms in '+j.confirm_in_s+' s';document.getElementById('fwinfo').textContent=t;}).catch(()=>{});}";
+    html += "function hex(b){return Array.from(new Uint8Array(b)).map(x=>x.toString(16).padStart(2,'0')).join('');}";
+    html += "async function fwUpdate(){var f=document.getElementById('fw').files[0],m=document.getElementById('fwmsg');if(!f)return;";
+    // crypto.subtle only exists on https/localhost; the device checks the image either way
+    html += "var q='';if(window.crypto&&crypto.subtle){q='?sha256='+hex(await crypto.subtle.digest('SHA-256',await f.arrayBuffer()));}";
+    html += "var fd=new FormData();fd.append('firmware',f);var x=new XMLHttpRequest(),t0=Date.now();";
+    html += "x.upload.onprogress=e=>{if(!e.lengthComputable)return;document.getElementById('fwbar').value=e.loaded*100/e.total;";
+    html += "m.textContent=Math.round(e.loaded/1024)+' KB, '+Math.round(e.loaded/1.024/Math.max(1,Date.now()-t0))+' KB/s';};";
+    html += "x.onload=()=>{var j={};try{j=JSON.parse(x.responseText);}catch(e){}";
+    html += "if(x.status==200){m.textContent='Installed ('+j.kbps+' KB/s), restarting...';setTimeout(fwInfo,15000);}";
+    html += "else m.textContent='Failed: '+(j.error||x.status);};";
+    html += "x.onerror=()=>{m.textContent='Connection lost';};x.open('POST','/api/ota'+q);x.send(fd);}";
+    html += "fwInfo();</script>";
+    // Config bundle: download this display's whole setup, or load one taken
+    // from another display (applied straight away, no restart)
+    html += "<h3>Backup / clone</h3>";
+    html += "<div class='form-row'><a class='tab-btn' href='/api/config/bundle' download>Download config</a></div>";
+    html += "<div class='form-row'><input type='file' id='cb' accept='.mdcb'>";
+    html += "<label><input type='checkbox' id='cbnet' checked> Network settings too</label>";
+    html += "<button class='tab-btn' type='button' onclick='cbLoad()'>Load config</button></div>";
+    html += "<p id='cbmsg'></p>";
+    html += "<script>function cbLoad(){var f=document.getElementById('cb').files[0],m=document.getElementById('cbmsg');if(!f)return;";
+    html += "var fd=new FormData();fd.append('bundle',f);m.textContent='Loading...';";
+    html += "fetch('/api/config/bundle'+(document.getElementById('cbnet').checked?'':'?network=0'),{method:'POST',body:fd})";
+    html += ".then(r=>r.json()).then(j=>{if(!j.ok){m.textContent='Failed: '+j.error;return;}";
+    html += "var miss=j.assets.filter(a=>a.state!='ok').map(a=>a.name+' ('+a.state+')');";
+    html += "m.textContent='Loaded '+j.screens+' screens in '+j.ms+' ms'+(j.restart_required?'; network settings apply after a restart':'')";
+    html += "+(miss.length?'. Upload these assets: '+miss.join(', '):'');}).catch(()=>{m.textContent='Connection lost';});}</script>";
     html += "<p style='text-align:center; margin-top:10px;'><a href='/'>Back</a></p>";
     html += "</div></div></body></html>";
     config_server.send(200, "text/html", html);
@@ -1847,7 +1840,10 @@ void handle_needles_page() {
     if (config_server.hasArg("gauge")) gauge = config_server.arg("gauge").toInt();
     if (screen < 0) screen = 0; if (screen >= NUM_SCREENS) screen = NUM_SCREENS - 1;
     if (gauge < 0) gauge = 0; if (gauge > 1) gauge = 0;
+    // Runs without the UI lock (see web_on); only the read needs it
+    ui_lock();
     NeedleStyle s = get_needle_style(screen, gauge);
+    ui_unlock();
 
     String html = "<html><head>";
     html += STYLE;
@@ -1879,6 +1875,9 @@ void handle_needles_page() {
     // Rounded / gradient / foreground
     html += "<div class='form-row'><label>Rounded ends:</label><input name='rounded' type='checkbox'" + String(s.rounded?" checked":"") + "></div>";
     html += "<div class='form-row'><label>Foreground:</label><input name='fg' type='checkbox'" + String(s.foreground?" checked":"") + "></div>";
+    // Motion: spring settle time and optional slew limit
+    html += "<div class='form-row'><label>Damping (ms):</label><input name='damping' type='number' min='0' max='" + String(NEEDLE_MAX_DAMPING_MS) + "' value='" + String(s.damping_ms) + "'> - (0 = no smoothing)</div>";
+    html += "<div class='form-row'><label>Max speed (&deg;/s):</label><input name='max_rate' type='number' min='0' max='" + String(NEEDLE_MAX_RATE_DPS) + "' value='" + String(s.max_rate) + "'> - (0 = unlimited)</div>";
 
     html += "<div style='text-align:center;margin-top:12px;'><button class='tab-btn' type='submit' style='padding:10px 18px;'>Save & Preview</button></div>";
     html += "</form>";
@@ -1905,6 +1904,8 @@ void handle_save_needles() {
     bool rounded = config_server.hasArg("rounded");
     bool gradient = config_server.hasArg("gradient");
     bool fg = config_server.hasArg("fg");
+    int damping = config_server.hasArg("damping") ? config_server.arg("damping").toInt() : NEEDLE_DEFAULT_DAMPING_MS;
+    int max_rate = config_server.hasArg("max_rate") ? config_server.arg("max_rate").toInt() : 0;
 
     // clamp sensible ranges
     if (width < 1) width = 1; if (width > 64) width = 64;
@@ -1912,8 +1913,10 @@ void handle_save_needles() {
     if (outer < 0) outer = 0; if (outer > 2000) outer = 2000;
     if (cx < 0) cx = 0; if (cx > 2000) cx = 2000;
     if (cy < 0) cy = 0; if (cy > 2000) cy = 2000;
+    if (damping < 0) damping = 0; if (damping > NEEDLE_MAX_DAMPING_MS) damping = NEEDLE_MAX_DAMPING_MS;
+    if (max_rate < 0) max_rate = 0; if (max_rate > NEEDLE_MAX_RATE_DPS) max_rate = NEEDLE_MAX_RATE_DPS;
 
-    save_needle_style_from_args(screen, gauge, color, (uint16_t)width, (int16_t)inner, (int16_t)outer, (uint16_t)cx, (uint16_t)cy, rounded, gradient, fg);
+    save_needle_style_from_args(screen, gauge, color, (uint16_t)width, (int16_t)inner, (int16_t)outer, (uint16_t)cx, (uint16_t)cy, rounded, gradient, fg, (uint16_t)damping, (uint16_t)max_rate);
 
     // Apply immediately
     apply_all_needle_styles();
@@ -1952,6 +1955,8 @@ void setup_sensESP() {
         Serial.println("\nWiFi connected!");
         Serial.print("IP: ");
         Serial.println(WiFi.localIP());
+        // Wall-clock time for the graph history store (UTC)
+        configTime(0, 0, "pool.ntp.org", "time.google.com");
         // Start mDNS responder so device can be reached by hostname.local
         if (saved_hostname.length() > 0) {
             if (MDNS.begin(saved_hostname.c_str())) {
@@ -1971,24 +1976,43 @@ void setup_sensESP() {
     show_fallback_error_screen_if_needed();
 
     // Register web UI routes and start server
-    config_server.on("/", handle_root);
-    config_server.on("/gauges", handle_gauges_page);
-    config_server.on("/save-gauges", HTTP_POST, handle_save_gauges);
-    config_server.on("/needles", handle_needles_page);
-    config_server.on("/save-needles", HTTP_POST, handle_save_needles);
-    // Assets manager page and upload/delete handlers
-    config_server.on("/assets", handle_assets_page);
-    config_server.on("/assets/upload", HTTP_POST, handle_assets_upload_post, handle_assets_upload);
-    config_server.on("/assets/delete", HTTP_POST, handle_assets_delete);
-    config_server.on("/network", handle_network_page);
-    config_server.on("/save-wifi", HTTP_POST, handle_save_wifi);
-    config_server.on("/device", handle_device_page);
-    config_server.on("/save-device", HTTP_POST, handle_save_device);
-    config_server.on("/test-gauge", HTTP_POST, handle_test_gauge);
-    config_server.on("/toggle-test-mode", HTTP_POST, handle_toggle_test_mode);
-    config_server.on("/set-screen", handle_set_screen);
-    config_server.on("/nvs_test", HTTP_GET, handle_nvs_test);
-    config_server.begin();
+    // "/" is the web app when it is in SPIFFS, else the menu below; also adds the JSON API
+    web_config_register(config_server, handle_root);
+    // Routes default to running under the UI lock; pass 0 for read-only ones
+    web_on(config_server, "/gauges", HTTP_ANY, handle_gauges_page, 0);
+    // Takes the UI lock itself, only around the change to the display
+    web_on(config_server, "/save-gauges", HTTP_POST, handle_save_gauges, 0);
+    web_on(config_server, "/needles", HTTP_ANY, handle_needles_page, 0);
+    web_on(config_server, "/save-needles", HTTP_POST, handle_save_needles);
+    web_on(config_server, "/filters", HTTP_ANY, handle_filters_page, 0);
+    web_on(config_server, "/save-filters", HTTP_POST, handle_save_filters);
+    web_on(config_server, "/derived", HTTP_ANY, handle_derived_page, 0);
+    web_on(config_server, "/save-derived", HTTP_POST, handle_save_derived);
+    // Assets manager page and upload/delete handlers (SD card only)
+    web_on(config_server, "/assets", HTTP_ANY, handle_assets_page, 0);
+    web_on(config_server, "/assets/upload", HTTP_POST, handle_assets_upload_post, 0, WEB_UPLOAD_MAX, handle_assets_upload);
+    web_on(config_server, "/assets/delete", HTTP_POST, handle_assets_delete, 0);
+    web_on(config_server, "/assets/rescan", HTTP_POST, handle_assets_rescan, 0);
+    web_on(config_server, "/api/assets", HTTP_GET, handle_assets_api, 0);
+    web_on(config_server, "/api/assets/jobs", HTTP_GET, handle_assets_jobs, 0);
+    web_on(config_server, "/network", HTTP_ANY, handle_network_page, 0);
+    web_on(config_server, "/save-wifi", HTTP_POST, handle_save_wifi);
+    web_on(config_server, "/device", HTTP_ANY, handle_device_page, 0);
+    web_on(config_server, "/save-device", HTTP_POST, handle_save_device);
+    web_on(config_server, "/test-gauge", HTTP_POST, handle_test_gauge);
+    web_on(config_server, "/toggle-test-mode", HTTP_POST, handle_toggle_test_mode);
+    web_on(config_server, "/set-screen", HTTP_ANY, handle_set_screen);
+    web_on(config_server, "/nvs_test", HTTP_GET, handle_nvs_test);
+    web_on(config_server, "/api/perf", HTTP_GET, handle_perf, 0);
+    web_on(config_server, "/api/stats", HTTP_GET, handle_stats_api, 0);
+    // The statistics have their own mutex; the SD write needs no UI lock
+    web_on(config_server, "/stats/reset", HTTP_POST, handle_stats_reset, 0);
+    // Firmware update into the other app slot
+    ota_update_register(config_server);
+    // Whole configuration as one file (backup / clone)
+    config_bundle_register(config_server);
+    // Serve from the web task from here on
+    web_task_start(config_server);
     Serial.println("[WebServer] Configuration web UI started on port 80");
 }
 
@@ -2085,7 +2109,21 @@ std::vector<String> get_all_signalk_paths() {
         }
     }
     
-    return all_paths;
+    // Statistics paths ("<path>:max1h") subscribe to the path they summarise;
+    // formula outputs are computed here, so subscribe to their inputs instead
+    std::vector<String> base_paths;
+    std::set<String> unique_bases;
+    for (const String& path : all_paths) {
+        String base = signalk_base_path(path);
+        if (derived_values_is_output(base.c_str())) continue;
+        if (unique_bases.insert(base).second) base_paths.push_back(base);
+    }
+    char input[EXPR_PATH_LEN];
+    for (int i = 0; derived_values_input_path(i, input, sizeof(input)); i++) {
+        String path = String(input);
+        if (unique_bases.insert(path).second) base_paths.push_back(path);
+    }
+    return base_paths;
 }
 
 void handle_test_gauge() {
@@ -2155,6 +2193,263 @@ void handle_nvs_test() {
     config_server.send(200, "text/plain", resp);
 }
 
+// Signal filter WebUI: one row per smoothed Signal K path
+void handle_filters_page() {
+    if (config_server.method() != HTTP_GET) {
+        config_server.send(405, "text/plain", "Method Not Allowed");
+        return;
+    }
+    SignalFilterConfig cfg[SIGNAL_FILTER_MAX_PATHS];
+    int n = signal_filter_get_config(cfg, SIGNAL_FILTER_MAX_PATHS);
+
+    String html = "<html><head>";
+    html += STYLE;
+    html += "<title>Signal Filters</title></head><body><div class='container'>";
+    html += "<div class='tab-content'>";
+    html += "<h2>Signal Filters</h2>";
+    html += "<p>Smoothing applied to incoming Signal K values before gauges, numbers and alarms (graphs keep the raw values). ";
+    html += "Stages run in order median &rarr; rate limit &rarr; EMA &rarr; Kalman; leave a field at 0 to skip it. Values are in Signal K units (m/s, K, ratio, Pa...). ";
+    html += "Set Angle for headings and wind angles (radians) so values either side of north or dead ahead are smoothed the short way round.</p>";
+    html += "<form method='POST' action='/save-filters'><table>";
+    html += "<tr><th>Signal K path</th><th>Median</th><th>Rate limit (/s)</th><th>EMA &tau; (s)</th><th>Kalman Q</th><th>Kalman R</th><th>Angle</th></tr>";
+    for (int i = 0; i < SIGNAL_FILTER_MAX_PATHS; ++i) {
+        SignalFilterConfig c;
+        memset(&c, 0, sizeof(c));
+        if (i < n) c = cfg[i];
+        String idx = String(i);
+        html += "<tr><td><input name='fp_" + idx + "' type='text' style='width:260px' value='" + String(c.path) + "'></td>";
+        html += "<td><select name='fm_" + idx + "'>";
+        static const uint8_t median_opts[] = {0, 3, 5, 7, 9};
+        for (uint8_t m : median_opts) {
+            html += "<option value='" + String(m) + "'" + String(c.median_len == m ? " selected" : "") + ">" + (m ? String(m) : String("off")) + "</option>";
+        }
+        html += "</select></td>";
+        html += "<td><input name='fr_" + idx + "' type='number' step='any' min='0' style='width:80px' value='" + String(c.rate_limit, 3) + "'></td>";
+        html += "<td><input name='fe_" + idx + "' type='number' step='any' min='0' style='width:80px' value='" + String(c.ema_tau_s, 2) + "'></td>";
+        html += "<td><input name='fq_" + idx + "' type='number' step='any' min='0' style='width:80px' value='" + String(c.kalman_q, 4) + "'></td>";
+        html += "<td><input name='fk_" + idx + "' type='number' step='any' min='0' style='width:80px' value='" + String(c.kalman_r, 4) + "'></td>";
+        html += "<td><select name='fa_" + idx + "'>";
+        static const char *const wrap_opts[] = {"no", "0..2&pi;", "&plusmn;&pi;"};
+        for (int w = 0; w < 3; ++w) {
+            html += "<option value='" + String(w) + "'" + String(c.circular == w ? " selected" : "") + ">" + wrap_opts[w] + "</option>";
+        }
+        html += "</select></td></tr>";
+    }
+    html += "</table>";
+    html += "<div style='text-align:center;margin-top:12px;'><button class='tab-btn' type='submit' style='padding:10px 18px;'>Save</button></div>";
+    html += "</form>";
+
+    html += "<h2>Statistics</h2>";
+    html += "<p>Any path field can show a rolling statistic by adding a suffix to the Signal K path, e.g. <code>propulsion.main.temperature:max1h</code>. ";
+    html += "Statistics: min, max, mean, std, p5, p50, p95. Window: none (since boot), <code>1h</code> (last hour) or <code>reset</code> (since the last reset). ";
+    html += "Hourly and since-reset values are kept on the SD card across reboots.</p>";
+    char tracked[STATS_MAX_PATHS][STATS_PATH_LEN];
+    int nt = stats_engine_tracked(tracked, STATS_MAX_PATHS);
+    if (nt == 0) {
+        html += "<p><i>No statistics paths in use.</i></p>";
+    } else {
+        html += "<table><tr><th>Signal K path</th><th>Samples since reset</th><th>Min</th><th>Max</th><th>Mean</th><th></th></tr>";
+        for (int i = 0; i < nt; ++i) {
+            StatsSummary sum;
+            stats_engine_summary(tracked[i], STATS_WIN_RESET, &sum);
+            html += "<tr><td>" + String(tracked[i]) + "</td><td>" + String(sum.n) + "</td>";
+            html += "<td>" + String(sum.v[STATS_MIN], 2) + "</td><td>" + String(sum.v[STATS_MAX], 2) + "</td><td>" + String(sum.v[STATS_MEAN], 2) + "</td>";
+            html += "<td><form method='POST' action='/stats/reset' style='margin:0'><input type='hidden' name='path' value='" + String(tracked[i]) + "'>";
+            html += "<button class='tab-btn' type='submit'>Reset</button></form></td></tr>";
+        }
+        html += "</table>";
+        html += "<form method='POST' action='/stats/reset' style='text-align:center;margin-top:8px;'><button class='tab-btn' type='submit'>Reset all</button></form>";
+    }
+    html += "<p style='text-align:center; margin-top:10px;'><a href='/'>Back</a></p>";
+    html += "</div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_save_filters() {
+    if (config_server.method() != HTTP_POST) {
+        config_server.send(405, "text/plain", "Method Not Allowed");
+        return;
+    }
+    SignalFilterConfig cfg[SIGNAL_FILTER_MAX_PATHS];
+    int n = 0;
+    for (int i = 0; i < SIGNAL_FILTER_MAX_PATHS; ++i) {
+        String idx = String(i);
+        String path = config_server.arg("fp_" + idx);
+        path.trim();
+        if (path.length() == 0) continue;
+        SignalFilterConfig &c = cfg[n++];
+        memset(&c, 0, sizeof(c));
+        strncpy(c.path, path.c_str(), SIGNAL_FILTER_PATH_LEN - 1);
+        c.median_len = (uint8_t)constrain(config_server.arg("fm_" + idx).toInt(), 0L, (long)SIGNAL_FILTER_MEDIAN_MAX);
+        c.rate_limit = config_server.arg("fr_" + idx).toFloat();
+        c.ema_tau_s = config_server.arg("fe_" + idx).toFloat();
+        c.kalman_q = config_server.arg("fq_" + idx).toFloat();
+        c.kalman_r = config_server.arg("fk_" + idx).toFloat();
+        c.circular = (uint8_t)constrain(config_server.arg("fa_" + idx).toInt(), 0L, (long)SIGNAL_FILTER_CIRCULAR_PI);
+    }
+    signal_filter_set_config(cfg, n);
+    config_server.sendHeader("Location", "/filters", true);
+    config_server.send(302, "text/plain", "");
+}
+
+// Derived values WebUI: one row per formula, with its compile result
+void handle_derived_page() {
+    if (config_server.method() != HTTP_GET) {
+        config_server.send(405, "text/plain", "Method Not Allowed");
+        return;
+    }
+    DerivedConfig cfg[DERIVED_MAX];
+    int n = derived_values_get_config(cfg, DERIVED_MAX);
+
+    String html = "<html><head>";
+    html += STYLE;
+    html += "<title>Derived Values</title></head><body><div class='container'>";
+    html += "<div class='tab-content'>";
+    html += "<h2>Derived Values</h2>";
+    html += "<p>Each row publishes a formula over Signal K paths under its own path, which any gauge, number display, alarm or statistic can use. ";
+    html += "Operators <code>+ - * / ^</code> and parentheses; functions <code>abs sqrt sin cos tan asin acos atan exp ln log10 deg rad</code> and <code>atan2 hypot min max pow</code> (two arguments); constant <code>pi</code>. ";
+    html += "Values are in Signal K units (m/s, rad, K, ratio, m3/s...). Example, true wind speed: ";
+    html += "<code>hypot(environment.wind.speedApparent*cos(environment.wind.angleApparent) - navigation.speedThroughWater, environment.wind.speedApparent*sin(environment.wind.angleApparent))</code></p>";
+    html += "<form method='POST' action='/save-derived'><table>";
+    html += "<tr><th>Output path</th><th>Formula</th><th>Status</th></tr>";
+    for (int i = 0; i < DERIVED_MAX; ++i) {
+        DerivedConfig c;
+        memset(&c, 0, sizeof(c));
+        if (i < n) c = cfg[i];
+        DerivedStatus st;
+        derived_values_get_status(i < n ? i : -1, &st);
+        String idx = String(i);
+        html += "<tr><td><input name='dn_" + idx + "' type='text' style='width:180px' placeholder='derived.name' value='" + String(c.name) + "'></td>";
+        html += "<td><input name='df_" + idx + "' type='text' style='width:420px' maxlength='" + String(DERIVED_FORMULA_LEN - 1) + "' value='" + String(c.formula) + "'></td><td>";
+        if (i >= n) {
+            // empty row for a new formula
+        } else if (!st.compiled) {
+            html += "<span style='color:#c00'>" + String(st.error) + "</span>";
+        } else if (st.evals == 0) {
+            html += "waiting for data (" + String(st.code_len) + " B)";
+        } else {
+            html += String(st.value, 3) + " (" + String(st.code_len) + " B)";
+        }
+        html += "</td></tr>";
+    }
+    html += "</table>";
+    html += "<div style='text-align:center;margin-top:12px;'><button class='tab-btn' type='submit' style='padding:10px 18px;'>Save</button></div>";
+    html += "</form>";
+    html += "<p style='text-align:center; margin-top:10px;'><a href='/'>Back</a></p>";
+    html += "</div></div></body></html>";
+    config_server.send(200, "text/html", html);
+}
+
+void handle_save_derived() {
+    if (config_server.method() != HTTP_POST) {
+        config_server.send(405, "text/plain", "Method Not Allowed");
+        return;
+    }
+    DerivedConfig cfg[DERIVED_MAX];
+    int n = 0;
+    for (int i = 0; i < DERIVED_MAX; ++i) {
+        String idx = String(i);
+        String name = config_server.arg("dn_" + idx);
+        String formula = config_server.arg("df_" + idx);
+        name.trim();
+        formula.trim();
+        if (name.length() == 0) continue;
+        DerivedConfig &c = cfg[n++];
+        memset(&c, 0, sizeof(c));
+        strncpy(c.name, name.c_str(), DERIVED_NAME_LEN - 1);
+        strncpy(c.formula, formula.c_str(), DERIVED_FORMULA_LEN - 1);
+    }
+    derived_values_set_config(cfg, n);
+    // Input paths may have changed
+    refresh_signalk_subscriptions();
+    config_server.sendHeader("Location", "/derived", true);
+    config_server.send(302, "text/plain", "");
+}
+
+// Rolling statistics for every tracked path as JSON, one object per window
+void handle_stats_api() {
+    static const char *const win_names[STATS_WIN_COUNT] = {"session", "1h", "reset"};
+    static const char *const kind_keys[STATS_KIND_COUNT] = {"min", "max", "mean", "std", "p5", "p50", "p95"};
+    char tracked[STATS_MAX_PATHS][STATS_PATH_LEN];
+    int nt = stats_engine_tracked(tracked, STATS_MAX_PATHS);
+
+    String json = "[";
+    for (int i = 0; i < nt; ++i) {
+        if (i) json += ",";
+        json += "{\"path\":\"" + String(tracked[i]) + "\"";
+        for (int w = 0; w < STATS_WIN_COUNT; ++w) {
+            StatsSummary sum;
+            stats_engine_summary(tracked[i], (StatsWindow)w, &sum);
+            json += ",\"" + String(win_names[w]) + "\":{\"n\":" + String(sum.n);
+            for (int k = 0; k < STATS_KIND_COUNT && sum.n > 0; ++k) {
+                json += ",\"" + String(kind_keys[k]) + "\":" + String(sum.v[k], 4);
+            }
+            json += "}";
+        }
+        json += "}";
+    }
+    json += "]";
+    config_server.send(200, "application/json", json);
+}
+
+// Restart the since-reset window of one path ("path" argument) or all paths
+void handle_stats_reset() {
+    String path = config_server.arg("path");
+    path.trim();
+    stats_engine_reset(path.length() ? path.c_str() : NULL);
+    config_server.sendHeader("Location", "/filters", true);
+    config_server.send(302, "text/plain", "");
+}
+
+// Runtime performance counters as JSON: frame rate, LVGL flushes, I2C bus
+// and per-widget redraw counts (screen is 0-based, slot is a WidgetSlot)
+void handle_perf() {
+    FrameGovStats gov;
+    frame_governor_get_stats(&gov);
+    static const char *const gov_modes[] = {"active", "idle", "deep_idle"};
+
+    String json = "{";
+    json += "\"uptime_ms\":" + String(millis());
+    json += ",\"heap_free\":" + String(ESP.getFreeHeap());
+    json += ",\"heap_min\":" + String(ESP.getMinFreeHeap());
+    json += ",\"psram_free\":" + String(ESP.getFreePsram());
+    json += ",\"governor\":{\"mode\":\"" + String(gov_modes[frame_governor_mode()]) + "\"";
+    json += ",\"loops_per_sec\":" + String(gov.loops_per_sec, 1);
+    json += ",\"fps\":" + String(gov.frames_per_sec, 1);
+    json += ",\"render_ms_max\":" + String(gov.render_ms_max);
+    json += ",\"active_pct\":" + String(gov.active_pct) + "}";
+    json += ",\"flush\":{\"count\":" + String(get_flush_count()) + ",\"max_us\":" + String(get_flush_max_us()) + "}";
+    json += ",";
+    web_task_metrics_json(json);
+
+    I2C_Device_Stats i2c[I2C_MAX_DEVICES];
+    uint8_t n = I2C_Get_Stats(i2c, I2C_MAX_DEVICES);
+    json += ",\"i2c\":[";
+    for (uint8_t i = 0; i < n; i++) {
+        if (i) json += ",";
+        json += "{\"addr\":" + String(i2c[i].addr) + ",\"count\":" + String(i2c[i].count) +
+                ",\"errors\":" + String(i2c[i].errors) + ",\"bus_us_avg\":" + String(i2c[i].bus_us_avg) +
+                ",\"bus_us_max\":" + String(i2c[i].bus_us_max) + ",\"wait_us_max\":" + String(i2c[i].wait_us_max) + "}";
+    }
+    json += "]";
+
+    json += ",\"widgets\":[";
+    bool first = true;
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        for (int w = 0; w < WIDGET_SLOT_COUNT; ++w) {
+            RedrawCounts c;
+            redraw_filter_get_counts(s, w, &c);
+            if (!c.redraws && !c.suppressed) continue;
+            if (!first) json += ",";
+            first = false;
+            json += "{\"screen\":" + String(s) + ",\"slot\":" + String(w) +
+                    ",\"redraws\":" + String(c.redraws) + ",\"suppressed\":" + String(c.suppressed) + "}";
+        }
+    }
+    json += "]}";
+    config_server.send(200, "application/json", json);
+}
+
 // Assets manager: list files and show upload form
 void handle_assets_page() {
     // Ensure assets dir exists (try SD_MMC, fall back to POSIX /sdcard)
@@ -2177,105 +2472,229 @@ void handle_assets_page() {
     // Upload form (styled)
     html += "<div class='assets-uploader'><form method='POST' action='/assets/upload' enctype='multipart/form-data' style='display:flex;gap:8px;align-items:center;'>";
     html += "<input type='file' name='file' accept='image/png,image/jpeg,image/bmp,image/gif'>";
+    html += "<select name='convert' title='PNG and JPEG uploads are converted to .bin on the display'>";
+    html += "<option value='auto'>Convert: auto</option><option value='icon'>Convert: icon</option>";
+    html += "<option value='background'>Convert: background</option><option value='keep'>Keep as uploaded</option></select>";
     html += "<input type='submit' value='Upload' class='tab-btn'>";
     html += "</form></div>";
 
     html += "<h3>Files in /assets</h3>";
-    html += "<table class='file-table'><tr><th>Name</th><th>Size</th><th>Actions</th></tr>";
-    File root = SD_MMC.open("/assets");
-    if (root && root.isDirectory()) {
-        File file = root.openNextFile();
-        while (file) {
-            String fname = file.name();
-            // show basename
-            String bname = fname;
-            if (bname.startsWith("/assets/")) bname = bname.substring(8);
-            html += "<tr><td>" + bname + "</td><td class='file-size'>" + String(file.size()) + "</td>";
-            html += "<td class='file-actions'><form method='POST' action='/assets/delete'><input type='hidden' name='file' value='" + bname + "'>";
-            html += "<input type='submit' value='Delete' class='tab-btn' onclick='return confirm(\"Delete " + bname + "?\")'></form>";
-            html += " <a href='S:/" + fname + "' target='_blank' class='tab-btn' style='padding:6px 10px;text-decoration:none;'>Download</a></td></tr>";
-            file = root.openNextFile();
-        }
-    } else {
-        // POSIX fallback: list files under /sdcard/assets
-        DIR *d = opendir("/sdcard/assets");
-        if (d) {
-            struct dirent *entry;
-            while ((entry = readdir(d)) != NULL) {
-                const char *fname = entry->d_name;
-                if (!fname) continue;
-                if (fname[0] == '.') continue; // skip . and .. and hidden
-                String bname = String(fname);
-                // get file size via stat
-                char fullpath[256];
-                snprintf(fullpath, sizeof(fullpath), "/sdcard/assets/%s", fname);
-                struct stat st;
-                long fsz = 0;
-                if (stat(fullpath, &st) == 0) fsz = (long)st.st_size;
-                html += "<tr><td>" + bname + "</td><td class='file-size'>" + String(fsz) + "</td>";
-                html += "<td class='file-actions'><form method='POST' action='/assets/delete'><input type='hidden' name='file' value='" + bname + "'>";
-                html += "<input type='submit' value='Delete' class='tab-btn' onclick='return confirm(\"Delete " + bname + "?\")'></form>";
-                html += " <a href='S:/assets/" + bname + "' target='_blank' class='tab-btn' style='padding:6px 10px;text-decoration:none;'>Download</a></td></tr>";
-            }
-            closedir(d);
-        }
+    html += "<form method='POST' action='/assets/rescan' style='margin-bottom:8px;'><input type='submit' value='Rescan card' class='tab-btn'></form>";
+    int dropped = asset_index_dropped();
+    if (dropped) {
+        html += "<p style='color:#c00'>Index full: " + String(dropped) + " file(s) on the card are not listed. ";
+        html += "Delete unused files and rescan.</p>";
+    }
+    html += "<table class='file-table'><tr><th>Name</th><th>Type</th><th>Size</th><th>Dimensions</th><th>CRC32</th><th>Actions</th></tr>";
+    int na = 0;
+    AssetEntry *assets = asset_index_snapshot(&na);
+    for (int i = 0; i < na; ++i) {
+        const AssetEntry &e = assets[i];
+        String bname = e.name;
+        char crc[12];
+        snprintf(crc, sizeof(crc), "%08lx", (unsigned long)e.crc32);
+        html += "<tr><td>" + bname + "</td><td>" + String(asset_type_name((AssetType)e.type)) + "</td>";
+        html += "<td class='file-size'>" + String(e.size) + "</td>";
+        html += "<td>" + (e.width ? String(e.width) + " x " + String(e.height) : String("-")) + "</td><td>" + String(crc) + "</td>";
+        html += "<td class='file-actions'><form method='POST' action='/assets/delete'><input type='hidden' name='file' value='" + bname + "'>";
+        html += "<input type='submit' value='Delete' class='tab-btn' onclick='return confirm(\"Delete " + bname + "?\")'></form>";
+        html += " <a href='S:/assets/" + bname + "' target='_blank' class='tab-btn' style='padding:6px 10px;text-decoration:none;'>Download</a></td></tr>";
     }
+    free(assets);
     html += "</table>";
     html += "<p style='text-align:center; margin-top:12px;'><a href='/'>Back</a></p>";
     html += "</div></div></body></html>";
     config_server.send(200, "text/html", html);
 }
 
-// Upload handler: called during multipart upload
-static File assets_upload_file;
-// POSIX FILE* fallback when `SD_MMC.open` cannot open the desired path
+// Upload handler: called during multipart upload. The body arrives in
+// ~1.4 KB pieces; they are gathered into a 32 KB block and written in whole
+// sectors, which FATFS hands to the card as one multi-block write instead of
+// a read-modify-write per piece. The data goes to a hidden .part file that
+// replaces /assets/<name> only once complete (asset_replace_file), so an
+// interrupted upload or reset never leaves a truncated or missing asset.
+#define ASSETS_UPLOAD_BLOCK (32 * 1024)
 static FILE *assets_upload_fp = NULL;
+static uint8_t *assets_upload_buf = NULL;
+static size_t assets_upload_fill = 0;
+// Name, running checksum and outcome of the current upload
+static String assets_upload_name;
+static String assets_upload_error;
+static uint32_t assets_upload_crc = 0;
+static uint32_t assets_upload_bytes = 0;
+static uint32_t assets_upload_t0 = 0;
+static uint32_t assets_upload_ms = 0;
+
+static String assets_part_path(const String &name) {
+    return String(ASSET_DIR) + "/." + name + ".part";
+}
+
+static uint32_t assets_upload_kbps() {
+    return (uint32_t)((uint64_t)assets_upload_bytes * 1000 / (assets_upload_ms ? assets_upload_ms : 1) / 1024);
+}
+
+static void assets_upload_flush() {
+    if (!assets_upload_fp || !assets_upload_fill) return;
+    if (fwrite(assets_upload_buf, 1, assets_upload_fill, assets_upload_fp) != assets_upload_fill &&
+        !assets_upload_error.length()) {
+        assets_upload_error = "Write failed (card full?)";
+    }
+    assets_upload_fill = 0;
+}
+
+// Read the .part file back and compare it with what was received
+static bool assets_upload_verify(const String &part) {
+    FILE *f = fopen(part.c_str(), "rb");
+    if (!f) return false;
+    uint32_t crc = 0, total = 0;
+    size_t n;
+    while ((n = fread(assets_upload_buf, 1, ASSETS_UPLOAD_BLOCK, f)) > 0) {
+        crc = esp_rom_crc32_le(crc, assets_upload_buf, n);
+        total += n;
+    }
+    fclose(f);
+    return crc == assets_upload_crc && total == assets_upload_bytes;
+}
+
+// Drop an unfinished .part file and the block buffer
+static void assets_upload_close(bool remove_part) {
+    if (assets_upload_fp) {
+        fclose(assets_upload_fp);
+        assets_upload_fp = NULL;
+        if (remove_part) remove(assets_part_path(assets_upload_name).c_str());
+    }
+    if (assets_upload_buf) {
+        heap_caps_free(assets_upload_buf);
+        assets_upload_buf = NULL;
+    }
+    assets_upload_fill = 0;
+}
+
 void handle_assets_upload() {
-    HTTPUpload& upload = config_server.upload();
+    HttpUpload &upload = config_server.upload();
     if (upload.status == UPLOAD_FILE_START) {
+        assets_upload_close(true);      // left over from an aborted upload
         String filename = upload.filename;
         // sanitize filename: remove paths
         int slash = filename.lastIndexOf('/');
         if (slash >= 0) filename = filename.substring(slash + 1);
-        String path = String("/assets/") + filename;
-        Serial.printf("[ASSETS] Upload start: %s -> %s\n", upload.filename.c_str(), path.c_str());
-        // open file for write (overwrite)
-        assets_upload_file = SD_MMC.open(path, FILE_WRITE);
-        if (!assets_upload_file) {
-            Serial.printf("[ASSETS] SD_MMC open failed for %s, trying POSIX fallback\n", path.c_str());
-            // Try POSIX fopen on /sdcard prefix (SDSPI mount uses /sdcard)
-            String alt = String("/sdcard") + path;
-            assets_upload_fp = fopen(alt.c_str(), "wb");
-            if (!assets_upload_fp) {
-                Serial.printf("[ASSETS] POSIX fopen fallback failed for %s\n", alt.c_str());
-            } else {
-                Serial.printf("[ASSETS] POSIX fopen fallback opened %s\n", alt.c_str());
-            }
+        slash = filename.lastIndexOf('\\');
+        if (slash >= 0) filename = filename.substring(slash + 1);
+        assets_upload_name = filename;
+        assets_upload_error = "";
+        assets_upload_crc = 0;
+        assets_upload_bytes = 0;
+        assets_upload_ms = 0;
+        assets_upload_t0 = millis();
+        // Hidden names are reserved for temporary files
+        if (filename.length() == 0 || filename[0] == '.' || filename.length() >= ASSET_NAME_LEN) {
+            assets_upload_error = "Invalid file name";
+            return;
+        }
+        mkdir(ASSET_DIR, 0755);
+        // sdmmc can only DMA from internal RAM; a PSRAM block still gets the
+        // multi-sector writes but is copied through a bounce buffer
+        assets_upload_buf = (uint8_t *)heap_caps_malloc(ASSETS_UPLOAD_BLOCK, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!assets_upload_buf) assets_upload_buf = (uint8_t *)heap_caps_malloc(ASSETS_UPLOAD_BLOCK, MALLOC_CAP_SPIRAM);
+        String part = assets_part_path(filename);
+        assets_upload_fp = assets_upload_buf ? fopen(part.c_str(), "wb") : NULL;
+        if (!assets_upload_fp) {
+            assets_upload_error = assets_upload_buf ? "Cannot create file on the SD card" : "Out of memory";
+            assets_upload_close(true);
+            Serial.printf("[ASSETS] Upload %s: %s\n", filename.c_str(), assets_upload_error.c_str());
+            return;
         }
+        // Our blocks are already sector multiples; skip stdio's own buffer
+        setvbuf(assets_upload_fp, NULL, _IONBF, 0);
+        Serial.printf("[ASSETS] Upload start: %s -> %s\n", upload.filename.c_str(), part.c_str());
     } else if (upload.status == UPLOAD_FILE_WRITE) {
-        if (assets_upload_file) {
-            assets_upload_file.write(upload.buf, upload.currentSize);
-        } else if (assets_upload_fp) {
-            fwrite(upload.buf, 1, upload.currentSize, assets_upload_fp);
+        if (!assets_upload_fp) return;
+        assets_upload_crc = esp_rom_crc32_le(assets_upload_crc, upload.buf, upload.currentSize);
+        assets_upload_bytes += upload.currentSize;
+        const uint8_t *p = upload.buf;
+        size_t left = upload.currentSize;
+        while (left) {
+            size_t n = ASSETS_UPLOAD_BLOCK - assets_upload_fill;
+            if (n > left) n = left;
+            memcpy(assets_upload_buf + assets_upload_fill, p, n);
+            assets_upload_fill += n;
+            p += n;
+            left -= n;
+            if (assets_upload_fill == ASSETS_UPLOAD_BLOCK) assets_upload_flush();
         }
     } else if (upload.status == UPLOAD_FILE_END) {
-        if (assets_upload_file) {
-            assets_upload_file.close();
-            Serial.printf("[ASSETS] Upload finished (SD_MMC): %s (%u bytes)\n", upload.filename.c_str(), (unsigned)upload.totalSize);
-        } else if (assets_upload_fp) {
-            fclose(assets_upload_fp);
-            assets_upload_fp = NULL;
-            Serial.printf("[ASSETS] Upload finished (POSIX fallback): %s (%u bytes)\n", upload.filename.c_str(), (unsigned)upload.totalSize);
+        if (!assets_upload_fp) return;
+        assets_upload_flush();
+        bool closed = fclose(assets_upload_fp) == 0;
+        assets_upload_fp = NULL;
+        assets_upload_ms = millis() - assets_upload_t0;
+        if (!closed && !assets_upload_error.length()) assets_upload_error = "Write failed (card full?)";
+        String part = assets_part_path(assets_upload_name);
+        String dest = String(ASSET_DIR) + "/" + assets_upload_name;
+        if (!assets_upload_error.length() && !assets_upload_verify(part)) assets_upload_error = "Checksum mismatch reading back";
+        assets_upload_close(false);
+        if (!assets_upload_error.length() && !asset_replace_file(part.c_str(), dest.c_str())) {
+            assets_upload_error = "Rename failed";
         }
+        if (assets_upload_error.length()) {
+            remove(part.c_str());
+            Serial.printf("[ASSETS] Upload %s failed: %s\n", assets_upload_name.c_str(), assets_upload_error.c_str());
+            return;
+        }
+        Serial.printf("[ASSETS] Upload finished: %s (%lu bytes in %lu ms, %lu KB/s)\n", assets_upload_name.c_str(),
+                      (unsigned long)assets_upload_bytes, (unsigned long)assets_upload_ms,
+                      (unsigned long)assets_upload_kbps());
+        asset_index_put(assets_upload_name.c_str(), assets_upload_bytes, assets_upload_crc);
+    } else if (upload.status == UPLOAD_FILE_ABORTED) {
+        assets_upload_close(true);
+        assets_upload_error = "Upload aborted";
+        Serial.printf("[ASSETS] Upload %s aborted\n", assets_upload_name.c_str());
     }
 }
 
-// Final POST handler after upload completes (redirect back)
+// Final POST handler after upload completes. Form fields are only parsed
+// once the whole body is in, so the conversion is queued here rather than
+// from the upload callback; the page then polls the job until it finishes.
 void handle_assets_upload_post() {
+    if (assets_upload_error.length()) {
+        String html = "<!DOCTYPE html><html><head>";
+        html += STYLE;
+        html += "<title>Upload Failed</title></head><body><div class='container'>";
+        html += "<h3>Upload failed</h3><p>" + assets_upload_name + ": " + assets_upload_error + "</p>";
+        html += "<p><a href='/assets'>Back to Assets</a></p>";
+        html += "</div></body></html>";
+        config_server.send(500, "text/html", html);
+        return;
+    }
+    String convert = config_server.arg("convert");
+    bool wants_convert = convert.length() && convert != "keep" && asset_transcode_supported(assets_upload_name.c_str());
+    uint32_t job = 0;
+    if (wants_convert) {
+        AssetSlot slot = convert == "icon" ? ASSET_SLOT_ICON
+                       : convert == "background" ? ASSET_SLOT_BACKGROUND : ASSET_SLOT_AUTO;
+        job = asset_transcode_queue(assets_upload_name.c_str(), slot);
+    }
     String html = "<!DOCTYPE html><html><head>";
     html += STYLE;
     html += "<title>Upload Complete</title></head><body><div class='container'>";
     html += "<h3>Upload complete</h3>";
+    char crc[12];
+    snprintf(crc, sizeof(crc), "%08lx", (unsigned long)assets_upload_crc);
+    html += "<p>" + assets_upload_name + ": " + String(assets_upload_bytes / 1024.0f, 1) + " KB in " +
+            String(assets_upload_ms) + " ms (" + String(assets_upload_kbps()) + " KB/s), CRC32 " + String(crc) +
+            " verified on the card</p>";
+    if (job) {
+        html += "<p>Converting " + assets_upload_name + ": <progress id='bar' max='100' value='0'></progress> <span id='msg'>queued</span></p>";
+        html += "<script>function poll(){fetch('/api/assets/jobs').then(r=>r.json()).then(js=>{";
+        html += "var j=js.find(x=>x.id==" + String(job) + ");if(!j)return;";
+        html += "document.getElementById('bar').value=j.progress;";
+        html += "if(j.state=='done'){document.getElementById('msg').textContent='saved as '+j.output+' ('+j.width+' x '+j.height+', '+j.ms+' ms)';return;}";
+        html += "if(j.state=='failed'){document.getElementById('msg').textContent='failed: '+j.error;return;}";
+        html += "document.getElementById('msg').textContent=j.state+' '+j.progress+'%';setTimeout(poll,500);";
+        html += "}).catch(()=>setTimeout(poll,1000));}poll();</script>";
+    } else if (wants_convert) {
+        html += "<p>The converter is busy; " + assets_upload_name + " was stored as uploaded.</p>";
+    }
     html += "<p><a href='/assets'>Back to Assets</a></p>";
     html += "</div></body></html>";
     config_server.send(200, "text/html", html);
@@ -2294,7 +2713,63 @@ void handle_assets_delete() {
         bool ok = SD_MMC.remove(path);
         Serial.printf("[ASSETS] Delete %s -> %d\n", path.c_str(), ok);
     }
+    asset_index_remove(fname.c_str());
     // redirect back
     config_server.sendHeader("Location", "/assets");
     config_server.send(303, "text/plain", "");
 }
+
+// Re-read /assets after files were copied onto the card from a computer
+void handle_assets_rescan() {
+    asset_index_rescan();
+    config_server.sendHeader("Location", "/assets");
+    config_server.send(303, "text/plain", "");
+}
+
+// The asset index as JSON
+void handle_assets_api() {
+    int na = 0;
+    AssetEntry *assets = asset_index_snapshot(&na);
+    String json;
+    json.reserve(64 + na * 112);
+    json += "[";
+    for (int i = 0; i < na; ++i) {
+        const AssetEntry &e = assets[i];
+        char crc[12];
+        snprintf(crc, sizeof(crc), "%08lx", (unsigned long)e.crc32);
+        if (i) json += ",";
+        json += "{\"name\":";
+        web_json_str(json, e.name);
+        json += ",\"type\":\"" + String(asset_type_name((AssetType)e.type)) + "\"";
+        json += ",\"size\":" + String(e.size);
+        json += ",\"width\":" + String(e.width) + ",\"height\":" + String(e.height);
+        json += ",\"crc32\":\"" + String(crc) + "\"}";
+    }
+    free(assets);
+    json += "]";
+    config_server.send(200, "application/json", json);
+}
+
+// Recent conversions, newest first, for the upload page to poll
+void handle_assets_jobs() {
+    AssetJob jobs[ASSET_JOBS];
+    int n = asset_transcode_jobs(jobs, ASSET_JOBS);
+    String json = "[";
+    for (int i = 0; i < n; ++i) {
+        const AssetJob &j = jobs[i];
+        if (i) json += ",";
+        json += "{\"id\":" + String(j.id) + ",\"source\":";
+        web_json_str(json, j.source);
+        json += ",\"output\":";
+        web_json_str(json, j.output);
+        json += ",\"slot\":\"" + String(asset_slot_name((AssetSlot)j.slot)) + "\"";
+        json += ",\"state\":\"" + String(asset_job_state_name((AssetJobState)j.state)) + "\"";
+        json += ",\"progress\":" + String(j.progress);
+        json += ",\"width\":" + String(j.width) + ",\"height\":" + String(j.height);
+        json += ",\"ms\":" + String(j.elapsed_ms) + ",\"error\":";
+        web_json_str(json, j.error);
+        json += "}";
+    }
+    json += "]";
+    config_server.send(200, "application/json", json);
+}
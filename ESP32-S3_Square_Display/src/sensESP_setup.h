@@ -3,7 +3,7 @@
 #define SENSEXP_SETUP_H
 
 #include <Arduino.h>
-#include <WebServer.h>
+#include "http_server.h"
 #include <vector>
 #include "signalk_config.h"  // For NUM_SCREENS, TOTAL_PARAMS
 
@@ -11,7 +11,7 @@
 extern GaugeCalibrationPoint gauge_cal[NUM_SCREENS][2][5];
 
 // Global web server instance
-extern WebServer config_server;
+extern HttpServer config_server;
 
 // Auto-scroll interval in seconds (0 = off)
 extern uint16_t auto_scroll_sec;
@@ -41,6 +41,9 @@ std::vector<String> get_all_signalk_paths();
 // Load persisted preferences and screen configs (from NVS or SD fallback)
 void load_preferences();
 
+// Persist one screen's config blob, gauge paths and cubic mask (not the whole set)
+bool save_screen_config(int s);
+
 // Dump loaded `screen_configs` to the log for debugging
 void dump_screen_configs();
 
@@ -0,0 +1,240 @@
+#include "signal_filter.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <math.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+extern Preferences preferences;
+
+#define SIGNAL_FILTER_PREF_KEY "sig_filters"
+#define SIGNAL_FILTER_MAX_DT 10.0f          // seconds; longer gaps restart smoothing
+// Entries saved before the circular option existed
+#define SIGNAL_FILTER_V1_SIZE offsetof(SignalFilterConfig, circular)
+#define TWO_PI_F 6.28318531f
+
+typedef struct {
+    float median_buf[SIGNAL_FILTER_MEDIAN_MAX];
+    uint8_t median_count;
+    uint8_t median_pos;
+    float rate_out;
+    float ema_out;
+    float kalman_x;
+    float kalman_p;
+    float raw;
+    float out;                          // last output, unwrapped (circular paths)
+    uint32_t last_ms;
+    bool primed;
+} SignalFilterState;
+
+static SignalFilterConfig filter_cfg[SIGNAL_FILTER_MAX_PATHS];
+static SignalFilterState filter_state[SIGNAL_FILTER_MAX_PATHS];
+static int filter_count = 0;
+static SemaphoreHandle_t filter_mutex = NULL;
+
+static int filter_find(const char *path) {
+    for (int i = 0; i < filter_count; i++) {
+        if (strcmp(filter_cfg[i].path, path) == 0) return i;
+    }
+    return -1;
+}
+
+static float filter_median(SignalFilterState *st, uint8_t len, float x) {
+    st->median_buf[st->median_pos] = x;
+    st->median_pos = (uint8_t)((st->median_pos + 1) % len);
+    if (st->median_count < len) st->median_count++;
+
+    // Insertion sort of at most SIGNAL_FILTER_MEDIAN_MAX values
+    float sorted[SIGNAL_FILTER_MEDIAN_MAX];
+    uint8_t n = st->median_count;
+    for (uint8_t i = 0; i < n; i++) {
+        float v = st->median_buf[i];
+        int j = i - 1;
+        while (j >= 0 && sorted[j] > v) { sorted[j + 1] = sorted[j]; j--; }
+        sorted[j + 1] = v;
+    }
+    return sorted[n / 2];
+}
+
+// Angle difference folded into [-pi, pi)
+static float wrap_pi(float d) {
+    return d - TWO_PI_F * floorf(d / TWO_PI_F + 0.5f);
+}
+
+static float wrap_range(float x, uint8_t circular) {
+    if (circular == SIGNAL_FILTER_CIRCULAR_PI) {
+        float w = wrap_pi(x);
+        return w == -(float)M_PI ? (float)M_PI : w;
+    }
+    float w = x - TWO_PI_F * floorf(x / TWO_PI_F);
+    return w >= TWO_PI_F ? 0.0f : w;
+}
+
+// Keep the unwrapped state near zero so float precision does not erode
+// after many turns; every stage holds values in the same frame
+static void filter_recentre(SignalFilterState *st) {
+    float shift = TWO_PI_F * floorf(st->out / TWO_PI_F + 0.5f);
+    if (shift == 0.0f) return;
+    for (uint8_t i = 0; i < st->median_count; i++) st->median_buf[i] -= shift;
+    st->rate_out -= shift;
+    st->ema_out -= shift;
+    st->kalman_x -= shift;
+    st->out -= shift;
+}
+
+static float filter_run(const SignalFilterConfig *c, SignalFilterState *st, float x, uint32_t now) {
+    float dt = (float)(now - st->last_ms) / 1000.0f;
+    if (c->circular) {
+        if (!st->primed || dt > SIGNAL_FILTER_MAX_DT) x = wrap_range(x, c->circular);
+        else x = st->out + wrap_pi(x - st->out);       // nearest turn to the last output
+    }
+    if (!st->primed || dt > SIGNAL_FILTER_MAX_DT) {
+        st->median_count = 0;
+        st->median_pos = 0;
+        if (c->median_len >= 3) filter_median(st, c->median_len, x);
+        st->rate_out = x;
+        st->ema_out = x;
+        st->kalman_x = x;
+        st->kalman_p = c->kalman_r;
+        st->out = x;
+        st->last_ms = now;
+        st->primed = true;
+        return x;
+    }
+    st->last_ms = now;
+
+    if (c->median_len >= 3) x = filter_median(st, c->median_len, x);
+
+    if (c->rate_limit > 0.0f) {
+        float step = c->rate_limit * dt;
+        float d = x - st->rate_out;
+        if (d > step) d = step;
+        else if (d < -step) d = -step;
+        st->rate_out += d;
+        x = st->rate_out;
+    }
+
+    if (c->ema_tau_s > 0.0f) {
+        float alpha = 1.0f - expf(-dt / c->ema_tau_s);
+        st->ema_out += alpha * (x - st->ema_out);
+        x = st->ema_out;
+    }
+
+    if (c->kalman_q > 0.0f && c->kalman_r > 0.0f) {
+        // Random-walk model: uncertainty grows with time between samples
+        st->kalman_p += c->kalman_q * dt;
+        float k = st->kalman_p / (st->kalman_p + c->kalman_r);
+        st->kalman_x += k * (x - st->kalman_x);
+        st->kalman_p *= (1.0f - k);
+        x = st->kalman_x;
+    }
+    if (!c->circular) return x;
+    st->out = x;
+    filter_recentre(st);
+    return wrap_range(x, c->circular);
+}
+
+static void filter_sanitize(SignalFilterConfig *c) {
+    c->path[SIGNAL_FILTER_PATH_LEN - 1] = '\0';
+    if (c->median_len < 3) c->median_len = 0;
+    if (c->median_len > SIGNAL_FILTER_MEDIAN_MAX) c->median_len = SIGNAL_FILTER_MEDIAN_MAX;
+    if (c->median_len && !(c->median_len & 1)) c->median_len++;
+    if (!(c->rate_limit > 0.0f) || !isfinite(c->rate_limit)) c->rate_limit = 0.0f;
+    if (!(c->ema_tau_s > 0.0f) || !isfinite(c->ema_tau_s)) c->ema_tau_s = 0.0f;
+    if (!(c->kalman_q > 0.0f) || !isfinite(c->kalman_q)) c->kalman_q = 0.0f;
+    if (!(c->kalman_r > 0.0f) || !isfinite(c->kalman_r)) c->kalman_r = 0.0f;
+    if (c->circular > SIGNAL_FILTER_CIRCULAR_PI) c->circular = SIGNAL_FILTER_LINEAR;
+}
+
+// Compact used entries into the table; caller holds the mutex
+static void filter_store(const SignalFilterConfig *cfg, int count) {
+    filter_count = 0;
+    memset(filter_state, 0, sizeof(filter_state));
+    for (int i = 0; i < count && filter_count < SIGNAL_FILTER_MAX_PATHS; i++) {
+        if (!cfg[i].path[0]) continue;
+        filter_cfg[filter_count] = cfg[i];
+        filter_sanitize(&filter_cfg[filter_count]);
+        filter_count++;
+    }
+}
+
+void signal_filter_init(void) {
+    if (!filter_mutex) filter_mutex = xSemaphoreCreateMutex();
+    SignalFilterConfig loaded[SIGNAL_FILTER_MAX_PATHS];
+    memset(loaded, 0, sizeof(loaded));
+    size_t got = 0;
+    int count = 0;
+    if (preferences.begin("settings", true)) {
+        size_t len = preferences.getBytesLength(SIGNAL_FILTER_PREF_KEY);
+        if (len && len % sizeof(SignalFilterConfig) != 0 && len % SIGNAL_FILTER_V1_SIZE == 0 &&
+            len <= SIGNAL_FILTER_V1_SIZE * SIGNAL_FILTER_MAX_PATHS) {
+            // Older, shorter entries: spread them out, circular stays off
+            uint8_t old_cfg[SIGNAL_FILTER_V1_SIZE * SIGNAL_FILTER_MAX_PATHS];
+            got = preferences.getBytes(SIGNAL_FILTER_PREF_KEY, old_cfg, len);
+            count = (int)(got / SIGNAL_FILTER_V1_SIZE);
+            for (int i = 0; i < count; i++) memcpy(&loaded[i], old_cfg + i * SIGNAL_FILTER_V1_SIZE, SIGNAL_FILTER_V1_SIZE);
+        } else {
+            got = preferences.getBytes(SIGNAL_FILTER_PREF_KEY, loaded, sizeof(loaded));
+            count = (int)(got / sizeof(SignalFilterConfig));
+        }
+        preferences.end();
+    }
+    xSemaphoreTake(filter_mutex, portMAX_DELAY);
+    filter_store(loaded, count);
+    xSemaphoreGive(filter_mutex);
+    Serial.printf("[FILTER] %d filtered path(s)\n", filter_count);
+}
+
+float signal_filter_apply(const char *path, float raw) {
+    if (!filter_mutex || !path || isnan(raw) || isinf(raw)) return raw;
+    if (xSemaphoreTake(filter_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return raw;
+    float out = raw;
+    int i = filter_find(path);
+    if (i >= 0) {
+        filter_state[i].raw = raw;
+        out = filter_run(&filter_cfg[i], &filter_state[i], raw, millis());
+    }
+    xSemaphoreGive(filter_mutex);
+    return out;
+}
+
+bool signal_filter_last_raw(const char *path, float *raw) {
+    if (!filter_mutex || !path) return false;
+    bool ok = false;
+    if (xSemaphoreTake(filter_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        int i = filter_find(path);
+        if (i >= 0 && filter_state[i].primed) {
+            if (raw) *raw = filter_state[i].raw;
+            ok = true;
+        }
+        xSemaphoreGive(filter_mutex);
+    }
+    return ok;
+}
+
+int signal_filter_get_config(SignalFilterConfig *out, int max) {
+    if (!filter_mutex || !out) return 0;
+    xSemaphoreTake(filter_mutex, portMAX_DELAY);
+    int n = filter_count < max ? filter_count : max;
+    memcpy(out, filter_cfg, n * sizeof(SignalFilterConfig));
+    xSemaphoreGive(filter_mutex);
+    return n;
+}
+
+void signal_filter_set_config(const SignalFilterConfig *cfg, int count) {
+    if (!filter_mutex) filter_mutex = xSemaphoreCreateMutex();
+    xSemaphoreTake(filter_mutex, portMAX_DELAY);
+    filter_store(cfg, count);
+    SignalFilterConfig saved[SIGNAL_FILTER_MAX_PATHS];
+    int n = filter_count;
+    memcpy(saved, filter_cfg, n * sizeof(SignalFilterConfig));
+    xSemaphoreGive(filter_mutex);
+
+    if (preferences.begin("settings", false)) {
+        if (n > 0) preferences.putBytes(SIGNAL_FILTER_PREF_KEY, saved, n * sizeof(SignalFilterConfig));
+        else preferences.remove(SIGNAL_FILTER_PREF_KEY);
+        preferences.end();
+    }
+    Serial.printf("[FILTER] Saved %d filtered path(s)\n", n);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per-path smoothing applied as Signal K values arrive.
+//
+// Each configured path runs a fixed chain: windowed median (spike removal),
+// rate limiter, exponential moving average and a 1-D Kalman filter. Any stage
+// can be switched off. State is a fixed table with no allocation; values are
+// in Signal K (SI) units, before any display conversion. The filtered value
+// feeds gauges, numbers and alarms; the last raw value is kept for graphs.
+//
+// Angle paths (headings, wind angles, in radians) need the circular option:
+// each sample is unwrapped to within pi of the previous output before it
+// enters the chain and the result is wrapped back into the path's range, so
+// a value hovering around north is not averaged through south.
+
+#define SIGNAL_FILTER_MAX_PATHS   12
+#define SIGNAL_FILTER_PATH_LEN    96
+#define SIGNAL_FILTER_MEDIAN_MAX  9
+
+typedef enum {
+    SIGNAL_FILTER_LINEAR = 0,
+    SIGNAL_FILTER_CIRCULAR_2PI,         // angle in [0, 2pi): headings, directions
+    SIGNAL_FILTER_CIRCULAR_PI,          // angle in (-pi, pi]: relative/apparent angles
+} SignalFilterWrap;
+
+typedef struct __attribute__((packed)) {
+    char path[SIGNAL_FILTER_PATH_LEN];  // empty = unused entry
+    uint8_t median_len;                 // odd window 3..9; 0 = off
+    float rate_limit;                   // max change per second; 0 = off
+    float ema_tau_s;                    // EMA time constant in seconds; 0 = off
+    float kalman_q;                     // process noise per second; 0 = Kalman off
+    float kalman_r;                     // measurement noise
+    uint8_t circular;                   // SignalFilterWrap
+} SignalFilterConfig;
+
+// Load the configuration from preferences. Call once before Signal K starts.
+void signal_filter_init(void);
+
+// Run a new raw value through the path's chain and return the filtered
+// value; unfiltered paths return raw unchanged. Called from the Signal K task.
+float signal_filter_apply(const char *path, float raw);
+
+// Last raw value seen for a filtered path; false if the path has no filter
+// or has not received data yet
+bool signal_filter_last_raw(const char *path, float *raw);
+
+// Copy out the configuration table; returns the number of used entries
+int signal_filter_get_config(SignalFilterConfig *out, int max);
+
+// Replace the whole configuration, reset filter state and persist it
+void signal_filter_set_config(const SignalFilterConfig *cfg, int count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,11 @@
 #include "signalk_config.h"
 #include "sensESP_setup.h"
+#include "timeseries_store.h"
+#include "alarm_engine.h"
+#include "frame_governor.h"
+#include "signal_filter.h"
+#include "stats_engine.h"
+#include "derived_values.h"
 #include <WiFi.h>
 #include <esp_wifi.h>
 #include <WebSocketsClient.h>
@@ -122,12 +128,17 @@ void set_sensor_value(int index, float value) {
     
     if (sensor_mutex != NULL && xSemaphoreTake(sensor_mutex, pdMS_TO_TICKS(50))) {
         float old = g_sensor_values[index];
-        if (old != value) {
+        bool changed = (old != value);
+        if (changed) {
             g_sensor_values[index] = value;
         } else {
             // No change; keep as-is
         }
         xSemaphoreGive(sensor_mutex);
+        if (changed) {
+            alarm_engine_feed(index, value);
+            frame_governor_kick();
+        }
     }
 }
 
@@ -174,6 +185,12 @@ float get_sensor_value_by_path(const String& path) {
         }
     }
     
+    // Virtual statistics paths ("<path>:max1h" etc.)
+    if (path.indexOf(':') >= 0) {
+        float val;
+        return stats_engine_value(path.c_str(), &val) ? val : NAN;
+    }
+    
     // Check extended storage
     if (sensor_mutex != NULL && xSemaphoreTake(sensor_mutex, pdMS_TO_TICKS(50))) {
         auto it = extended_sensor_values.find(path);
@@ -185,6 +202,59 @@ float get_sensor_value_by_path(const String& path) {
     return NAN;
 }
 
+// Unfiltered value by path for graphs; same as get_sensor_value_by_path()
+// unless the path has a smoothing filter configured
+float get_sensor_raw_value_by_path(const String& path) {
+    float raw;
+    if (signal_filter_last_raw(path.c_str(), &raw)) return raw;
+    return get_sensor_value_by_path(path);
+}
+
+// Signal K path behind a virtual statistics path; plain paths are returned as-is
+String signalk_base_path(const String& path) {
+    size_t base_len;
+    if (!stats_parse_path(path.c_str(), &base_len, NULL, NULL)) return path;
+    return path.substring(0, base_len);
+}
+
+// Store a new value for a path: gauge slots bound to it (or to a statistic of
+// it) and the extended map used by number/dual/quad displays. Signal K updates
+// and derived formulas both publish through here.
+void publish_sensor_value_by_path(const char* path, float value) {
+    // Rolling statistics (no-op unless a widget binds "<path>:<stat>")
+    stats_engine_ingest(path, value);
+    
+    // Check if this path matches any gauge path
+    bool found_in_gauge = false;
+    size_t path_len = strlen(path);
+    for (int i = 0; i < TOTAL_PARAMS; i++) {
+        // Gauges bound to a statistic of this path get the updated statistic
+        if (signalk_paths[i].length() > path_len && signalk_paths[i][path_len] == ':' &&
+            signalk_paths[i].startsWith(path)) {
+            float stat;
+            if (stats_engine_value(signalk_paths[i].c_str(), &stat)) set_sensor_value(i, stat);
+            continue;
+        }
+        if (signalk_paths[i].length() > 0 && signalk_paths[i].equals(path)) {
+            set_sensor_value(i, value);
+            found_in_gauge = true;
+            // Reduced logging - only log every 20th update
+            static int log_counter = 0;
+            if (++log_counter >= 20) {
+                Serial.printf("WS Path[%d]: %.2f\n", i, value);
+                log_counter = 0;
+            }
+            // Don't break - continue to update ALL matching path indices
+        }
+    }
+    
+    // If not in gauge paths, store in extended map (for number/dual displays)
+    if (!found_in_gauge && sensor_mutex != NULL && xSemaphoreTake(sensor_mutex, pdMS_TO_TICKS(50))) {
+        extended_sensor_values[String(path)] = value;
+        xSemaphoreGive(sensor_mutex);
+    }
+}
+
 // Get sensor unit by path
 String get_sensor_unit_by_path(const String& path) {
     if (path.length() == 0) return "";
@@ -196,6 +266,9 @@ String get_sensor_unit_by_path(const String& path) {
         }
     }
     
+    // Statistics share the unit of the path they summarise
+    if (path.indexOf(':') >= 0) return get_sensor_unit_by_path(signalk_base_path(path));
+    
     // Check extended storage
     if (sensor_mutex != NULL && xSemaphoreTake(sensor_mutex, pdMS_TO_TICKS(50))) {
         auto it = extended_sensor_units.find(path);
@@ -218,6 +291,14 @@ String get_sensor_description_by_path(const String& path) {
         }
     }
     
+    // Statistics: base description plus the statistic, e.g. "Coolant (max 1h)"
+    if (path.indexOf(':') >= 0) {
+        char label[24];
+        stats_path_label(path.c_str(), label, sizeof(label));
+        String desc = get_sensor_description_by_path(signalk_base_path(path));
+        return desc.length() ? desc + " (" + label + ")" : String(label);
+    }
+    
     // Check extended storage
     if (sensor_mutex != NULL && xSemaphoreTake(sensor_mutex, pdMS_TO_TICKS(50))) {
         auto it = extended_sensor_descriptions.find(path);
@@ -294,7 +375,7 @@ void fetch_all_metadata() {
     // Fetch for gauge paths (stored by index)
     for (int i = 0; i < TOTAL_PARAMS; i++) {
         if (signalk_paths[i].length() > 0) {
-            fetch_metadata_for_path(i, signalk_paths[i]);
+            fetch_metadata_for_path(i, signalk_base_path(signalk_paths[i]));
             vTaskDelay(pdMS_TO_TICKS(100)); // Small delay between requests
         }
     }
@@ -368,16 +449,15 @@ static void wsEvent(WStype_t type, uint8_t * payload, size_t length) {
         last_message_time = millis();
         // reset backoff on successful connect
         current_backoff_ms = RECONNECT_BASE_MS;
-        // Build subscription JSON
-        DynamicJsonDocument subdoc(1024);
+        // Build subscription JSON: gauge, number and formula input paths
+        DynamicJsonDocument subdoc(2048);
         subdoc["context"] = "vessels.self";
         JsonArray subs = subdoc.createNestedArray("subscribe");
-        for (int i = 0; i < TOTAL_PARAMS; i++) {
-            if (signalk_paths[i].length() > 0) {
-                JsonObject s = subs.createNestedObject();
-                s["path"] = signalk_paths[i];
-                s["period"] = 0; // instant updates (server may push immediately)
-            }
+        std::vector<String> all_paths = get_all_signalk_paths();
+        for (const String& path : all_paths) {
+            JsonObject s = subs.createNestedObject();
+            s["path"] = path;
+            s["period"] = 0; // instant updates (server may push immediately)
         }
         String out;
         serializeJson(subdoc, out);
@@ -413,29 +493,20 @@ static void wsEvent(WStype_t type, uint8_t * payload, size_t length) {
                     const char* path = val["path"];
                     float value = val["value"].as<float>();
                     
-                    // Check if this path matches any gauge path
-                    bool found_in_gauge = false;
-                    for (int i = 0; i < TOTAL_PARAMS; i++) {
-                        if (signalk_paths[i].length() > 0 && signalk_paths[i].equals(path)) {
-                            set_sensor_value(i, value);
-                            found_in_gauge = true;
-                            // Reduced logging - only log every 20th update
-                            static int log_counter = 0;
-                            if (++log_counter >= 20) {
-                                Serial.printf("WS Path[%d]: %.2f\n", i, value);
-                                log_counter = 0;
-                            }
-                            // Don't break - continue to update ALL matching path indices
-                        }
-                    }
-                    
-                    // If not in gauge paths, store in extended map (for number/dual displays)
-                    if (!found_in_gauge && sensor_mutex != NULL && xSemaphoreTake(sensor_mutex, pdMS_TO_TICKS(50))) {
-                        extended_sensor_values[String(path)] = value;
-                        xSemaphoreGive(sensor_mutex);
-                    }
+                    // Long-horizon history for graph screens (no-op for untracked paths)
+                    ts_store_ingest(path, value);
+
+                    // Smooth before anything displays or alarms on it; the raw
+                    // value stays available to graphs via signal_filter_last_raw()
+                    value = signal_filter_apply(path, value);
+
+                    publish_sensor_value_by_path(path, value);
+
+                    // Formulas reading this path are re-evaluated once the message is done
+                    derived_values_input(path, value);
                 }
             }
+            derived_values_update();
         }
     }
     // handle pong or ping responses if available
@@ -54,8 +54,13 @@ void set_sensor_metadata(int index, const char* unit, const char* description);
 
 // Path-based getters (for number and dual displays that may use non-gauge paths)
 float get_sensor_value_by_path(const String& path);
+float get_sensor_raw_value_by_path(const String& path);   // before smoothing filters
 String get_sensor_unit_by_path(const String& path);
 String get_sensor_description_by_path(const String& path);
+// Strip a statistics suffix ("<path>:max1h" -> "<path>") for subscriptions and metadata
+String signalk_base_path(const String& path);
+// Store a value under a path for every gauge/number widget bound to it
+void publish_sensor_value_by_path(const char* path, float value);
 
 // Backward compatibility helpers
 inline float get_frequency_hz() { return get_sensor_value(SCREEN1_RPM); }
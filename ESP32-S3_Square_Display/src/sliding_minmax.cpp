@@ -0,0 +1,92 @@
+#include "sliding_minmax.h"
+#include <Arduino.h>
+#include "esp_heap_caps.h"
+
+static inline uint16_t dq_index(const MonoDeque* d, uint16_t i) {
+    return (uint16_t)((d->head + i) % d->cap);
+}
+
+static bool dq_init(MonoDeque* d, uint16_t cap) {
+    d->seq = (uint32_t*)heap_caps_malloc(cap * sizeof(uint32_t), MALLOC_CAP_SPIRAM);
+    d->val = (float*)heap_caps_malloc(cap * sizeof(float), MALLOC_CAP_SPIRAM);
+    d->cap = cap;
+    d->head = 0;
+    d->len = 0;
+    return d->seq && d->val;
+}
+
+static void dq_free(MonoDeque* d) {
+    if (d->seq) heap_caps_free(d->seq);
+    if (d->val) heap_caps_free(d->val);
+    d->seq = NULL;
+    d->val = NULL;
+    d->cap = d->head = d->len = 0;
+}
+
+// Pop entries from the back that the new value dominates, then append it.
+// `keep_lower` selects the min deque (values increase front to back).
+static void dq_push(MonoDeque* d, uint32_t seq, float v, bool keep_lower) {
+    if (d->len > 0) {
+        uint16_t b = dq_index(d, d->len - 1);
+        // Same sequence already holds a value at least as extreme: nothing to add
+        if (d->seq[b] == seq && (keep_lower ? (d->val[b] <= v) : (d->val[b] >= v))) return;
+    }
+    while (d->len > 0) {
+        float back = d->val[dq_index(d, d->len - 1)];
+        if (keep_lower ? (back >= v) : (back <= v)) d->len--;
+        else break;
+    }
+    if (d->len == d->cap) {
+        // Only reachable if the capacity was undersized; drop the oldest entry
+        d->head = dq_index(d, 1);
+        d->len--;
+    }
+    uint16_t i = dq_index(d, d->len);
+    d->seq[i] = seq;
+    d->val[i] = v;
+    d->len++;
+}
+
+static void dq_expire(MonoDeque* d, uint32_t oldest_kept) {
+    while (d->len > 0 && d->seq[d->head] < oldest_kept) {
+        d->head = dq_index(d, 1);
+        d->len--;
+    }
+}
+
+bool sliding_minmax_init(SlidingMinMax* w, uint32_t window, uint16_t capacity) {
+    w->window = window;
+    bool ok = dq_init(&w->lo, capacity) && dq_init(&w->hi, capacity);
+    if (!ok) sliding_minmax_free(w);
+    return ok;
+}
+
+void sliding_minmax_free(SlidingMinMax* w) {
+    dq_free(&w->lo);
+    dq_free(&w->hi);
+}
+
+void sliding_minmax_reset(SlidingMinMax* w) {
+    w->lo.head = w->lo.len = 0;
+    w->hi.head = w->hi.len = 0;
+}
+
+void sliding_minmax_push(SlidingMinMax* w, uint32_t seq, float mn, float mx) {
+    if (!w->lo.seq || isnan(mn) || isnan(mx)) return;
+    dq_push(&w->lo, seq, mn, true);
+    dq_push(&w->hi, seq, mx, false);
+}
+
+void sliding_minmax_expire(SlidingMinMax* w, uint32_t newest_seq) {
+    if (!w->lo.seq || newest_seq < w->window) return;
+    uint32_t oldest_kept = newest_seq - w->window + 1;
+    dq_expire(&w->lo, oldest_kept);
+    dq_expire(&w->hi, oldest_kept);
+}
+
+bool sliding_minmax_get(const SlidingMinMax* w, float* mn, float* mx) {
+    if (!w->lo.seq || w->lo.len == 0 || w->hi.len == 0) return false;
+    if (mn) *mn = w->lo.val[w->lo.head];
+    if (mx) *mx = w->hi.val[w->hi.head];
+    return true;
+}
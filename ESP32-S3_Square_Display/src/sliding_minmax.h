@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Exact min/max over a sliding window of sequence numbers (e.g. graph columns)
+// using two monotonic deques. Push and expire are amortised O(1); reading the
+// current extremes is O(1).
+//
+// Values are pushed with a non-decreasing sequence number. Several values may
+// share a sequence number (a column that keeps receiving samples, or two series
+// in one window); only the most extreme one per sequence is kept, so each deque
+// holds at most one entry per sequence number in the window.
+
+typedef struct {
+    uint32_t* seq;
+    float* val;
+    uint16_t cap;
+    uint16_t head;   // index of the front (oldest) entry
+    uint16_t len;
+} MonoDeque;
+
+typedef struct {
+    MonoDeque lo;    // increasing values: front is the window minimum
+    MonoDeque hi;    // decreasing values: front is the window maximum
+    uint32_t window;
+} SlidingMinMax;
+
+// Allocate storage for `capacity` entries per deque (window + 1 is enough)
+bool sliding_minmax_init(SlidingMinMax* w, uint32_t window, uint16_t capacity);
+void sliding_minmax_free(SlidingMinMax* w);
+void sliding_minmax_reset(SlidingMinMax* w);
+
+// Add a min/max pair for sequence `seq` (a single sample passes v, v)
+void sliding_minmax_push(SlidingMinMax* w, uint32_t seq, float mn, float mx);
+
+// Drop entries that fell out of the window ending at `newest_seq`
+void sliding_minmax_expire(SlidingMinMax* w, uint32_t newest_seq);
+
+// Current window extremes; false when the window is empty
+bool sliding_minmax_get(const SlidingMinMax* w, float* mn, float* mx);
+
+#ifdef __cplusplus
+}
+#endif
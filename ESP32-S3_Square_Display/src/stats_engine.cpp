@@ -0,0 +1,561 @@
+#include "stats_engine.h"
+#include "stats_sketch.h"
+#include "screen_config_c_api.h"
+#include "sensESP_setup.h"
+#include "timeseries_store.h"
+#include "web_task.h"
+#include "SD_Card.h"
+#include <Arduino.h>
+#include <FS.h>
+#include <SD_MMC.h>
+#include <math.h>
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define STATS_FILE "/config/stats.bin"
+#define STATS_FILE_TMP "/config/stats.tmp"
+#define STATS_FILE_MAGIC 0x32545453UL     // "STT2": minute buckets carry a sketch
+#define STATS_HOUR_BUCKETS 60             // one-minute buckets
+#define STATS_REFRESH_MS 5000UL           // re-check which paths are bound
+#define STATS_SAVE_MS 300000UL
+#define STATS_QUANTILES 3
+
+static const float quantile_p[STATS_QUANTILES] = {0.05f, 0.50f, 0.95f};
+
+static const char *const kind_names[STATS_KIND_COUNT] = {"min", "max", "mean", "std", "p5", "p50", "p95"};
+static const char *const window_names[STATS_WIN_COUNT] = {"", "1h", "reset"};
+
+// P-square estimator (Jain & Chlamtac): five markers track one quantile
+typedef struct {
+    float q[5];             // marker heights; the first `count` hold raw samples until primed
+    float pos[5];           // actual marker positions (1-based)
+    float want[5];          // desired marker positions
+    uint32_t count;
+} P2Quantile;
+
+typedef struct {
+    uint32_t n;
+    float min;
+    float max;
+    double mean;
+    double m2;              // sum of squared deviations (Welford)
+    P2Quantile pct[STATS_QUANTILES];
+} StatsAccum;
+
+typedef struct {
+    uint32_t minute;        // ts_store_now() / 60
+    uint32_t n;
+    float min;
+    float max;
+    float mean;
+    float m2;
+    StatsSketch sketch;     // for the last-hour percentiles
+} StatsBucket;
+
+typedef struct {
+    bool active;
+    char path[STATS_PATH_LEN];
+    StatsAccum session;
+    StatsAccum since_reset;
+    uint32_t reset_time;
+    StatsBucket hour[STATS_HOUR_BUCKETS];
+    // Last-hour summary is rebuilt only after new samples or a new minute
+    uint32_t version;
+    uint32_t hour_version;
+    uint32_t hour_minute;
+    StatsSummary hour_cache;
+} StatsSeries;
+
+// On-card snapshot: header followed by `count` records
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t count;
+    uint16_t record_size;
+} StatsFileHeader;
+
+typedef struct {
+    char path[STATS_PATH_LEN];
+    StatsAccum since_reset;
+    uint32_t reset_time;
+    StatsBucket hour[STATS_HOUR_BUCKETS];
+} StatsRecord;
+
+static StatsSeries *stats_series = NULL;     // STATS_MAX_PATHS entries in PSRAM
+static StatsSketchBin *stats_hour_bins = NULL;  // merge buffer for hour_summary (stats_mutex held)
+static SemaphoreHandle_t stats_mutex = NULL;
+static SemaphoreHandle_t stats_io_mutex = NULL;
+static TaskHandle_t stats_task_handle = NULL;
+static volatile bool stats_dirty = false;
+
+// ---- Path grammar ----------------------------------------------------------
+
+bool stats_parse_path(const char *path, size_t *base_len, StatsKind *kind, StatsWindow *window) {
+    if (!path) return false;
+    const char *colon = strchr(path, ':');
+    if (!colon || colon == path) return false;
+    const char *suffix = colon + 1;
+    // Longest names first so "p50" is not read as "p5" followed by "0"
+    static const StatsKind order[STATS_KIND_COUNT] = {STATS_MEAN, STATS_MIN, STATS_MAX, STATS_STD, STATS_P50, STATS_P95, STATS_P5};
+    for (int i = 0; i < STATS_KIND_COUNT; i++) {
+        const char *name = kind_names[order[i]];
+        size_t len = strlen(name);
+        if (strncmp(suffix, name, len) != 0) continue;
+        for (int w = 0; w < STATS_WIN_COUNT; w++) {
+            if (strcmp(suffix + len, window_names[w]) != 0) continue;
+            if (base_len) *base_len = (size_t)(colon - path);
+            if (kind) *kind = order[i];
+            if (window) *window = (StatsWindow)w;
+            return true;
+        }
+    }
+    return false;
+}
+
+void stats_path_label(const char *path, char *out, size_t len) {
+    if (!out || len == 0) return;
+    out[0] = '\0';
+    StatsKind kind;
+    StatsWindow window;
+    if (!stats_parse_path(path, NULL, &kind, &window)) return;
+    if (window == STATS_WIN_SESSION) snprintf(out, len, "%s", kind_names[kind]);
+    else snprintf(out, len, "%s %s", kind_names[kind], window_names[window]);
+}
+
+// ---- Estimators ------------------------------------------------------------
+
+static void p2_add(P2Quantile *e, float p, float x) {
+    if (e->count < 5) {
+        // Keep the first five samples sorted; they become the initial markers
+        int i = (int)e->count - 1;
+        while (i >= 0 && e->q[i] > x) { e->q[i + 1] = e->q[i]; i--; }
+        e->q[i + 1] = x;
+        e->count++;
+        if (e->count == 5) {
+            for (int m = 0; m < 5; m++) e->pos[m] = (float)(m + 1);
+            e->want[0] = 1.0f;
+            e->want[1] = 1.0f + 2.0f * p;
+            e->want[2] = 1.0f + 4.0f * p;
+            e->want[3] = 3.0f + 2.0f * p;
+            e->want[4] = 5.0f;
+        }
+        return;
+    }
+    e->count++;
+
+    int k;
+    if (x < e->q[0]) { e->q[0] = x; k = 0; }
+    else if (x >= e->q[4]) { e->q[4] = x; k = 3; }
+    else { k = 0; while (k < 3 && x >= e->q[k + 1]) k++; }
+
+    for (int m = k + 1; m < 5; m++) e->pos[m] += 1.0f;
+    const float step[5] = {0.0f, p / 2.0f, p, (1.0f + p) / 2.0f, 1.0f};
+    for (int m = 0; m < 5; m++) e->want[m] += step[m];
+
+    for (int m = 1; m < 4; m++) {
+        float d = e->want[m] - e->pos[m];
+        if (!((d >= 1.0f && e->pos[m + 1] - e->pos[m] > 1.0f) ||
+              (d <= -1.0f && e->pos[m - 1] - e->pos[m] < -1.0f))) {
+            continue;
+        }
+        float s = d > 0.0f ? 1.0f : -1.0f;
+        float np = e->pos[m + 1] - e->pos[m - 1];
+        float qp = e->q[m] + s / np *
+                   ((e->pos[m] - e->pos[m - 1] + s) * (e->q[m + 1] - e->q[m]) / (e->pos[m + 1] - e->pos[m]) +
+                    (e->pos[m + 1] - e->pos[m] - s) * (e->q[m] - e->q[m - 1]) / (e->pos[m] - e->pos[m - 1]));
+        if (!(e->q[m - 1] < qp && qp < e->q[m + 1])) {
+            // Parabolic step would break marker order; fall back to linear
+            int o = m + (int)s;
+            qp = e->q[m] + s * (e->q[o] - e->q[m]) / (e->pos[o] - e->pos[m]);
+        }
+        e->q[m] = qp;
+        e->pos[m] += s;
+    }
+}
+
+static float p2_get(const P2Quantile *e, float p) {
+    if (e->count == 0) return NAN;
+    if (e->count >= 5) return e->q[2];
+    return e->q[(int)lroundf(p * (float)(e->count - 1))];
+}
+
+static void accum_add(StatsAccum *a, float x) {
+    if (a->n == 0) { a->min = x; a->max = x; }
+    if (x < a->min) a->min = x;
+    if (x > a->max) a->max = x;
+    a->n++;
+    double d = x - a->mean;
+    a->mean += d / a->n;
+    a->m2 += d * (x - a->mean);
+    for (int i = 0; i < STATS_QUANTILES; i++) p2_add(&a->pct[i], quantile_p[i], x);
+}
+
+static void summary_clear(StatsSummary *out) {
+    out->n = 0;
+    for (int k = 0; k < STATS_KIND_COUNT; k++) out->v[k] = NAN;
+}
+
+static void accum_summary(const StatsAccum *a, StatsSummary *out) {
+    summary_clear(out);
+    if (a->n == 0) return;
+    out->n = a->n;
+    out->v[STATS_MIN] = a->min;
+    out->v[STATS_MAX] = a->max;
+    out->v[STATS_MEAN] = (float)a->mean;
+    out->v[STATS_STD] = a->n > 1 ? (float)sqrt(a->m2 / (a->n - 1)) : 0.0f;
+    out->v[STATS_P5] = p2_get(&a->pct[0], quantile_p[0]);
+    out->v[STATS_P50] = p2_get(&a->pct[1], quantile_p[1]);
+    out->v[STATS_P95] = p2_get(&a->pct[2], quantile_p[2]);
+}
+
+static void bucket_add(StatsBucket *b, uint32_t minute, float x) {
+    if (b->minute != minute || b->n == 0) {
+        b->minute = minute;
+        b->n = 0;
+        b->min = b->max = x;
+        b->mean = 0.0f;
+        b->m2 = 0.0f;
+        stats_sketch_clear(&b->sketch);
+    }
+    if (x < b->min) b->min = x;
+    if (x > b->max) b->max = x;
+    b->n++;
+    float d = x - b->mean;
+    b->mean += d / b->n;
+    b->m2 += d * (x - b->mean);
+    stats_sketch_add(&b->sketch, x);
+}
+
+// Merge the minute buckets of the last hour (Chan's parallel variance).
+// Percentiles come from the merged minute sketches.
+static void hour_summary(const StatsSeries *s, uint32_t now_min, StatsSummary *out) {
+    summary_clear(out);
+    int nb = 0;
+    uint32_t n = 0;
+    double mean = 0.0, m2 = 0.0;
+    float mn = 0.0f, mx = 0.0f;
+    for (int i = 0; i < STATS_HOUR_BUCKETS; i++) {
+        const StatsBucket *b = &s->hour[i];
+        if (b->n == 0 || b->minute > now_min || now_min - b->minute >= STATS_HOUR_BUCKETS) continue;
+        if (n == 0) { mn = b->min; mx = b->max; }
+        if (b->min < mn) mn = b->min;
+        if (b->max > mx) mx = b->max;
+        uint32_t nn = n + b->n;
+        double d = b->mean - mean;
+        mean += d * b->n / nn;
+        m2 += b->m2 + d * d * (double)n * b->n / nn;
+        n = nn;
+        stats_sketch_collect(&b->sketch, stats_hour_bins, &nb, STATS_HOUR_BUCKETS * STATS_SKETCH_BINS);
+    }
+    if (n == 0) return;
+    out->n = n;
+    out->v[STATS_MIN] = mn;
+    out->v[STATS_MAX] = mx;
+    out->v[STATS_MEAN] = (float)mean;
+    out->v[STATS_STD] = n > 1 ? (float)sqrt(m2 / (n - 1)) : 0.0f;
+    float pct[STATS_QUANTILES];
+    stats_sketch_quantiles(stats_hour_bins, nb, quantile_p, pct, STATS_QUANTILES);
+    const StatsKind pk[STATS_QUANTILES] = {STATS_P5, STATS_P50, STATS_P95};
+    // A bin centre can lie just outside the observed range
+    for (int q = 0; q < STATS_QUANTILES; q++) out->v[pk[q]] = fminf(fmaxf(pct[q], mn), mx);
+}
+
+// ---- Table (stats_mutex held) ----------------------------------------------
+
+static StatsSeries *stats_find_n(const char *path, size_t len) {
+    for (int i = 0; i < STATS_MAX_PATHS; i++) {
+        StatsSeries *s = &stats_series[i];
+        if (s->active && strncmp(s->path, path, len) == 0 && s->path[len] == '\0') return s;
+    }
+    return NULL;
+}
+
+static uint32_t stats_now_minute(void) {
+    return ts_store_now() / 60;
+}
+
+static void stats_window_summary(StatsSeries *s, StatsWindow window, StatsSummary *out) {
+    switch (window) {
+        case STATS_WIN_SESSION:
+            accum_summary(&s->session, out);
+            break;
+        case STATS_WIN_RESET:
+            accum_summary(&s->since_reset, out);
+            break;
+        case STATS_WIN_1H:
+        default: {
+            uint32_t now_min = stats_now_minute();
+            if (s->hour_version != s->version || s->hour_minute != now_min) {
+                hour_summary(s, now_min, &s->hour_cache);
+                s->hour_version = s->version;
+                s->hour_minute = now_min;
+            }
+            *out = s->hour_cache;
+            break;
+        }
+    }
+}
+
+// ---- Card I/O (stats_io_mutex held) ----------------------------------------
+
+static void stats_load(void) {
+    if (!SD_IsMounted() || !SD_MMC.exists(STATS_FILE)) return;
+    File f = SD_MMC.open(STATS_FILE, FILE_READ);
+    if (!f) return;
+    StatsFileHeader hdr;
+    if (f.read((uint8_t *)&hdr, sizeof(hdr)) != sizeof(hdr) || hdr.magic != STATS_FILE_MAGIC ||
+        hdr.record_size != sizeof(StatsRecord)) {
+        Serial.println("[STATS] Ignoring incompatible " STATS_FILE);
+        f.close();
+        return;
+    }
+    StatsRecord *rec = (StatsRecord *)heap_caps_malloc(sizeof(StatsRecord), MALLOC_CAP_SPIRAM);
+    int loaded = 0;
+    uint32_t now_min = stats_now_minute();
+    for (int i = 0; rec && i < hdr.count && loaded < STATS_MAX_PATHS; i++) {
+        if (f.read((uint8_t *)rec, sizeof(StatsRecord)) != sizeof(StatsRecord)) break;
+        rec->path[STATS_PATH_LEN - 1] = '\0';
+        if (!rec->path[0]) continue;
+        xSemaphoreTake(stats_mutex, portMAX_DELAY);
+        StatsSeries *s = &stats_series[loaded++];
+        memset(s, 0, sizeof(*s));
+        memcpy(s->path, rec->path, STATS_PATH_LEN);
+        s->since_reset = rec->since_reset;
+        s->reset_time = rec->reset_time;
+        memcpy(s->hour, rec->hour, sizeof(s->hour));
+        // Buckets from a different clock base (e.g. before SNTP) cannot be placed
+        for (int b = 0; b < STATS_HOUR_BUCKETS; b++) {
+            if (s->hour[b].minute > now_min) s->hour[b].n = 0;
+        }
+        s->version = 1;
+        s->active = true;
+        xSemaphoreGive(stats_mutex);
+    }
+    if (rec) heap_caps_free(rec);
+    f.close();
+    Serial.printf("[STATS] Restored %d path(s) from " STATS_FILE "\n", loaded);
+}
+
+static void stats_save_locked(void) {
+    if (!SD_IsMounted()) return;
+    if (!SD_MMC.exists("/config")) SD_MMC.mkdir("/config");
+    StatsRecord *rec = (StatsRecord *)heap_caps_malloc(sizeof(StatsRecord), MALLOC_CAP_SPIRAM);
+    if (!rec) return;
+    File f = SD_MMC.open(STATS_FILE_TMP, FILE_WRITE);
+    if (!f) {
+        Serial.println("[STATS] Failed to write " STATS_FILE_TMP);
+        heap_caps_free(rec);
+        return;
+    }
+    stats_dirty = false;
+    StatsFileHeader hdr = {STATS_FILE_MAGIC, 0, (uint16_t)sizeof(StatsRecord)};
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    for (int i = 0; i < STATS_MAX_PATHS; i++) if (stats_series[i].active) hdr.count++;
+    xSemaphoreGive(stats_mutex);
+    f.write((const uint8_t *)&hdr, sizeof(hdr));
+    int written = 0;
+    for (int i = 0; i < STATS_MAX_PATHS && written < hdr.count; i++) {
+        // Copy one series at a time so ingest is never blocked by the card
+        xSemaphoreTake(stats_mutex, portMAX_DELAY);
+        StatsSeries *s = &stats_series[i];
+        bool active = s->active;
+        if (active) {
+            memcpy(rec->path, s->path, STATS_PATH_LEN);
+            rec->since_reset = s->since_reset;
+            rec->reset_time = s->reset_time;
+            memcpy(rec->hour, s->hour, sizeof(rec->hour));
+        }
+        xSemaphoreGive(stats_mutex);
+        if (!active) continue;
+        f.write((const uint8_t *)rec, sizeof(StatsRecord));
+        written++;
+    }
+    // A series dropped mid-save leaves a short count; pad so the header stays valid
+    memset(rec, 0, sizeof(StatsRecord));
+    for (; written < hdr.count; written++) f.write((const uint8_t *)rec, sizeof(StatsRecord));
+    f.close();
+    heap_caps_free(rec);
+    // Replace the old snapshot only once the new one is complete
+    SD_MMC.remove(STATS_FILE);
+    SD_MMC.rename(STATS_FILE_TMP, STATS_FILE);
+}
+
+void stats_engine_save(void) {
+    if (!stats_series || !stats_io_mutex) return;
+    if (xSemaphoreTake(stats_io_mutex, portMAX_DELAY) != pdTRUE) return;
+    stats_save_locked();
+    xSemaphoreGive(stats_io_mutex);
+}
+
+// ---- Tracking --------------------------------------------------------------
+
+static void stats_want(char (*wanted)[STATS_PATH_LEN], int *nw, const char *path) {
+    size_t base_len;
+    if (!stats_parse_path(path, &base_len, NULL, NULL) || base_len >= STATS_PATH_LEN) return;
+    for (int j = 0; j < *nw; j++) {
+        if (strncmp(wanted[j], path, base_len) == 0 && wanted[j][base_len] == '\0') return;
+    }
+    if (*nw >= STATS_MAX_PATHS) return;
+    memcpy(wanted[*nw], path, base_len);
+    wanted[*nw][base_len] = '\0';
+    (*nw)++;
+}
+
+// Track exactly the base paths that some widget binds a statistic of
+static void stats_refresh_series(void) {
+    char wanted[STATS_MAX_PATHS][STATS_PATH_LEN];
+    int nw = 0;
+    // The web task rewrites the paths and screen_configs under the UI lock
+    ui_lock();
+    for (int i = 0; i < NUM_SCREENS * 2; i++) {
+        String p = get_signalk_path_by_index(i);
+        stats_want(wanted, &nw, p.c_str());
+    }
+    for (int s = 0; s < NUM_SCREENS; s++) {
+        const ScreenConfig *c = &screen_configs[s];
+        const char *paths[] = {c->number_path, c->dual_top_path, c->dual_bottom_path, c->quad_tl_path,
+                               c->quad_tr_path, c->quad_bl_path, c->quad_br_path, c->gauge_num_center_path};
+        for (size_t k = 0; k < sizeof(paths) / sizeof(paths[0]); k++) stats_want(wanted, &nw, paths[k]);
+    }
+    ui_unlock();
+
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    for (int i = 0; i < STATS_MAX_PATHS; i++) {
+        StatsSeries *s = &stats_series[i];
+        if (!s->active) continue;
+        bool keep = false;
+        for (int j = 0; j < nw; j++) if (strcmp(wanted[j], s->path) == 0) keep = true;
+        if (keep) continue;
+        s->active = false;
+        stats_dirty = true;
+        Serial.printf("[STATS] Stopped tracking %s\n", s->path);
+    }
+    for (int j = 0; j < nw; j++) {
+        if (stats_find_n(wanted[j], strlen(wanted[j]))) continue;
+        for (int i = 0; i < STATS_MAX_PATHS; i++) {
+            StatsSeries *s = &stats_series[i];
+            if (s->active) continue;
+            memset(s, 0, sizeof(*s));
+            strncpy(s->path, wanted[j], STATS_PATH_LEN - 1);
+            s->reset_time = ts_store_now();
+            s->version = 1;
+            s->active = true;
+            stats_dirty = true;
+            Serial.printf("[STATS] Tracking %s\n", s->path);
+            break;
+        }
+    }
+    xSemaphoreGive(stats_mutex);
+}
+
+static void stats_task(void *parameter) {
+    unsigned long last_save = millis();
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(STATS_REFRESH_MS));
+        stats_refresh_series();
+        if (stats_dirty && millis() - last_save >= STATS_SAVE_MS) {
+            last_save = millis();
+            stats_engine_save();
+        }
+    }
+}
+
+void stats_engine_init(void) {
+    if (stats_series) return;
+    stats_series = (StatsSeries *)heap_caps_calloc(STATS_MAX_PATHS, sizeof(StatsSeries), MALLOC_CAP_SPIRAM);
+    stats_hour_bins = (StatsSketchBin *)heap_caps_malloc(STATS_HOUR_BUCKETS * STATS_SKETCH_BINS * sizeof(StatsSketchBin),
+                                                         MALLOC_CAP_SPIRAM);
+    if (!stats_series || !stats_hour_bins) {
+        Serial.println("[STATS] Out of PSRAM; statistics disabled");
+        if (stats_series) heap_caps_free(stats_series);
+        if (stats_hour_bins) heap_caps_free(stats_hour_bins);
+        stats_series = NULL;
+        stats_hour_bins = NULL;
+        return;
+    }
+    stats_mutex = xSemaphoreCreateMutex();
+    stats_io_mutex = xSemaphoreCreateMutex();
+
+    xSemaphoreTake(stats_io_mutex, portMAX_DELAY);
+    stats_load();
+    xSemaphoreGive(stats_io_mutex);
+    stats_refresh_series();
+
+    xTaskCreatePinnedToCore(stats_task, "stats", 4096, NULL, 1, &stats_task_handle, 0);
+    Serial.printf("[STATS] Statistics engine started (%u bytes)\n",
+                  (unsigned)(STATS_MAX_PATHS * sizeof(StatsSeries)));
+}
+
+// ---- Public API ------------------------------------------------------------
+
+void stats_engine_ingest(const char *path, float value) {
+    if (!stats_series || !path || isnan(value) || isinf(value)) return;
+    uint32_t minute = stats_now_minute();
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+    StatsSeries *s = stats_find_n(path, strlen(path));
+    if (s) {
+        accum_add(&s->session, value);
+        accum_add(&s->since_reset, value);
+        bucket_add(&s->hour[minute % STATS_HOUR_BUCKETS], minute, value);
+        s->version++;
+        stats_dirty = true;
+    }
+    xSemaphoreGive(stats_mutex);
+}
+
+bool stats_engine_value(const char *virtual_path, float *out) {
+    size_t base_len;
+    StatsKind kind;
+    StatsWindow window;
+    if (!stats_series || !stats_parse_path(virtual_path, &base_len, &kind, &window)) return false;
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return false;
+    bool ok = false;
+    StatsSeries *s = stats_find_n(virtual_path, base_len);
+    if (s) {
+        StatsSummary sum;
+        stats_window_summary(s, window, &sum);
+        if (sum.n > 0) {
+            if (out) *out = sum.v[kind];
+            ok = true;
+        }
+    }
+    xSemaphoreGive(stats_mutex);
+    return ok;
+}
+
+bool stats_engine_summary(const char *base_path, StatsWindow window, StatsSummary *out) {
+    if (!stats_series || !base_path || !out) return false;
+    summary_clear(out);
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(50)) != pdTRUE) return false;
+    StatsSeries *s = stats_find_n(base_path, strlen(base_path));
+    if (s) stats_window_summary(s, window, out);
+    xSemaphoreGive(stats_mutex);
+    return s != NULL;
+}
+
+int stats_engine_tracked(char (*out)[STATS_PATH_LEN], int max) {
+    if (!stats_series || !out) return 0;
+    int n = 0;
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    for (int i = 0; i < STATS_MAX_PATHS && n < max; i++) {
+        if (stats_series[i].active) memcpy(out[n++], stats_series[i].path, STATS_PATH_LEN);
+    }
+    xSemaphoreGive(stats_mutex);
+    return n;
+}
+
+void stats_engine_reset(const char *base_path) {
+    if (!stats_series) return;
+    xSemaphoreTake(stats_mutex, portMAX_DELAY);
+    for (int i = 0; i < STATS_MAX_PATHS; i++) {
+        StatsSeries *s = &stats_series[i];
+        if (!s->active || (base_path && strcmp(s->path, base_path) != 0)) continue;
+        memset(&s->since_reset, 0, sizeof(s->since_reset));
+        s->reset_time = ts_store_now();
+        s->version++;
+        Serial.printf("[STATS] Reset %s\n", s->path);
+    }
+    xSemaphoreGive(stats_mutex);
+    stats_engine_save();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rolling statistics per Signal K path, exposed as virtual paths.
+//
+// Binding any widget to "<path>:<stat><window>" (for example
+// "propulsion.main.temperature:max1h") makes the engine track <path>.
+//   stat:   min, max, mean, std, p5, p50, p95
+//   window: (none) = since boot, 1h = last hour, reset = since the last reset
+// Every update is O(1): Welford mean/variance, running min/max and P-square
+// quantile markers for the session and since-reset windows, plus a ring of
+// one-minute buckets (with a mergeable quantile sketch) for the last hour. Memory per path is fixed. The hour
+// ring and the since-reset window are saved to /config/stats.bin on the SD
+// card every few minutes and restored at boot.
+
+#define STATS_MAX_PATHS   8
+#define STATS_PATH_LEN    96
+
+typedef enum {
+    STATS_MIN = 0,
+    STATS_MAX,
+    STATS_MEAN,
+    STATS_STD,
+    STATS_P5,
+    STATS_P50,
+    STATS_P95,
+    STATS_KIND_COUNT
+} StatsKind;
+
+typedef enum {
+    STATS_WIN_SESSION = 0,
+    STATS_WIN_1H,
+    STATS_WIN_RESET,
+    STATS_WIN_COUNT
+} StatsWindow;
+
+typedef struct {
+    uint32_t n;             // samples in the window; other fields are NaN when 0
+    float v[STATS_KIND_COUNT];
+} StatsSummary;
+
+// Split a virtual path into its base path length, statistic and window.
+// Returns false for plain paths and unknown suffixes.
+bool stats_parse_path(const char *path, size_t *base_len, StatsKind *kind, StatsWindow *window);
+
+// Short label for a virtual path suffix, e.g. "max 1h"; empty for plain paths
+void stats_path_label(const char *path, char *out, size_t len);
+
+// Allocate the tables, restore the saved snapshot and start the background
+// task that follows the configured paths. Call after preferences are loaded
+// and the SD card is mounted (persistence is skipped without a card).
+void stats_engine_init(void);
+
+// Feed a new value for a Signal K path; ignored unless the path is tracked
+void stats_engine_ingest(const char *path, float value);
+
+// Current value of a virtual path; false if it is not tracked or has no data
+bool stats_engine_value(const char *virtual_path, float *out);
+
+// All statistics of one tracked base path for one window
+bool stats_engine_summary(const char *base_path, StatsWindow window, StatsSummary *out);
+
+// Base paths currently tracked; returns how many were copied
+int stats_engine_tracked(char (*out)[STATS_PATH_LEN], int max);
+
+// Restart the since-reset window of one path (NULL = all paths)
+void stats_engine_reset(const char *base_path);
+
+// Write the snapshot to the SD card now
+void stats_engine_save(void);
+
+#ifdef __cplusplus
+}
+#endif
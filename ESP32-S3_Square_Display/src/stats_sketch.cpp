@@ -0,0 +1,80 @@
+#include "stats_sketch.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Float bits mapped so that unsigned order matches numeric order
+static uint16_t sketch_key(float x) {
+    uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    u = (u & 0x80000000UL) ? ~u : (u | 0x80000000UL);
+    return (uint16_t)(u >> 16);
+}
+
+float stats_sketch_value(uint16_t key) {
+    uint32_t u = ((uint32_t)key << 16) | 0x8000UL;
+    u = (u & 0x80000000UL) ? (u & 0x7FFFFFFFUL) : ~u;
+    float x;
+    memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+void stats_sketch_clear(StatsSketch *s) {
+    s->used = 0;
+}
+
+void stats_sketch_add(StatsSketch *s, float x) {
+    uint16_t k = sketch_key(x);
+    int lo = 0, hi = s->used;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (s->key[mid] < k) lo = mid + 1;
+        else hi = mid;
+    }
+    int i = lo;
+    if (i == s->used || s->key[i] != k) {
+        if (s->used < STATS_SKETCH_BINS) {
+            memmove(&s->key[i + 1], &s->key[i], (s->used - i) * sizeof(s->key[0]));
+            memmove(&s->count[i + 1], &s->count[i], (s->used - i) * sizeof(s->count[0]));
+            s->key[i] = k;
+            s->count[i] = 0;
+            s->used++;
+        } else if (i == s->used || (i > 0 && k - s->key[i - 1] < s->key[i] - k)) {
+            i--;                                        // full: join the nearest bin
+        }
+    }
+    if (s->count[i] < 0xFFFF) s->count[i]++;
+}
+
+bool stats_sketch_collect(const StatsSketch *s, StatsSketchBin *out, int *n, int max) {
+    for (int i = 0; i < s->used; ++i) {
+        if (*n >= max) return false;
+        out[*n].key = s->key[i];
+        out[*n].count = s->count[i];
+        (*n)++;
+    }
+    return true;
+}
+
+static int bin_cmp(const void *a, const void *b) {
+    uint16_t ka = ((const StatsSketchBin *)a)->key, kb = ((const StatsSketchBin *)b)->key;
+    return ka < kb ? -1 : ka > kb;
+}
+
+void stats_sketch_quantiles(StatsSketchBin *bins, int n, const float *p, float *out, int np) {
+    uint64_t total = 0;
+    for (int i = 0; i < n; ++i) total += bins[i].count;
+    if (total == 0) {
+        for (int q = 0; q < np; ++q) out[q] = NAN;
+        return;
+    }
+    qsort(bins, n, sizeof(bins[0]), bin_cmp);
+    for (int q = 0; q < np; ++q) {
+        // Bin holding the sample of rank p * (total - 1), counting from 0
+        double rank = p[q] * (double)(total - 1);
+        uint64_t seen = 0;
+        int i = 0;
+        while (i < n - 1 && (double)(seen + bins[i].count) <= rank) seen += bins[i++].count;
+        out[q] = stats_sketch_value(bins[i].key);
+    }
+}
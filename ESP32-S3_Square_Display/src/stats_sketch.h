@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Mergeable quantile sketch for one minute of samples, kept free of
+// Arduino/FreeRTOS so it can be tested on the host (test/test_stats_sketch).
+//
+// A sample is binned by the top 16 bits of its order-preserving float key
+// (sign, exponent and 7 mantissa bits), so every bin spans at most 1/128 of
+// its magnitude and bins from different minutes line up exactly. A minute
+// keeps up to STATS_SKETCH_BINS sorted bins; past that a sample joins the
+// nearest bin. Quantiles over any set of minutes come from merging their
+// bins, not their means.
+
+#define STATS_SKETCH_BINS   24
+
+typedef struct {
+    uint16_t key[STATS_SKETCH_BINS];    // ascending
+    uint16_t count[STATS_SKETCH_BINS];  // saturates at 65535
+    uint8_t used;
+} StatsSketch;
+
+typedef struct {
+    uint16_t key;
+    uint32_t count;
+} StatsSketchBin;
+
+void stats_sketch_clear(StatsSketch *s);
+void stats_sketch_add(StatsSketch *s, float x);
+
+// Append the bins of `s` to out[*n..max); returns false when they did not fit
+bool stats_sketch_collect(const StatsSketch *s, StatsSketchBin *out, int *n, int max);
+
+// Sort the collected bins in place and read quantile p[i] (0..1) into out[i];
+// NaN when there are no samples
+void stats_sketch_quantiles(StatsSketchBin *bins, int n, const float *p, float *out, int np);
+
+// Centre of the bin with key `key`
+float stats_sketch_value(uint16_t key);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,479 @@
+#include "timeseries_store.h"
+#include "screen_config_c_api.h"
+#include "SD_Card.h"
+#include "web_task.h"
+#include <Arduino.h>
+#include <FS.h>
+#include <SD_MMC.h>
+#include <time.h>
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#define TS_ROOT "/ts"
+#define TS_MAX_SERIES (NUM_SCREENS * 2)   // two graph series per screen
+#define TS_PATH_LEN 128
+#define TS_SEG_SLOTS 32                   // must exceed the largest retention count
+#define TS_PENDING_MAX 128                // per level; room for a slow card past one batch
+#define TS_FLUSH_BATCH 60                 // flush once a minute of 1 s buckets is pending
+#define TS_FLUSH_MS 60000UL
+#define TS_REFRESH_MS 5000UL              // re-check which paths are on graph screens
+#define TS_READ_CHUNK 32
+#define TS_EPOCH_VALID 1600000000UL       // time(NULL) above this means SNTP has set the clock
+#define TS_INDEX_MAGIC 0x31535354UL       // "TSS1"
+
+static const uint32_t level_seconds[TS_LEVEL_COUNT] = {1, 60, 900, 3600};
+// Records per segment file: 1 h, 1 day, 1 week and 30 days of buckets (16 bytes each)
+static const uint32_t level_seg_records[TS_LEVEL_COUNT] = {3600, 1440, 672, 720};
+// Segments kept per level: 24 h of 1 s, 14 days of 1 min, 12 weeks of 15 min, ~2 years of 1 h
+static const uint32_t level_retention[TS_LEVEL_COUNT] = {24, 14, 12, 24};
+
+typedef struct __attribute__((packed)) {
+    uint32_t first_seg;                  // oldest segment still on the card
+    uint32_t last_seg;                   // segment currently being appended
+    uint32_t seg_start[TS_SEG_SLOTS];    // start time of segment n at [n % TS_SEG_SLOTS]
+} TsLevelIndex;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    TsLevelIndex level[TS_LEVEL_COUNT];
+} TsIndex;
+
+// Bucket being filled for one level (n == 0 means empty)
+typedef struct {
+    uint32_t t;
+    float min;
+    float max;
+    double sum;
+    uint32_t n;
+} TsAccum;
+
+typedef struct {
+    bool active;
+    char path[TS_PATH_LEN];
+    char dir[16];                        // /ts/<fnv1a hash>
+    // Guarded by ts_io_mutex (only touched while writing or reading files)
+    TsIndex index;
+    uint32_t last_count[TS_LEVEL_COUNT]; // records in last_seg
+    // Guarded by ts_state_mutex
+    uint32_t last_t[TS_LEVEL_COUNT];     // newest emitted bucket, keeps files time-ordered
+    bool has_data[TS_LEVEL_COUNT];
+    TsAccum acc[TS_LEVEL_COUNT];
+    TsRecord pending[TS_LEVEL_COUNT][TS_PENDING_MAX];
+    uint16_t pending_n[TS_LEVEL_COUNT];
+} TsSeries;
+
+static TsSeries* ts_series = NULL;       // TS_MAX_SERIES entries in PSRAM
+static TsRecord* ts_scratch = NULL;      // flush copy buffer (one level at a time)
+static SemaphoreHandle_t ts_state_mutex = NULL;
+static SemaphoreHandle_t ts_io_mutex = NULL;
+static TaskHandle_t ts_task_handle = NULL;
+static uint32_t ts_boot_base = 0;
+static volatile bool ts_flush_requested = false;
+
+static uint32_t fnv1a(const char* s) {
+    uint32_t h = 2166136261UL;
+    while (*s) { h ^= (uint8_t)*s++; h *= 16777619UL; }
+    return h;
+}
+
+static void ts_seg_name(const TsSeries* s, int level, uint32_t seg, char* out, size_t len) {
+    snprintf(out, len, "%s/L%d_%06lu.bin", s->dir, level, (unsigned long)seg);
+}
+
+uint32_t ts_store_level_seconds(TsLevel level) {
+    if (level < 0 || level >= TS_LEVEL_COUNT) return 1;
+    return level_seconds[level];
+}
+
+uint32_t ts_store_now(void) {
+    time_t now = time(NULL);
+    if ((unsigned long)now > TS_EPOCH_VALID) return (uint32_t)now;
+    return ts_boot_base + (uint32_t)(millis() / 1000UL);
+}
+
+// ---- State (ts_state_mutex held) ------------------------------------------
+
+static void ts_accum_add(TsSeries* s, int level, uint32_t t, float mn, float mx, double sum, uint32_t n);
+
+static void ts_emit(TsSeries* s, int level, const TsRecord& rec, uint32_t weight) {
+    // Buckets must be strictly increasing within a level for the binary search
+    if (s->has_data[level] && rec.t <= s->last_t[level]) return;
+    s->last_t[level] = rec.t;
+    s->has_data[level] = true;
+    if (s->pending_n[level] < TS_PENDING_MAX) {
+        s->pending[level][s->pending_n[level]++] = rec;
+    } else {
+        ts_flush_requested = true;  // writer fell behind; this bucket is dropped
+    }
+    if (s->pending_n[level] >= TS_FLUSH_BATCH) ts_flush_requested = true;
+    if (level + 1 < TS_LEVEL_COUNT) {
+        ts_accum_add(s, level + 1, rec.t, rec.min, rec.max, (double)rec.avg * weight, weight);
+    }
+}
+
+static void ts_accum_close(TsSeries* s, int level) {
+    TsAccum& a = s->acc[level];
+    if (a.n == 0) return;
+    TsRecord rec = { a.t, a.min, a.max, (float)(a.sum / a.n) };
+    uint32_t weight = a.n;
+    a.n = 0;
+    ts_emit(s, level, rec, weight);
+}
+
+static void ts_accum_add(TsSeries* s, int level, uint32_t t, float mn, float mx, double sum, uint32_t n) {
+    TsAccum& a = s->acc[level];
+    uint32_t bucket = t - (t % level_seconds[level]);
+    if (a.n > 0 && a.t != bucket) ts_accum_close(s, level);
+    if (a.n == 0) {
+        a.t = bucket;
+        a.min = mn;
+        a.max = mx;
+        a.sum = 0;
+    } else {
+        if (mn < a.min) a.min = mn;
+        if (mx > a.max) a.max = mx;
+    }
+    a.sum += sum;
+    a.n += n;
+}
+
+// Close buckets whose time span has passed so data stops lingering in RAM
+static void ts_close_expired(TsSeries* s, uint32_t now) {
+    for (int l = 0; l < TS_LEVEL_COUNT; ++l) {
+        TsAccum& a = s->acc[l];
+        if (a.n > 0 && now >= a.t + level_seconds[l]) ts_accum_close(s, l);
+    }
+}
+
+static TsSeries* ts_find(const char* path) {
+    if (!ts_series || !path || !path[0]) return NULL;
+    for (int i = 0; i < TS_MAX_SERIES; ++i) {
+        if (ts_series[i].active && strcmp(ts_series[i].path, path) == 0) return &ts_series[i];
+    }
+    return NULL;
+}
+
+// ---- Card I/O (ts_io_mutex held) ------------------------------------------
+
+static void ts_save_index(TsSeries* s) {
+    char p[48];
+    snprintf(p, sizeof(p), "%s/index.bin", s->dir);
+    File f = SD_MMC.open(p, FILE_WRITE);
+    if (!f) {
+        Serial.printf("[TS] Failed to write %s\n", p);
+        return;
+    }
+    f.write((const uint8_t*)&s->index, sizeof(TsIndex));
+    f.close();
+}
+
+static void ts_load_series(TsSeries* s, const char* path) {
+    memset(s, 0, sizeof(*s));
+    strncpy(s->path, path, TS_PATH_LEN - 1);
+    snprintf(s->dir, sizeof(s->dir), TS_ROOT "/%08lx", (unsigned long)fnv1a(path));
+    if (!SD_MMC.exists(s->dir)) SD_MMC.mkdir(s->dir);
+
+    char p[48];
+    snprintf(p, sizeof(p), "%s/index.bin", s->dir);
+    File f = SD_MMC.open(p, FILE_READ);
+    bool ok = false;
+    if (f) {
+        ok = f.read((uint8_t*)&s->index, sizeof(TsIndex)) == sizeof(TsIndex) && s->index.magic == TS_INDEX_MAGIC;
+        f.close();
+    }
+    if (!ok) {
+        memset(&s->index, 0, sizeof(TsIndex));
+        s->index.magic = TS_INDEX_MAGIC;
+        // Record the path alongside the hashed directory name for anyone browsing the card
+        snprintf(p, sizeof(p), "%s/path.txt", s->dir);
+        File pf = SD_MMC.open(p, FILE_WRITE);
+        if (pf) { pf.print(path); pf.close(); }
+        ts_save_index(s);
+    }
+
+    // Record count of the open segment comes from its size; the newest record
+    // gives the last bucket time so appends stay ordered across reboots.
+    for (int l = 0; l < TS_LEVEL_COUNT; ++l) {
+        char seg[48];
+        ts_seg_name(s, l, s->index.level[l].last_seg, seg, sizeof(seg));
+        File sf = SD_MMC.open(seg, FILE_READ);
+        if (!sf) continue;
+        uint32_t count = sf.size() / sizeof(TsRecord);
+        if (count > level_seg_records[l]) count = level_seg_records[l];
+        s->last_count[l] = count;
+        if (count > 0) {
+            TsRecord last;
+            sf.seek((count - 1) * sizeof(TsRecord));
+            if (sf.read((uint8_t*)&last, sizeof(last)) == sizeof(last)) {
+                s->last_t[l] = last.t;
+                s->has_data[l] = true;
+            }
+        }
+        sf.close();
+    }
+}
+
+static void ts_append(TsSeries* s, int level, const TsRecord* recs, size_t n) {
+    TsLevelIndex& li = s->index.level[level];
+    bool index_dirty = false;
+    while (n > 0) {
+        if (s->last_count[level] >= level_seg_records[level]) {
+            // Segment full: start the next one and drop segments beyond retention
+            li.last_seg++;
+            s->last_count[level] = 0;
+            while (li.last_seg - li.first_seg + 1 > level_retention[level]) {
+                char old[48];
+                ts_seg_name(s, level, li.first_seg, old, sizeof(old));
+                SD_MMC.remove(old);
+                li.first_seg++;
+            }
+            index_dirty = true;
+        }
+        if (s->last_count[level] == 0) {
+            li.seg_start[li.last_seg % TS_SEG_SLOTS] = recs[0].t;
+            index_dirty = true;
+        }
+        size_t room = level_seg_records[level] - s->last_count[level];
+        size_t k = n < room ? n : room;
+        char seg[48];
+        ts_seg_name(s, level, li.last_seg, seg, sizeof(seg));
+        File f = SD_MMC.open(seg, FILE_APPEND);
+        if (!f) {
+            Serial.printf("[TS] Failed to append %s\n", seg);
+            break;
+        }
+        size_t wrote = f.write((const uint8_t*)recs, k * sizeof(TsRecord));
+        f.close();
+        s->last_count[level] += wrote / sizeof(TsRecord);
+        if (wrote != k * sizeof(TsRecord)) break;
+        recs += k;
+        n -= k;
+    }
+    if (index_dirty) ts_save_index(s);
+}
+
+static void ts_flush_series(TsSeries* s) {
+    for (int l = 0; l < TS_LEVEL_COUNT; ++l) {
+        size_t n = 0;
+        if (xSemaphoreTake(ts_state_mutex, portMAX_DELAY) == pdTRUE) {
+            n = s->pending_n[l];
+            memcpy(ts_scratch, s->pending[l], n * sizeof(TsRecord));
+            s->pending_n[l] = 0;
+            xSemaphoreGive(ts_state_mutex);
+        }
+        if (n > 0) ts_append(s, l, ts_scratch, n);
+    }
+}
+
+static void ts_flush_all_locked(void) {
+    for (int i = 0; i < TS_MAX_SERIES; ++i) {
+        if (ts_series[i].active) ts_flush_series(&ts_series[i]);
+    }
+}
+
+void ts_store_flush(void) {
+    if (!ts_series || !ts_io_mutex) return;
+    if (xSemaphoreTake(ts_io_mutex, portMAX_DELAY) != pdTRUE) return;
+    ts_flush_all_locked();
+    xSemaphoreGive(ts_io_mutex);
+}
+
+// Track exactly the paths configured on graph screens
+static void ts_refresh_series(void) {
+    char wanted[TS_MAX_SERIES][TS_PATH_LEN];
+    int nw = 0;
+    // screen_configs is rewritten by the web task under the UI lock
+    ui_lock();
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        if (screen_configs[s].display_type != DISPLAY_TYPE_GRAPH) continue;
+        const char* paths[2] = { screen_configs[s].number_path, screen_configs[s].graph_path_2 };
+        for (int k = 0; k < 2; ++k) {
+            if (!paths[k][0]) continue;
+            bool dup = false;
+            for (int j = 0; j < nw; ++j) if (strncmp(wanted[j], paths[k], TS_PATH_LEN) == 0) dup = true;
+            if (dup || nw >= TS_MAX_SERIES) continue;
+            strncpy(wanted[nw], paths[k], TS_PATH_LEN - 1);
+            wanted[nw][TS_PATH_LEN - 1] = '\0';
+            nw++;
+        }
+    }
+    ui_unlock();
+
+    if (xSemaphoreTake(ts_io_mutex, portMAX_DELAY) != pdTRUE) return;
+    for (int i = 0; i < TS_MAX_SERIES; ++i) {
+        TsSeries* s = &ts_series[i];
+        if (!s->active) continue;
+        bool keep = false;
+        for (int j = 0; j < nw; ++j) if (strcmp(wanted[j], s->path) == 0) keep = true;
+        if (keep) continue;
+        ts_flush_series(s);
+        xSemaphoreTake(ts_state_mutex, portMAX_DELAY);
+        s->active = false;
+        xSemaphoreGive(ts_state_mutex);
+        Serial.printf("[TS] Stopped tracking %s\n", s->path);
+    }
+    for (int j = 0; j < nw; ++j) {
+        if (ts_find(wanted[j])) continue;
+        for (int i = 0; i < TS_MAX_SERIES; ++i) {
+            TsSeries* s = &ts_series[i];
+            if (s->active) continue;
+            ts_load_series(s, wanted[j]);
+            xSemaphoreTake(ts_state_mutex, portMAX_DELAY);
+            s->active = true;
+            xSemaphoreGive(ts_state_mutex);
+            Serial.printf("[TS] Tracking %s in %s\n", s->path, s->dir);
+            break;
+        }
+    }
+    xSemaphoreGive(ts_io_mutex);
+}
+
+static void ts_task(void* parameter) {
+    unsigned long last_flush = millis();
+    unsigned long last_refresh = millis();
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        unsigned long ms = millis();
+        if (ms - last_refresh >= TS_REFRESH_MS) {
+            last_refresh = ms;
+            ts_refresh_series();
+        }
+
+        // Closing buckets sets ts_flush_requested once a batch is pending
+        uint32_t now = ts_store_now();
+        xSemaphoreTake(ts_state_mutex, portMAX_DELAY);
+        for (int i = 0; i < TS_MAX_SERIES; ++i) {
+            if (ts_series[i].active) ts_close_expired(&ts_series[i], now);
+        }
+        xSemaphoreGive(ts_state_mutex);
+
+        if (ts_flush_requested || ms - last_flush >= TS_FLUSH_MS) {
+            ts_flush_requested = false;
+            last_flush = ms;
+            ts_store_flush();
+        }
+    }
+}
+
+void ts_store_init(void) {
+    if (ts_series) return;
+    if (!SD_IsMounted()) {
+        Serial.println("[TS] SD card not mounted; time-series store disabled");
+        return;
+    }
+    ts_series = (TsSeries*)heap_caps_calloc(TS_MAX_SERIES, sizeof(TsSeries), MALLOC_CAP_SPIRAM);
+    ts_scratch = (TsRecord*)heap_caps_malloc(TS_PENDING_MAX * sizeof(TsRecord), MALLOC_CAP_SPIRAM);
+    if (!ts_series || !ts_scratch) {
+        Serial.println("[TS] Out of PSRAM; time-series store disabled");
+        if (ts_series) heap_caps_free(ts_series);
+        if (ts_scratch) heap_caps_free(ts_scratch);
+        ts_series = NULL;
+        ts_scratch = NULL;
+        return;
+    }
+    ts_state_mutex = xSemaphoreCreateMutex();
+    ts_io_mutex = xSemaphoreCreateMutex();
+    if (!SD_MMC.exists(TS_ROOT)) SD_MMC.mkdir(TS_ROOT);
+
+    ts_refresh_series();
+
+    // Without a wall clock, continue from the newest stored bucket
+    for (int i = 0; i < TS_MAX_SERIES; ++i) {
+        if (ts_series[i].active && ts_series[i].last_t[TS_LEVEL_1S] >= ts_boot_base) {
+            ts_boot_base = ts_series[i].last_t[TS_LEVEL_1S] + 1;
+        }
+    }
+
+    xTaskCreatePinnedToCore(ts_task, "ts_store", 6144, NULL, 1, &ts_task_handle, 0);
+    Serial.printf("[TS] Time-series store started (base=%lu)\n", (unsigned long)ts_boot_base);
+}
+
+void ts_store_ingest(const char* path, float value) {
+    if (!ts_series || isnan(value) || isinf(value)) return;
+    uint32_t now = ts_store_now();
+    if (xSemaphoreTake(ts_state_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return;
+    TsSeries* s = ts_find(path);
+    if (s) ts_accum_add(s, TS_LEVEL_1S, now, value, value, value, 1);
+    xSemaphoreGive(ts_state_mutex);
+}
+
+// Index of the first record in an open segment with t >= t_from
+static uint32_t ts_lower_bound(File& f, uint32_t count, uint32_t t_from) {
+    uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        TsRecord r;
+        f.seek(mid * sizeof(TsRecord));
+        if (f.read((uint8_t*)&r, sizeof(r)) != sizeof(r)) return count;
+        if (r.t < t_from) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+size_t ts_store_query(const char* path, TsLevel level, uint32_t t_from, uint32_t t_to,
+                      TsRecord* out, size_t max_out) {
+    if (!ts_series || !out || max_out == 0 || level < 0 || level >= TS_LEVEL_COUNT) return 0;
+    if (xSemaphoreTake(ts_io_mutex, pdMS_TO_TICKS(500)) != pdTRUE) return 0;
+
+    size_t n = 0;
+    uint32_t newest = 0;
+    TsSeries* s = ts_find(path);
+    if (s) {
+        const TsLevelIndex& li = s->index.level[level];
+        bool any = s->last_count[level] > 0 || li.last_seg > li.first_seg;
+        uint32_t last = (s->last_count[level] > 0 || li.last_seg == li.first_seg) ? li.last_seg : li.last_seg - 1;
+        if (any) {
+            // Newest segment starting at or before t_from (else the oldest one)
+            uint32_t lo = li.first_seg, hi = last, seg = li.first_seg;
+            while (lo <= hi) {
+                uint32_t mid = lo + (hi - lo) / 2;
+                if (li.seg_start[mid % TS_SEG_SLOTS] <= t_from) { seg = mid; lo = mid + 1; }
+                else { if (mid == 0) break; hi = mid - 1; }
+            }
+            bool done = false;
+            for (; seg <= last && !done && n < max_out; ++seg) {
+                if (li.seg_start[seg % TS_SEG_SLOTS] > t_to) break;
+                char name[48];
+                ts_seg_name(s, level, seg, name, sizeof(name));
+                File f = SD_MMC.open(name, FILE_READ);
+                if (!f) continue;
+                uint32_t count = f.size() / sizeof(TsRecord);
+                uint32_t idx = ts_lower_bound(f, count, t_from);
+                f.seek(idx * sizeof(TsRecord));
+                TsRecord chunk[TS_READ_CHUNK];
+                while (idx < count && !done && n < max_out) {
+                    uint32_t want = count - idx;
+                    if (want > TS_READ_CHUNK) want = TS_READ_CHUNK;
+                    size_t got = f.read((uint8_t*)chunk, want * sizeof(TsRecord)) / sizeof(TsRecord);
+                    if (got == 0) break;
+                    for (size_t i = 0; i < got && n < max_out; ++i) {
+                        if (chunk[i].t > t_to) { done = true; break; }
+                        out[n++] = chunk[i];
+                        newest = chunk[i].t;
+                    }
+                    idx += got;
+                }
+                f.close();
+            }
+        }
+
+        // Records still batched in RAM, then the bucket currently being filled
+        xSemaphoreTake(ts_state_mutex, portMAX_DELAY);
+        for (uint16_t i = 0; i < s->pending_n[level] && n < max_out; ++i) {
+            const TsRecord& r = s->pending[level][i];
+            if (r.t < t_from || r.t > t_to || (n > 0 && r.t <= newest)) continue;
+            out[n++] = r;
+            newest = r.t;
+        }
+        const TsAccum& a = s->acc[level];
+        if (a.n > 0 && n < max_out && a.t >= t_from && a.t <= t_to && (n == 0 || a.t > newest)) {
+            TsRecord r = { a.t, a.min, a.max, (float)(a.sum / a.n) };
+            out[n++] = r;
+        }
+        xSemaphoreGive(ts_state_mutex);
+    }
+    xSemaphoreGive(ts_io_mutex);
+    return n;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Persistent multi-resolution time-series store on the SD card.
+//
+// Every Signal K path shown on a graph screen is rolled up into 1 s, 1 min,
+// 15 min and 1 h buckets (min/max/avg each). Each level is appended to
+// fixed-size segment files under /ts/<series>/ and a small per-series index
+// keeps the start time of every segment, so a range query is a binary search
+// over segments followed by a binary search inside one segment.
+// Completed buckets are batched in RAM and written roughly once a minute.
+
+typedef enum {
+    TS_LEVEL_1S = 0,
+    TS_LEVEL_1M = 1,
+    TS_LEVEL_15M = 2,
+    TS_LEVEL_1H = 3,
+    TS_LEVEL_COUNT = 4
+} TsLevel;
+
+typedef struct __attribute__((packed)) {
+    uint32_t t;     // bucket start in seconds (Unix time once the clock is set)
+    float min;
+    float max;
+    float avg;
+} TsRecord;
+
+// Load the per-series indexes and start the background writer task.
+// Call after the SD card is mounted and preferences are loaded.
+void ts_store_init(void);
+
+// Feed a new value for a Signal K path; ignored unless the path is tracked.
+void ts_store_ingest(const char* path, float value);
+
+// Copy records of one level with t_from <= t <= t_to into `out` (oldest first).
+// Includes batched records not yet on the card and the bucket still being filled.
+size_t ts_store_query(const char* path, TsLevel level, uint32_t t_from, uint32_t t_to,
+                      TsRecord* out, size_t max_out);
+
+// Bucket length of a level in seconds
+uint32_t ts_store_level_seconds(TsLevel level);
+
+// Current store time in seconds (wall clock when set, otherwise continues
+// from the newest stored record so time stays monotonic across reboots)
+uint32_t ts_store_now(void);
+
+// Write all batched records to the card now
+void ts_store_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,7 +1,7 @@
 #include "ui_Settings.h"
 #include "ui.h"
 #include "Display_ST7701.h"
-#include "TCA9554PWR.h"  // For buzzer control
+#include "buzzer.h"
 #include <WiFi.h>
 
 #include "sensESP_setup.h"
@@ -34,23 +34,11 @@ lv_obj_t *ui_BuzzerCooldownLabel = NULL;
 int buzzer_mode = 0;
 uint16_t buzzer_cooldown_sec = 60; // default 60s
 
-// Buzzer alert function - makes two beeps
+// Buzzer alert function - queues a double beep on the buzzer sequencer
 extern "C" void trigger_buzzer_alert() {
     if (buzzer_mode == 0) return; // disabled
     printf("trigger_buzzer_alert() called, buzzer_mode=%d\n", buzzer_mode);
-    // First beep
-    printf("  -> beep 1 on\n");
-    Set_EXIO(EXIO_PIN6, High);
-    delay(100);
-    Set_EXIO(EXIO_PIN6, Low);
-    printf("  -> beep 1 off\n");
-    delay(100);
-    // Second beep
-    printf("  -> beep 2 on\n");
-    Set_EXIO(EXIO_PIN6, High);
-    delay(100);
-    Set_EXIO(EXIO_PIN6, Low);
-    printf("  -> beep 2 off\n");
+    buzzer_play(BUZZER_DOUBLE_BEEP, BUZZER_PRIO_ALARM);
 }
 
 // Event handler for buzzer dropdown
@@ -5,6 +5,7 @@
 
 #include "ui_helpers.h"
 #include "screen_config_c_api.h"
+#include "alarm_engine.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -300,15 +301,8 @@ void _ui_apply_icon_style(lv_obj_t *img, int screen, int gauge)
    // Obtain runtime value (may be NAN)
    float runtime_value = ui_get_runtime_value(screen, gauge);
 
-   // Find the zone index (1..4) whose min/max contains runtime_value.
-   int chosen_zone = 1;
-   for (int z = 1; z <= 4; ++z) {
-      float mn = screen_configs[screen].min[gauge][z];
-      float mx = screen_configs[screen].max[gauge][z];
-      if (mn == mx) continue; // skip unconfigured zone
-      if (!isnan(runtime_value) && runtime_value >= mn && runtime_value <= mx) { chosen_zone = z; break; }
-      if (isnan(runtime_value) && (mn != 0.0f || mx != 0.0f)) { chosen_zone = z; break; }
-   }
+   // Zone selection (narrowest match, hysteresis, debounce) lives in the alarm engine
+   int chosen_zone = alarm_engine_zone(screen, gauge);
 
    // Diagnostic: Print transparent value for Min2 (zone 2) at runtime
    if (chosen_zone == 2) {
@@ -6,6 +6,8 @@
 #include "quad_number_display.h"
 #include "gauge_number_display.h"
 #include "graph_display.h"
+#include "alarm_engine.h"
+#include "redraw_filter.h"
 #include <lvgl.h>
 #include "esp_log.h"
 static const char *TAG_UIHOT = "ui_hotupdate";
@@ -159,148 +161,174 @@ bool apply_icons_for_screen(int s) {
     return any;
 }
 
+// Recreate the value widgets of one screen for its display type (number,
+// dual, quad, gauge+number, graph) and hide what that type does not use.
+// Returns true if a widget was recreated.
+bool apply_display_for_screen(int s) {
+    bool any = false;
+    // If this screen is set to number display mode, recreate the number display
+    // to apply any changes (font size, color, path, etc.)
+    if (screen_configs[s].display_type == DISPLAY_TYPE_NUMBER) {
+        // Destroy other display types first
+        dual_number_display_destroy(s);
+        quad_number_display_destroy(s);
+        gauge_number_display_destroy(s);
+        graph_display_destroy(s);
+        // Hide gauge needles (not used in number display)
+        lv_obj_t *upper_needle = get_upper_needle_obj_for_screen(s);
+        lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
+        if (upper_needle) lv_obj_add_flag(upper_needle, LV_OBJ_FLAG_HIDDEN);
+        if (lower_needle) lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_t *top_icon = get_top_icon_obj_for_screen(s);
+        lv_obj_t *bot_icon = get_bottom_icon_obj_for_screen(s);
+        if (top_icon) lv_obj_add_flag(top_icon, LV_OBJ_FLAG_HIDDEN);
+        if (bot_icon) lv_obj_add_flag(bot_icon, LV_OBJ_FLAG_HIDDEN);
+        number_display_create(s);
+        // Reset tracking to force immediate update with current sensor data
+        reset_number_display_tracking(s + 1);  // +1 because reset function expects 1-5
+        // Force immediate update so description and units appear right away
+        force_update_number_display(s + 1);
+        any = true;
+    } else if (screen_configs[s].display_type == DISPLAY_TYPE_DUAL) {
+        // Destroy other display types first
+        number_display_destroy(s);
+        quad_number_display_destroy(s);
+        gauge_number_display_destroy(s);
+        graph_display_destroy(s);
+        // Hide gauge needles (not used in dual display)
+        lv_obj_t *upper_needle = get_upper_needle_obj_for_screen(s);
+        lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
+        if (upper_needle) lv_obj_add_flag(upper_needle, LV_OBJ_FLAG_HIDDEN);
+        if (lower_needle) lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_t *top_icon = get_top_icon_obj_for_screen(s);
+        lv_obj_t *bot_icon = get_bottom_icon_obj_for_screen(s);
+        if (top_icon) lv_obj_add_flag(top_icon, LV_OBJ_FLAG_HIDDEN);
+        if (bot_icon) lv_obj_add_flag(bot_icon, LV_OBJ_FLAG_HIDDEN);
+        // Recreate dual display with updated settings
+        dual_number_display_create(
+            s,
+            screen_configs[s].dual_top_font_size,
+            screen_configs[s].dual_top_font_color,
+            screen_configs[s].dual_bottom_font_size,
+            screen_configs[s].dual_bottom_font_color,
+            screen_configs[s].number_bg_color
+        );
+        any = true;
+    } else if (screen_configs[s].display_type == DISPLAY_TYPE_QUAD) {
+        // Destroy other display types first
+        number_display_destroy(s);
+        dual_number_display_destroy(s);
+        gauge_number_display_destroy(s);
+        graph_display_destroy(s);
+        // Hide gauge needles (not used in quad display)
+        lv_obj_t *upper_needle = get_upper_needle_obj_for_screen(s);
+        lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
+        if (upper_needle) lv_obj_add_flag(upper_needle, LV_OBJ_FLAG_HIDDEN);
+        if (lower_needle) lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_t *top_icon = get_top_icon_obj_for_screen(s);
+        lv_obj_t *bot_icon = get_bottom_icon_obj_for_screen(s);
+        if (top_icon) lv_obj_add_flag(top_icon, LV_OBJ_FLAG_HIDDEN);
+        if (bot_icon) lv_obj_add_flag(bot_icon, LV_OBJ_FLAG_HIDDEN);
+        // Recreate quad display with updated settings
+        quad_number_display_create(
+            s,
+            screen_configs[s].quad_tl_font_size,
+            screen_configs[s].quad_tl_font_color,
+            screen_configs[s].quad_tr_font_size,
+            screen_configs[s].quad_tr_font_color,
+            screen_configs[s].quad_bl_font_size,
+            screen_configs[s].quad_bl_font_color,
+            screen_configs[s].quad_br_font_size,
+            screen_configs[s].quad_br_font_color,
+            screen_configs[s].number_bg_color
+        );
+        any = true;
+    } else if (screen_configs[s].display_type == DISPLAY_TYPE_GAUGE_NUMBER) {
+        // Destroy other display types first
+        number_display_destroy(s);
+        dual_number_display_destroy(s);
+        quad_number_display_destroy(s);
+        graph_display_destroy(s);
+        // Hide the bottom gauge needle (gauge+number only shows top gauge)
+        lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
+        if (lower_needle) {
+            lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
+        }
+        lv_obj_t *bot = get_bottom_icon_obj_for_screen(s);
+        if (bot) {
+            lv_obj_add_flag(bot, LV_OBJ_FLAG_HIDDEN);
+        }
+        // Recreate gauge+number display with updated settings
+        gauge_number_display_create(
+            s,
+            screen_configs[s].gauge_num_center_font_size,
+            screen_configs[s].gauge_num_center_font_color
+        );
+        any = true;
+    } else if (screen_configs[s].display_type == DISPLAY_TYPE_GRAPH) {
+        // Destroy other display types first
+        number_display_destroy(s);
+        dual_number_display_destroy(s);
+        quad_number_display_destroy(s);
+        gauge_number_display_destroy(s);
+        // Hide gauge needles (not used in graph display)
+        lv_obj_t *upper_needle = get_upper_needle_obj_for_screen(s);
+        lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
+        if (upper_needle) lv_obj_add_flag(upper_needle, LV_OBJ_FLAG_HIDDEN);
+        if (lower_needle) lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_t *top_icon = get_top_icon_obj_for_screen(s);
+        lv_obj_t *bot_icon = get_bottom_icon_obj_for_screen(s);
+        if (top_icon) lv_obj_add_flag(top_icon, LV_OBJ_FLAG_HIDDEN);
+        if (bot_icon) lv_obj_add_flag(bot_icon, LV_OBJ_FLAG_HIDDEN);
+        // Recreate graph display
+        graph_display_create(s);
+        any = true;
+    } else {
+        // Display type is GAUGE - destroy all number/dual/quad/gauge-number/graph displays to show gauges
+        number_display_destroy(s);
+        dual_number_display_destroy(s);
+        quad_number_display_destroy(s);
+        gauge_number_display_destroy(s);
+        graph_display_destroy(s);
+        // Show both gauge needles for regular gauge display
+        lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
+        if (lower_needle) {
+            if (screen_configs[s].show_bottom) {
+                lv_obj_clear_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
+            } else {
+                lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
+            }
+        }
+    }
+    return any;
+}
+
+// Apply every visual of a single screen after only that screen's config changed
+bool apply_screen_visuals(int s) {
+    if (s < 0 || s >= NUM_SCREENS) return false;
+    alarm_engine_rebuild();
+    redraw_filter_reset(s);
+    bool a = apply_background_for_screen(s);
+    bool b = apply_icons_for_screen(s);
+    bool c = apply_display_for_screen(s);
+    if (a || b || c) {
+        lv_refr_now(NULL);
+    }
+    return a || b || c;
+}
+
 // Apply visuals for all screens. Returns true if at least one target object was present.
 bool apply_all_screen_visuals() {
     bool any = false;
+    // Zone limits may have changed; recompile before icons are restyled
+    alarm_engine_rebuild();
+    // Widgets may be recreated below with placeholders; let the next values through
+    redraw_filter_reset_all();
     for (int s = 0; s < NUM_SCREENS; ++s) {
         bool a = apply_background_for_screen(s);
         bool b = apply_icons_for_screen(s);
-        any = any || a || b;
-        
-        // If this screen is set to number display mode, recreate the number display
-        // to apply any changes (font size, color, path, etc.)
-        if (screen_configs[s].display_type == DISPLAY_TYPE_NUMBER) {
-            // Destroy other display types first
-            dual_number_display_destroy(s);
-            quad_number_display_destroy(s);
-            gauge_number_display_destroy(s);
-            graph_display_destroy(s);
-            // Hide gauge needles (not used in number display)
-            lv_obj_t *upper_needle = get_upper_needle_obj_for_screen(s);
-            lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
-            if (upper_needle) lv_obj_add_flag(upper_needle, LV_OBJ_FLAG_HIDDEN);
-            if (lower_needle) lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
-            lv_obj_t *top_icon = get_top_icon_obj_for_screen(s);
-            lv_obj_t *bot_icon = get_bottom_icon_obj_for_screen(s);
-            if (top_icon) lv_obj_add_flag(top_icon, LV_OBJ_FLAG_HIDDEN);
-            if (bot_icon) lv_obj_add_flag(bot_icon, LV_OBJ_FLAG_HIDDEN);
-            number_display_create(s);
-            // Reset tracking to force immediate update with current sensor data
-            reset_number_display_tracking(s + 1);  // +1 because reset function expects 1-5
-            // Force immediate update so description and units appear right away
-            force_update_number_display(s + 1);
-            any = true;
-        } else if (screen_configs[s].display_type == DISPLAY_TYPE_DUAL) {
-            // Destroy other display types first
-            number_display_destroy(s);
-            quad_number_display_destroy(s);
-            gauge_number_display_destroy(s);
-            graph_display_destroy(s);
-            // Hide gauge needles (not used in dual display)
-            lv_obj_t *upper_needle = get_upper_needle_obj_for_screen(s);
-            lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
-            if (upper_needle) lv_obj_add_flag(upper_needle, LV_OBJ_FLAG_HIDDEN);
-            if (lower_needle) lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
-            lv_obj_t *top_icon = get_top_icon_obj_for_screen(s);
-            lv_obj_t *bot_icon = get_bottom_icon_obj_for_screen(s);
-            if (top_icon) lv_obj_add_flag(top_icon, LV_OBJ_FLAG_HIDDEN);
-            if (bot_icon) lv_obj_add_flag(bot_icon, LV_OBJ_FLAG_HIDDEN);
-            // Recreate dual display with updated settings
-            dual_number_display_create(
-                s,
-                screen_configs[s].dual_top_font_size,
-                screen_configs[s].dual_top_font_color,
-                screen_configs[s].dual_bottom_font_size,
-                screen_configs[s].dual_bottom_font_color,
-                screen_configs[s].number_bg_color
-            );
-            any = true;
-        } else if (screen_configs[s].display_type == DISPLAY_TYPE_QUAD) {
-            // Destroy other display types first
-            number_display_destroy(s);
-            dual_number_display_destroy(s);
-            gauge_number_display_destroy(s);
-            graph_display_destroy(s);
-            // Hide gauge needles (not used in quad display)
-            lv_obj_t *upper_needle = get_upper_needle_obj_for_screen(s);
-            lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
-            if (upper_needle) lv_obj_add_flag(upper_needle, LV_OBJ_FLAG_HIDDEN);
-            if (lower_needle) lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
-            lv_obj_t *top_icon = get_top_icon_obj_for_screen(s);
-            lv_obj_t *bot_icon = get_bottom_icon_obj_for_screen(s);
-            if (top_icon) lv_obj_add_flag(top_icon, LV_OBJ_FLAG_HIDDEN);
-            if (bot_icon) lv_obj_add_flag(bot_icon, LV_OBJ_FLAG_HIDDEN);
-            // Recreate quad display with updated settings
-            quad_number_display_create(
-                s,
-                screen_configs[s].quad_tl_font_size,
-                screen_configs[s].quad_tl_font_color,
-                screen_configs[s].quad_tr_font_size,
-                screen_configs[s].quad_tr_font_color,
-                screen_configs[s].quad_bl_font_size,
-                screen_configs[s].quad_bl_font_color,
-                screen_configs[s].quad_br_font_size,
-                screen_configs[s].quad_br_font_color,
-                screen_configs[s].number_bg_color
-            );
-            any = true;
-        } else if (screen_configs[s].display_type == DISPLAY_TYPE_GAUGE_NUMBER) {
-            // Destroy other display types first
-            number_display_destroy(s);
-            dual_number_display_destroy(s);
-            quad_number_display_destroy(s);
-            graph_display_destroy(s);
-            // Hide the bottom gauge needle (gauge+number only shows top gauge)
-            lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
-            if (lower_needle) {
-                lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
-            }
-            lv_obj_t *bot = get_bottom_icon_obj_for_screen(s);
-            if (bot) {
-                lv_obj_add_flag(bot, LV_OBJ_FLAG_HIDDEN);
-            }
-            // Recreate gauge+number display with updated settings
-            gauge_number_display_create(
-                s,
-                screen_configs[s].gauge_num_center_font_size,
-                screen_configs[s].gauge_num_center_font_color
-            );
-            any = true;
-        } else if (screen_configs[s].display_type == DISPLAY_TYPE_GRAPH) {
-            // Destroy other display types first
-            number_display_destroy(s);
-            dual_number_display_destroy(s);
-            quad_number_display_destroy(s);
-            gauge_number_display_destroy(s);
-            // Hide gauge needles (not used in graph display)
-            lv_obj_t *upper_needle = get_upper_needle_obj_for_screen(s);
-            lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
-            if (upper_needle) lv_obj_add_flag(upper_needle, LV_OBJ_FLAG_HIDDEN);
-            if (lower_needle) lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
-            lv_obj_t *top_icon = get_top_icon_obj_for_screen(s);
-            lv_obj_t *bot_icon = get_bottom_icon_obj_for_screen(s);
-            if (top_icon) lv_obj_add_flag(top_icon, LV_OBJ_FLAG_HIDDEN);
-            if (bot_icon) lv_obj_add_flag(bot_icon, LV_OBJ_FLAG_HIDDEN);
-            // Recreate graph display
-            graph_display_create(s);
-            any = true;
-        } else {
-            // Display type is GAUGE - destroy all number/dual/quad/gauge-number/graph displays to show gauges
-            number_display_destroy(s);
-            dual_number_display_destroy(s);
-            quad_number_display_destroy(s);
-            gauge_number_display_destroy(s);
-            graph_display_destroy(s);
-            // Show both gauge needles for regular gauge display
-            lv_obj_t *lower_needle = get_lower_needle_obj_for_screen(s);
-            if (lower_needle) {
-                if (screen_configs[s].show_bottom) {
-                    lv_obj_clear_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
-                } else {
-                    lv_obj_add_flag(lower_needle, LV_OBJ_FLAG_HIDDEN);
-                }
-            }
-        }
+        bool c = apply_display_for_screen(s);
+        any = any || a || b || c;
     }
     // Only force refresh if changes were made, for immediate user feedback
     if (any) {
@@ -0,0 +1,552 @@
+#include "web_config.h"
+#include "web_task.h"
+#include <ArduinoJson.h>
+#include <stddef.h>
+#include "sensESP_setup.h"
+#include "signalk_config.h"
+#include "screen_config_c_api.h"
+#include "gauge_config.h"
+#include "needle_style.h"
+#include "needle_motion.h"
+#include "alarm_engine.h"
+#include "redraw_filter.h"
+
+// REST resources for one screen, one gauge or one needle at a time.
+// GET returns the resource; PATCH takes a JSON object with any subset of its
+// fields, validates all of them before changing anything, stores only the
+// affected screen and re-applies only what the changed fields touch.
+// Screens are numbered 1..NUM_SCREENS as on the display; gauges are 0 (top)
+// and 1 (bottom) as on the needles page.
+
+extern String signalk_paths[NUM_SCREENS * 2];
+extern bool apply_background_for_screen(int s);
+extern bool apply_icons_for_screen(int s);
+extern bool apply_display_for_screen(int s);
+extern bool apply_screen_visuals(int s);
+
+#define API_PATCH_DOC_SIZE 4096
+#define API_ERR_LEN 96
+#define ZONES_PER_GAUGE 4     // zones 1..4 of ScreenConfig.min/max/color/...
+
+// What a patch touched, so only the matching parts are re-applied
+enum {
+    APPLY_BACKGROUND = 1 << 0,
+    APPLY_ICONS      = 1 << 1,   // icon image or position, bottom gauge shown
+    APPLY_DISPLAY    = 1 << 2,   // display type or number/graph widget settings
+    APPLY_ALARMS     = 1 << 3,   // zone limits, colours and buzzer flags
+    APPLY_CAL        = 1 << 4,   // calibration points or curve type
+    APPLY_PATHS      = 1 << 5,   // Signal K subscriptions
+    APPLY_REDRAW     = 1 << 6,   // redraw filter settings
+};
+
+typedef enum { FIELD_U8, FIELD_STR, FIELD_COLOR } FieldKind;
+
+// A scalar field of ScreenConfig that can be read and patched by name
+typedef struct {
+    const char *key;
+    uint8_t kind;
+    uint16_t offset;
+    uint8_t size;           // capacity including the terminator (strings)
+    uint8_t max;            // largest accepted value (FIELD_U8)
+    uint8_t apply;
+} ScreenField;
+
+#define SF_MEMBER_SIZE(f) sizeof(((ScreenConfig *)0)->f)
+#define SF_U8(f, mx, ap)  {#f, FIELD_U8, offsetof(ScreenConfig, f), 1, mx, ap}
+#define SF_STR(f, ap)     {#f, FIELD_STR, offsetof(ScreenConfig, f), SF_MEMBER_SIZE(f), 0, ap}
+#define SF_COLOR(f, ap)   {#f, FIELD_COLOR, offsetof(ScreenConfig, f), SF_MEMBER_SIZE(f), 0, ap}
+#define SF_NUMBER(prefix) \
+    SF_STR(prefix##_path, APPLY_PATHS | APPLY_DISPLAY), \
+    SF_U8(prefix##_font_size, NUMBER_FONT_XXLARGE, APPLY_DISPLAY), \
+    SF_COLOR(prefix##_font_color, APPLY_DISPLAY)
+
+static const ScreenField screen_fields[] = {
+    SF_U8(display_type, DISPLAY_TYPE_GRAPH, APPLY_BACKGROUND | APPLY_ICONS | APPLY_DISPLAY),
+    SF_U8(show_bottom, 1, APPLY_ICONS | APPLY_DISPLAY),
+    SF_STR(background_path, APPLY_BACKGROUND | APPLY_DISPLAY),
+    SF_COLOR(number_bg_color, APPLY_DISPLAY),
+    SF_NUMBER(number),
+    SF_NUMBER(dual_top),
+    SF_NUMBER(dual_bottom),
+    SF_NUMBER(quad_tl),
+    SF_NUMBER(quad_tr),
+    SF_NUMBER(quad_bl),
+    SF_NUMBER(quad_br),
+    SF_NUMBER(gauge_num_center),
+    SF_U8(graph_chart_type, GRAPH_CHART_SCATTER, APPLY_DISPLAY),
+    SF_U8(graph_time_range, GRAPH_TIME_7D, APPLY_DISPLAY),
+    SF_STR(graph_path_2, APPLY_PATHS | APPLY_DISPLAY),
+    SF_COLOR(graph_color_2, APPLY_DISPLAY),
+};
+#define SCREEN_FIELD_COUNT (sizeof(screen_fields) / sizeof(screen_fields[0]))
+
+// Working copy of everything a screen patch may change. Patches are applied
+// here first and only committed when every field validated.
+typedef struct {
+    ScreenConfig cfg;
+    GaugeCalibrationPoint cal[2][5];
+    char path[2][128];
+    uint16_t cubic_mask;
+    uint8_t apply;
+    char err[API_ERR_LEN];
+} ScreenPatch;
+
+// ---- Helpers -----------------------------------------------------------------
+
+static bool parse_index(const String &s, int lo, int hi, int *out) {
+    if (s.length() == 0 || s.length() > 3) return false;
+    for (size_t i = 0; i < s.length(); ++i) if (!isdigit((unsigned char)s[i])) return false;
+    int v = s.toInt();
+    if (v < lo || v > hi) return false;
+    *out = v;
+    return true;
+}
+
+static bool valid_color(const char *c) {
+    if (strlen(c) != 7 || c[0] != '#') return false;
+    for (int i = 1; i < 7; ++i) if (!isxdigit((unsigned char)c[i])) return false;
+    return true;
+}
+
+static bool patch_fail(ScreenPatch *p, const char *field, const char *msg) {
+    snprintf(p->err, sizeof(p->err), "%s: %s", field, msg);
+    return false;
+}
+
+static bool read_string(ScreenPatch *p, const char *field, JsonVariant v, char *dst, size_t cap) {
+    if (!v.is<const char *>()) return patch_fail(p, field, "must be a string");
+    const char *s = v.as<const char *>();
+    if (strlen(s) >= cap) return patch_fail(p, field, "too long");
+    memset(dst, 0, cap);
+    memcpy(dst, s, strlen(s));
+    return true;
+}
+
+static bool read_color(ScreenPatch *p, const char *field, JsonVariant v, char *dst) {
+    if (!v.is<const char *>() || !valid_color(v.as<const char *>())) return patch_fail(p, field, "must be #RRGGBB");
+    return read_string(p, field, v, dst, 8);
+}
+
+static bool read_number(ScreenPatch *p, const char *field, JsonVariant v, float lo, float hi, float *out) {
+    if (!v.is<float>()) return patch_fail(p, field, "must be a number");
+    float f = v.as<float>();
+    if (!(f >= lo && f <= hi)) return patch_fail(p, field, "out of range");
+    *out = f;
+    return true;
+}
+
+static bool read_flag(ScreenPatch *p, const char *field, JsonVariant v, int *out) {
+    if (v.is<bool>()) *out = v.as<bool>() ? 1 : 0;
+    else if (v.is<int>() && (v.as<int>() == 0 || v.as<int>() == 1)) *out = v.as<int>();
+    else return patch_fail(p, field, "must be true or false");
+    return true;
+}
+
+// ---- Serialisation -------------------------------------------------------------
+
+static void append_gauge(String &json, int s, int g) {
+    const ScreenConfig &c = screen_configs[s];
+    json += "{\"path\":";
+    web_json_str(json, signalk_paths[s * 2 + g].c_str());
+    json += ",\"icon\":";
+    web_json_str(json, c.icon_paths[g]);
+    json += ",\"icon_pos\":" + String(c.icon_pos[g]);
+    json += ",\"cubic\":" + String(((gauge_cal_cubic_mask >> (s * 2 + g)) & 1) ? "true" : "false");
+    json += ",\"calibration\":[";
+    for (int p = 0; p < 5; ++p) {
+        if (p) json += ",";
+        json += "{\"angle\":" + String(gauge_cal[s][g][p].angle) + ",\"value\":";
+        web_json_num(json, gauge_cal[s][g][p].value, 3);
+        json += "}";
+    }
+    json += "],\"zones\":[";
+    for (int z = 1; z <= ZONES_PER_GAUGE; ++z) {
+        if (z > 1) json += ",";
+        json += "{\"min\":";
+        web_json_num(json, c.min[g][z], 3);
+        json += ",\"max\":";
+        web_json_num(json, c.max[g][z], 3);
+        json += ",\"color\":";
+        web_json_str(json, c.color[g][z]);
+        json += ",\"transparent\":" + String(c.transparent[g][z] ? "true" : "false");
+        json += ",\"buzzer\":" + String(c.buzzer[g][z] ? "true" : "false") + "}";
+    }
+    json += "]}";
+}
+
+static void append_screen(String &json, int s) {
+    const uint8_t *base = (const uint8_t *)&screen_configs[s];
+    json += "{\"screen\":" + String(s + 1);
+    for (size_t i = 0; i < SCREEN_FIELD_COUNT; ++i) {
+        const ScreenField *f = &screen_fields[i];
+        json += ",\"" + String(f->key) + "\":";
+        if (f->kind == FIELD_U8) {
+            json += String(base[f->offset]);
+        } else {
+            // Copy out of the packed struct and make sure it is terminated
+            char buf[128];
+            memcpy(buf, base + f->offset, f->size);
+            buf[f->size - 1] = '\0';
+            web_json_str(json, buf);
+        }
+    }
+    json += ",\"redraw\":[";
+    for (int w = 0; w < WIDGET_SLOT_COUNT; ++w) {
+        if (w) json += ",";
+        json += "{\"deadband\":";
+        web_json_num(json, screen_configs[s].redraw_deadband[w], 3);
+        json += ",\"min_ms\":" + String(screen_configs[s].redraw_min_ms[w]);
+        json += ",\"resolution\":";
+        web_json_num(json, screen_configs[s].redraw_resolution[w], 3);
+        json += "}";
+    }
+    json += "],\"gauges\":[";
+    append_gauge(json, s, 0);
+    json += ",";
+    append_gauge(json, s, 1);
+    json += "]}";
+}
+
+// ---- Patching ------------------------------------------------------------------
+
+static void patch_begin(ScreenPatch *p, int s) {
+    memcpy(&p->cfg, &screen_configs[s], sizeof(ScreenConfig));
+    memcpy(p->cal, gauge_cal[s], sizeof(p->cal));
+    for (int g = 0; g < 2; ++g) snprintf(p->path[g], sizeof(p->path[g]), "%s", signalk_paths[s * 2 + g].c_str());
+    p->cubic_mask = gauge_cal_cubic_mask;
+    p->apply = 0;
+    p->err[0] = '\0';
+}
+
+static bool patch_gauge(ScreenPatch *p, int s, int g, JsonObject obj) {
+    ScreenConfig &c = p->cfg;
+    for (JsonPair kv : obj) {
+        const char *k = kv.key().c_str();
+        JsonVariant v = kv.value();
+        if (strcmp(k, "path") == 0) {
+            if (!read_string(p, k, v, p->path[g], sizeof(p->path[g]))) return false;
+            p->apply |= APPLY_PATHS | APPLY_ALARMS;
+        } else if (strcmp(k, "icon") == 0) {
+            if (!read_string(p, k, v, c.icon_paths[g], sizeof(c.icon_paths[g]))) return false;
+            p->apply |= APPLY_ICONS;
+        } else if (strcmp(k, "icon_pos") == 0) {
+            float pos;
+            if (!read_number(p, k, v, 0, 3, &pos)) return false;
+            c.icon_pos[g] = (uint8_t)pos;
+            p->apply |= APPLY_ICONS;
+        } else if (strcmp(k, "cubic") == 0) {
+            int on;
+            if (!read_flag(p, k, v, &on)) return false;
+            uint16_t bit = 1u << (s * 2 + g);
+            p->cubic_mask = on ? (p->cubic_mask | bit) : (p->cubic_mask & ~bit);
+            p->apply |= APPLY_CAL;
+        } else if (strcmp(k, "calibration") == 0) {
+            JsonArray arr = v.as<JsonArray>();
+            if (arr.isNull() || arr.size() > 5) return patch_fail(p, k, "must be an array of up to 5 points");
+            int i = 0;
+            for (JsonObject pt : arr) {
+                // Points are patched by position; missing keys keep their value
+                if (pt.containsKey("angle")) {
+                    float a;
+                    if (!read_number(p, "calibration.angle", pt["angle"], -360, 360, &a)) return false;
+                    p->cal[g][i].angle = (int)a;
+                }
+                if (pt.containsKey("value")) {
+                    float val;
+                    if (!read_number(p, "calibration.value", pt["value"], -1e9f, 1e9f, &val)) return false;
+                    p->cal[g][i].value = val;
+                }
+                i++;
+            }
+            p->apply |= APPLY_CAL;
+        } else if (strcmp(k, "zones") == 0) {
+            JsonArray arr = v.as<JsonArray>();
+            if (arr.isNull() || arr.size() > ZONES_PER_GAUGE) return patch_fail(p, k, "must be an array of up to 4 zones");
+            int z = 1;
+            for (JsonObject zo : arr) {
+                // ScreenConfig is packed, so values go through locals rather than member pointers
+                float lim;
+                int flag;
+                if (zo.containsKey("min")) {
+                    if (!read_number(p, "zones.min", zo["min"], -1e9f, 1e9f, &lim)) return false;
+                    c.min[g][z] = lim;
+                }
+                if (zo.containsKey("max")) {
+                    if (!read_number(p, "zones.max", zo["max"], -1e9f, 1e9f, &lim)) return false;
+                    c.max[g][z] = lim;
+                }
+                if (zo.containsKey("color") && !read_color(p, "zones.color", zo["color"], c.color[g][z])) return false;
+                if (zo.containsKey("transparent")) {
+                    if (!read_flag(p, "zones.transparent", zo["transparent"], &flag)) return false;
+                    c.transparent[g][z] = flag;
+                }
+                if (zo.containsKey("buzzer")) {
+                    if (!read_flag(p, "zones.buzzer", zo["buzzer"], &flag)) return false;
+                    c.buzzer[g][z] = flag;
+                }
+                z++;
+            }
+            p->apply |= APPLY_ALARMS;
+        } else {
+            return patch_fail(p, k, "unknown field");
+        }
+    }
+    return true;
+}
+
+static bool patch_screen(ScreenPatch *p, int s, JsonObject obj) {
+    uint8_t *base = (uint8_t *)&p->cfg;
+    for (JsonPair kv : obj) {
+        const char *k = kv.key().c_str();
+        JsonVariant v = kv.value();
+        const ScreenField *f = NULL;
+        for (size_t i = 0; i < SCREEN_FIELD_COUNT && !f; ++i) {
+            if (strcmp(screen_fields[i].key, k) == 0) f = &screen_fields[i];
+        }
+        if (f) {
+            if (f->kind == FIELD_U8) {
+                int flag;
+                float n;
+                if (f->max == 1 && v.is<bool>()) {
+                    read_flag(p, k, v, &flag);
+                    n = flag;
+                } else if (!read_number(p, k, v, 0, f->max, &n)) {
+                    return false;
+                }
+                base[f->offset] = (uint8_t)n;
+            } else if (f->kind == FIELD_COLOR) {
+                if (!read_color(p, k, v, (char *)base + f->offset)) return false;
+            } else if (!read_string(p, k, v, (char *)base + f->offset, f->size)) {
+                return false;
+            }
+            p->apply |= f->apply;
+        } else if (strcmp(k, "redraw") == 0) {
+            JsonArray arr = v.as<JsonArray>();
+            if (arr.isNull() || arr.size() > WIDGET_SLOT_COUNT) return patch_fail(p, k, "must be an array of up to 6 slots");
+            int w = 0;
+            for (JsonObject ro : arr) {
+                float n;
+                if (ro.containsKey("deadband")) {
+                    if (!read_number(p, "redraw.deadband", ro["deadband"], 0, 1e6f, &n)) return false;
+                    p->cfg.redraw_deadband[w] = n;
+                }
+                if (ro.containsKey("min_ms")) {
+                    if (!read_number(p, "redraw.min_ms", ro["min_ms"], 0, 60000, &n)) return false;
+                    p->cfg.redraw_min_ms[w] = (uint16_t)n;
+                }
+                if (ro.containsKey("resolution")) {
+                    if (!read_number(p, "redraw.resolution", ro["resolution"], 0, 1e6f, &n)) return false;
+                    p->cfg.redraw_resolution[w] = n;
+                }
+                w++;
+            }
+            p->apply |= APPLY_REDRAW;
+        } else if (strcmp(k, "gauges") == 0) {
+            JsonArray arr = v.as<JsonArray>();
+            if (arr.isNull() || arr.size() > 2) return patch_fail(p, k, "must be an array of up to 2 gauges");
+            int g = 0;
+            for (JsonObject go : arr) {
+                if (!patch_gauge(p, s, g++, go)) return false;
+            }
+        } else if (strcmp(k, "screen") != 0) {
+            return patch_fail(p, k, "unknown field");
+        }
+    }
+    return true;
+}
+
+// Commit a validated patch: copy it into the live config and re-apply what
+// changed under the UI lock, then persist the screen and refresh Signal K
+// without it. Only the web task writes the config, so reading it back
+// after ui_unlock() is safe.
+static void patch_commit(ScreenPatch *p, int s) {
+    uint32_t t0 = millis();
+    memcpy(p->cfg.cal, p->cal, sizeof(p->cal));
+    ui_lock();
+    uint32_t t_locked = millis();
+    memcpy(&screen_configs[s], &p->cfg, sizeof(ScreenConfig));
+    memcpy(gauge_cal[s], p->cal, sizeof(p->cal));
+    for (int g = 0; g < 2; ++g) signalk_paths[s * 2 + g] = String(p->path[g]);
+    gauge_cal_cubic_mask = p->cubic_mask;
+
+    if (p->apply & APPLY_CAL) gauge_cal_changed();
+    if ((p->apply & (APPLY_BACKGROUND | APPLY_DISPLAY)) == (APPLY_BACKGROUND | APPLY_DISPLAY)) {
+        apply_screen_visuals(s);        // rebuilds alarms and resets redraw filters too
+    } else {
+        if (p->apply & (APPLY_ALARMS | APPLY_ICONS)) alarm_engine_rebuild();
+        if (p->apply & (APPLY_DISPLAY | APPLY_REDRAW)) redraw_filter_reset(s);
+        if (p->apply & APPLY_BACKGROUND) apply_background_for_screen(s);
+        if (p->apply & APPLY_ICONS) apply_icons_for_screen(s);
+        if (p->apply & APPLY_DISPLAY) apply_display_for_screen(s);
+    }
+    ui_unlock();
+    uint32_t t_applied = millis();
+
+    save_screen_config(s);
+    if (p->apply & APPLY_PATHS) {
+        // Same as the gauges form: units and descriptions for the new paths
+        refresh_signalk_subscriptions();
+        fetch_all_metadata();
+    }
+    Serial.printf("[API] screen%d patched (apply 0x%02x): apply %lu ms (UI lock wait %lu ms), save %lu ms\n", s,
+                  (unsigned)p->apply, (unsigned long)(t_applied - t_locked), (unsigned long)(t_locked - t0),
+                  (unsigned long)(millis() - t_applied));
+}
+
+// Parse the body, patch a working copy of screen `s` (gauge `g`, or the
+// whole screen when g < 0) and commit it on success.
+// Returns false after sending the error response.
+static bool run_patch(int s, int g) {
+    DynamicJsonDocument doc(API_PATCH_DOC_SIZE);
+    DeserializationError err = deserializeJson(doc, config_server.arg("plain"));
+    if (err) {
+        web_json_error(400, err.c_str());
+        return false;
+    }
+    JsonObject obj = doc.as<JsonObject>();
+    if (obj.isNull()) {
+        web_json_error(400, "Body must be a JSON object");
+        return false;
+    }
+    // ScreenConfig is about 2 KB; keep it off the web server task's stack
+    ScreenPatch *p = (ScreenPatch *)malloc(sizeof(ScreenPatch));
+    if (!p) {
+        web_json_error(503, "Out of memory");
+        return false;
+    }
+    patch_begin(p, s);
+    bool ok = g < 0 ? patch_screen(p, s, obj) : patch_gauge(p, s, g, obj);
+    if (ok) patch_commit(p, s);
+    else web_json_error(400, p->err);
+    free(p);
+    return ok;
+}
+
+// ---- Handlers ------------------------------------------------------------------
+
+// /api/screens/{n}
+static void handle_api_screen() {
+    int n;
+    if (!parse_index(config_server.pathArg(0), 1, NUM_SCREENS, &n)) {
+        web_json_error(404, "No such screen");
+        return;
+    }
+    if (config_server.method() == HTTP_PATCH && !run_patch(n - 1, -1)) return;
+    String json;
+    json.reserve(3072);
+    append_screen(json, n - 1);
+    config_server.send(200, "application/json", json);
+}
+
+// /api/screens/{n}/gauges/{g}
+static void handle_api_gauge() {
+    int n, g;
+    if (!parse_index(config_server.pathArg(0), 1, NUM_SCREENS, &n) || !parse_index(config_server.pathArg(1), 0, 1, &g)) {
+        web_json_error(404, "No such gauge");
+        return;
+    }
+    if (config_server.method() == HTTP_PATCH && !run_patch(n - 1, g)) return;
+    String json;
+    json.reserve(768);
+    append_gauge(json, n - 1, g);
+    config_server.send(200, "application/json", json);
+}
+
+static void append_needle(String &json, const NeedleStyle &ns) {
+    json += "{\"color\":";
+    web_json_str(json, ns.color.c_str());
+    json += ",\"width\":" + String(ns.width);
+    json += ",\"inner\":" + String(ns.inner);
+    json += ",\"outer\":" + String(ns.outer);
+    json += ",\"cx\":" + String(ns.cx);
+    json += ",\"cy\":" + String(ns.cy);
+    json += ",\"rounded\":" + String(ns.rounded ? "true" : "false");
+    json += ",\"gradient\":" + String(ns.gradient ? "true" : "false");
+    json += ",\"foreground\":" + String(ns.foreground ? "true" : "false");
+    json += ",\"damping_ms\":" + String(ns.damping_ms);
+    json += ",\"max_rate\":" + String(ns.max_rate) + "}";
+}
+
+// Validate a needle patch into `ns`; same limits as the needles form
+static bool patch_needle(NeedleStyle &ns, JsonObject obj, char *err, size_t err_len) {
+    for (JsonPair kv : obj) {
+        const char *k = kv.key().c_str();
+        JsonVariant v = kv.value();
+        bool is_flag = strcmp(k, "rounded") == 0 || strcmp(k, "gradient") == 0 || strcmp(k, "foreground") == 0;
+        if (strcmp(k, "color") == 0) {
+            if (!v.is<const char *>() || !valid_color(v.as<const char *>())) { snprintf(err, err_len, "color: must be #RRGGBB"); return false; }
+            ns.color = v.as<const char *>();
+        } else if (is_flag) {
+            if (!v.is<bool>()) { snprintf(err, err_len, "%s: must be true or false", k); return false; }
+            bool b = v.as<bool>();
+            if (k[0] == 'r') ns.rounded = b;
+            else if (k[0] == 'g') ns.gradient = b;
+            else ns.foreground = b;
+        } else {
+            static const struct { const char *key; long lo, hi; } limits[] = {
+                {"width", 1, 64}, {"inner", 0, 2000}, {"outer", 0, 2000}, {"cx", 0, 2000}, {"cy", 0, 2000},
+                {"damping_ms", 0, NEEDLE_MAX_DAMPING_MS}, {"max_rate", 0, NEEDLE_MAX_RATE_DPS},
+            };
+            int li = -1;
+            for (int i = 0; i < (int)(sizeof(limits) / sizeof(limits[0])); ++i) if (strcmp(limits[i].key, k) == 0) li = i;
+            if (li < 0) { snprintf(err, err_len, "%s: unknown field", k); return false; }
+            if (!v.is<int>()) { snprintf(err, err_len, "%s: must be a whole number", k); return false; }
+            long x = v.as<long>();
+            if (x < limits[li].lo || x > limits[li].hi) { snprintf(err, err_len, "%s: out of range", k); return false; }
+            switch (li) {
+                case 0: ns.width = (uint16_t)x; break;
+                case 1: ns.inner = (int16_t)x; break;
+                case 2: ns.outer = (int16_t)x; break;
+                case 3: ns.cx = (uint16_t)x; break;
+                case 4: ns.cy = (uint16_t)x; break;
+                case 5: ns.damping_ms = (uint16_t)x; break;
+                default: ns.max_rate = (uint16_t)x; break;
+            }
+        }
+    }
+    return true;
+}
+
+// /api/needles/{n}/{g}
+static void handle_api_needle() {
+    int n, g;
+    if (!parse_index(config_server.pathArg(0), 1, NUM_SCREENS, &n) || !parse_index(config_server.pathArg(1), 0, 1, &g)) {
+        web_json_error(404, "No such needle");
+        return;
+    }
+    NeedleStyle ns = get_needle_style(n - 1, g);
+    if (config_server.method() == HTTP_PATCH) {
+        DynamicJsonDocument doc(512);
+        DeserializationError derr = deserializeJson(doc, config_server.arg("plain"));
+        JsonObject obj = doc.as<JsonObject>();
+        if (derr || obj.isNull()) {
+            web_json_error(400, derr ? derr.c_str() : "Body must be a JSON object");
+            return;
+        }
+        char err[API_ERR_LEN];
+        if (!patch_needle(ns, obj, err, sizeof(err))) {
+            web_json_error(400, err);
+            return;
+        }
+        save_needle_style_from_args(n - 1, g, ns.color, ns.width, ns.inner, ns.outer, ns.cx, ns.cy,
+                                    ns.rounded, ns.gradient, ns.foreground, ns.damping_ms, ns.max_rate);
+        ui_lock();
+        apply_needle_style(n - 1, g);
+        ui_unlock();
+    }
+    String json;
+    append_needle(json, ns);
+    config_server.send(200, "application/json", json);
+}
+
+void web_api_screens_register(HttpServer &server) {
+    // "{}" matches exactly one segment, so the order here does not matter.
+    // The PATCH handlers take the UI lock themselves, only while they apply
+    // the change, so saving to flash does not hold up the display.
+    web_on(server, "/api/screens/{}/gauges/{}", HTTP_GET, handle_api_gauge, 0);
+    web_on(server, "/api/screens/{}/gauges/{}", HTTP_PATCH, handle_api_gauge, 0);
+    web_on(server, "/api/needles/{}/{}", HTTP_GET, handle_api_needle, 0);
+    web_on(server, "/api/needles/{}/{}", HTTP_PATCH, handle_api_needle, 0);
+    web_on(server, "/api/screens/{}", HTTP_GET, handle_api_screen, 0);
+    web_on(server, "/api/screens/{}", HTTP_PATCH, handle_api_screen, 0);
+}
@@ -0,0 +1,100 @@
+#include "web_config.h"
+#include <FS.h>
+#include <SPIFFS.h>
+#include "web_task.h"
+
+#define WEB_ROOT "/www"
+
+// One gzipped file of the web app. The ETag is a hash of the stored bytes,
+// computed once at registration; the files only change with an uploadfs.
+typedef struct {
+    const char *uri;
+    const char *file;
+    const char *mime;
+    bool immutable;         // URL carries a content hash (?v=...)
+    char etag[12];          // "\"xxxxxxxx\"", empty when the file is missing
+} WebAppFile;
+
+static WebAppFile web_files[] = {
+    {"/",        WEB_ROOT "/index.html.gz", "text/html",              false, ""},
+    {"/app.js",  WEB_ROOT "/app.js.gz",     "application/javascript", true,  ""},
+    {"/app.css", WEB_ROOT "/app.css.gz",    "text/css",               true,  ""},
+};
+#define WEB_FILE_COUNT (sizeof(web_files) / sizeof(web_files[0]))
+
+static HttpServer *web_server = NULL;
+static HttpServer::THandlerFunction web_legacy_root;
+static bool web_app_present = false;
+
+static bool hash_file(const char *path, char *etag, size_t len) {
+    File f = SPIFFS.open(path, "r");
+    if (!f) return false;
+    uint32_t h = 2166136261UL;
+    uint8_t buf[512];
+    size_t n;
+    while ((n = f.read(buf, sizeof(buf))) > 0) {
+        for (size_t i = 0; i < n; i++) { h ^= buf[i]; h *= 16777619UL; }
+    }
+    f.close();
+    snprintf(etag, len, "\"%08lx\"", (unsigned long)h);
+    return true;
+}
+
+static void serve_file(const WebAppFile *wf) {
+    HttpServer &server = *web_server;
+    if (server.hasHeader("If-None-Match") && server.header("If-None-Match") == wf->etag) {
+        server.sendHeader("ETag", wf->etag);
+        server.send(304, wf->mime, "");
+        return;
+    }
+    File f = SPIFFS.open(wf->file, "r");
+    if (!f) {
+        server.send(404, "text/plain", "Not found");
+        return;
+    }
+    server.sendHeader("ETag", wf->etag);
+    server.sendHeader("Cache-Control", wf->immutable ? "public, max-age=31536000, immutable" : "no-cache");
+    // streamFile adds Content-Encoding: gzip for a .gz file and sends it in
+    // HTTP_FILE_CHUNK pieces straight from flash
+    server.streamFile(f, wf->mime);
+    f.close();
+}
+
+static void handle_app_file() {
+    String uri = web_server->uri();
+    for (size_t i = 0; i < WEB_FILE_COUNT; i++) {
+        const WebAppFile *wf = &web_files[i];
+        if (uri != wf->uri) continue;
+        if (wf->etag[0]) serve_file(wf);
+        else if (i == 0 && web_legacy_root) web_legacy_root();
+        else web_server->send(404, "text/plain", "Not found");
+        return;
+    }
+    web_server->send(404, "text/plain", "Not found");
+}
+
+void web_config_register(HttpServer &server, HttpServer::THandlerFunction legacy_root) {
+    web_server = &server;
+    web_legacy_root = legacy_root;
+
+    int found = 0;
+    for (size_t i = 0; i < WEB_FILE_COUNT; i++) {
+        if (hash_file(web_files[i].file, web_files[i].etag, sizeof(web_files[i].etag))) found++;
+        else web_files[i].etag[0] = '\0';
+        web_on(server, web_files[i].uri, HTTP_GET, handle_app_file, 0);
+    }
+    web_app_present = web_files[0].etag[0] != '\0';
+    Serial.printf("[WEB] Web app: %d of %u files in SPIFFS%s\n", found, (unsigned)WEB_FILE_COUNT,
+                  web_app_present ? "" : " (serving the built-in menu at /)");
+
+    web_on(server, "/menu", HTTP_GET, legacy_root, 0);
+    web_on(server, "/api/state", HTTP_GET, handle_api_state_get, 0);
+    web_on(server, "/api/state", HTTP_POST, handle_api_state_post);
+    web_on(server, "/api/config", HTTP_GET, handle_api_config_get, 0);
+    web_on(server, "/api/config", HTTP_POST, handle_api_config_post);
+    web_api_screens_register(server);
+}
+
+bool web_config_app_present(void) {
+    return web_app_present;
+}
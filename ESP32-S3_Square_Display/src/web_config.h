@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+#include "http_server.h"
+
+// Single-page web UI served from SPIFFS plus the JSON API it talks to.
+//
+// The page sources live in web/ and are gzipped into data/www/ by
+// scripts/build_web.py at build time (upload with `pio run -t uploadfs`).
+// Files are sent as stored, with Content-Encoding: gzip. index.html is
+// revalidated on every load through its ETag; app.js and app.css are
+// referenced with a content hash in the query string and cached for a year.
+// When the SPIFFS image has no web app, "/" keeps serving the
+// server-rendered menu, which is also always reachable at /menu.
+
+// Register the static files, "/" and the JSON API routes.
+// `legacy_root` renders the server-side menu.
+void web_config_register(HttpServer &server, HttpServer::THandlerFunction legacy_root);
+
+// True when /www/index.html.gz was found at registration
+bool web_config_app_present(void);
+
+// JSON helpers shared by the API handlers: append a quoted, escaped string;
+// append a number (null when not finite); send {"error": msg}
+void web_json_str(String &out, const char *s);
+void web_json_num(String &out, float v, int decimals);
+void web_json_error(int code, const char *msg);
+
+// JSON API handlers (web_config_handlers.cpp)
+void handle_api_state_get();
+void handle_api_state_post();
+void handle_api_config_get();
+void handle_api_config_post();
+
+// GET/PATCH /api/screens/{n}, /api/screens/{n}/gauges/{g} and
+// /api/needles/{n}/{g} (web_api_screens.cpp)
+void web_api_screens_register(HttpServer &server);
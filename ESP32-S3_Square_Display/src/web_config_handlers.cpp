@@ -0,0 +1,286 @@
+#include "web_config.h"
+#include <WiFi.h>
+#include <ArduinoJson.h>
+#include <math.h>
+#include "sensESP_setup.h"
+#include "signalk_config.h"
+#include "screen_config_c_api.h"
+#include "signal_filter.h"
+#include "derived_values.h"
+
+extern String saved_ssid;
+extern String saved_signalk_ip;
+extern uint16_t saved_signalk_port;
+extern String saved_hostname;
+extern String signalk_paths[NUM_SCREENS * 2];
+extern int buzzer_mode;
+extern uint16_t buzzer_cooldown_sec;
+extern bool first_run_buzzer;
+extern void save_preferences();
+extern "C" int ui_get_current_screen(void);
+extern "C" void ui_set_screen(int screen_num);
+
+#define API_BODY_DOC_SIZE 6144
+
+// ---- JSON output helpers ----------------------------------------------------
+
+void web_json_str(String &out, const char *s) {
+    out += '"';
+    for (; *s; s++) {
+        char c = *s;
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((uint8_t)c < 0x20) { char esc[8]; snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)c); out += esc; }
+        else out += c;
+    }
+    out += '"';
+}
+
+void web_json_num(String &out, float v, int decimals) {
+    if (isfinite(v)) out += String(v, decimals);
+    else out += "null";
+}
+
+void web_json_error(int code, const char *msg) {
+    String json = "{\"error\":";
+    web_json_str(json, msg);
+    json += "}";
+    config_server.send(code, "application/json", json);
+}
+
+// Paths a screen shows for its display type, with a short slot name
+typedef struct {
+    const char *slot;
+    const char *path;
+} ScreenBinding;
+
+static int screen_bindings(int s, ScreenBinding *out) {
+    const ScreenConfig &sc = screen_configs[s];
+    int n = 0;
+    switch (sc.display_type) {
+        case DISPLAY_TYPE_NUMBER:
+            out[n++] = {"number", sc.number_path};
+            break;
+        case DISPLAY_TYPE_DUAL:
+            out[n++] = {"top", sc.dual_top_path};
+            out[n++] = {"bottom", sc.dual_bottom_path};
+            break;
+        case DISPLAY_TYPE_QUAD:
+            out[n++] = {"top_left", sc.quad_tl_path};
+            out[n++] = {"top_right", sc.quad_tr_path};
+            out[n++] = {"bottom_left", sc.quad_bl_path};
+            out[n++] = {"bottom_right", sc.quad_br_path};
+            break;
+        case DISPLAY_TYPE_GAUGE_NUMBER:
+            out[n++] = {"gauge", signalk_paths[s * 2].c_str()};
+            out[n++] = {"center", sc.gauge_num_center_path};
+            break;
+        case DISPLAY_TYPE_GRAPH:
+            out[n++] = {"series_1", sc.number_path};
+            out[n++] = {"series_2", sc.graph_path_2};
+            break;
+        default:
+            out[n++] = {"gauge_top", signalk_paths[s * 2].c_str()};
+            if (sc.show_bottom) out[n++] = {"gauge_bottom", signalk_paths[s * 2 + 1].c_str()};
+            break;
+    }
+    return n;
+}
+
+// ---- /api/state -------------------------------------------------------------
+
+// Live state: current screen, network, memory and the value of every bound path
+void handle_api_state_get() {
+    String json;
+    json.reserve(1024);
+    json += "{\"screen\":" + String(ui_get_current_screen());
+    json += ",\"num_screens\":" + String(NUM_SCREENS);
+    json += ",\"uptime_ms\":" + String(millis());
+    json += ",\"heap_free\":" + String(ESP.getFreeHeap());
+    json += ",\"psram_free\":" + String(ESP.getFreePsram());
+    json += ",\"wifi\":{\"connected\":" + String(WiFi.isConnected() ? "true" : "false");
+    json += ",\"ip\":\"" + (WiFi.isConnected() ? WiFi.localIP() : WiFi.softAPIP()).toString() + "\"";
+    json += ",\"rssi\":" + String(WiFi.isConnected() ? WiFi.RSSI() : 0);
+    json += ",\"hostname\":";
+    web_json_str(json, saved_hostname.c_str());
+    json += "},\"screens\":[";
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        if (s) json += ",";
+        json += "{\"display_type\":" + String(screen_configs[s].display_type) + ",\"values\":[";
+        ScreenBinding b[4];
+        int nb = screen_bindings(s, b);
+        bool first = true;
+        for (int i = 0; i < nb; ++i) {
+            if (!b[i].path[0]) continue;
+            String path(b[i].path);
+            if (!first) json += ",";
+            first = false;
+            json += "{\"slot\":\"" + String(b[i].slot) + "\",\"path\":";
+            web_json_str(json, b[i].path);
+            json += ",\"value\":";
+            web_json_num(json, get_sensor_value_by_path(path), 4);
+            json += ",\"unit\":";
+            web_json_str(json, get_sensor_unit_by_path(path).c_str());
+            json += "}";
+        }
+        json += "]}";
+    }
+    json += "]}";
+    config_server.send(200, "application/json", json);
+}
+
+// {"screen": n} switches the display to screen n (1-based)
+void handle_api_state_post() {
+    DynamicJsonDocument doc(256);
+    if (deserializeJson(doc, config_server.arg("plain"))) {
+        web_json_error(400, "Invalid JSON");
+        return;
+    }
+    if (doc.containsKey("screen")) {
+        int s = doc["screen"].as<int>();
+        if (s < 1 || s > NUM_SCREENS) {
+            web_json_error(400, "screen out of range");
+            return;
+        }
+        ui_set_screen(s);
+    }
+    handle_api_state_get();
+}
+
+// ---- /api/config ------------------------------------------------------------
+
+// Device settings, a summary of each screen and the filter and formula tables
+void handle_api_config_get() {
+    String json;
+    json.reserve(4096);
+    json += "{\"device\":{\"hostname\":";
+    web_json_str(json, saved_hostname.c_str());
+    json += ",\"ssid\":";
+    web_json_str(json, saved_ssid.c_str());
+    json += ",\"signalk_ip\":";
+    web_json_str(json, saved_signalk_ip.c_str());
+    json += ",\"signalk_port\":" + String(saved_signalk_port);
+    json += ",\"buzzer_mode\":" + String(buzzer_mode);
+    json += ",\"buzzer_cooldown\":" + String(buzzer_cooldown_sec);
+    json += ",\"auto_scroll\":" + String(auto_scroll_sec) + "}";
+
+    json += ",\"screens\":[";
+    for (int s = 0; s < NUM_SCREENS; ++s) {
+        if (s) json += ",";
+        json += "{\"display_type\":" + String(screen_configs[s].display_type) + ",\"paths\":{";
+        ScreenBinding b[4];
+        int nb = screen_bindings(s, b);
+        for (int i = 0; i < nb; ++i) {
+            if (i) json += ",";
+            json += "\"" + String(b[i].slot) + "\":";
+            web_json_str(json, b[i].path);
+        }
+        json += "}}";
+    }
+
+    json += "],\"filters\":[";
+    SignalFilterConfig fc[SIGNAL_FILTER_MAX_PATHS];
+    int nf = signal_filter_get_config(fc, SIGNAL_FILTER_MAX_PATHS);
+    for (int i = 0; i < nf; ++i) {
+        if (i) json += ",";
+        json += "{\"path\":";
+        web_json_str(json, fc[i].path);
+        json += ",\"median\":" + String(fc[i].median_len);
+        json += ",\"rate_limit\":" + String(fc[i].rate_limit, 4);
+        json += ",\"ema_tau\":" + String(fc[i].ema_tau_s, 3);
+        json += ",\"kalman_q\":" + String(fc[i].kalman_q, 5);
+        json += ",\"kalman_r\":" + String(fc[i].kalman_r, 5);
+        json += ",\"circular\":" + String(fc[i].circular) + "}";
+    }
+
+    json += "],\"derived\":[";
+    DerivedConfig dc[DERIVED_MAX];
+    int nd = derived_values_get_config(dc, DERIVED_MAX);
+    for (int i = 0; i < nd; ++i) {
+        DerivedStatus st;
+        derived_values_get_status(i, &st);
+        if (i) json += ",";
+        json += "{\"name\":";
+        web_json_str(json, dc[i].name);
+        json += ",\"formula\":";
+        web_json_str(json, dc[i].formula);
+        json += ",\"compiled\":" + String(st.compiled ? "true" : "false");
+        json += ",\"error\":";
+        web_json_str(json, st.error);
+        json += ",\"value\":";
+        web_json_num(json, st.evals ? st.value : NAN, 4);
+        json += ",\"code_len\":" + String(st.code_len) + "}";
+    }
+    json += "]}";
+    config_server.send(200, "application/json", json);
+}
+
+// Apply any of "device", "filters" and "derived" from the posted document.
+// The filter and formula arrays replace their whole tables, like the forms.
+// Network settings need a reboot and stay on the /network page.
+void handle_api_config_post() {
+    DynamicJsonDocument doc(API_BODY_DOC_SIZE);
+    DeserializationError err = deserializeJson(doc, config_server.arg("plain"));
+    if (err) {
+        web_json_error(400, err.c_str());
+        return;
+    }
+
+    JsonObject dev = doc["device"];
+    if (!dev.isNull()) {
+        if (dev.containsKey("buzzer_mode")) {
+            int bm = dev["buzzer_mode"].as<int>();
+            if (bm < 0 || bm > 2) { web_json_error(400, "buzzer_mode must be 0, 1 or 2"); return; }
+            buzzer_mode = bm;
+            first_run_buzzer = true;
+        }
+        if (dev.containsKey("buzzer_cooldown")) {
+            buzzer_cooldown_sec = (uint16_t)constrain(dev["buzzer_cooldown"].as<long>(), 0L, 3600L);
+        }
+        if (dev.containsKey("auto_scroll")) {
+            auto_scroll_sec = (uint16_t)constrain(dev["auto_scroll"].as<long>(), 0L, 3600L);
+            set_auto_scroll_interval(auto_scroll_sec);
+        }
+        save_preferences();
+        Serial.printf("[API] device: buzzer_mode=%d buzzer_cooldown_sec=%u auto_scroll=%u\n",
+                      buzzer_mode, (unsigned)buzzer_cooldown_sec, (unsigned)auto_scroll_sec);
+    }
+
+    JsonArray filters = doc["filters"];
+    if (!filters.isNull()) {
+        SignalFilterConfig cfg[SIGNAL_FILTER_MAX_PATHS];
+        int n = 0;
+        for (JsonObject f : filters) {
+            const char *path = f["path"] | "";
+            if (!path[0] || n >= SIGNAL_FILTER_MAX_PATHS) continue;
+            SignalFilterConfig &c = cfg[n++];
+            memset(&c, 0, sizeof(c));
+            strncpy(c.path, path, SIGNAL_FILTER_PATH_LEN - 1);
+            c.median_len = (uint8_t)constrain(f["median"] | 0L, 0L, (long)SIGNAL_FILTER_MEDIAN_MAX);
+            c.rate_limit = f["rate_limit"] | 0.0f;
+            c.ema_tau_s = f["ema_tau"] | 0.0f;
+            c.kalman_q = f["kalman_q"] | 0.0f;
+            c.kalman_r = f["kalman_r"] | 0.0f;
+            c.circular = (uint8_t)constrain(f["circular"] | 0L, 0L, (long)SIGNAL_FILTER_CIRCULAR_PI);
+        }
+        signal_filter_set_config(cfg, n);
+    }
+
+    JsonArray derived = doc["derived"];
+    if (!derived.isNull()) {
+        DerivedConfig cfg[DERIVED_MAX];
+        int n = 0;
+        for (JsonObject d : derived) {
+            const char *name = d["name"] | "";
+            if (!name[0] || n >= DERIVED_MAX) continue;
+            DerivedConfig &c = cfg[n++];
+            memset(&c, 0, sizeof(c));
+            strncpy(c.name, name, DERIVED_NAME_LEN - 1);
+            strncpy(c.formula, d["formula"] | "", DERIVED_FORMULA_LEN - 1);
+        }
+        derived_values_set_config(cfg, n);
+        // Input paths may have changed
+        refresh_signalk_subscriptions();
+    }
+
+    handle_api_config_get();
+}
@@ -0,0 +1,139 @@
+#include "web_task.h"
+#include <string.h>
+
+#define WEB_TASK_PRIORITY   1       // below the Signal K task (3) on core 0
+#define WEB_TASK_CORE       0
+
+typedef struct {
+    const char *uri;
+    HTTPMethod method;
+    uint8_t flags;
+    size_t max_body;
+    uint32_t count;
+    uint32_t rejected;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t lock_wait_max_us;
+} WebRoute;
+
+// Only the web task touches the routes after registration, and /api/perf
+// runs on that task too, so the counters need no locking
+static WebRoute web_routes[WEB_ROUTE_MAX];
+static int web_route_count = 0;
+static HttpServer *web_server = NULL;
+static SemaphoreHandle_t ui_mutex = NULL;
+static bool web_started = false;
+
+static const char *method_name(HTTPMethod m) {
+    switch (m) {
+        case HTTP_GET: return "GET";
+        case HTTP_POST: return "POST";
+        case HTTP_PUT: return "PUT";
+        case HTTP_PATCH: return "PATCH";
+        case HTTP_DELETE: return "DELETE";
+        case HTTP_ANY: return "ANY";
+        default: return "OTHER";
+    }
+}
+
+void ui_lock(void) {
+    if (ui_mutex) xSemaphoreTake(ui_mutex, portMAX_DELAY);
+}
+
+void ui_unlock(void) {
+    if (ui_mutex) xSemaphoreGive(ui_mutex);
+}
+
+static bool over_limit(const WebRoute *r) {
+    return r->max_body && web_server->clientContentLength() > r->max_body;
+}
+
+static void web_dispatch(WebRoute *r, const HttpServer::THandlerFunction &fn) {
+    uint32_t t0 = micros();
+    if (over_limit(r)) {
+        r->rejected++;
+        Serial.printf("[WEB] %s %s: body of %u bytes over the %u byte limit\n", method_name(r->method), r->uri,
+                      (unsigned)web_server->clientContentLength(), (unsigned)r->max_body);
+        web_server->send(413, "text/plain", "Request too large");
+        web_server->closeConnection();
+        return;
+    }
+    // Read the body (and stream any upload) before taking the UI lock
+    if (!web_server->readBody()) {
+        r->rejected++;
+        web_server->send(400, "text/plain", "Bad request body");
+        return;
+    }
+    uint32_t wait_us = 0;
+    if (r->flags & WEB_ROUTE_UI) {
+        ui_lock();
+        wait_us = micros() - t0;
+    }
+    fn();
+    if (r->flags & WEB_ROUTE_UI) ui_unlock();
+
+    uint32_t us = micros() - t0;
+    r->count++;
+    r->total_us += us;
+    if (us > r->max_us) r->max_us = us;
+    if (wait_us > r->lock_wait_max_us) r->lock_wait_max_us = wait_us;
+    if (us >= WEB_SLOW_REQUEST_MS * 1000UL) {
+        Serial.printf("[WEB] Slow request %s %s: %lu ms (UI lock wait %lu ms)\n", method_name(web_server->method()),
+                      web_server->uri().c_str(), (unsigned long)(us / 1000), (unsigned long)(wait_us / 1000));
+    }
+}
+
+void web_on(HttpServer &server, const char *uri, HTTPMethod method, HttpServer::THandlerFunction fn,
+            uint8_t flags, size_t max_body, HttpServer::THandlerFunction upload) {
+    web_server = &server;
+    if (web_route_count >= WEB_ROUTE_MAX) {
+        // Still serve it, just without limits or metrics
+        Serial.printf("[WEB] Route table full, %s registered without metrics\n", uri);
+        server.on(uri, method, [fn]() { web_server->readBody(); fn(); }, upload);
+        return;
+    }
+
+    WebRoute *r = &web_routes[web_route_count++];
+    memset(r, 0, sizeof(*r));
+    r->uri = uri;
+    r->method = method;
+    r->flags = flags;
+    r->max_body = max_body;
+
+    // The upload callback runs from readBody() in web_dispatch, after the
+    // size check, so an upload over max_body never reaches it
+    server.on(uri, method, [r, fn]() { web_dispatch(r, fn); }, upload);
+}
+
+void web_task_start(HttpServer &server) {
+    if (web_started) return;
+    web_server = &server;
+    ui_mutex = xSemaphoreCreateMutex();
+    // The caller is the loop task; it owns the UI until loop() first sleeps
+    ui_lock();
+    web_started = server.begin(WEB_TASK_PRIORITY, WEB_TASK_STACK, WEB_TASK_CORE);
+    if (web_started) Serial.printf("[WEB] Config server task started (%d routes)\n", web_route_count);
+}
+
+void web_task_metrics_json(String &out) {
+    uint32_t total = 0, rejected = 0;
+    for (int i = 0; i < web_route_count; ++i) {
+        total += web_routes[i].count;
+        rejected += web_routes[i].rejected;
+    }
+    out += "\"web\":{\"requests\":" + String(total) + ",\"rejected\":" + String(rejected) + ",\"routes\":[";
+    bool first = true;
+    for (int i = 0; i < web_route_count; ++i) {
+        const WebRoute *r = &web_routes[i];
+        if (!r->count && !r->rejected) continue;
+        if (!first) out += ",";
+        first = false;
+        out += "{\"route\":\"" + String(method_name(r->method)) + " " + String(r->uri) + "\"";
+        out += ",\"count\":" + String(r->count);
+        out += ",\"avg_ms\":" + String(r->count ? (float)(r->total_us / r->count) / 1000.0f : 0.0f, 1);
+        out += ",\"max_ms\":" + String(r->max_us / 1000.0f, 1);
+        out += ",\"ui_wait_max_ms\":" + String(r->lock_wait_max_us / 1000.0f, 1);
+        out += ",\"rejected\":" + String(r->rejected) + "}";
+    }
+    out += "]}";
+}
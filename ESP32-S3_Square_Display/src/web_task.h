@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+#include "http_server.h"
+
+// Runs the config web server on its own task so page loads, slow clients
+// and uploads never run on the UI thread.
+//
+// Routes are registered through web_on(), which wraps each handler with a
+// request size check and per-route timing (count, average, worst case and
+// time spent waiting for the UI), reported under "web" in /api/perf.
+//
+// loop() holds the UI lock except while it sleeps between passes. Handlers
+// registered with WEB_ROUTE_UI (anything that touches LVGL objects or
+// screen_configs) take the lock, so they run between frames instead of in
+// the middle of one. Read-only routes run without it and can stream to a
+// slow browser while the display keeps rendering. Handlers that also save
+// to flash or fetch from the network register without the flag and take
+// the lock only around the change itself; the web task is the only writer
+// of the config, so it can persist from the structs after ui_unlock().
+//
+// The server is esp_http_server (see http_server.h): one task waits on up
+// to HTTP_MAX_SOCKETS keep-alive connections at once, but requests are
+// handled one at a time on it, so one slow upload still delays other page
+// loads (never the display). Bodies are read before the UI lock is taken,
+// so a slow client never holds up a frame. Read-only handlers that need
+// screen_configs copy it under ui_lock() and stream from the copy. Live
+// values go over the WebSocket server on port 81, which is separate.
+
+#define WEB_TASK_STACK          8192
+#define WEB_ROUTE_MAX           56
+#define WEB_BODY_MAX_DEFAULT    (32 * 1024)
+#define WEB_UPLOAD_MAX          (2 * 1024 * 1024)
+#define WEB_SLOW_REQUEST_MS     250
+
+// Route flags
+#define WEB_ROUTE_UI            0x01    // run the handler under the UI lock
+
+// Register a route; "{}" in the pattern matches one path segment.
+// Requests whose Content-Length exceeds max_body (0 = no limit) get a 413
+// without the handler (or upload callback) being called, and the
+// connection is closed rather than the body read.
+void web_on(HttpServer &server, const char *uri, HTTPMethod method, HttpServer::THandlerFunction fn,
+            uint8_t flags = WEB_ROUTE_UI, size_t max_body = WEB_BODY_MAX_DEFAULT,
+            HttpServer::THandlerFunction upload = nullptr);
+
+// Start the server task. Call from setup() after the routes are
+// registered; the calling task (the Arduino loop task) then holds the UI lock.
+void web_task_start(HttpServer &server);
+
+// Held by loop() while it works; released around frame_governor_wait()
+void ui_lock(void);
+void ui_unlock(void);
+
+// Append "\"web\":{...}" with the per-route metrics to a JSON object
+void web_task_metrics_json(String &out);
@@ -0,0 +1,93 @@
+// Host tests for the alarm zone tables: pio test -e native -f test_alarm_zones
+#include <unity.h>
+#include <math.h>
+#include "alarm_zones.h"
+
+static AlarmTable t;
+
+// Zones 1..4 from (min, max) pairs; min == max leaves a zone unconfigured
+static void build(const float (*zones)[2], const int *buzzer = NULL) {
+    float mn[ALARM_ZONES + 1] = {0}, mx[ALARM_ZONES + 1] = {0};
+    int bz[ALARM_ZONES + 1] = {0};
+    for (int z = 1; z <= ALARM_ZONES; ++z) {
+        mn[z] = zones[z - 1][0];
+        mx[z] = zones[z - 1][1];
+        if (buzzer) bz[z] = buzzer[z - 1];
+    }
+    alarm_zones_compile(&t, mn, mx, bz);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_narrowest_zone_wins(void) {
+    const float zones[4][2] = {{0, 120}, {0, 0}, {100, 120}, {0, 0}};
+    build(zones);
+    TEST_ASSERT_EQUAL(1, alarm_zones_lookup(&t, 50));
+    TEST_ASSERT_EQUAL(3, alarm_zones_lookup(&t, 110));
+    TEST_ASSERT_EQUAL(0, alarm_zones_lookup(&t, 130));
+}
+
+// A narrow alarm zone inside a wide one is entered once the value is clear of
+// the hysteresis band at its edge, and left again the same way
+static void test_nested_zone_is_entered(void) {
+    const float zones[4][2] = {{0, 120}, {0, 0}, {100, 120}, {0, 0}};
+    build(zones);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.2f, t.hysteresis);
+    TEST_ASSERT_EQUAL(3, alarm_zones_classify(&t, 1, 105));
+    TEST_ASSERT_EQUAL(3, alarm_zones_classify(&t, 1, 110));
+    TEST_ASSERT_EQUAL(3, alarm_zones_classify(&t, 1, 119));
+    TEST_ASSERT_EQUAL(1, alarm_zones_classify(&t, 1, 100.5f));    // just over the edge
+    TEST_ASSERT_EQUAL(3, alarm_zones_classify(&t, 3, 99.5f));     // just back under it
+    TEST_ASSERT_EQUAL(1, alarm_zones_classify(&t, 3, 98));
+}
+
+static void test_adjacent_zones_hysteresis(void) {
+    const float zones[4][2] = {{0, 50}, {50, 80}, {80, 100}, {0, 0}};
+    build(zones);   // band 1.0
+    TEST_ASSERT_EQUAL(1, alarm_zones_classify(&t, 1, 50.5f));
+    TEST_ASSERT_EQUAL(2, alarm_zones_classify(&t, 1, 51.5f));
+    TEST_ASSERT_EQUAL(2, alarm_zones_classify(&t, 2, 49.5f));
+    TEST_ASSERT_EQUAL(1, alarm_zones_classify(&t, 2, 48.5f));
+    TEST_ASSERT_EQUAL(3, alarm_zones_classify(&t, 2, 81.5f));
+    // Not next to the committed zone: no band applies
+    TEST_ASSERT_EQUAL(3, alarm_zones_classify(&t, 1, 80.5f));
+}
+
+// A zone narrower than the band can still be entered
+static void test_zone_narrower_than_band(void) {
+    const float zones[4][2] = {{0, 1000}, {0, 0}, {500, 505}, {0, 0}};
+    build(zones);   // band 10
+    TEST_ASSERT_EQUAL(3, alarm_zones_classify(&t, 1, 502.5f));
+    TEST_ASSERT_EQUAL(1, alarm_zones_classify(&t, 1, 500.5f));
+}
+
+static void test_outside_and_nan(void) {
+    const float zones[4][2] = {{0, 0}, {10, 20}, {0, 0}, {0, 0}};
+    build(zones);
+    TEST_ASSERT_EQUAL(1, alarm_zones_classify(&t, 0, 5));
+    TEST_ASSERT_EQUAL(2, alarm_zones_classify(&t, 0, 15));
+    TEST_ASSERT_EQUAL(2, alarm_zones_classify(&t, 1, NAN));       // first configured zone
+    TEST_ASSERT_TRUE(alarm_zones_exists(&t, 1));
+    TEST_ASSERT_TRUE(alarm_zones_exists(&t, 2));
+    TEST_ASSERT_FALSE(alarm_zones_exists(&t, 3));
+    TEST_ASSERT_FALSE(alarm_zones_exists(&t, 0));
+}
+
+static void test_buzzer_zones(void) {
+    const float zones[4][2] = {{0, 50}, {50, 80}, {80, 100}, {0, 0}};
+    const int buzzer[4] = {0, 0, 1, 0};
+    build(zones, buzzer);
+    TEST_ASSERT_EQUAL(1u << 3, t.buzzer_zones);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_narrowest_zone_wins);
+    RUN_TEST(test_nested_zone_is_entered);
+    RUN_TEST(test_adjacent_zones_hysteresis);
+    RUN_TEST(test_zone_narrower_than_band);
+    RUN_TEST(test_outside_and_nan);
+    RUN_TEST(test_buzzer_zones);
+    return UNITY_END();
+}
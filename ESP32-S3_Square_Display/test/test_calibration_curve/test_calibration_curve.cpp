@@ -0,0 +1,151 @@
+// Host tests and benchmark for the compiled calibration curves:
+//   pio test -e native -f test_calibration_curve
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "calibration_curve.h"
+
+static CalCurve curve;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Compiled lookup against the reference scan over `steps` values spanning
+// the curve plus 10% either side; returns the number of mismatches
+static int sweep_mismatches(const GaugeCalibrationPoint *pts, int n, int steps) {
+    cal_curve_compile(&curve, pts, n, false);
+    float lo = pts[0].value, hi = pts[0].value;
+    for (int i = 1; i < n; ++i) {
+        if (pts[i].value < lo) lo = pts[i].value;
+        if (pts[i].value > hi) hi = pts[i].value;
+    }
+    float span = hi - lo;
+    int bad = 0;
+    for (int k = 0; k <= steps; ++k) {
+        float v = lo - span * 0.1f + span * 1.2f * k / steps;
+        if (cal_curve_eval(&curve, v) != cal_curve_eval_reference(pts, n, v)) ++bad;
+    }
+    // Every calibration point itself
+    for (int i = 0; i < n; ++i)
+        if (cal_curve_eval(&curve, pts[i].value) != cal_curve_eval_reference(pts, n, pts[i].value)) ++bad;
+    return bad;
+}
+
+static void test_linear_ascending_matches_reference(void) {
+    const GaugeCalibrationPoint pts[5] = {{0, 0.0f}, {45, 1000.0f}, {90, 2000.0f}, {135, 3000.0f}, {180, 4000.0f}};
+    TEST_ASSERT_EQUAL(0, sweep_mismatches(pts, 5, 200000));
+    TEST_ASSERT_TRUE(curve.compiled);
+}
+
+static void test_reversed_values_match_reference(void) {
+    const GaugeCalibrationPoint pts[5] = {{-120, 100.0f}, {-60, 75.0f}, {0, 50.0f}, {60, 25.0f}, {120, 0.0f}};
+    TEST_ASSERT_EQUAL(0, sweep_mismatches(pts, 5, 200000));
+    TEST_ASSERT_TRUE(curve.reversed);
+}
+
+static void test_decreasing_angles_match_reference(void) {
+    const GaugeCalibrationPoint pts[5] = {{270, 0.0f}, {200, 0.3f}, {150, 0.45f}, {95, 2.5f}, {-30, 7.75f}};
+    TEST_ASSERT_EQUAL(0, sweep_mismatches(pts, 5, 200000));
+}
+
+// Uneven spacing, small and huge spans, fractional values
+static void test_random_curves_match_reference(void) {
+    srand(1234);
+    int bad = 0;
+    for (int c = 0; c < 300; ++c) {
+        GaugeCalibrationPoint pts[5];
+        float scale = powf(10.0f, (float)(rand() % 8) - 3.0f);
+        float v = ((rand() % 2000) - 1000) * scale * 0.01f;
+        int a = rand() % 360 - 180;
+        bool up = rand() & 1;
+        for (int i = 0; i < 5; ++i) {
+            pts[i].value = v;
+            pts[i].angle = a;
+            float dv = (0.01f + (rand() % 1000) * 0.01f) * scale;
+            v += up ? dv : -dv;
+            a += rand() % 121 - 60;
+        }
+        bad += sweep_mismatches(pts, 5, 5000);
+    }
+    TEST_ASSERT_EQUAL(0, bad);
+}
+
+static void test_out_of_range_and_nan(void) {
+    const GaugeCalibrationPoint pts[3] = {{10, 0.0f}, {50, 5.0f}, {200, 10.0f}};
+    cal_curve_compile(&curve, pts, 3, false);
+    TEST_ASSERT_EQUAL(10, cal_curve_eval(&curve, -1.0f));
+    TEST_ASSERT_EQUAL(200, cal_curve_eval(&curve, 11.0f));
+    TEST_ASSERT_EQUAL(200, cal_curve_eval(&curve, NAN));
+    TEST_ASSERT_EQUAL(cal_curve_eval_reference(pts, 3, NAN), cal_curve_eval(&curve, NAN));
+}
+
+// Values that are not strictly monotone keep the reference scan
+static void test_non_monotone_falls_back(void) {
+    const GaugeCalibrationPoint pts[5] = {{0, 0.0f}, {45, 10.0f}, {90, 5.0f}, {135, 20.0f}, {180, 30.0f}};
+    cal_curve_compile(&curve, pts, 5, false);
+    TEST_ASSERT_FALSE(curve.compiled);
+    for (float v = -5.0f; v <= 35.0f; v += 0.25f)
+        TEST_ASSERT_EQUAL(cal_curve_eval_reference(pts, 5, v), cal_curve_eval(&curve, v));
+}
+
+// The cubic passes through every point and never runs backwards between them
+static void test_cubic_through_points_and_monotone(void) {
+    const GaugeCalibrationPoint pts[5] = {{0, 0.0f}, {20, 10.0f}, {90, 20.0f}, {100, 40.0f}, {180, 100.0f}};
+    cal_curve_compile(&curve, pts, 5, true);
+    TEST_ASSERT_TRUE(curve.cubic);
+    for (int i = 0; i < 5; ++i) TEST_ASSERT_EQUAL(pts[i].angle, cal_curve_eval(&curve, pts[i].value));
+    int prev = cal_curve_eval(&curve, 0.0f);
+    for (float v = 0.0f; v <= 100.0f; v += 0.01f) {
+        int a = cal_curve_eval(&curve, v);
+        TEST_ASSERT_TRUE(a >= prev);
+        prev = a;
+    }
+}
+
+// Time both paths over the same inputs and report ns per lookup
+static void bench(const GaugeCalibrationPoint *pts, int n, const char *name) {
+    cal_curve_compile(&curve, pts, n, false);
+    static float values[4096];
+    float lo = pts[0].value, hi = pts[n - 1].value, span = hi - lo;
+    for (int k = 0; k < 4096; ++k) values[k] = lo - span * 0.1f + span * 1.2f * (float)((k * 2654435761u) % 4096) / 4096.0f;
+    const int rounds = 500;
+    volatile int32_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) for (int k = 0; k < 4096; ++k) sink += cal_curve_eval_reference(pts, n, values[k]);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) for (int k = 0; k < 4096; ++k) sink += cal_curve_eval(&curve, values[k]);
+    auto t2 = std::chrono::steady_clock::now();
+    double lookups = 4096.0 * rounds;
+    char msg[112];
+    snprintf(msg, sizeof(msg), "%s: reference %.1f ns/lookup, compiled %.1f ns/lookup", name,
+             std::chrono::duration<double, std::nano>(t1 - t0).count() / lookups,
+             std::chrono::duration<double, std::nano>(t2 - t1).count() / lookups);
+    TEST_MESSAGE(msg);
+}
+
+// Not a pass/fail check: reports the per-lookup cost of both paths
+static void test_benchmark_against_reference(void) {
+    const GaugeCalibrationPoint five[5] = {{0, 0.0f}, {45, 1000.0f}, {90, 2000.0f}, {135, 3000.0f}, {180, 4000.0f}};
+    bench(five, 5, "5 points");
+    GaugeCalibrationPoint sixteen[CAL_CURVE_MAX_POINTS];
+    for (int i = 0; i < CAL_CURVE_MAX_POINTS; ++i) {
+        sixteen[i].value = i * i * 12.5f;
+        sixteen[i].angle = -135 + i * 18;
+    }
+    bench(sixteen, CAL_CURVE_MAX_POINTS, "16 points");
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_linear_ascending_matches_reference);
+    RUN_TEST(test_reversed_values_match_reference);
+    RUN_TEST(test_decreasing_angles_match_reference);
+    RUN_TEST(test_random_curves_match_reference);
+    RUN_TEST(test_out_of_range_and_nan);
+    RUN_TEST(test_non_monotone_falls_back);
+    RUN_TEST(test_cubic_through_points_and_monotone);
+    RUN_TEST(test_benchmark_against_reference);
+    return UNITY_END();
+}
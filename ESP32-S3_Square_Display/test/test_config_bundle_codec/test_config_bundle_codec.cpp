@@ -0,0 +1,167 @@
+// Host tests for the config bundle format: pio test -e native -f test_config_bundle_codec
+#include <unity.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "config_bundle_codec.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+// Records shaped like the real ones: short strings in mostly empty space
+static void add_section(Bytes &raw, uint8_t tag, uint8_t count, uint16_t rec_size, uint8_t fill) {
+    BundleSection sec = {tag, count, rec_size};
+    const uint8_t *p = (const uint8_t *)&sec;
+    raw.insert(raw.end(), p, p + sizeof(sec));
+    for (size_t i = 0; i < (size_t)count * rec_size; ++i) raw.push_back(i % 64 < 12 ? (uint8_t)(fill + i % 64) : 0);
+}
+
+static Bytes seal(const Bytes &raw, uint8_t flags) {
+    Bytes out(sizeof(BundleHeader) + raw.size() * 2);
+    out.resize(bundle_seal(raw.data(), raw.size(), flags, out.data()));
+    return out;
+}
+
+// What the section walk reported
+struct Walk {
+    std::vector<int> tags;
+    std::vector<size_t> sizes;
+};
+
+static void on_section(void *ctx, const BundleSection *sec, const uint8_t *body) {
+    (void)body;
+    Walk *w = (Walk *)ctx;
+    w->tags.push_back(sec->tag);
+    w->sizes.push_back((size_t)sec->count * sec->rec_size);
+}
+
+static bool walk(const Bytes &raw, Walk *w, uint16_t *have, char *err) {
+    *have = 0;
+    return bundle_sections(raw.data(), raw.size(), on_section, w, have, err, BUNDLE_ERR_LEN);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_pack_round_trip(void) {
+    srand(7);
+    for (int round = 0; round < 200; ++round) {
+        Bytes in(rand() % 2000);
+        // Mostly zeros, with runs past 255 to split
+        for (uint8_t &b : in) b = rand() % 4 ? 0 : (uint8_t)(1 + rand() % 255);
+        if (round == 0) in.assign(1000, 0);
+        Bytes packed(in.size() * 2 + 1);
+        size_t n = bundle_pack(in.data(), in.size(), packed.data());
+        TEST_ASSERT_TRUE(n <= in.size() * 2);
+        Bytes out(in.size() + 1);
+        TEST_ASSERT_TRUE(bundle_unpack(packed.data(), n, out.data(), in.size()));
+        TEST_ASSERT_TRUE(in.empty() || memcmp(in.data(), out.data(), in.size()) == 0);
+    }
+}
+
+static void test_unpack_rejects_bad_data(void) {
+    uint8_t out[16];
+    const uint8_t zero_run_of_zero[] = {1, 0, 0};
+    const uint8_t run_cut_off[] = {1, 0};
+    const uint8_t too_long[] = {1, 0, 20};
+    const uint8_t short_by_one[] = {1, 2, 0, 3};
+    TEST_ASSERT_FALSE(bundle_unpack(zero_run_of_zero, sizeof(zero_run_of_zero), out, 1));
+    TEST_ASSERT_FALSE(bundle_unpack(run_cut_off, sizeof(run_cut_off), out, 1));
+    TEST_ASSERT_FALSE(bundle_unpack(too_long, sizeof(too_long), out, sizeof(out)));
+    TEST_ASSERT_FALSE(bundle_unpack(short_by_one, sizeof(short_by_one), out, 6));
+    TEST_ASSERT_TRUE(bundle_unpack(short_by_one, sizeof(short_by_one), out, 5));
+}
+
+static void test_crc_matches_ieee(void) {
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, bundle_crc32((const uint8_t *)"123456789", 9));
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, bundle_crc32(NULL, 0));
+}
+
+static void test_sealed_bundle_opens(void) {
+    Bytes raw;
+    add_section(raw, SEC_DEVICE, 1, 200, 'd');
+    add_section(raw, SEC_SCREENS, 5, 900, 's');
+    add_section(raw, 0x7E, 2, 10, 'x');         // from a newer firmware: skipped
+    add_section(raw, SEC_ASSETS, 0, 40, 'a');
+    Bytes b = seal(raw, BUNDLE_HAS_PASSWORD);
+    TEST_ASSERT_TRUE(b.size() < raw.size());
+
+    BundleHeader hdr;
+    char err[BUNDLE_ERR_LEN] = "";
+    TEST_ASSERT_TRUE(bundle_open(b.data(), b.size(), &hdr, err, sizeof(err)));
+    TEST_ASSERT_EQUAL(BUNDLE_HAS_PASSWORD, hdr.flags);
+    TEST_ASSERT_EQUAL((long)raw.size(), (long)hdr.raw_len);
+    Bytes out(hdr.raw_len);
+    TEST_ASSERT_TRUE(bundle_unpack(b.data() + sizeof(hdr), hdr.packed_len, out.data(), out.size()));
+    TEST_ASSERT_TRUE(out == raw);
+
+    Walk w;
+    uint16_t have;
+    TEST_ASSERT_TRUE(walk(out, &w, &have, err));
+    TEST_ASSERT_EQUAL(3, (int)w.tags.size());
+    TEST_ASSERT_EQUAL(SEC_DEVICE, w.tags[0]);
+    TEST_ASSERT_EQUAL(SEC_SCREENS, w.tags[1]);
+    TEST_ASSERT_EQUAL(4500, (int)w.sizes[1]);
+    TEST_ASSERT_EQUAL(SEC_ASSETS, w.tags[2]);
+    TEST_ASSERT_EQUAL_HEX16((1 << SEC_DEVICE) | (1 << SEC_SCREENS) | (1 << SEC_ASSETS), have);
+}
+
+static void test_open_rejects_damage(void) {
+    Bytes raw;
+    add_section(raw, SEC_PATHS, 10, 128, 'p');
+    Bytes good = seal(raw, 0);
+    BundleHeader hdr;
+    char err[BUNDLE_ERR_LEN];
+
+    Bytes b = good;
+    b[0] = 'X';
+    TEST_ASSERT_FALSE(bundle_open(b.data(), b.size(), &hdr, err, sizeof(err)));
+    TEST_ASSERT_EQUAL_STRING("Not a config bundle", err);
+    TEST_ASSERT_FALSE(bundle_open(good.data(), 10, &hdr, err, sizeof(err)));
+    TEST_ASSERT_EQUAL_STRING("Not a config bundle", err);
+
+    b = good;
+    b[4] = CONFIG_BUNDLE_VERSION + 1;
+    TEST_ASSERT_FALSE(bundle_open(b.data(), b.size(), &hdr, err, sizeof(err)));
+    TEST_ASSERT_TRUE(strstr(err, "not supported") != NULL);
+
+    TEST_ASSERT_FALSE(bundle_open(good.data(), good.size() - 1, &hdr, err, sizeof(err)));
+    TEST_ASSERT_EQUAL_STRING("Bundle is truncated", err);
+
+    b = good;
+    b[sizeof(BundleHeader) + 5] ^= 0x40;
+    TEST_ASSERT_FALSE(bundle_open(b.data(), b.size(), &hdr, err, sizeof(err)));
+    TEST_ASSERT_EQUAL_STRING("Bundle CRC mismatch", err);
+}
+
+static void test_sections_reject_corruption(void) {
+    Walk w;
+    uint16_t have;
+    char err[BUNDLE_ERR_LEN];
+
+    Bytes raw;
+    add_section(raw, SEC_NEEDLES, 10, 20, 'n');
+    Bytes cut(raw.begin(), raw.end() - 1);
+    TEST_ASSERT_FALSE(walk(cut, &w, &have, err));
+    TEST_ASSERT_EQUAL_STRING("Bundle data is corrupt", err);
+
+    Bytes partial_header = raw;
+    partial_header.push_back(SEC_FILTERS);
+    TEST_ASSERT_FALSE(walk(partial_header, &w, &have, err));
+    TEST_ASSERT_EQUAL_STRING("Bundle data is corrupt", err);
+
+    Bytes twice = raw;
+    add_section(twice, SEC_NEEDLES, 1, 20, 'n');
+    TEST_ASSERT_FALSE(walk(twice, &w, &have, err));
+    TEST_ASSERT_EQUAL_STRING("Duplicate needles section", err);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pack_round_trip);
+    RUN_TEST(test_unpack_rejects_bad_data);
+    RUN_TEST(test_crc_matches_ieee);
+    RUN_TEST(test_sealed_bundle_opens);
+    RUN_TEST(test_open_rejects_damage);
+    RUN_TEST(test_sections_reject_corruption);
+    return UNITY_END();
+}
@@ -0,0 +1,154 @@
+// Host tests and benchmark for the formula compiler and evaluator:
+//   pio test -e native -f test_expression
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include "expression.h"
+
+static ExprProgram prog;
+static char err[96];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Compile and run with the given inputs (in first-use order)
+static float run(const char *src, const float *inputs = NULL) {
+    TEST_ASSERT_TRUE_MESSAGE(expr_compile(src, &prog, err, sizeof(err)), err);
+    static const float none[EXPR_INPUT_MAX] = {0};
+    return expr_eval(&prog, inputs ? inputs : none);
+}
+
+static void expect_error(const char *src, const char *msg) {
+    TEST_ASSERT_FALSE(expr_compile(src, &prog, err, sizeof(err)));
+    TEST_ASSERT_EQUAL(0, prog.code_len);
+    TEST_ASSERT_EQUAL_STRING(msg, err);
+    TEST_ASSERT_TRUE(isnan(expr_eval(&prog, NULL)));
+}
+
+static void test_precedence(void) {
+    TEST_ASSERT_EQUAL_FLOAT(14.0f, run("2 + 3 * 4"));
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, run("(2 + 3) * 4"));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, run("8 / 4 / 2"));
+    TEST_ASSERT_EQUAL_FLOAT(-4.0f, run("10 - 8 - 6"));
+    TEST_ASSERT_EQUAL_FLOAT(512.0f, run("2 ^ 3 ^ 2"));      // right-associative
+    TEST_ASSERT_EQUAL_FLOAT(-4.0f, run("-2 ^ 2"));          // unary minus binds looser than ^
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, run("2 ^ -1"));
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, run("1 + -(-2) * +3"));
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, run(".5 * .5"));
+}
+
+static void test_functions_and_paths(void) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 180.0f, run("deg(pi)"));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, (float)M_PI / 2, run("rad(90)"));
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, run("hypot(3, 4)"));
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, run("min(2, 3)"));
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, run("max(2, 3)"));
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, run("pow(2, 3)"));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, (float)M_PI / 4, run("atan2(1, 1)"));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 2.0f, run("log10(100)"));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, run("ln(exp(1))"));
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, run("abs(sqrt(9) * -1)"));
+
+    // True wind speed from apparent wind and boat speed, one path used twice
+    const float in[3] = {10.0f, (float)M_PI / 2, 6.0f};
+    float tws = run("hypot(environment.wind.speedApparent * cos(environment.wind.angleApparent)"
+                    " - navigation.speedThroughWater, environment.wind.speedApparent"
+                    " * sin(environment.wind.angleApparent))", in);
+    TEST_ASSERT_EQUAL(3, prog.n_inputs);
+    TEST_ASSERT_EQUAL_STRING("environment.wind.speedApparent", prog.inputs[0]);
+    TEST_ASSERT_EQUAL_STRING("navigation.speedThroughWater", prog.inputs[2]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, sqrtf(136.0f), tws);
+}
+
+static void test_nan_propagates(void) {
+    const float in[1] = {NAN};
+    const char *const forms[] = {"a + 1", "a * 0", "-a", "abs(a)", "min(a, 1)", "min(1, a)", "max(a, 1)",
+                                 "max(1, a)", "pow(1, a)", "1 ^ a", "a ^ 0", "hypot(a, 1e30 * 1e30)", "atan2(a, 1)"};
+    for (size_t i = 0; i < sizeof(forms) / sizeof(forms[0]); ++i) {
+        TEST_ASSERT_TRUE_MESSAGE(isnan(run(forms[i], in)), forms[i]);
+    }
+    // Constants and finite inputs are unaffected
+    const float one[1] = {1.0f};
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, run("max(a, 0)", one));
+}
+
+static void test_errors(void) {
+    expect_error("", "Empty formula at position 1");
+    expect_error("   ", "Empty formula at position 4");
+    expect_error("1 +", "Unexpected end of formula at position 4");
+    expect_error("(1 + 2", "Expected ')' at position 7");
+    expect_error("1 2", "Unexpected character at position 3");
+    expect_error("foo(1)", "Unknown function at position 4");
+    expect_error("min(1)", "Expected ',' at position 6");
+    expect_error("sin(1, 2)", "Expected ')' at position 6");
+    expect_error("a. + 1", "Path ends with '.' at position 3");
+    expect_error("a+b+c+d+e+f+g", "Too many different paths at position 14");
+    expect_error("1 # 2", "Unexpected character at position 3");
+}
+
+static void test_nesting_limit(void) {
+    // Just inside the limit: each '(' opens one more level below the top one
+    std::string ok = std::string(EXPR_MAX_NESTING - 1, '(') + "1" + std::string(EXPR_MAX_NESTING - 1, ')');
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, run(ok.c_str()));
+    std::string deep = std::string(EXPR_MAX_NESTING, '(') + "1" + std::string(EXPR_MAX_NESTING, ')');
+    TEST_ASSERT_FALSE(expr_compile(deep.c_str(), &prog, err, sizeof(err)));
+    TEST_ASSERT_NOT_NULL(strstr(err, "nested too deeply"));
+    // Signs and calls count too; a hostile formula fails instead of exhausting the stack
+    std::string signs(10000, '-');
+    signs += "1";
+    TEST_ASSERT_FALSE(expr_compile(signs.c_str(), &prog, err, sizeof(err)));
+    std::string calls;
+    for (int i = 0; i < 5000; ++i) calls += "abs(";
+    calls += "1";
+    TEST_ASSERT_FALSE(expr_compile(calls.c_str(), &prog, err, sizeof(err)));
+    TEST_ASSERT_NOT_NULL(strstr(err, "nested too deeply"));
+}
+
+static void test_stack_and_code_limits(void) {
+    // Right-nested sums keep every operand on the stack
+    std::string wide = "1";
+    for (int i = 0; i < EXPR_STACK_MAX; ++i) wide = "1 + (" + wide + ")";
+    TEST_ASSERT_FALSE(expr_compile(wide.c_str(), &prog, err, sizeof(err)));
+    std::string longf = "1";
+    for (int i = 0; i < EXPR_CODE_MAX; ++i) longf += " + 1";
+    TEST_ASSERT_FALSE(expr_compile(longf.c_str(), &prog, err, sizeof(err)));
+    TEST_ASSERT_NOT_NULL(strstr(err, "Formula too long"));
+}
+
+// Not a pass/fail check: reports the cost of compiling and evaluating
+static void test_benchmark(void) {
+    const char *src = "hypot(environment.wind.speedApparent * cos(environment.wind.angleApparent)"
+                      " - navigation.speedThroughWater, environment.wind.speedApparent"
+                      " * sin(environment.wind.angleApparent))";
+    const int compiles = 20000, evals = 2000000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < compiles; ++i) expr_compile(src, &prog, err, sizeof(err));
+    auto t1 = std::chrono::steady_clock::now();
+    float in[3] = {10.0f, 0.5f, 6.0f};
+    volatile float sink = 0.0f;
+    for (int i = 0; i < evals; ++i) {
+        in[1] = (float)(i & 1023) * 0.006f;
+        sink = sink + expr_eval(&prog, in);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    char msg[112];
+    snprintf(msg, sizeof(msg), "true wind: compile %.0f ns, eval %.1f ns (%u bytes of code)",
+             std::chrono::duration<double, std::nano>(t1 - t0).count() / compiles,
+             std::chrono::duration<double, std::nano>(t2 - t1).count() / evals, (unsigned)prog.code_len);
+    TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_precedence);
+    RUN_TEST(test_functions_and_paths);
+    RUN_TEST(test_nan_propagates);
+    RUN_TEST(test_errors);
+    RUN_TEST(test_nesting_limit);
+    RUN_TEST(test_stack_and_code_limits);
+    RUN_TEST(test_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,170 @@
+// Host tests and throughput for the streaming multipart parser:
+//   pio test -e native -f test_multipart_parser
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "multipart_parser.h"
+
+#define BOUNDARY "----WebKitFormBoundaryx7Qz"
+
+// Body fed to the parser in pieces of `step` bytes (0 = random 1..1500)
+struct Feed {
+    std::string body;
+    size_t pos;
+    size_t step;
+};
+
+struct Seen {
+    std::string name, filename, type, data;
+    bool is_file;
+    bool ended;
+};
+
+static Feed feed;
+static std::vector<Seen> seen;
+
+static int feed_read(void *ctx, char *buf, size_t len) {
+    Feed *f = (Feed *)ctx;
+    size_t n = f->step ? f->step : 1 + (size_t)(rand() % 1500);
+    if (n > len) n = len;
+    if (n > f->body.size() - f->pos) n = f->body.size() - f->pos;
+    memcpy(buf, f->body.data() + f->pos, n);
+    f->pos += n;
+    return (int)n;
+}
+
+static void on_begin(void *, const MultipartPart *p) {
+    seen.push_back({p->name, p->filename, p->content_type, "", p->is_file, false});
+}
+
+static void on_data(void *, const MultipartPart *, const uint8_t *d, size_t n) {
+    seen.back().data.append((const char *)d, n);
+}
+
+static void on_end(void *, const MultipartPart *) {
+    seen.back().ended = true;
+}
+
+static MultipartResult parse(const std::string &body, size_t step) {
+    feed = {body, 0, step};
+    seen.clear();
+    MultipartHandler h = {feed_read, on_begin, on_data, on_end, &feed};
+    return multipart_parse(BOUNDARY, &h);
+}
+
+static std::string field(const char *name, const std::string &value) {
+    return std::string("--" BOUNDARY "\r\nContent-Disposition: form-data; name=\"") + name + "\"\r\n\r\n" + value + "\r\n";
+}
+
+static std::string file(const char *name, const char *filename, const std::string &data) {
+    return std::string("--" BOUNDARY "\r\nContent-Disposition: form-data; name=\"") + name + "\"; filename=\"" +
+           filename + "\"\r\nContent-Type: application/octet-stream\r\n\r\n" + data + "\r\n";
+}
+
+static const std::string closing = "--" BOUNDARY "--\r\n";
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_fields_and_file_any_step(void) {
+    std::string body = field("convert", "1") + file("file", "gauge face.png", "PNGDATA") + field("note", "") + closing;
+    for (size_t step = 1; step <= 64; ++step) {
+        TEST_ASSERT_EQUAL(MULTIPART_OK, parse(body, step));
+        TEST_ASSERT_EQUAL(3, (int)seen.size());
+        TEST_ASSERT_EQUAL_STRING("convert", seen[0].name.c_str());
+        TEST_ASSERT_EQUAL_STRING("1", seen[0].data.c_str());
+        TEST_ASSERT_FALSE(seen[0].is_file);
+        TEST_ASSERT_TRUE(seen[1].is_file);
+        TEST_ASSERT_EQUAL_STRING("gauge face.png", seen[1].filename.c_str());
+        TEST_ASSERT_EQUAL_STRING("application/octet-stream", seen[1].type.c_str());
+        TEST_ASSERT_EQUAL_STRING("PNGDATA", seen[1].data.c_str());
+        TEST_ASSERT_EQUAL_STRING("", seen[2].data.c_str());
+        for (const Seen &s : seen) TEST_ASSERT_TRUE(s.ended);
+    }
+}
+
+// Data holding CRLFs, dashes, a cut-short boundary and the boundary without
+// its CRLF must come through intact
+static void test_near_boundary_data_is_kept(void) {
+    std::string tricky = "a\r\n--" BOUNDARY;
+    tricky.pop_back();
+    tricky += "\r\n\r\n--\r\nx--" BOUNDARY "\n--" BOUNDARY "\r\r\n-" "-end";
+    std::string body = "preamble\r\n" + file("f", "x.bin", tricky) + closing + "epilogue";
+    for (size_t step = 1; step <= 80; ++step) {
+        TEST_ASSERT_EQUAL(MULTIPART_OK, parse(body, step));
+        TEST_ASSERT_EQUAL(1, (int)seen.size());
+        TEST_ASSERT_TRUE(seen[0].data == tricky);
+    }
+}
+
+static void test_large_binary_file(void) {
+    srand(42);
+    std::string data(300 * 1024, '\0');
+    for (char &c : data) c = (char)(rand() & 0xff);
+    std::string body = field("sha256", "abc") + file("firmware", "firmware.bin", data) + closing;
+    TEST_ASSERT_EQUAL(MULTIPART_OK, parse(body, 0));
+    TEST_ASSERT_EQUAL(2, (int)seen.size());
+    TEST_ASSERT_EQUAL((long)data.size(), (long)seen[1].data.size());
+    TEST_ASSERT_TRUE(seen[1].data == data);
+}
+
+static void test_truncated_body(void) {
+    std::string body = file("file", "a.png", std::string(10000, 'x')) + closing;
+    body.resize(6000);
+    TEST_ASSERT_EQUAL(MULTIPART_TRUNCATED, parse(body, 0));
+    TEST_ASSERT_EQUAL(1, (int)seen.size());
+    TEST_ASSERT_FALSE(seen[0].ended);
+    TEST_ASSERT_TRUE(seen[0].data.size() < 6000);
+
+    TEST_ASSERT_EQUAL(MULTIPART_TRUNCATED, parse("", 1));
+    TEST_ASSERT_EQUAL(0, (int)seen.size());
+}
+
+static void test_header_too_long(void) {
+    std::string body = "--" BOUNDARY "\r\nContent-Disposition: form-data; name=\"" + std::string(MULTIPART_WINDOW + 10, 'n') +
+                       "\"\r\n\r\nx\r\n" + closing;
+    TEST_ASSERT_EQUAL(MULTIPART_MALFORMED, parse(body, 0));
+}
+
+static void test_boundary_from_content_type(void) {
+    char b[MULTIPART_BOUNDARY_MAX + 1];
+    TEST_ASSERT_TRUE(multipart_boundary("multipart/form-data; boundary=" BOUNDARY, b, sizeof(b)));
+    TEST_ASSERT_EQUAL_STRING(BOUNDARY, b);
+    TEST_ASSERT_TRUE(multipart_boundary("multipart/form-data; Boundary=\"a b\"; charset=utf-8", b, sizeof(b)));
+    TEST_ASSERT_EQUAL_STRING("a b", b);
+    TEST_ASSERT_FALSE(multipart_boundary("multipart/form-data", b, sizeof(b)));
+    TEST_ASSERT_FALSE(multipart_boundary("multipart/form-data; boundary=", b, sizeof(b)));
+    TEST_ASSERT_FALSE(multipart_boundary(NULL, b, sizeof(b)));
+}
+
+// Not a pass/fail check: parser throughput on a 2 MB upload read in
+// TCP-segment sized pieces
+static void test_throughput(void) {
+    std::string data(2 * 1024 * 1024, '\0');
+    for (size_t i = 0; i < data.size(); ++i) data[i] = (char)(i * 2654435761u >> 24);
+    std::string body = file("file", "big.bin", data) + closing;
+    auto t0 = std::chrono::steady_clock::now();
+    TEST_ASSERT_EQUAL(MULTIPART_OK, parse(body, 1436));
+    auto t1 = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(seen[0].data == data);
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    char msg[96];
+    snprintf(msg, sizeof(msg), "2 MB in %.2f ms (%.0f MB/s)", ms, 2.0 / (ms / 1000.0));
+    TEST_MESSAGE(msg);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fields_and_file_any_step);
+    RUN_TEST(test_near_boundary_data_is_kept);
+    RUN_TEST(test_large_binary_file);
+    RUN_TEST(test_truncated_body);
+    RUN_TEST(test_header_too_long);
+    RUN_TEST(test_boundary_from_content_type);
+    RUN_TEST(test_throughput);
+    return UNITY_END();
+}
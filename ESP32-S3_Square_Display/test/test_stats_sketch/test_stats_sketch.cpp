@@ -0,0 +1,100 @@
+// Host tests for the minute quantile sketch: pio test -e native -f test_stats_sketch
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include "stats_sketch.h"
+
+#define MINUTES 60
+
+static StatsSketch minutes[MINUTES];
+static StatsSketchBin bins[MINUTES * STATS_SKETCH_BINS];
+static const float p[3] = {0.05f, 0.50f, 0.95f};
+
+void setUp(void) {
+    for (int m = 0; m < MINUTES; ++m) stats_sketch_clear(&minutes[m]);
+}
+void tearDown(void) {}
+
+static void merged_quantiles(int count, float *out) {
+    int n = 0;
+    for (int m = 0; m < count; ++m) TEST_ASSERT_TRUE(stats_sketch_collect(&minutes[m], bins, &n, MINUTES * STATS_SKETCH_BINS));
+    stats_sketch_quantiles(bins, n, p, out, 3);
+}
+
+static void test_bin_centre_is_close(void) {
+    const float xs[] = {0.001f, -0.5f, 1.0f, 3.14159f, 293.15f, -40.0f, 101325.0f, 1e-20f};
+    for (unsigned i = 0; i < sizeof(xs) / sizeof(xs[0]); ++i) {
+        StatsSketch s;
+        stats_sketch_clear(&s);
+        stats_sketch_add(&s, xs[i]);
+        TEST_ASSERT_EQUAL(1, s.used);
+        TEST_ASSERT_FLOAT_WITHIN(fabsf(xs[i]) / 128.0f, xs[i], stats_sketch_value(s.key[0]));
+    }
+}
+
+// A minute of steady readings followed by a minute with a spike: the minute
+// means alone would hide the spread the merged bins keep
+static void test_quantiles_see_inside_minutes(void) {
+    for (int i = 0; i < 40; ++i) stats_sketch_add(&minutes[0], 10.0f);
+    for (int i = 0; i < 60; ++i) stats_sketch_add(&minutes[1], i < 54 ? 20.0f : 100.0f);
+    float q[3];
+    merged_quantiles(2, q);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 10.0f, q[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 20.0f, q[1]);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 100.0f, q[2]);
+}
+
+// An hour of uniform noise across minutes against the exact percentiles
+static void test_hour_of_noise_matches_exact(void) {
+    static float all[MINUTES * 120];
+    int total = 0;
+    srand(42);
+    for (int m = 0; m < MINUTES; ++m) {
+        for (int i = 0; i < 120; ++i) {
+            float x = 280.0f + 20.0f * (float)rand() / RAND_MAX + m * 0.1f;
+            stats_sketch_add(&minutes[m], x);
+            int j = total++;
+            while (j > 0 && all[j - 1] > x) { all[j] = all[j - 1]; --j; }
+            all[j] = x;
+        }
+    }
+    float q[3];
+    merged_quantiles(MINUTES, q);
+    for (int k = 0; k < 3; ++k) {
+        float exact = all[(int)lroundf(p[k] * (total - 1))];
+        TEST_ASSERT_FLOAT_WITHIN(exact / 128.0f, exact, q[k]);
+    }
+}
+
+// More distinct values than bins: samples join the nearest bin and the
+// quantiles stay in range and ordered
+static void test_full_sketch_stays_bounded(void) {
+    for (int i = 0; i < 1000; ++i) stats_sketch_add(&minutes[0], (float)(i % 200) - 100.0f);
+    TEST_ASSERT_EQUAL(STATS_SKETCH_BINS, minutes[0].used);
+    uint32_t sum = 0;
+    for (int i = 0; i < minutes[0].used; ++i) {
+        sum += minutes[0].count[i];
+        if (i) TEST_ASSERT_TRUE(minutes[0].key[i - 1] < minutes[0].key[i]);
+    }
+    TEST_ASSERT_EQUAL(1000, sum);
+    float q[3];
+    merged_quantiles(1, q);
+    TEST_ASSERT_TRUE(q[0] <= q[1] && q[1] <= q[2]);
+    TEST_ASSERT_TRUE(q[0] >= -101.0f && q[2] <= 101.0f);
+}
+
+static void test_empty_is_nan(void) {
+    float q[3];
+    merged_quantiles(MINUTES, q);
+    for (int k = 0; k < 3; ++k) TEST_ASSERT_TRUE(isnan(q[k]));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bin_centre_is_close);
+    RUN_TEST(test_quantiles_see_inside_minutes);
+    RUN_TEST(test_hour_of_noise_matches_exact);
+    RUN_TEST(test_full_sketch_stays_bounded);
+    RUN_TEST(test_empty_is_nan);
+    return UNITY_END();
+}
@@ -0,0 +1,433 @@
+'use strict';
+// Single-page config UI over /api/state, /api/config, /api/screens and /api/needles.
+
+const $ = (id) => document.getElementById(id);
+const TYPE_NAMES = ['Gauge', 'Number', 'Dual', 'Quad', 'Gauge + Number', 'Graph'];
+const FILTER_FIELDS = [
+  ['median', 'Median', 1], ['rate_limit', 'Rate /s', 'any'], ['ema_tau', 'EMA tau s', 'any'],
+  ['kalman_q', 'Kalman Q', 'any'], ['kalman_r', 'Kalman R', 'any'],
+];
+// Filter "circular" option: angle paths are smoothed the short way round
+const WRAP_NAMES = ['no', '0..2\u03c0', '\u00b1\u03c0'];
+const FONT_NAMES = ['Small (48pt)', 'Medium (72pt)', 'Large (96pt)', 'X-Large (120pt)', 'XX-Large (144pt)'];
+const CHART_NAMES = ['Line Chart', 'Bar Chart', 'Scatter Plot'];
+const RANGE_NAMES = ['10 seconds', '30 seconds', '1 minute', '5 minutes', '10 minutes', '30 minutes',
+  '6 hours', '24 hours', '7 days'];
+const ICON_POS_NAMES = ['Top', 'Right', 'Bottom', 'Left'];
+const WIDGET_NAMES = ['Top needle (\u00b0)', 'Bottom needle (\u00b0)', 'Number / top / top-left / center',
+  'Bottom / top-right', 'Bottom-left', 'Bottom-right'];
+const NEEDLE_FIELDS = [
+  ['width', 'Width'], ['inner', 'Inner r'], ['outer', 'Outer r'], ['cx', 'Center x'], ['cy', 'Center y'],
+  ['damping_ms', 'Damping ms'], ['max_rate', 'Max \u00b0/s'],
+];
+const NEEDLE_FLAGS = [['rounded', 'Rounded'], ['gradient', 'Gradient'], ['foreground', 'On top']];
+
+let pollTimer = null;
+let numScreens = 0;
+let editScreen = 1;       // screen shown on the Gauges and Needles tabs
+
+function el(tag, props, children) {
+  const e = document.createElement(tag);
+  Object.assign(e, props || {});
+  (children || []).forEach((c) => e.append(c));
+  return e;
+}
+
+function message(text, isError) {
+  const m = $('msg');
+  m.textContent = text;
+  m.className = isError ? 'msg err' : 'msg';
+}
+
+async function api(path, body, method) {
+  const opts = body === undefined ? {} : {
+    method: method || 'POST', headers: {'Content-Type': 'application/json'}, body: JSON.stringify(body),
+  };
+  const r = await fetch(path, opts);
+  const data = await r.json();
+  if (!r.ok) throw new Error(data.error || r.statusText);
+  return data;
+}
+
+function fmt(v) {
+  if (v === null || v === undefined) return '--';
+  return Math.abs(v) >= 100 ? v.toFixed(0) : v.toFixed(2);
+}
+
+// ---- Live tab ---------------------------------------------------------------
+
+function renderState(st) {
+  numScreens = st.num_screens;
+  const w = st.wifi;
+  $('status').textContent = `Status: ${w.connected ? 'Connected' : 'AP Mode'} | IP: ${w.ip}` +
+    ` | Hostname: ${w.hostname ? w.hostname + '.local' : '(not set)'}` +
+    ` | Heap: ${Math.round(st.heap_free / 1024)} KB | Up ${Math.round(st.uptime_ms / 60000)} min`;
+
+  const row = $('screens');
+  row.replaceChildren();
+  for (let i = 1; i <= st.num_screens; i++) {
+    const b = el('button', {className: 'tab-btn' + (i === st.screen ? ' active' : ''), textContent: 'Screen ' + i});
+    b.onclick = () => api('/api/state', {screen: i}).then(renderState).catch((e) => message(e.message, true));
+    row.append(b);
+  }
+
+  const table = $('values');
+  table.replaceChildren(el('tr', {}, [
+    el('th', {textContent: 'Screen'}), el('th', {textContent: 'Slot'}),
+    el('th', {textContent: 'Path'}), el('th', {textContent: 'Value'}),
+  ]));
+  st.screens.forEach((s, i) => {
+    s.values.forEach((v) => {
+      table.append(el('tr', {}, [
+        el('td', {textContent: `${i + 1} (${TYPE_NAMES[s.display_type] || '?'})`}),
+        el('td', {textContent: v.slot.replace(/_/g, ' ')}),
+        el('td', {textContent: v.path}),
+        el('td', {className: 'value', textContent: `${fmt(v.value)} ${v.unit}`}),
+      ]));
+    });
+  });
+}
+
+function poll() {
+  api('/api/state').then(renderState).catch(() => { $('status').textContent = 'Device not responding'; });
+}
+
+// ---- Config tabs ------------------------------------------------------------
+
+function renderDevice(dev) {
+  ['buzzer_mode', 'buzzer_cooldown', 'auto_scroll'].forEach((k) => { $(k).value = String(dev[k]); });
+}
+
+function input(type, value, step) {
+  const i = el('input', {type, value: value === undefined ? '' : value});
+  if (step) i.step = step;
+  return i;
+}
+
+function select(names, value) {
+  const s = el('select', {}, names.map((n, i) => el('option', {value: String(i), textContent: n})));
+  s.value = String(value || 0);
+  return s;
+}
+
+function checkbox(on) {
+  return el('input', {type: 'checkbox', checked: !!on});
+}
+
+function colorInput(value, fallback) {
+  return el('input', {type: 'color', value: value || fallback});
+}
+
+function filterRow(f) {
+  const cells = [el('td', {}, [input('text', f.path || '')])];
+  FILTER_FIELDS.forEach(([k, , step]) => cells.push(el('td', {}, [input('number', f[k] || 0, step)])));
+  cells.push(el('td', {}, [select(WRAP_NAMES, f.circular)]));
+  return el('tr', {}, cells);
+}
+
+function renderFilters(list) {
+  const t = $('filters');
+  t.replaceChildren(el('tr', {}, [el('th', {textContent: 'Path'})]
+    .concat(FILTER_FIELDS.map(([, label]) => el('th', {textContent: label})), [el('th', {textContent: 'Angle'})])));
+  list.forEach((f) => t.append(filterRow(f)));
+}
+
+function derivedRow(d) {
+  let status = '';
+  if (d.name) status = d.compiled ? (d.value === null ? 'waiting for data' : fmt(d.value)) : d.error;
+  return el('tr', {}, [
+    el('td', {}, [input('text', d.name || '')]),
+    el('td', {}, [input('text', d.formula || '')]),
+    el('td', {className: d.compiled === false ? 'err' : '', textContent: status}),
+  ]);
+}
+
+function renderDerived(list) {
+  const t = $('derived');
+  t.replaceChildren(el('tr', {}, [
+    el('th', {textContent: 'Output path'}), el('th', {textContent: 'Formula'}), el('th', {textContent: 'Status'}),
+  ]));
+  list.forEach((d) => t.append(derivedRow(d)));
+}
+
+function renderConfig(cfg) {
+  renderDevice(cfg.device);
+  renderFilters(cfg.filters);
+  renderDerived(cfg.derived);
+}
+
+function rows(tableId) {
+  return Array.from($(tableId).querySelectorAll('tr')).slice(1).map((tr) => tr.querySelectorAll('input, select'));
+}
+
+function save(body, what) {
+  message('Saving...');
+  api('/api/config', body).then((cfg) => { renderConfig(cfg); message(what + ' saved'); })
+    .catch((e) => message(e.message, true));
+}
+
+$('save-device').onclick = () => save({device: {
+  buzzer_mode: +$('buzzer_mode').value, buzzer_cooldown: +$('buzzer_cooldown').value, auto_scroll: +$('auto_scroll').value,
+}}, 'Device settings');
+
+$('save-filters').onclick = () => save({filters: rows('filters').map((ins) => {
+  const f = {path: ins[0].value.trim()};
+  FILTER_FIELDS.forEach(([k], i) => { f[k] = +ins[i + 1].value || 0; });
+  f.circular = +ins[FILTER_FIELDS.length + 1].value;
+  return f;
+}).filter((f) => f.path)}, 'Filters');
+
+$('save-derived').onclick = () => save({derived: rows('derived').map((ins) => ({
+  name: ins[0].value.trim(), formula: ins[1].value.trim(),
+})).filter((d) => d.name)}, 'Derived values');
+
+$('add-filter').onclick = () => { if (rows('filters').length < 12) $('filters').append(filterRow({})); };
+$('add-derived').onclick = () => { if (rows('derived').length < 8) $('derived').append(derivedRow({})); };
+
+// ---- Gauges and needles tabs ------------------------------------------------
+// One screen at a time. Save sends only the fields that differ from what was
+// loaded, so the device re-applies no more than the edit touched.
+
+let screenEdit = null;    // {loaded, assets, type, parts: [[box, shown(type), read(edited)]]}
+let needlesLoaded = [];
+
+// Fields of `after` that differ from `before`, or null. Arrays are patched by
+// position on the device, so unchanged entries ahead of a change go as {}.
+function changes(before, after) {
+  if (Array.isArray(after)) {
+    const out = after.map((a, i) => changes(before[i], a));
+    const last = out.reduce((l, c, i) => (c === null ? l : i), -1);
+    return last < 0 ? null : out.slice(0, last + 1).map((c) => c || {});
+  }
+  if (after !== null && typeof after === 'object') {
+    const out = {};
+    Object.keys(after).forEach((k) => {
+      const c = changes(before[k], after[k]);
+      if (c !== null) out[k] = c;
+    });
+    return Object.keys(out).length ? out : null;
+  }
+  // Colour pickers report lower case
+  if (typeof after === 'string' && /^#[0-9a-f]{6}$/.test(after) && after === String(before).toLowerCase()) return null;
+  return after === before ? null : after;
+}
+
+function formRow(label, control) {
+  return el('div', {className: 'form-row'}, [el('label', {textContent: label + ':'}), control]);
+}
+
+function table(heads, cells) {
+  return el('table', {className: 'table'}, [el('tr', {}, heads.map((h) => el('th', {textContent: h})))]
+    .concat(cells.map((row) => el('tr', {}, row.map((c) => el('td', {}, [c]))))));
+}
+
+// Asset picker holding paths in the "S://assets/<name>" form the gauges page
+// stores. A saved path spelled differently, or no longer on the card, is kept
+// as it is so saving does not change it.
+function assetSelect(files, value, fixed) {
+  const norm = (p) => p.toLowerCase().replace(/\/+/g, '/');
+  const opts = fixed.concat(files.map((f) => [f, f]));
+  if (value && !opts.some(([v]) => v === value)) {
+    const same = opts.find(([v]) => v && norm(v) === norm(value));
+    if (same) same[0] = value;
+    else opts.push([value, value]);
+  }
+  const s = el('select', {}, opts.map(([v, text]) => el('option', {value: v, textContent: text})));
+  s.value = value;
+  return s;
+}
+
+function screenButtons(rowId, load) {
+  const row = $(rowId);
+  row.replaceChildren();
+  for (let i = 1; i <= numScreens; i++) {
+    const b = el('button', {className: 'tab-btn' + (i === editScreen ? ' active' : ''), textContent: 'Screen ' + i});
+    b.onclick = () => { editScreen = i; load(); };
+    row.append(b);
+  }
+}
+
+// A block of the screen form, shown for the display types `shown` accepts
+function part(shown, children, read) {
+  const box = el('div', {}, children);
+  screenEdit.parts.push([box, shown, read]);
+  return box;
+}
+
+function showParts() {
+  const t = +screenEdit.type.value;
+  screenEdit.parts.forEach(([box, shown]) => { box.hidden = !shown(t); });
+}
+
+function gaugePart(shown, sc, g, icons) {
+  const gd = sc.gauges[g];
+  const path = input('text', gd.path);
+  const icon = assetSelect(icons, gd.icon, [['', 'None']]);
+  const pos = select(ICON_POS_NAMES, gd.icon_pos);
+  const cubic = checkbox(gd.cubic);
+  const cal = gd.calibration.map((p) => [input('number', p.angle, 1), input('number', p.value, 'any')]);
+  const zones = gd.zones.map((z) => [input('number', z.min, 'any'), input('number', z.max, 'any'),
+    colorInput(z.color, '#000000'), checkbox(z.transparent), checkbox(z.buzzer)]);
+  return part(shown, [
+    el('h3', {textContent: g ? 'Bottom gauge' : 'Top gauge'}),
+    formRow('Signal K path', path), formRow('Icon', icon), formRow('Icon position', pos),
+    table(['Point', 'Angle', 'Value'], cal.map((c, i) => [String(i + 1)].concat(c))),
+    el('label', {}, [cubic, ' Smooth curve between points (monotone cubic)']),
+    table(['Zone', 'Min', 'Max', 'Color', 'Transparent', 'Buzzer'], zones.map((z, i) => [String(i + 1)].concat(z))),
+  ], (e) => Object.assign(e.gauges[g], {
+    path: path.value.trim(), icon: icon.value, icon_pos: +pos.value, cubic: cubic.checked,
+    calibration: cal.map(([a, v]) => ({angle: +a.value, value: +v.value})),
+    zones: zones.map(([mn, mx, c, t, b]) => ({
+      min: +mn.value, max: +mx.value, color: c.value, transparent: t.checked, buzzer: b.checked,
+    })),
+  }));
+}
+
+function numberPart(shown, sc, prefix, heading, sizes) {
+  const path = input('text', sc[prefix + '_path']);
+  const size = select(sizes, sc[prefix + '_font_size']);
+  const color = colorInput(sc[prefix + '_font_color'], '#ffffff');
+  return part(shown, [
+    el('h3', {textContent: heading}), formRow('Signal K path', path), formRow('Font size', size), formRow('Font color', color),
+  ], (e) => {
+    e[prefix + '_path'] = path.value.trim();
+    e[prefix + '_font_size'] = +size.value;
+    e[prefix + '_font_color'] = color.value;
+  });
+}
+
+function renderScreen(sc, assets) {
+  const listed = assets.filter((a) => a.name[0] !== '_');
+  const files = (types) => listed.filter((a) => types.includes(a.type)).map((a) => 'S://assets/' + a.name);
+  const icons = files(['png', 'rgb565a']);
+  const type = select(TYPE_NAMES, sc.display_type);
+  screenEdit = {loaded: sc, assets, type, parts: []};
+
+  const bg = assetSelect(files(['rgb565']), sc.background_path, [['', 'Default'], ['Custom Color', 'Custom Color']]);
+  const bgColor = colorInput(sc.number_bg_color, '#000000');
+  const bottom = checkbox(sc.show_bottom);
+  const graph = [input('text', sc.number_path), select(CHART_NAMES, sc.graph_chart_type),
+    select(RANGE_NAMES, sc.graph_time_range), colorInput(sc.number_font_color, '#00ff00'),
+    input('text', sc.graph_path_2), colorInput(sc.graph_color_2, '#ff0000')];
+  const redraw = sc.redraw.map((r) => [input('number', r.deadband, 'any'), input('number', r.min_ms, 1),
+    input('number', r.resolution, 'any')]);
+  const isGauge = (t) => t === 0 || t === 4;
+  const quad = FONT_NAMES.slice(0, 3);
+
+  $('screen-form').replaceChildren(
+    part(() => true, [formRow('Display type', type), formRow('Background', bg), formRow('Background color', bgColor)], (e) => {
+      e.display_type = +type.value;
+      e.background_path = bg.value;
+      e.number_bg_color = bgColor.value;
+    }),
+    gaugePart(isGauge, sc, 0, icons),
+    part((t) => t === 0, [el('label', {}, [bottom, ' Show bottom gauge'])], (e) => { e.show_bottom = bottom.checked ? 1 : 0; }),
+    gaugePart((t) => t === 0 && bottom.checked, sc, 1, icons),
+    numberPart((t) => t === 1, sc, 'number', 'Number', FONT_NAMES),
+    numberPart((t) => t === 2, sc, 'dual_top', 'Top number', FONT_NAMES),
+    numberPart((t) => t === 2, sc, 'dual_bottom', 'Bottom number', FONT_NAMES),
+    numberPart((t) => t === 3, sc, 'quad_tl', 'Top-left', quad),
+    numberPart((t) => t === 3, sc, 'quad_tr', 'Top-right', quad),
+    numberPart((t) => t === 3, sc, 'quad_bl', 'Bottom-left', quad),
+    numberPart((t) => t === 3, sc, 'quad_br', 'Bottom-right', quad),
+    numberPart((t) => t === 4, sc, 'gauge_num_center', 'Center number', FONT_NAMES),
+    part((t) => t === 5, [el('h3', {textContent: 'Graph'})].concat(['Signal K path', 'Chart type', 'Time range',
+      'Series 1 color', 'Signal K path 2', 'Series 2 color'].map((label, i) => formRow(label, graph[i]))), (e) => {
+      e.number_path = graph[0].value.trim();
+      e.graph_chart_type = +graph[1].value;
+      e.graph_time_range = +graph[2].value;
+      e.number_font_color = graph[3].value;
+      e.graph_path_2 = graph[4].value.trim();
+      e.graph_color_2 = graph[5].value;
+    }),
+    part(() => true, [el('details', {}, [el('summary', {textContent: 'Redraw filtering'}),
+      table(['Widget', 'Deadband', 'Min interval (ms)', 'Resolution'], redraw.map((r, i) => [WIDGET_NAMES[i]].concat(r)))])],
+    (e) => { e.redraw = redraw.map(([d, ms, res]) => ({deadband: +d.value, min_ms: +ms.value, resolution: +res.value})); }),
+  );
+  type.onchange = showParts;
+  bottom.onchange = showParts;
+  showParts();
+}
+
+// The loaded screen with every visible part of the form copied over it
+function readScreen() {
+  const t = +screenEdit.type.value;
+  const e = JSON.parse(JSON.stringify(screenEdit.loaded));
+  screenEdit.parts.forEach(([, shown, read]) => { if (shown(t)) read(e); });
+  return e;
+}
+
+async function loadScreen() {
+  try {
+    if (!numScreens) numScreens = (await api('/api/state')).num_screens;
+    screenButtons('gauge-screens', loadScreen);
+    const [sc, assets] = await Promise.all([api(`/api/screens/${editScreen}`), api('/api/assets')]);
+    renderScreen(sc, assets);
+  } catch (e) {
+    message(e.message, true);
+  }
+}
+
+function renderNeedles(list) {
+  needlesLoaded = list;
+  const t = $('needles');
+  t.replaceChildren(el('tr', {}, ['Needle', 'Color'].concat(NEEDLE_FIELDS.map(([, l]) => l), NEEDLE_FLAGS.map(([, l]) => l))
+    .map((h) => el('th', {textContent: h}))));
+  list.forEach((ns, g) => t.append(el('tr', {}, [
+    el('td', {textContent: g ? 'Bottom' : 'Top'}), el('td', {}, [colorInput(ns.color, '#ffffff')]),
+  ].concat(NEEDLE_FIELDS.map(([k]) => el('td', {}, [input('number', ns[k], 1)])),
+    NEEDLE_FLAGS.map(([k]) => el('td', {}, [checkbox(ns[k])]))))));
+}
+
+async function loadNeedles() {
+  try {
+    if (!numScreens) numScreens = (await api('/api/state')).num_screens;
+    screenButtons('needle-screens', loadNeedles);
+    renderNeedles(await Promise.all([0, 1].map((g) => api(`/api/needles/${editScreen}/${g}`))));
+  } catch (e) {
+    message(e.message, true);
+  }
+}
+
+$('save-screen').onclick = () => {
+  const n = editScreen;
+  const body = changes(screenEdit.loaded, readScreen());
+  if (!body) { message('No changes'); return; }
+  message('Saving...');
+  api(`/api/screens/${n}`, body, 'PATCH').then((sc) => {
+    if (n === editScreen) renderScreen(sc, screenEdit.assets);
+    message(`Screen ${n} saved`);
+  }).catch((e) => message(e.message, true));
+};
+
+$('save-needles').onclick = () => {
+  const n = editScreen;
+  const patches = rows('needles').map((ins, g) => {
+    const ns = {color: ins[0].value};
+    NEEDLE_FIELDS.forEach(([k], i) => { ns[k] = +ins[i + 1].value; });
+    NEEDLE_FLAGS.forEach(([k], i) => { ns[k] = ins[NEEDLE_FIELDS.length + 1 + i].checked; });
+    return changes(needlesLoaded[g], ns);
+  });
+  if (!patches.some((p) => p)) { message('No changes'); return; }
+  message('Saving...');
+  Promise.all(patches.map((p, g) => (p ? api(`/api/needles/${n}/${g}`, p, 'PATCH') : needlesLoaded[g]))).then((list) => {
+    if (n === editScreen) renderNeedles(list);
+    message(`Screen ${n} needles saved`);
+  }).catch((e) => message(e.message, true));
+};
+
+// ---- Tabs -------------------------------------------------------------------
+
+function showTab(name) {
+  document.querySelectorAll('.tabs .tab-btn').forEach((b) => b.classList.toggle('active', b.dataset.tab === name));
+  document.querySelectorAll('section').forEach((s) => { s.hidden = s.id !== 'tab-' + name; });
+  clearInterval(pollTimer);
+  if (name === 'live') { poll(); pollTimer = setInterval(poll, 2000); }
+  if (name === 'gauges') loadScreen();
+  if (name === 'needles') loadNeedles();
+  message('');
+}
+
+document.querySelectorAll('.tabs .tab-btn').forEach((b) => { b.onclick = () => showTab(b.dataset.tab); });
+api('/api/config').then(renderConfig).catch((e) => message(e.message, true));
+showTab('live');